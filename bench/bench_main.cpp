@@ -0,0 +1,330 @@
+/**
+ * Micro-benchmarks for the MD and heat-diffusion (2D, 3D) hot paths.
+ * Run via: ./run.sh --bench [-- --json] [-- --quick]
+ *
+ * Output is one record per (benchmark, size): CSV on stdout by default,
+ * JSON with --json. ns_per_item is per particle-step for MD benchmarks and
+ * per cell-update for heat diffusion; items_per_s is its inverse.
+ */
+#include <matsimu/core/types.hpp>
+#include <matsimu/lattice/lattice.hpp>
+#include <matsimu/physics/integrator.hpp>
+#include <matsimu/physics/neighbor_list.hpp>
+#include <matsimu/physics/particle_builder.hpp>
+#include <matsimu/physics/potential.hpp>
+#include <matsimu/sim/heat_diffusion_2d.hpp>
+#include <matsimu/sim/device_simulation.hpp>
+#include <matsimu/sim/heat_diffusion_3d.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+  bool json{false};
+  bool quick{false};
+  double min_seconds{0.2};  // per timing batch
+};
+
+struct Record {
+  std::string name;
+  std::size_t size;     // particles or grid cells
+  std::size_t reps;     // calls in the best batch
+  double ns_per_op;     // one call
+  double ns_per_item;   // one particle-step / cell-update
+};
+
+using Clock = std::chrono::steady_clock;
+
+/// Best of three batches, each repeating op until min_seconds elapse.
+/// steps_per_op: time steps one call advances (ns_per_item is per step).
+Record time_op(const Options& opt, const std::string& name, std::size_t size,
+               const std::function<void()>& op, std::size_t steps_per_op = 1) {
+  op();  // warm-up (first neighbor build, page faults)
+  double best = 1e300;
+  std::size_t best_reps = 0;
+  for (int batch = 0; batch < 3; ++batch) {
+    std::size_t reps = 0;
+    const auto t0 = Clock::now();
+    double elapsed = 0.0;
+    do {
+      op();
+      ++reps;
+      elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    } while (elapsed < opt.min_seconds);
+    const double ns = elapsed * 1e9 / static_cast<double>(reps);
+    if (ns < best) {
+      best = ns;
+      best_reps = reps;
+    }
+  }
+  return {name, size, best_reps, best, best / static_cast<double>(size * steps_per_op)};
+}
+
+// Argon-like LJ liquid: jittered simple-cubic lattice at 0.36 nm spacing.
+constexpr matsimu::Real kEpsilon = 1.65e-21;
+constexpr matsimu::Real kSigma = 0.34e-9;
+constexpr matsimu::Real kCutoff = 2.5 * kSigma;
+constexpr matsimu::Real kSkin = 0.1e-9;
+constexpr matsimu::Real kSpacing = 0.36e-9;
+constexpr matsimu::Real kMass = 6.63e-26;
+
+matsimu::ParticleSystem make_liquid(std::size_t n, matsimu::Lattice& box) {
+  const std::size_t side = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(n))));
+  const matsimu::Real len = kSpacing * static_cast<matsimu::Real>(side);
+  box.a1[0] = len; box.a1[1] = 0.0; box.a1[2] = 0.0;
+  box.a2[0] = 0.0; box.a2[1] = len; box.a2[2] = 0.0;
+  box.a3[0] = 0.0; box.a3[1] = 0.0; box.a3[2] = len;
+  box.update_cache();
+
+  std::vector<matsimu::Real> x[3], v[3];
+  for (int d = 0; d < 3; ++d) {
+    x[d].resize(n);
+    v[d].resize(n);
+  }
+  std::mt19937 rng(42u);
+  std::uniform_real_distribution<matsimu::Real> jitter(-0.05 * kSpacing, 0.05 * kSpacing);
+  std::normal_distribution<matsimu::Real> vel(0.0, 200.0);
+  for (std::size_t k = 0; k < n; ++k) {
+    const std::size_t cell[3] = {k % side, (k / side) % side, k / (side * side)};
+    for (int d = 0; d < 3; ++d)
+      x[d][k] = (static_cast<matsimu::Real>(cell[d]) + 0.5) * kSpacing + jitter(rng);
+    for (int d = 0; d < 3; ++d) v[d][k] = vel(rng);
+  }
+  matsimu::ParticleSystem ps;
+  const matsimu::Real* pos[3] = {x[0].data(), x[1].data(), x[2].data()};
+  const matsimu::Real* vels[3] = {v[0].data(), v[1].data(), v[2].data()};
+  ps.append(n, pos, vels, kMass);
+  return ps;
+}
+
+void bench_md(const Options& opt, std::vector<Record>& out) {
+  const std::vector<std::size_t> sizes = opt.quick
+      ? std::vector<std::size_t>{256, 2048}
+      : std::vector<std::size_t>{256, 2048, 8192, 32768};
+  const std::size_t all_pairs_max = opt.quick ? 2048 : 8192;
+  auto lj = std::make_shared<matsimu::LennardJones>(kEpsilon, kSigma, kCutoff);
+  auto tabulated = std::make_shared<matsimu::TabulatedPotential>(*lj, 0.8 * kSigma);
+
+  for (std::size_t n : sizes) {
+    matsimu::Lattice box;
+    matsimu::ParticleSystem ps = make_liquid(n, box);
+
+    if (n <= all_pairs_max) {
+      matsimu::ForceField ff(lj);
+      out.push_back(time_op(opt, "force_all_pairs", n, [&] { ff.compute_forces(ps, &box); }));
+    }
+
+    matsimu::NeighborForceField nff(lj, kCutoff, kSkin);
+    nff.set_precision(matsimu::Precision::Double);
+    out.push_back(time_op(opt, "force_neighbor", n, [&] { nff.compute_forces(ps, &box); }));
+    matsimu::NeighborForceField nff_fp32(lj, kCutoff, kSkin);
+    nff_fp32.set_precision(matsimu::Precision::Single);
+    out.push_back(time_op(opt, "force_neighbor_fp32", n, [&] { nff_fp32.compute_forces(ps, &box); }));
+    matsimu::NeighborForceField nff_table(tabulated, kCutoff, kSkin);
+    out.push_back(time_op(opt, "force_neighbor_tabulated", n, [&] { nff_table.compute_forces(ps, &box); }));
+    // Same pass carrying the RDF/virial sinks of a sampled step.
+    matsimu::PairSampler sampler;
+    sampler.set_rdf(100, kCutoff);
+    sampler.set_histogram(true);
+    out.push_back(time_op(opt, "force_neighbor_sampled", n, [&] {
+      nff.compute_forces(ps, &box, true, matsimu::ForceShell::All, &sampler);
+    }));
+
+    // System setup: fcc replication of a cell with ~n atoms, and random
+    // placement with cell-list overlap rejection into the liquid's box.
+    matsimu::Lattice fcc_cell;
+    fcc_cell.a1[0] = fcc_cell.a2[1] = fcc_cell.a3[2] = 0.526e-9;
+    matsimu::CrystalSpec fcc;
+    for (auto& r : fcc.repeats)
+      r = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(n) / 4.0)));
+    out.push_back(time_op(opt, "build_fcc", n, [&] {
+      matsimu::ParticleSystem crystal;
+      matsimu::fill_crystal(crystal, fcc_cell, fcc);
+    }));
+    out.push_back(time_op(opt, "place_random_overlap", n, [&] {
+      matsimu::PlacementGrid grid(box, 0.2 * kSpacing);
+      std::mt19937 rng(3u);
+      std::uniform_real_distribution<matsimu::Real> uni(0.0, box.a1[0]);
+      while (grid.size() < n) {
+        const matsimu::Real r[3] = {uni(rng), uni(rng), uni(rng)};
+        grid.try_insert(r);
+      }
+    }));
+
+    matsimu::NeighborList cells(kCutoff, kSkin, matsimu::NeighborBuild::Cells);
+    out.push_back(time_op(opt, "neighbor_build_cells", n, [&] { cells.build(ps, &box); }));
+    if (n <= all_pairs_max) {
+      matsimu::NeighborList brute(kCutoff, kSkin, matsimu::NeighborBuild::BruteForce);
+      out.push_back(time_op(opt, "neighbor_build_brute", n, [&] { brute.build(ps, &box); }));
+    }
+
+    // Integrator alone: both half-steps, forces held fixed. Runs on a copy
+    // so the drifted positions do not leak into the full-step benchmark.
+    matsimu::VelocityVerlet vv(1e-15);
+    matsimu::ParticleSystem drift = ps;
+    out.push_back(time_op(opt, "verlet_step", n, [&] {
+      vv.step1(drift);
+      vv.step2(drift);
+    }));
+
+    // Full MD step as Simulation runs it (integrate, wrap, forces).
+    out.push_back(time_op(opt, "md_step_neighbor", n, [&] {
+      vv.step1(ps);
+      ps.apply_pbc(box);
+      nff.compute_forces(ps, &box);
+      vv.step2(ps);
+    }));
+
+    // r-RESPA: 4 fs outer steps over four 1 fs inner steps, timed per
+    // particle-fs like md_step_neighbor (a net win is a lower ns_per_item).
+    const matsimu::Real split = 0.6 * kCutoff, width = 0.2 * split;
+    matsimu::NeighborForceField nff_respa(lj, kCutoff, kSkin);
+    nff_respa.set_precision(matsimu::Precision::Double);
+    nff_respa.set_shell_switch(split, width);
+    matsimu::RespaIntegrator respa(4e-15, 4, split, width);
+    const matsimu::RespaIntegrator::ForcePass inner = [&](matsimu::ParticleSystem& s) {
+      s.apply_pbc(box);
+      nff_respa.compute_forces(s, &box, true, matsimu::ForceShell::Inner);
+    };
+    const matsimu::RespaIntegrator::ForcePass outer = [&](matsimu::ParticleSystem& s) {
+      nff_respa.compute_forces(s, &box, true, matsimu::ForceShell::Outer);
+    };
+    respa.prime(ps, inner, outer);
+    out.push_back(time_op(opt, "md_step_respa", n, [&] { respa.step(ps, inner, outer); }, 4));
+
+    // Same step with the state resident on the offload device (host loops
+    // without MATSIMU_USE_OFFLOAD).
+    {
+      matsimu::SimulationParams mp;
+      mp.cutoff = kCutoff;
+      mp.neighbor_skin = kSkin;
+      mp.dt = 1e-15;
+      mp.max_steps = static_cast<std::size_t>(-1);
+      mp.energy_interval = 0;
+      matsimu::DeviceSimulation device(mp, lj);
+      device.system() = ps;
+      device.set_lattice(box);
+      if (device.is_valid())
+        out.push_back(time_op(opt, "md_step_device", n, [&] { device.step(); }));
+      else
+        std::fprintf(stderr, "md_step_device %zu: %s\n", n, device.error_message().c_str());
+    }
+  }
+}
+
+void bench_heat(const Options& opt, std::vector<Record>& out) {
+  const std::vector<std::size_t> sides = opt.quick
+      ? std::vector<std::size_t>{64, 256}
+      : std::vector<std::size_t>{64, 256, 1024, 2048, 4096};
+  for (std::size_t side : sides) {
+    matsimu::HeatDiffusion2DParams p;
+    p.nx = side;
+    p.ny = side;
+    p.dt = 0.9 * p.stability_limit();
+    p.max_steps = static_cast<std::size_t>(-1);
+    p.precision = matsimu::Precision::Double;
+    matsimu::HeatDiffusion2DModel model(p);
+    if (!model.is_valid()) {
+      std::fprintf(stderr, "heat2d %zux%zu: %s\n", side, side, model.error_message().c_str());
+      continue;
+    }
+    out.push_back(time_op(opt, "heat2d_step", side * side, [&] { model.step(); }));
+    constexpr std::size_t kFused = 16;
+    out.push_back(time_op(opt, "heat2d_advance16", side * side,
+                          [&] { model.advance(kFused); }, kFused));
+
+    p.precision = matsimu::Precision::Single;
+    matsimu::HeatDiffusion2DModel fp32(p);
+    out.push_back(time_op(opt, "heat2d_step_fp32", side * side, [&] { fp32.step(); }));
+    p.precision = matsimu::Precision::Double;
+
+    p.backend = matsimu::ComputeBackend::Device;
+    matsimu::HeatDiffusion2DModel device(p);
+    out.push_back(time_op(opt, "heat2d_step_device", side * side, [&] { device.step(); }));
+    p.backend = matsimu::ComputeBackend::Host;
+
+    p.scheme = matsimu::HeatScheme::Implicit;
+    p.dt = 100.0 * p.stability_limit();
+    matsimu::HeatDiffusion2DModel adi(p);
+    out.push_back(time_op(opt, "heat2d_adi_step", side * side, [&] { adi.step(); }));
+  }
+}
+
+void bench_heat_3d(const Options& opt, std::vector<Record>& out) {
+  const std::vector<std::size_t> sides = opt.quick
+      ? std::vector<std::size_t>{32, 96}
+      : std::vector<std::size_t>{32, 96, 192, 320};
+  for (std::size_t side : sides) {
+    matsimu::HeatDiffusion3DParams p;
+    p.nx = p.ny = p.nz = side;
+    p.dt = 0.9 * p.stability_limit();
+    p.max_steps = static_cast<std::size_t>(-1);
+    matsimu::HeatDiffusion3DModel model(p);
+    if (!model.is_valid()) {
+      std::fprintf(stderr, "heat3d %zu^3: %s\n", side, model.error_message().c_str());
+      continue;
+    }
+    out.push_back(time_op(opt, "heat3d_step", side * side * side, [&] { model.step(); }));
+    p.backend = matsimu::ComputeBackend::Device;
+    matsimu::HeatDiffusion3DModel device(p);
+    out.push_back(time_op(opt, "heat3d_step_device", side * side * side, [&] { device.step(); }));
+  }
+}
+
+void print_csv(const std::vector<Record>& records) {
+  std::printf("benchmark,size,reps,ns_per_op,ns_per_item,items_per_s\n");
+  for (const Record& r : records) {
+    std::printf("%s,%zu,%zu,%.1f,%.3f,%.4g\n", r.name.c_str(), r.size, r.reps,
+                r.ns_per_op, r.ns_per_item, 1e9 / r.ns_per_item);
+  }
+}
+
+void print_json(const std::vector<Record>& records) {
+  std::printf("[\n");
+  for (std::size_t k = 0; k < records.size(); ++k) {
+    const Record& r = records[k];
+    std::printf("  {\"benchmark\": \"%s\", \"size\": %zu, \"reps\": %zu, \"ns_per_op\": %.1f, "
+                "\"ns_per_item\": %.3f, \"items_per_s\": %.4g}%s\n",
+                r.name.c_str(), r.size, r.reps, r.ns_per_op, r.ns_per_item,
+                1e9 / r.ns_per_item, k + 1 < records.size() ? "," : "");
+  }
+  std::printf("]\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0) {
+      opt.json = true;
+    } else if (std::strcmp(argv[i], "--csv") == 0) {
+      opt.json = false;
+    } else if (std::strcmp(argv[i], "--quick") == 0) {
+      opt.quick = true;
+      opt.min_seconds = 0.02;
+    } else {
+      std::fprintf(stderr, "Usage: %s [--csv|--json] [--quick]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  std::vector<Record> records;
+  bench_md(opt, records);
+  bench_heat(opt, records);
+  bench_heat_3d(opt, records);
+  if (opt.json)
+    print_json(records);
+  else
+    print_csv(records);
+  return 0;
+}
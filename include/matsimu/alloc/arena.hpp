@@ -0,0 +1,126 @@
+#pragma once
+
+#include <matsimu/alloc/bounded_allocator.hpp>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace matsimu {
+
+/**
+ * Bump arena over one preallocated region, for per-step scratch.
+ *
+ * allocate() carves aligned blocks off the top; deallocate() only gives
+ * memory back when it is the most recent block, otherwise it waits for the
+ * enclosing ArenaScope (or reset()) to roll the top back. Exceeding the
+ * capacity throws std::bad_alloc, like bounded_allocator; nothing falls back
+ * to the heap behind the caller's back.
+ *
+ * reserve() sizes the region between scopes, so a loop that reserves what it
+ * needs stops allocating from the system after the first iterations. With
+ * huge_pages the region is 2 MiB aligned and sized, and on Linux advised as
+ * transparent-huge-page backed. set_budget() counts the region against a
+ * bounded_allocator budget (the particle arrays' max_bytes for the neighbor
+ * list scratch); without one the arena is uncapped. Not thread-safe: one
+ * arena per owner thread.
+ */
+class Arena {
+public:
+    static constexpr std::size_t kHugePageBytes = std::size_t(2) << 20;
+
+    explicit Arena(std::size_t capacity = 0, bool huge_pages = false);
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /// bytes aligned to align (a power of two); throws std::bad_alloc when full.
+    void* allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t));
+    /// Pops p if it is the top block; otherwise a no-op until the scope ends.
+    void deallocate(void* p, std::size_t bytes) noexcept;
+
+    /// Grow the region to at least bytes. Only while nothing is allocated
+    /// (used() == 0); returns false otherwise. Grows geometrically.
+    bool reserve(std::size_t bytes);
+
+    /// Charge the region to budget (null: uncapped); reserve() then throws
+    /// std::bad_alloc when growing would exceed it. Changing the budget frees
+    /// the region, so only while nothing is allocated; returns false otherwise.
+    bool set_budget(std::shared_ptr<bounded_allocator_state> budget);
+    const bounded_allocator_state* budget() const { return budget_.get(); }
+
+    std::size_t mark() const { return top_; }
+    void release(std::size_t mark) noexcept { if (mark < top_) top_ = mark; }
+    void reset() noexcept { top_ = 0; }
+
+    std::size_t capacity() const { return capacity_; }
+    std::size_t used() const { return top_; }
+    std::size_t peak() const { return peak_; }        ///< Highest used() so far [bytes]
+    std::size_t regions() const { return regions_; }  ///< System allocations made (warm-up count)
+    bool huge_pages() const { return huge_pages_; }
+
+private:
+    char* base_{nullptr};
+    std::size_t capacity_{0};
+    std::size_t top_{0};
+    std::size_t peak_{0};
+    std::size_t regions_{0};
+    bool huge_pages_;
+    std::shared_ptr<bounded_allocator_state> budget_;  // charged capacity_ bytes
+
+    void free_region() noexcept;
+};
+
+/// Rolls the arena back to its state at construction (reset-per-step scope).
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) : arena_(arena), mark_(arena.mark()) {}
+    ~ArenaScope() { arena_.release(mark_); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena& arena_;
+    std::size_t mark_;
+};
+
+/**
+ * STL allocator drawing from an Arena; a null arena uses the global heap, so
+ * code can take an optional arena without a second code path. Can also be
+ * the Inner allocator of bounded_allocator to put a byte cap per container.
+ */
+template <typename T>
+struct arena_allocator {
+    using value_type = T;
+
+    Arena* arena{nullptr};
+
+    arena_allocator() noexcept = default;
+    explicit arena_allocator(Arena* a) noexcept : arena(a) {}
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(std::size_t n) {
+        if (arena) return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (arena) arena->deallocate(p, n * sizeof(T));
+        else ::operator delete(p);
+    }
+
+    friend bool operator==(const arena_allocator& a, const arena_allocator& b) noexcept {
+        return a.arena == b.arena;
+    }
+    friend bool operator!=(const arena_allocator& a, const arena_allocator& b) noexcept {
+        return !(a == b);
+    }
+};
+
+/// Scratch vector in an arena (or on the heap when the arena is null).
+template <typename T>
+using ArenaVector = std::vector<T, arena_allocator<T>>;
+
+}  // namespace matsimu
@@ -7,11 +7,38 @@
 
 namespace matsimu {
 
+/// Usage shared by every copy and rebind of one bounded_allocator budget.
+struct bounded_allocator_state {
+  std::size_t max_bytes;
+  std::atomic<std::size_t> current_bytes{0};
+  std::atomic<std::size_t> peak_bytes{0};  // high-water mark of current_bytes
+  explicit bounded_allocator_state(std::size_t m) : max_bytes(m) {}
+
+  /// Count bytes against max_bytes; throws std::bad_alloc past the cap.
+  void charge(std::size_t bytes) {
+    std::size_t current = current_bytes.load(std::memory_order_relaxed);
+    while (true) {
+      if (current + bytes > max_bytes)
+        throw std::bad_alloc();
+      if (current_bytes.compare_exchange_weak(current, current + bytes, std::memory_order_relaxed))
+        break;
+    }
+    std::size_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (current + bytes > peak &&
+           !peak_bytes.compare_exchange_weak(peak, current + bytes, std::memory_order_relaxed)) {}
+  }
+
+  void refund(std::size_t bytes) noexcept {
+    current_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+};
+
 /**
  * Bounded allocator: enforces a hard byte limit; throws std::bad_alloc on
  * exhaustion. No silent nullptr. Deterministic for same inputs and limit.
  *
- * Uses shared state for usage tracking across allocator copies.
+ * Uses shared state for usage tracking across allocator copies; rebinds
+ * (e.g. an index array next to the Real arrays) draw from the same budget.
  */
 template <typename T, typename Inner = std::allocator<T>>
 struct bounded_allocator {
@@ -20,11 +47,7 @@ struct bounded_allocator {
   using size_type       = std::size_t;
   using difference_type = std::ptrdiff_t;
 
-  struct State {
-    size_type max_bytes;
-    std::atomic<size_type> current_bytes{0};
-    explicit State(size_type m) : max_bytes(m) {}
-  };
+  using State = bounded_allocator_state;
 
   Inner inner;
   std::shared_ptr<State> state;
@@ -44,28 +67,18 @@ struct bounded_allocator {
   T* allocate(size_type n) {
     if (n == 0) return nullptr;
     size_type need = n * sizeof(T);
-    
-    // Optimistic atomic update
-    size_type current = state->current_bytes.load(std::memory_order_relaxed);
-    while (true) {
-        if (current + need > state->max_bytes)
-            throw std::bad_alloc();
-        if (state->current_bytes.compare_exchange_weak(current, current + need, 
-                                                     std::memory_order_relaxed))
-            break;
-    }
-    
+    state->charge(need);
     try {
         return inner_traits::allocate(inner, n);
     } catch (...) {
-        state->current_bytes.fetch_sub(need, std::memory_order_relaxed);
+        state->refund(need);
         throw;
     }
   }
 
   void deallocate(T* p, size_type n) noexcept {
     if (!p) return;
-    state->current_bytes.fetch_sub(n * sizeof(T), std::memory_order_relaxed);
+    state->refund(n * sizeof(T));
     inner_traits::deallocate(inner, p, n);
   }
 
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace matsimu {
+
+class ThreadPool;
+
+/**
+ * Placement policy for large arrays (particle SoA arrays, heat fields).
+ *
+ * huge_pages: blocks of at least kMinBytes are 2 MiB aligned and advised as
+ * transparent-huge-page backed (madvise(MADV_HUGEPAGE) on Linux; elsewhere
+ * only the alignment applies), so multi-GB grids need far fewer TLB entries.
+ *
+ * first_touch: such blocks are faulted in on the pool before the container
+ * constructs its elements, thread t touching the t-th of size() equal
+ * contiguous chunks — the static split the force, reduction and stencil
+ * loops use. Under the default first-touch NUMA policy the pages then live
+ * on the node of the thread that sweeps them, instead of all on the node of
+ * the constructing thread. Threads are not pinned; this is best effort.
+ */
+struct MemoryPlacement {
+    static constexpr std::size_t kHugePageBytes = std::size_t(2) << 20;
+    static constexpr std::size_t kMinBytes = kHugePageBytes;  ///< Smaller blocks: plain operator new
+
+    bool huge_pages{false};
+    std::shared_ptr<ThreadPool> first_touch;  ///< Null: touched by whoever writes first
+
+    /// Whether a block of bytes gets the placed (aligned, touched) path.
+    bool placed(std::size_t bytes) const {
+        return bytes >= kMinBytes && (huge_pages || first_touch);
+    }
+};
+
+/// Allocate bytes per policy (null policy: operator new); throws std::bad_alloc.
+void* placement_allocate(std::size_t bytes, const MemoryPlacement* policy);
+/// Release a placement_allocate block (same bytes and policy).
+void placement_deallocate(void* p, std::size_t bytes, const MemoryPlacement* policy) noexcept;
+
+/// Shared policy, or null when neither option is set.
+std::shared_ptr<const MemoryPlacement> make_memory_placement(bool huge_pages, bool first_touch,
+                                                             std::shared_ptr<ThreadPool> pool);
+
+/**
+ * STL allocator applying a MemoryPlacement; the Inner allocator of the
+ * bounded_allocator behind ParticleSystem and the heat fields. A null policy
+ * behaves like std::allocator. The policy is fixed per allocator, so blocks
+ * are always released the way they were obtained.
+ */
+template <typename T>
+struct placement_allocator {
+    using value_type = T;
+
+    std::shared_ptr<const MemoryPlacement> policy;
+
+    placement_allocator() noexcept = default;
+    explicit placement_allocator(std::shared_ptr<const MemoryPlacement> p) noexcept : policy(std::move(p)) {}
+    template <typename U>
+    placement_allocator(const placement_allocator<U>& other) noexcept : policy(other.policy) {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(placement_allocate(n * sizeof(T), policy.get())); }
+    void deallocate(T* p, std::size_t n) noexcept { placement_deallocate(p, n * sizeof(T), policy.get()); }
+
+    friend bool operator==(const placement_allocator& a, const placement_allocator& b) noexcept {
+        return a.policy == b.policy;
+    }
+    friend bool operator!=(const placement_allocator& a, const placement_allocator& b) noexcept {
+        return !(a == b);
+    }
+};
+
+}  // namespace matsimu
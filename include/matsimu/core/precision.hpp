@@ -0,0 +1,36 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+
+namespace matsimu {
+
+/**
+ * Arithmetic precision of the hot compute kernels.
+ *
+ * Double: everything in Real.
+ * Single: mixed precision. The LJ pair arithmetic (vector kernel) and the
+ *         explicit 2D heat stencil run in float, which doubles the lanes
+ *         per register and halves the bytes per cell. Displacements, force
+ *         sums and energies stay in Accum, and the state of record
+ *         (particle arrays, the field behind temperature()) stays Real.
+ *
+ * Build with -DMATSIMU_SINGLE_PRECISION (./run.sh --single) to make Single
+ * the default; every params struct can still select either at run time.
+ */
+enum class Precision { Double, Single };
+
+/// Accumulator for energies, force sums and other reductions.
+using Accum = double;
+
+#ifdef MATSIMU_SINGLE_PRECISION
+constexpr Precision kDefaultPrecision = Precision::Single;
+#else
+constexpr Precision kDefaultPrecision = Precision::Double;
+#endif
+
+/// Lower-case name ("double", "single") for logs and config files.
+inline const char* precision_name(Precision p) {
+    return p == Precision::Single ? "single" : "double";
+}
+
+}  // namespace matsimu
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace matsimu {
+
+/**
+ * Step instrumentation switch (Simulation::stats(), NeighborList timings).
+ *
+ * Timers run only when SimulationParams::profile is set. Build with
+ * -DMATSIMU_NO_PROFILE to compile every clock read out; the plain counters
+ * (steps, neighbor rebuilds, allocator high-water mark) are kept either way.
+ */
+#ifdef MATSIMU_NO_PROFILE
+constexpr bool kProfileCompiled = false;
+#else
+constexpr bool kProfileCompiled = true;
+#endif
+
+/// Monotonic clock for phase timing [ns]; 0 when profiling is compiled out.
+inline std::uint64_t profile_clock_ns() {
+    if constexpr (kProfileCompiled) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    } else {
+        return 0;
+    }
+}
+
+}  // namespace matsimu
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/sim/ensemble.hpp>
+#include <matsimu/sim/simulation.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace matsimu {
+
+/**
+ * Result of a checkpoint save or load: ok, or an error message.
+ * Same shape as ConfigResult; nothing throws.
+ */
+struct CheckpointResult {
+  bool ok{false};
+  std::string error;
+
+  static CheckpointResult success() {
+    CheckpointResult r;
+    r.ok = true;
+    return r;
+  }
+  static CheckpointResult failure(std::string msg) {
+    CheckpointResult r;
+    r.error = std::move(msg);
+    return r;
+  }
+};
+
+/// Format version written by save_checkpoint; load accepts only this one.
+constexpr std::uint32_t kCheckpointVersion = 1;
+
+/**
+ * Binary checkpoint of a Simulation's run state.
+ *
+ * Layout (native byte order; 8-byte aligned records):
+ *   header   magic "MATSCKPT", version, SimMode, sizeof(Real), time, step count
+ *   records  {tag, payload bytes} + payload, padded to 8 bytes:
+ *            Lattice    a1, a2, a3
+ *            Particles  count, then pos x/y/z, vel x/y/z, force x/y/z, mass arrays
+ *            ParticleIds  uint32 id per slot, only once the system was reordered
+ *            Thermostat save_state() text (e.g. Andersen mt19937 + normal state)
+ *            Field      one per ISimModel::state_buffers() entry, in order
+ *
+ * Arrays are written straight from the SoA / field buffers. The file is
+ * written to `path.tmp` and renamed over `path`, so a crash mid-write
+ * leaves the previous checkpoint intact.
+ *
+ * Params, potential and thermostat type are not stored: restore into a
+ * Simulation built from the same configuration. load_checkpoint maps the
+ * file (mmap on POSIX) and copies each record into place; forces are
+ * restored too, so MD continues with step() and no initialize().
+ */
+CheckpointResult save_checkpoint(const Simulation& sim, const std::string& path);
+
+/// Restore sim from a save_checkpoint file. On failure sim may be partially
+/// restored; the error says which record did not match.
+CheckpointResult load_checkpoint(Simulation& sim, const std::string& path);
+
+/// Result of load_particles (same contract as ConfigResult).
+struct ParticleFileResult {
+  bool ok{false};
+  std::shared_ptr<ParticleSource> source;
+  std::string error;
+
+  static ParticleFileResult success(std::shared_ptr<ParticleSource> s) {
+    ParticleFileResult r;
+    r.ok = true;
+    r.source = std::move(s);
+    return r;
+  }
+  static ParticleFileResult failure(std::string msg) {
+    ParticleFileResult r;
+    r.error = std::move(msg);
+    return r;
+  }
+};
+
+/**
+ * Binary particle file: an MD checkpoint holding only the Lattice and
+ * Particles records (time and step 0), written like save_checkpoint.
+ * Lets large start configurations be prepared once and loaded without
+ * building them in code.
+ */
+CheckpointResult save_particles(const ParticleSystem& particles, const Lattice& lattice,
+                                const std::string& path);
+
+/**
+ * Box, positions, velocities and masses from a particle file or any MD
+ * checkpoint (other records are skipped). The file is mapped and the
+ * arrays copied once; max_bytes bounds the particle storage.
+ */
+ParticleFileResult load_particles(const std::string& path,
+                                  std::size_t max_bytes = 1024ull * 1024 * 1024);
+
+}  // namespace matsimu
@@ -2,8 +2,12 @@
 
 #include <matsimu/core/types.hpp>
 #include <matsimu/sim/simulation.hpp>
+#include <charconv>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
 
 namespace matsimu {
 
@@ -37,12 +41,51 @@ struct ConfigResult {
  * - Non-empty path: reads file; on success returns parsed params (SI); on file-not-found
  *   or parse error returns ok = false and a non-empty error message (no silent defaults).
  *
+ * The file is mapped once (MappedFile) and parsed in place: lines, keys and
+ * values are string_views into the mapping, numbers go through
+ * std::from_chars.
+ *
  * File format: one key=value per line; '#' comment; keys: dt, dx, end_time, max_steps,
- * temperature, cutoff, neighbor_skin, use_neighbor_list. All numeric values in SI.
+ * temperature, cutoff, neighbor_skin, neighbor_skin_auto (tune the skin at run time),
+ * neighbor_skin_min, neighbor_skin_max, use_neighbor_list, neighbor_build (cells|brute),
+ * sort_interval (Morton-reorder particles every n-th rebuild), num_threads,
+ * respa_steps, respa_split, respa_switch (r-RESPA multiple time stepping),
+ * health_check (every_step|interval|debug|fused), health_check_interval,
+ * energy_interval (0 = potential energy only on demand), precision (double|single),
+ * max_bytes (particle array budget), huge_pages and first_touch (particle array
+ * placement, alloc/placement.hpp), profile (per-phase step timing, Simulation::stats()).
+ * All numeric values in SI.
  * Conversions only at this I/O boundary; core simulation uses SI.
  */
 ConfigResult load_config(const std::string& path);
 
+/// Parse one config key=value into p (same keys as load_config). Returns an
+/// error message for an unknown key or bad value; does not validate p.
+std::optional<std::string> apply_config_value(SimulationParams& p, std::string_view key,
+                                              std::string_view value);
+
+/// Whole-value number parse (std::from_chars: no locale, no copy). False on
+/// an empty value, trailing characters or overflow; out is then unchanged.
+/// Shared by the config, batch and run-file loaders.
+template <typename T>
+bool parse_config_number(std::string_view value, T& out) {
+  T x{};
+  const char* end = value.data() + value.size();
+  const auto [ptr, ec] = std::from_chars(value.data(), end, x);
+  if (ec != std::errc() || ptr != end || value.empty()) return false;
+  out = x;
+  return true;
+}
+
+/// "1|true|yes" or "0|false|no" (any case).
+bool parse_config_bool(std::string_view value, bool& out);
+
+/// Case-insensitive comparison of a config value with a lower-case keyword.
+bool config_equals(std::string_view value, std::string_view keyword);
+
+/// value with leading and trailing blanks (space, tab, CR, LF) removed.
+std::string_view trim_config(std::string_view value);
+
 /**
  * Load config; throws std::runtime_error on invalid non-empty path.
  * Empty path returns default params.
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace matsimu {
+
+/**
+ * Read-only view of a whole file: mmap on POSIX, else a heap copy.
+ * Loaders parse straight out of the mapping (checkpoints, particle files,
+ * config and run files), so nothing is copied line by line.
+ * data() is null when the file could not be opened or is empty;
+ * is_open() tells the two apart.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool is_open() const { return open_; }
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  std::string_view view() const { return {data_, size_}; }
+
+ private:
+  const char* data_{nullptr};
+  std::size_t size_{0};
+  bool open_{false};
+  bool mapped_{false};
+  std::vector<char> copy_;
+};
+
+}  // namespace matsimu
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <matsimu/physics/potential.hpp>
+#include <memory>
+#include <string>
+
+namespace matsimu {
+
+/// Result of loading a pair potential table (same contract as ConfigResult).
+struct PotentialTableResult {
+  bool ok{false};
+  std::shared_ptr<TabulatedPotential> potential;
+  std::string error;
+
+  static PotentialTableResult success(std::shared_ptr<TabulatedPotential> p) {
+    PotentialTableResult r;
+    r.ok = true;
+    r.potential = std::move(p);
+    return r;
+  }
+  static PotentialTableResult failure(std::string msg) {
+    PotentialTableResult r;
+    r.error = std::move(msg);
+    return r;
+  }
+};
+
+/**
+ * Load a fitted pair potential from a text table.
+ *
+ * Format: one "r energy force" row per line (SI: m, J, N; force = -dU/dr),
+ * '#' comments and blank lines ignored. At least two rows, r > 0 strictly
+ * increasing, all values finite. The first row's r is r_min, the last
+ * row's r the cutoff.
+ *
+ * Rows may be spaced arbitrarily: they are interpolated (cubic Hermite in r,
+ * using the given forces as slopes) onto `points` nodes uniform in r², the
+ * TabulatedPotential grid.
+ */
+PotentialTableResult load_potential_table(const std::string& path,
+                                          std::size_t points = TabulatedPotential::kDefaultPoints);
+
+}  // namespace matsimu
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <matsimu/sim/ensemble.hpp>
+#include <matsimu/sim/heat_diffusion.hpp>
+#include <matsimu/sim/heat_diffusion_2d.hpp>
+#include <matsimu/sim/heat_diffusion_3d.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace matsimu {
+
+/// Physics model of one run in a run file.
+enum class RunModel { MD, Heat, Heat2D, Heat3D };
+
+/// Config keyword of a model (md, heat, heat2d, heat3d).
+const char* run_model_name(RunModel model);
+
+/**
+ * One fully described run. Only the params of `model` are used: md for
+ * MD (parameters, crystal or preloaded particle source, potential,
+ * thermostat, seed), heat / heat_2d / heat_3d for the grid models.
+ */
+struct RunSpec {
+  std::string name;
+  RunModel model{RunModel::MD};
+  ReplicaSpec md;
+  HeatDiffusionParams heat;
+  HeatDiffusion2DParams heat_2d;
+  HeatDiffusion3DParams heat_3d;
+};
+
+/// A parsed run file: the runs in file order and how to execute them.
+struct RunPlan {
+  std::vector<RunSpec> runs;
+  EnsembleOptions options;
+  std::string output;  ///< CSV path ("" = caller decides)
+};
+
+/// Result of loading a run file (same contract as ConfigResult).
+struct RunPlanResult {
+  bool ok{false};
+  RunPlan plan;
+  std::string error;
+
+  static RunPlanResult success(RunPlan p) {
+    RunPlanResult r;
+    r.ok = true;
+    r.plan = std::move(p);
+    return r;
+  }
+  static RunPlanResult failure(std::string msg) {
+    RunPlanResult r;
+    r.error = std::move(msg);
+    return r;
+  }
+};
+
+/**
+ * Load a multi-run file.
+ *
+ * Format: key=value lines and '#' comments, grouped into sections:
+ *
+ *   threads = 4             # before any section: runner keys threads,
+ *   output = runs.csv       # memory_limit, output (as in batch files)
+ *   [defaults]              # applied to every run before its own keys
+ *   dt = 2e-15
+ *   [run argon-50K]         # one run per section; the name is optional
+ *   model = md              # md (default) | heat | heat2d | heat3d
+ *   temperature = 50
+ *
+ * MD keys: every load_config key, the batch replica keys (cells, spacing,
+ * mass, epsilon, sigma, thermostat, thermostat_tau, seed), particles =
+ * binary particle file (load_particles; replaces the crystal) and
+ * potential_table = load_potential_table file (replaces LJ; params.cutoff
+ * becomes the table cutoff). Heat keys are the fields of
+ * HeatDiffusionParams / HeatDiffusion2DParams / HeatDiffusion3DParams
+ * under their own names; enum values are explicit|implicit (scheme),
+ * hot_center|uniform_hot (ic), double|single (precision).
+ *
+ * A [defaults] key only has to suit one model; runs of other models skip
+ * it. Paths are relative to the run file. The file is mapped once and
+ * parsed in place (std::from_chars); each particle file and potential
+ * table is loaded once and shared by the runs that name it. Every run is
+ * validated at load time.
+ */
+RunPlanResult load_run_file(const std::string& path);
+
+/**
+ * Execute every run; results in plan order. MD runs go through
+ * run_ensemble (plan.options: concurrency and memory budget), grid runs
+ * follow on the calling thread; their results carry steps, time, status
+ * and wall time (energies and temperature are MD only).
+ */
+std::vector<ReplicaResult> run_plan(const RunPlan& plan);
+
+/// One CSV row per run: index, name, model, then the write_ensemble_csv columns.
+void write_run_csv(std::ostream& out, const RunPlan& plan,
+                   const std::vector<ReplicaResult>& results);
+
+}  // namespace matsimu
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <matsimu/sim/ensemble.hpp>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace matsimu {
+
+/// One swept key and the values it takes, in file order.
+struct SweepAxis {
+  std::string key;
+  std::vector<std::string> values;
+};
+
+/**
+ * Parsed batch file: a template replica, the swept axes and how to run them.
+ * The ensemble is the cartesian product of all axes (last axis fastest).
+ */
+struct SweepPlan {
+  ReplicaSpec base;               ///< Params/system/seed before sweeping
+  std::vector<SweepAxis> axes;
+  EnsembleOptions options;
+  std::string output;             ///< CSV path ("" = caller decides)
+
+  /// Number of replicas (product of axis sizes; 1 without axes).
+  std::size_t size() const;
+};
+
+/// Result of loading a batch file (same contract as ConfigResult).
+struct SweepResult {
+  bool ok{false};
+  SweepPlan plan;
+  std::string error;
+
+  static SweepResult success(SweepPlan p) {
+    SweepResult r;
+    r.ok = true;
+    r.plan = std::move(p);
+    return r;
+  }
+  static SweepResult failure(std::string msg) {
+    SweepResult r;
+    r.error = std::move(msg);
+    return r;
+  }
+};
+
+/**
+ * Load a batch (parameter sweep) file.
+ *
+ * Format: key=value lines, '#' comments. Keys:
+ * - base: config file (load_config format), relative to the batch file
+ * - any load_config key (dt, max_steps, temperature, num_threads, ...)
+ * - replica system: cells, spacing, mass, epsilon, sigma,
+ *   thermostat (none|rescale|andersen), thermostat_tau, seed
+ * - runner: threads (concurrent replicas), memory_limit (total particle
+ *   bytes across running replicas), output (CSV path)
+ *
+ * A comma list ("temperature = 50, 100, 150") or an inclusive integer range
+ * ("seed = 1:8") on a config or system key makes it a sweep axis. Every
+ * value is checked when the file is loaded.
+ */
+SweepResult load_sweep(const std::string& path);
+
+/// Parse one replica key=value into spec: the replica system keys above
+/// (and seed), else a load_config key on spec.params. Does not validate.
+std::optional<std::string> apply_replica_value(ReplicaSpec& spec, std::string_view key,
+                                               std::string_view value);
+
+/// Expand plan into one ReplicaSpec per point of the sweep, indexed 0..size()-1.
+std::vector<ReplicaSpec> expand_sweep(const SweepPlan& plan);
+
+/// Write one CSV row per replica: index, axis values, atoms, status, steps,
+/// simulated time, final energies, temperature and wall time (SI units).
+void write_ensemble_csv(std::ostream& out, const SweepPlan& plan,
+                        const std::vector<ReplicaSpec>& specs,
+                        const std::vector<ReplicaResult>& results);
+
+}  // namespace matsimu
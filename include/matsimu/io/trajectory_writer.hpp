@@ -0,0 +1,130 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/sim/simulation.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace matsimu {
+
+/// On-disk layout of a trajectory file (see TrajectoryWriter).
+enum class TrajectoryFormat { XYZ, Binary };
+
+/**
+ * Options for TrajectoryWriter.
+ *
+ * Invariants:
+ *   - stride >= 1 (on_step writes every stride-th step)
+ *   - queue_depth >= 2 (snapshot buffers; 2 = classic double buffering)
+ *   - compress requires a build with MATSIMU_USE_ZLIB (run.sh adds it when
+ *     zlib is installed); the file is then a gzip stream
+ */
+struct TrajectoryOptions {
+  TrajectoryFormat format{TrajectoryFormat::Binary};
+  std::size_t stride{10};
+  std::size_t queue_depth{4};
+  bool compress{false};
+  int compression_level{1};       ///< zlib level 1..9 (1 = fastest)
+  std::string xyz_symbol{"Ar"};   ///< Element column for XYZ frames
+
+  /// Returns error message if invalid, std::nullopt otherwise.
+  std::optional<std::string> validate() const;
+};
+
+/// Binary trajectory magic and format version.
+constexpr char kTrajectoryMagic[8] = {'M', 'A', 'T', 'S', 'T', 'R', 'A', 'J'};
+constexpr std::uint32_t kTrajectoryVersion = 1;
+
+/**
+ * Streaming MD trajectory writer with a background I/O thread.
+ *
+ * submit() copies the particle positions and box of a Simulation into a
+ * free snapshot buffer and returns; the writer thread formats and writes
+ * queued snapshots in order. The step loop only waits when every buffer
+ * is still queued (counted by stalls()), so disk and formatting cost stay
+ * off the integration path as long as the disk keeps up on average.
+ *
+ * Formats (native byte order for Binary):
+ *   XYZ     extended XYZ: count, a comment line with step, time [s] and
+ *           Lattice="..." [Å], then "<symbol> x y z" per atom [Å]
+ *   Binary  DCD-like: header {magic "MATSTRAJ", version, sizeof(Real),
+ *           atom count}, then per frame {step (u64), time, box a1 a2 a3,
+ *           x[n], y[n], z[n]} in SI units, straight from the SoA arrays
+ *
+ * I/O errors are sticky: the first one is kept in error_message() and
+ * later frames are dropped. close() (or the destructor) drains the queue
+ * and joins the thread. Not copyable; submit from one thread only.
+ */
+class TrajectoryWriter {
+ public:
+  TrajectoryWriter(const std::string& path, const TrajectoryOptions& opts = {});
+  ~TrajectoryWriter();
+  TrajectoryWriter(const TrajectoryWriter&) = delete;
+  TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+  /// False if the options were invalid or the file could not be opened.
+  bool is_open() const { return open_; }
+  /// First open/option/write error (empty if none).
+  std::string error_message() const;
+
+  /// Queue a snapshot of sim (MD mode) regardless of stride.
+  void submit(const Simulation& sim);
+  /// Queue a snapshot when sim.step_count() is a multiple of the stride.
+  /// Suitable as Simulation::set_step_callback target (see callback()).
+  void on_step(const Simulation& sim) {
+    if (sim.step_count() % opts_.stride == 0) submit(sim);
+  }
+  /// Step callback that forwards to on_step; the writer must outlive it.
+  Simulation::StepCallback callback() {
+    return [this](const Simulation& sim) { on_step(sim); };
+  }
+
+  /// Drain queued frames, close the file and join the writer thread.
+  /// Returns true if every frame was written. Idempotent.
+  bool close();
+
+  /// Frames written to disk so far.
+  std::size_t frames_written() const;
+  /// Number of submit() calls that had to wait for a free buffer.
+  std::size_t stalls() const { return stalls_; }
+  const TrajectoryOptions& options() const { return opts_; }
+
+ private:
+  struct Frame {
+    std::uint64_t step{0};
+    Real time{0};
+    Real box[9]{};
+    std::vector<Real> x, y, z;
+  };
+  class Sink;
+
+  TrajectoryOptions opts_;
+  std::vector<Frame> frames_;
+  std::vector<Frame*> free_;      // guarded by mutex_
+  std::deque<Frame*> ready_;      // guarded by mutex_
+  mutable std::mutex mutex_;
+  std::condition_variable ready_cv_;
+  std::condition_variable free_cv_;
+  std::thread thread_;
+  std::unique_ptr<Sink> sink_;
+  std::size_t atoms_{0};          // fixed by the first frame (Binary header)
+  bool header_written_{false};    // writer thread only
+  std::size_t written_{0};        // guarded by mutex_
+  std::size_t stalls_{0};
+  std::string error_;             // guarded by mutex_
+  bool stopping_{false};          // guarded by mutex_
+  bool open_{false};
+
+  void run();
+  bool write_frame(const Frame& f);
+};
+
+}  // namespace matsimu
@@ -3,6 +3,7 @@
 #include <matsimu/core/types.hpp>
 #include <string>    // For std::string
 #include <optional>  // For std::optional
+#include <cmath>     // For std::nearbyint
 
 namespace matsimu {
 
@@ -10,6 +11,12 @@ namespace matsimu {
  * Lattice: three basis vectors a1, a2, a3 (right-handed).
  * All lattice points R = n1*a1 + n2*a2 + n3*a3.
  * Lengths in SI (m). Volume V = a1 · (a2 × a3).
+ *
+ * update_cache() precomputes the inverse basis and, for diagonal
+ * (orthorhombic) cells, the box lengths so min-image and coordinate
+ * conversions skip the cross products. The cache remembers the basis it was
+ * built from; if a1..a3 change afterwards, queries use the general path
+ * until update_cache() is called again (slower, never wrong).
  */
 struct Lattice {
   Real a1[3]{1, 0, 0};
@@ -32,7 +39,18 @@ struct Lattice {
   void wrap_cartesian(Real cart[3]) const;
 
   /// Compute minimum-image displacement vector in Cartesian coordinates.
-  void min_image_displacement(const Real r1[3], const Real r2[3], Real dr[3]) const;
+  /// Orthorhombic cached cells: one multiply-round-subtract per axis.
+  void min_image_displacement(const Real r1[3], const Real r2[3], Real dr[3]) const {
+    dr[0] = r2[0] - r1[0];
+    dr[1] = r2[1] - r1[1];
+    dr[2] = r2[2] - r1[2];
+    if (cache_.orthorhombic && cache_current()) {
+      for (int d = 0; d < 3; ++d)
+        dr[d] -= cache_.length[d] * std::nearbyint(dr[d] * cache_.inv_length[d]);
+      return;
+    }
+    min_image_general(dr);
+  }
 
   /// Validate lattice: returns an error message if invalid, std::nullopt otherwise.
   std::optional<std::string> validate() const;
@@ -42,6 +60,35 @@ struct Lattice {
 
   /// Check if lattice is orthogonal (a1 along x, a2 along y, a3 along z).
   bool is_orthogonal() const;
+
+  /// Precompute inverse basis and orthorhombic box lengths for a1..a3.
+  /// Call after changing the basis (Simulation::set_lattice does).
+  void update_cache();
+
+  /// Exactly diagonal basis with positive lengths (per-axis min-image is valid).
+  bool is_orthorhombic() const;
+
+ private:
+  struct Cache {
+    bool valid{false};
+    bool orthorhombic{false};
+    Real basis[9]{};       // a1, a2, a3 the cache was built from
+    Real inverse[9]{};     // rows of A^{-1}: frac = inverse * cart
+    Real length[3]{};      // orthorhombic box lengths
+    Real inv_length[3]{};
+  };
+  Cache cache_;
+
+  /// Cache was built from the current a1..a3
+  bool cache_current() const {
+    return cache_.valid &&
+           cache_.basis[0] == a1[0] && cache_.basis[1] == a1[1] && cache_.basis[2] == a1[2] &&
+           cache_.basis[3] == a2[0] && cache_.basis[4] == a2[1] && cache_.basis[5] == a2[2] &&
+           cache_.basis[6] == a3[0] && cache_.basis[7] == a3[1] && cache_.basis[8] == a3[2];
+  }
+
+  /// Min-image of a Cartesian displacement through fractional coordinates.
+  void min_image_general(Real dr[3]) const;
 };
 
 }  // namespace matsimu
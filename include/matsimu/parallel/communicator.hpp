@@ -0,0 +1,157 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace matsimu {
+
+/**
+ * Message passing between the ranks of a distributed run
+ * (DistributedSimulation).
+ *
+ * Every operation is collective in the MPI sense: each rank of the group
+ * makes the same sequence of calls, and messages between two ranks arrive in
+ * the order they were sent (per payload type). Payloads are Real arrays,
+ * with integer overloads for particle ids and counts, which a float Real
+ * could not carry exactly. Reductions combine the ranks in rank order, so
+ * results do not depend on timing.
+ *
+ * Backends: SelfCommunicator (one rank), LocalCommunicator (ranks as threads
+ * of one process; tests and single-node runs) and the MPI backend
+ * (make_world_communicator(), built with MATSIMU_USE_MPI).
+ */
+class Communicator {
+public:
+    virtual ~Communicator() = default;
+
+    /// This rank, in [0, size())
+    virtual int rank() const = 0;
+
+    /// Number of ranks in the group
+    virtual int size() const = 0;
+
+    /// Element-wise sum of data[0..n) over all ranks, in place (n equal on every rank)
+    virtual void allreduce_sum(Real* data, std::size_t n) = 0;
+    virtual void allreduce_sum(std::uint64_t* data, std::size_t n) = 0;
+
+    /// Send `send` to rank dest and receive recv from rank src (sizes may
+    /// differ and recv is resized). dest or src may be this rank.
+    virtual void sendrecv(int dest, const std::vector<Real>& send, int src,
+                          std::vector<Real>& recv) = 0;
+    virtual void sendrecv(int dest, const std::vector<std::uint32_t>& send, int src,
+                          std::vector<std::uint32_t>& recv) = 0;
+
+    /// Concatenate every rank's send on root in rank order (recv untouched
+    /// on other ranks).
+    virtual void gather(const std::vector<Real>& send, std::vector<Real>& recv, int root) = 0;
+    virtual void gather(const std::vector<std::uint32_t>& send, std::vector<std::uint32_t>& recv,
+                        int root) = 0;
+
+    /**
+     * Nonblocking point-to-point, for overlapping a halo exchange with
+     * computation: isend posts data to dest, irecv posts a receive of exactly
+     * data.size() values from src, and wait_all() completes everything posted
+     * since the last call. Both buffers must stay alive and untouched until
+     * then. Receives from one rank match its sends in posting order; do not
+     * interleave them with sendrecv() between the same pair.
+     */
+    virtual void isend(int dest, const std::vector<Real>& data) = 0;
+    virtual void irecv(int src, std::vector<Real>& data) = 0;
+    virtual void wait_all() = 0;
+};
+
+/// Group of one: reductions are no-ops, sendrecv and gather copy.
+class SelfCommunicator : public Communicator {
+public:
+    int rank() const override { return 0; }
+    int size() const override { return 1; }
+    void allreduce_sum(Real*, std::size_t) override {}
+    void allreduce_sum(std::uint64_t*, std::size_t) override {}
+    void sendrecv(int dest, const std::vector<Real>& send, int src,
+                  std::vector<Real>& recv) override;
+    void sendrecv(int dest, const std::vector<std::uint32_t>& send, int src,
+                  std::vector<std::uint32_t>& recv) override;
+    void gather(const std::vector<Real>& send, std::vector<Real>& recv, int root) override;
+    void gather(const std::vector<std::uint32_t>& send, std::vector<std::uint32_t>& recv,
+                int root) override;
+    void isend(int dest, const std::vector<Real>& data) override;
+    void irecv(int src, std::vector<Real>& data) override;
+    void wait_all() override;
+
+private:
+    std::deque<std::vector<Real>> sent_;      // isend copies, FIFO
+    std::vector<std::vector<Real>*> pending_; // irecv targets
+};
+
+/**
+ * In-process group: rank r is whatever thread holds communicator r of
+ * create_group(). Sends are buffered (never block), receives wait for the
+ * matching message. Each member must be used by one thread at a time.
+ */
+class LocalCommunicator : public Communicator {
+public:
+    /// Communicators for ranks 0 .. ranks-1 of one new group (ranks >= 1)
+    static std::vector<std::shared_ptr<Communicator>> create_group(int ranks);
+
+    int rank() const override { return rank_; }
+    int size() const override;
+    void allreduce_sum(Real* data, std::size_t n) override;
+    void allreduce_sum(std::uint64_t* data, std::size_t n) override;
+    void sendrecv(int dest, const std::vector<Real>& send, int src,
+                  std::vector<Real>& recv) override;
+    void sendrecv(int dest, const std::vector<std::uint32_t>& send, int src,
+                  std::vector<std::uint32_t>& recv) override;
+    void gather(const std::vector<Real>& send, std::vector<Real>& recv, int root) override;
+    void gather(const std::vector<std::uint32_t>& send, std::vector<std::uint32_t>& recv,
+                int root) override;
+    /// Sends are delivered at once (buffered); receives complete in wait_all().
+    void isend(int dest, const std::vector<Real>& data) override;
+    void irecv(int src, std::vector<Real>& data) override;
+    void wait_all() override;
+
+    struct Group;
+
+private:
+    LocalCommunicator(std::shared_ptr<Group> group, int rank)
+        : group_(std::move(group)), rank_(rank) {}
+
+    std::shared_ptr<Group> group_;
+    int rank_;
+    std::vector<std::pair<int, std::vector<Real>*>> pending_;  // irecv (src, target)
+
+    template <typename T>
+    void reduce(T* data, std::size_t n);
+    template <typename T>
+    void post(int dest, const std::vector<T>& data);
+    template <typename T>
+    void receive(int src, std::vector<T>& data);
+    template <typename T>
+    void gather_into(const std::vector<T>& send, std::vector<T>& recv, int root);
+};
+
+/**
+ * MPI_Init / MPI_Finalize for main(). Without MATSIMU_USE_MPI, or when MPI
+ * is already initialized, it does nothing.
+ */
+class MpiSession {
+public:
+    MpiSession(int& argc, char**& argv);
+    ~MpiSession();
+
+    MpiSession(const MpiSession&) = delete;
+    MpiSession& operator=(const MpiSession&) = delete;
+
+private:
+    bool owns_{false};
+};
+
+/// Communicator over MPI_COMM_WORLD; null when built without
+/// MATSIMU_USE_MPI or before MPI is initialized (see MpiSession).
+std::shared_ptr<Communicator> make_world_communicator();
+
+}  // namespace matsimu
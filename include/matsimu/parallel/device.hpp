@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+/**
+ * Accelerator offload through OpenMP target regions.
+ *
+ * Built with MATSIMU_USE_OFFLOAD (MATSIMU_USE_OFFLOAD=1 ./run.sh adds
+ * -fopenmp and MATSIMU_OFFLOAD_FLAGS, e.g. -foffload=nvptx-none for NVIDIA
+ * or -foffload=amdgcn-amdhsa for AMD GPUs), MATSIMU_OFFLOAD(...) expands to
+ * `#pragma omp ...` and the device kernels (DeviceForceField, the device
+ * heat stencils) run on the default device; without a device the OpenMP
+ * runtime runs them on the host threads. Without MATSIMU_USE_OFFLOAD the
+ * pragmas vanish: the same kernels are plain serial host loops and every
+ * DeviceMirror is the host array itself, so the device code paths build and
+ * are tested everywhere.
+ *
+ * Use MATSIMU_OFFLOAD with the directive minus "omp", e.g.
+ *   MATSIMU_OFFLOAD(target teams distribute parallel for map(alloc: x[0:n]))
+ * Arrays named in a kernel must already be resident (DeviceMirror), so
+ * map(alloc: ...) finds them without a transfer.
+ */
+#ifdef MATSIMU_USE_OFFLOAD
+#define MATSIMU_OFFLOAD_STRING(...) #__VA_ARGS__
+#define MATSIMU_OFFLOAD(...) _Pragma(MATSIMU_OFFLOAD_STRING(omp __VA_ARGS__))
+#else
+#define MATSIMU_OFFLOAD(...)
+#endif
+
+namespace matsimu {
+
+/// Where a model keeps its state and runs its kernels.
+enum class ComputeBackend {
+    Host,    ///< Host arrays, thread pool and SIMD kernels
+    Device   ///< Resident on the offload device (host loops without MATSIMU_USE_OFFLOAD)
+};
+
+/// "host" or "device"
+const char* compute_backend_name(ComputeBackend backend);
+
+/// Whether this build offloads (MATSIMU_USE_OFFLOAD).
+bool offload_enabled();
+
+/// Offload devices visible to the OpenMP runtime (0 without offload, or
+/// when kernels fall back to the host).
+int device_count();
+
+/// Where device kernels run, e.g. "OpenMP target, 1 device" or "host (offload not built)".
+std::string device_description();
+
+/**
+ * Device copy of a host array [host, host + n), held for the lifetime of the
+ * mirror (OpenMP `target enter data` / `exit data`). The host array must not
+ * move or resize while mapped. upload() and download() copy the whole range;
+ * between them the device copy is authoritative and kernels work on it in
+ * place. Without offload every call is a no-op.
+ */
+template <typename T>
+class DeviceMirror {
+public:
+    DeviceMirror() = default;
+    DeviceMirror(T* host, std::size_t n) { map(host, n); }
+    ~DeviceMirror() { release(); }
+
+    DeviceMirror(const DeviceMirror&) = delete;
+    DeviceMirror& operator=(const DeviceMirror&) = delete;
+    DeviceMirror(DeviceMirror&& other) noexcept
+        : host_(std::exchange(other.host_, nullptr)), n_(std::exchange(other.n_, 0)) {}
+    DeviceMirror& operator=(DeviceMirror&& other) noexcept {
+        if (this != &other) {
+            release();
+            host_ = std::exchange(other.host_, nullptr);
+            n_ = std::exchange(other.n_, 0);
+        }
+        return *this;
+    }
+
+    /// Allocate the device copy of host[0, n) and upload it (replaces any earlier mapping).
+    void map(T* host, std::size_t n) {
+        release();
+        host_ = host;
+        n_ = n;
+        if (n_ == 0) return;
+        T* p = host_;
+        MATSIMU_OFFLOAD(target enter data map(to: p[0:n]))
+        (void)p;
+    }
+
+    /// Drop the device copy (the host array keeps its last downloaded state).
+    void release() {
+        if (host_ && n_ > 0) {
+            T* p = host_;
+            const std::size_t n = n_;
+            MATSIMU_OFFLOAD(target exit data map(delete: p[0:n]))
+            (void)p;
+            (void)n;
+        }
+        host_ = nullptr;
+        n_ = 0;
+    }
+
+    /// Host -> device
+    void upload() const {
+        if (n_ == 0) return;
+        T* p = host_;
+        const std::size_t n = n_;
+        MATSIMU_OFFLOAD(target update to(p[0:n]))
+        (void)p;
+        (void)n;
+    }
+
+    /// Device -> host
+    void download() const {
+        if (n_ == 0) return;
+        T* p = host_;
+        const std::size_t n = n_;
+        MATSIMU_OFFLOAD(target update from(p[0:n]))
+        (void)p;
+        (void)n;
+    }
+
+    /// Exchange mappings without touching the device (follows a std::swap
+    /// of the host arrays)
+    void swap(DeviceMirror& other) noexcept {
+        std::swap(host_, other.host_);
+        std::swap(n_, other.n_);
+    }
+
+    /// Host address of the mapped array (the name kernels map it by)
+    T* host() const { return host_; }
+    std::size_t size() const { return n_; }
+    bool mapped() const { return host_ != nullptr; }
+
+private:
+    T* host_{nullptr};
+    std::size_t n_{0};
+};
+
+}  // namespace matsimu
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace matsimu {
+
+/**
+ * Vector instruction level for explicitly vectorized kernels.
+ * Detected once at run time from CPU features; builds without x86 support
+ * only report Scalar.
+ */
+enum class SimdLevel { Scalar, AVX2, AVX512 };
+
+/// Best level supported by this CPU (and this build).
+SimdLevel detect_simd_level();
+
+/// Human-readable level name ("scalar", "avx2", "avx512")
+const char* simd_level_name(SimdLevel level);
+
+}  // namespace matsimu
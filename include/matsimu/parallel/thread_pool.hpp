@@ -0,0 +1,74 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace matsimu {
+
+/**
+ * Fixed-size pool of persistent worker threads.
+ *
+ * run(task) calls task(tid) once for every tid in [0, size()) and blocks until
+ * all calls return; the calling thread executes tid 0. Work is split by tid,
+ * never by scheduling order, so callers that partition statically get the
+ * same result on every run. The first exception thrown by any tid is
+ * rethrown from run(). One run() at a time; not reentrant.
+ */
+class ThreadPool {
+public:
+    /// Pool with num_threads participants (0 is treated as 1; 1 spawns no workers).
+    explicit ThreadPool(std::size_t num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Number of participants, including the calling thread
+    std::size_t size() const { return workers_.size() + 1; }
+
+    /// Execute task(tid) for tid = 0 .. size()-1 and wait for completion
+    void run(const std::function<void(std::size_t)>& task);
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    const std::function<void(std::size_t)>* task_{nullptr};
+    std::size_t generation_{0};
+    std::size_t pending_{0};
+    std::exception_ptr error_;
+    bool stop_{false};
+
+    void worker_loop(std::size_t tid);
+};
+
+/**
+ * Start of part `part` when [0, n) is cut into `parts` contiguous ranges of
+ * roughly equal cost. cost_before(i) is the total cost of items [0, i) and
+ * must be non-decreasing; e.g. CSR offsets for neighbor-list rows.
+ * Part p covers [balanced_split(.., p), balanced_split(.., p + 1)).
+ */
+template <typename CostBefore>
+std::size_t balanced_split(std::size_t n, std::size_t part, std::size_t parts,
+                           CostBefore cost_before) {
+    if (part == 0 || parts == 0) return 0;
+    if (part >= parts) return n;
+    const double target = static_cast<double>(cost_before(n)) * static_cast<double>(part)
+                          / static_cast<double>(parts);
+    // First i with cost_before(i) >= target.
+    std::size_t lo = 0, hi = n;
+    while (lo < hi) {
+        const std::size_t mid = lo + (hi - lo) / 2;
+        if (static_cast<double>(cost_before(mid)) < target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+}  // namespace matsimu
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/lattice/lattice.hpp>
+#include <matsimu/parallel/device.hpp>
+#include <matsimu/physics/potential.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace matsimu {
+
+/// Host addresses of particle arrays resident on the offload device
+/// (DeviceMirror), as the kernels of DeviceForceField map them.
+struct DeviceParticleArrays {
+    std::size_t n{0};
+    const Real* pos[3]{nullptr, nullptr, nullptr};
+    Real* force[3]{nullptr, nullptr, nullptr};
+};
+
+/**
+ * Pair forces on the offload device (parallel/device.hpp) for particles
+ * that live there (DeviceSimulation), the device counterpart of
+ * NeighborForceField.
+ *
+ * The Verlet list (cutoff + skin) stays on the device in ELL layout: a fixed
+ * number of slots per particle, every pair listed from both sides, so each
+ * device thread owns one particle and writes only its own force (no atomics,
+ * no per-thread buffers; twice the pair evaluations of the host half list).
+ * A pass first reduces the largest displacement since the last build and
+ * rebuilds when it exceeds skin/2. The build bins the particles into cells
+ * at least cutoff + skin wide (a counting sort on the device, members kept
+ * in index order so rows do not depend on thread timing) and scans the 27
+ * cells around each particle, O(N) per rebuild; rows grow when a particle
+ * has more neighbors than slots.
+ *
+ * Potentials: LennardJones (evaluated analytically) and TabulatedPotential
+ * (its spline is copied to the device), so any other Potential runs after
+ * tabulating it. Periodic box: orthorhombic (Lattice::is_orthorhombic) and
+ * at least 2·(cutoff + skin) wide.
+ */
+class DeviceForceField {
+public:
+    /// Throws std::invalid_argument for potentials supports() rejects.
+    DeviceForceField(std::shared_ptr<Potential> potential, Real skin);
+
+    /// LennardJones or TabulatedPotential
+    static bool supports(const Potential& potential);
+
+    Potential* potential() const { return potential_.get(); }
+    Real cutoff() const { return std::sqrt(cutoff_sq_); }
+    Real skin() const { return skin_; }
+
+    /// Periodic box for the next passes (orthorhombic; forces a rebuild)
+    void set_box(const Lattice& box);
+
+    /// The arrays were replaced or rewritten from the host: rebuild on the next pass.
+    void invalidate() { stale_ = true; }
+
+    /**
+     * Overwrite p.force with the pair forces at p.pos and return the
+     * potential energy [J] (0 when !with_energy; forces are identical either
+     * way). Rebuilds the list first when needed (see class comment).
+     */
+    Real compute_forces(const DeviceParticleArrays& p, bool with_energy = true);
+
+    /// List builds so far and slots per particle
+    std::size_t rebuilds() const { return rebuilds_; }
+    std::size_t row_capacity() const { return capacity_; }
+
+private:
+    std::shared_ptr<Potential> potential_;
+    Real skin_;
+    Real cutoff_sq_{0};
+    bool tabulated_{false};
+    // LennardJones
+    Real epsilon_{0};
+    Real sigma_sq_{0};
+    Real shift_{0};
+    // TabulatedPotential
+    std::vector<Real> table_;
+    DeviceMirror<const Real> table_device_;
+    Real s_min_{0};
+    Real inv_h_{0};
+    std::size_t last_segment_{0};
+
+    Real length_[3]{0, 0, 0};
+    Real inv_length_[3]{0, 0, 0};
+
+    std::size_t capacity_{0};                 // slots per row
+    std::size_t rows_{0};                     // particles the list was built for
+    std::vector<std::uint32_t> neighbors_;    // rows_ × capacity_
+    std::vector<std::uint32_t> counts_;
+    std::vector<Real> reference_[3];          // positions at the last build
+    DeviceMirror<std::uint32_t> neighbors_device_;
+    DeviceMirror<std::uint32_t> counts_device_;
+    DeviceMirror<Real> reference_device_[3];
+    bool stale_{true};
+    std::size_t rebuilds_{0};
+
+    // Cell binning of the last build
+    std::size_t cells_[3]{0, 0, 0};           // cells along each axis
+    std::vector<std::uint32_t> cell_of_;      // cell of every particle
+    std::vector<std::uint32_t> cell_start_;   // cell c holds cell_members_[start[c], start[c + 1])
+    std::vector<std::uint32_t> cell_fill_;    // per-cell counts, then fill cursors
+    std::vector<std::uint32_t> cell_members_; // particle indices grouped by cell
+    DeviceMirror<std::uint32_t> cell_of_device_;
+    DeviceMirror<std::uint32_t> cell_start_device_;
+    DeviceMirror<std::uint32_t> cell_fill_device_;
+    DeviceMirror<std::uint32_t> cell_members_device_;
+
+    bool needs_rebuild(const DeviceParticleArrays& p) const;
+    void bin(const DeviceParticleArrays& p);  // fill the cell arrays on the device
+    void rebuild(const DeviceParticleArrays& p);
+    void allocate(std::size_t rows, std::size_t capacity);
+    void allocate_cells(std::size_t n, std::size_t cells);
+};
+
+}  // namespace matsimu
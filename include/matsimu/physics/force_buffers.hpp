@@ -0,0 +1,83 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/physics/particle.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
+#include <type_traits>
+#include <vector>
+
+namespace matsimu {
+
+/**
+ * Per-thread force accumulators for race-free parallel pair loops.
+ *
+ * Thread 0 accumulates straight into the system's force arrays; threads
+ * 1..T-1 get private x/y/z buffers that reduce() adds in ascending thread
+ * order, so the result is bit-for-bit repeatable for a fixed thread count.
+ * Buffers and per-thread energies keep their capacity across steps.
+ */
+class ThreadForceBuffers {
+public:
+    /// Size buffers for `threads` participants and n particles
+    void prepare(std::size_t threads, std::size_t n);
+
+    /// Force component arrays for thread tid; tid > 0 buffers are zeroed here
+    void begin_thread(std::size_t tid, ParticleSystem& system, Real* f[3]);
+
+    /// Record the potential energy accumulated by thread tid
+    void set_energy(std::size_t tid, Real e) { energy_[tid] = e; }
+
+    /// Add thread buffers into the system forces (parallel over particles);
+    /// returns the per-thread energies summed in thread order.
+    Real reduce(ParticleSystem& system, ThreadPool& pool);
+
+private:
+    std::size_t threads_{0};
+    std::size_t n_{0};
+    std::vector<Real> buffers_;  // (threads_-1) * 3 * n_, thread-major
+    std::vector<Real> energy_;
+};
+
+/// Participants run_pair_rows uses with pool (1 = serial)
+inline std::size_t pair_row_threads(const ThreadPool* pool) {
+    return pool && pool->size() > 1 ? pool->size() : 1;
+}
+
+/**
+ * Run a pair-force row kernel over [0, n) rows, serially or across pool.
+ * rows_fn(begin, end, f) accumulates rows [begin, end) into f[3] and returns
+ * their energy; cost_before(i) is the pair count of rows [0, i) and drives
+ * the static split. Forces are cleared first; returns the total energy.
+ * rows_fn may take the participant index as a fourth argument
+ * (0 .. pair_row_threads(pool) - 1) to reach per-thread state.
+ */
+template <typename CostBefore, typename RowsFn>
+Real run_pair_rows(ThreadPool* pool, ThreadForceBuffers& buffers, ParticleSystem& system,
+                   CostBefore cost_before, RowsFn rows_fn) {
+    const auto call = [&rows_fn](std::size_t begin, std::size_t end, Real* const f[3],
+                                 std::size_t tid) {
+        if constexpr (std::is_invocable_v<RowsFn&, std::size_t, std::size_t, Real* const*,
+                                          std::size_t>)
+            return rows_fn(begin, end, f, tid);
+        else
+            return rows_fn(begin, end, f);
+    };
+    system.clear_forces();
+    const std::size_t n = system.size();
+    if (!pool || pool->size() < 2) {
+        Real* f[3] = {system.force(0), system.force(1), system.force(2)};
+        return call(std::size_t{0}, n, f, std::size_t{0});
+    }
+    const std::size_t parts = pool->size();
+    buffers.prepare(parts, n);
+    pool->run([&](std::size_t tid) {
+        Real* f[3];
+        buffers.begin_thread(tid, system, f);
+        const std::size_t begin = balanced_split(n, tid, parts, cost_before);
+        const std::size_t end = balanced_split(n, tid + 1, parts, cost_before);
+        buffers.set_energy(tid, call(begin, end, f, tid));
+    });
+    return buffers.reduce(system, *pool);
+}
+
+}  // namespace matsimu
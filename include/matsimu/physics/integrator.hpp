@@ -1,10 +1,12 @@
 #pragma once
 
 #include <matsimu/core/types.hpp>
+#include <matsimu/physics/observables.hpp>
 #include <matsimu/physics/particle.hpp>
 #include <matsimu/lattice/lattice.hpp>
 #include <cmath>
 #include <functional>
+#include <vector>
 
 namespace matsimu {
 
@@ -23,6 +25,7 @@ namespace matsimu {
 class VelocityVerlet {
 public:
     explicit VelocityVerlet(Real dt) : dt_(dt), half_dt_(0.5 * dt) {}
+    virtual ~VelocityVerlet() = default;
     
     /// Set time step
     void set_dt(Real dt) {
@@ -40,9 +43,22 @@ public:
     
     /**
      * Second half-step: update velocities with new forces.
-     * Call this after computing forces at new positions.
+     * Call this after computing forces at new positions. Also sums the
+     * kinetic moments of the new velocities in the same sweep and caches
+     * them (ParticleSystem::kinetic_moments()), and the per-slab kinetic
+     * energy into profile when given (KineticProfile::begin() first).
      */
-    void step2(ParticleSystem& system) const;
+    void step2(ParticleSystem& system, KineticProfile* profile = nullptr) const;
+    
+    /**
+     * step1/step2 with the finiteness check fused into the update loop.
+     * step1_checked: false if any updated position is non-finite.
+     * step2_checked: false if any updated velocity, any force, or any mass
+     * (via 1/m, must be finite and positive) is invalid.
+     * Same arithmetic as step1/step2; the state is updated either way.
+     */
+    bool step1_checked(ParticleSystem& system) const;
+    bool step2_checked(ParticleSystem& system, KineticProfile* profile = nullptr) const;
     
     /**
      * Full integration step (convenience method).
@@ -56,6 +72,63 @@ private:
     Real half_dt_;
 };
 
+/**
+ * Multiple-time-step Velocity Verlet (r-RESPA, reversible reference system
+ * propagator) for a pair potential split into a cheap-to-vary inner shell
+ * and a slowly varying outer shell (ShellSwitch, pair_kernel.hpp).
+ *
+ * dt() is the outer step; each step runs inner_steps() Verlet sub-steps of
+ * dt() / inner_steps() under the inner forces, between two half kicks of
+ * the outer forces:
+ *   1. v += 0.5*dt*F_out/m
+ *   2. inner_steps() times: v += 0.5*dt_in*F_in/m, r += dt_in*v,
+ *      F_in(r), v += 0.5*dt_in*F_in/m
+ *   3. F_out(r), v += 0.5*dt*F_out/m
+ * The outer forces are evaluated once per step instead of every sub-step.
+ *
+ * The force passes are callbacks: inner(system) must leave the inner-shell
+ * forces in system.force(), outer(system) the outer-shell forces. Between
+ * steps system.force() holds the inner forces and the integrator keeps the
+ * outer ones. Simulation plugs it in via set_integrator(); the shells come
+ * from NeighborForceField::compute_forces(..., ForceShell).
+ */
+class RespaIntegrator : public VelocityVerlet {
+public:
+    using ForcePass = std::function<void(ParticleSystem&)>;
+
+    /// split and switch_width describe the ShellSwitch the force passes use [m].
+    RespaIntegrator(Real dt, std::size_t inner_steps, Real split, Real switch_width);
+
+    std::size_t inner_steps() const { return inner_steps_; }
+    Real inner_dt() const { return dt() / static_cast<Real>(inner_steps_); }
+    Real split() const { return split_; }
+    Real switch_width() const { return switch_width_; }
+
+    /**
+     * Evaluate both shells at the current positions (outer first, kept here;
+     * then inner, left in system.force()). Needed after positions, masses or
+     * storage order change outside step(); step() primes on its own when
+     * the particle count differs from the last prime.
+     */
+    void prime(ParticleSystem& system, const ForcePass& inner, const ForcePass& outer);
+    bool primed(const ParticleSystem& system) const { return outer_.size() == 3 * system.size(); }
+
+    /**
+     * One outer step. The final kick caches the kinetic moments and fills
+     * profile, as VelocityVerlet::step2 does. check = true fuses the
+     * finiteness checks of step1_checked/step2_checked into every kick and
+     * drift and returns false if any failed (the state is updated either way).
+     */
+    bool step(ParticleSystem& system, const ForcePass& inner, const ForcePass& outer,
+              bool check = false, KineticProfile* profile = nullptr);
+
+private:
+    std::size_t inner_steps_;
+    Real split_;
+    Real switch_width_;
+    std::vector<Real> outer_;  // outer-shell forces, component-major (3 * n)
+};
+
 /**
  * Simple Euler integrator (for comparison/testing only).
  * Not recommended for production MD - use VelocityVerlet instead.
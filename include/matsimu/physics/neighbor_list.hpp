@@ -1,15 +1,57 @@
 #pragma once
 
 #include <matsimu/core/types.hpp>
+#include <matsimu/alloc/arena.hpp>
+#include <matsimu/core/precision.hpp>
+#include <matsimu/core/profile.hpp>
 #include <matsimu/physics/particle.hpp>
 #include <matsimu/lattice/lattice.hpp>
 #include <matsimu/physics/potential.hpp>
+#include <matsimu/physics/pair_kernel.hpp>
+#include <matsimu/parallel/simd_level.hpp>
 #include <vector>
 #include <memory>
 #include <array>
+#include <cstdint>
 
 namespace matsimu {
 
+/**
+ * Read-only view of one particle's neighbors inside NeighborList's CSR
+ * storage (span-like; valid until the next build()).
+ */
+class NeighborRange {
+public:
+    using value_type = std::uint32_t;
+    using const_iterator = const std::uint32_t*;
+
+    NeighborRange(const std::uint32_t* first, const std::uint32_t* last)
+        : first_(first), last_(last) {}
+
+    const_iterator begin() const { return first_; }
+    const_iterator end() const { return last_; }
+    std::size_t size() const { return static_cast<std::size_t>(last_ - first_); }
+    bool empty() const { return first_ == last_; }
+    std::uint32_t operator[](std::size_t k) const { return first_[k]; }
+
+private:
+    const std::uint32_t* first_;
+    const std::uint32_t* last_;
+};
+
+/**
+ * How NeighborList::build finds candidate pairs.
+ *
+ * Cells:      Bin particles into cells of width >= cutoff + skin (fractional
+ *             coordinates under a lattice, so triclinic cells work) and scan
+ *             only the 27 surrounding cells. O(N) per build.
+ * BruteForce: Check every i<j pair. O(N²); reference implementation.
+ *
+ * Both modes produce identical pair sets. Cells falls back to BruteForce when
+ * the periodic cell is too small for a 3×3×3 grid.
+ */
+enum class NeighborBuild { Cells, BruteForce };
+
 /**
  * Verlet neighbor list for efficient force calculation.
  * 
@@ -17,6 +59,11 @@ namespace matsimu {
  * within a skin radius (cutoff + skin).
  * 
  * The list is rebuilt when any particle moves more than skin/2.
+ *
+ * Storage is compressed sparse row: neighbors of i (all j > i) are
+ * indices()[offsets()[i] .. offsets()[i+1]), as 32-bit indices in one
+ * contiguous array. Both arrays keep their capacity across rebuilds, so
+ * steady-state rebuilds do not allocate.
  */
 class NeighborList {
 public:
@@ -25,12 +72,19 @@ public:
      * 
      * @param cutoff Force cutoff distance
      * @param skin Buffer distance for list rebuilds (typically 0.2-0.3 * cutoff)
+     * @param mode Pair search strategy used by build()
      */
-    NeighborList(Real cutoff, Real skin);
+    NeighborList(Real cutoff, Real skin, NeighborBuild mode = NeighborBuild::Cells);
     
     /// Set cutoff and skin distances
     void set_cutoff(Real cutoff, Real skin);
     
+    /// Select the pair search strategy for subsequent builds
+    void set_build_mode(NeighborBuild mode) { build_mode_ = mode; }
+    
+    /// Current pair search strategy
+    NeighborBuild build_mode() const { return build_mode_; }
+    
     /// Get cutoff distance
     Real cutoff() const { return cutoff_; }
     
@@ -40,6 +94,12 @@ public:
     /// Get total cutoff (cutoff + skin)
     Real total_cutoff() const { return cutoff_ + skin_; }
     
+    /// Give only particles [0, rows) neighbor rows in later builds; the rest
+    /// appear only as partners of those, and pairs among them are skipped
+    /// (ghost particles of a DistributedSimulation rank). Default: all rows.
+    void set_row_limit(std::size_t rows) { row_limit_ = rows; }
+    std::size_t row_limit() const { return row_limit_; }
+    
     /**
      * Build or rebuild the neighbor list.
      * Should be called when particles have moved significantly.
@@ -61,35 +121,76 @@ public:
     bool needs_rebuild(const ParticleSystem& system, const Lattice* lattice = nullptr) const;
     
     /// Access neighbors of particle i
-    const std::vector<std::size_t>& neighbors(std::size_t i) const {
-        return neighbors_[i];
+    NeighborRange neighbors(std::size_t i) const {
+        const std::uint32_t* base = indices_.data();
+        return NeighborRange(base + offsets_[i], base + offsets_[i + 1]);
     }
     
+    /// CSR row offsets (size() + 1 entries)
+    const std::vector<std::size_t>& offsets() const { return offsets_; }
+    
+    /// CSR column indices (num_pairs() entries)
+    const std::vector<std::uint32_t>& indices() const { return indices_; }
+    
     /// Total number of neighbor pairs
     std::size_t num_pairs() const { return num_pairs_; }
     
+    /// Builds since construction, the pairs they found in total, and the time
+    /// spent in build() [ns; 0 if profiling is compiled out, core/profile.hpp].
+    std::size_t build_count() const { return build_count_; }
+    std::size_t pairs_built() const { return pairs_built_; }
+    std::uint64_t build_ns() const { return build_ns_; }
+
+    /// Arena for per-build temporaries (cell fill cursors; the spatial sort
+    /// borrows it too). Sized on the first builds, then reused: steady-state
+    /// rebuilds make no heap allocations unless the system grows. Its region
+    /// counts against the built system's max_bytes budget.
+    Arena& scratch() { return scratch_; }
+    const Arena& scratch() const { return scratch_; }
+    
     /// Number of particles in list
-    std::size_t size() const { return neighbors_.size(); }
+    std::size_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
     
-    /// Clear the list
+    /// Clear the list (keeps allocated capacity for the next build)
     void clear();
     
     /// Calculate squared distance with optional PBC, returns displacement vector
     static Real distance_sq(const Particle& p1, const Particle& p2,
                            const Lattice* lattice, Real dx[3]);
 
+    /// Same as above for particles i and j of a system, read from the SoA arrays
+    static Real distance_sq(const ParticleSystem& system, std::size_t i, std::size_t j,
+                           const Lattice* lattice, Real dx[3]);
+
 private:
     Real cutoff_;           // Force cutoff
     Real skin_;             // Skin buffer
     Real cutoff_sq_;        // (cutoff + skin)^2
     Real skin_half_sq_;     // (skin/2)^2 for rebuild check
+    NeighborBuild build_mode_;
+    std::size_t row_limit_{static_cast<std::size_t>(-1)};
     
-    std::vector<std::vector<std::size_t>> neighbors_;  // neighbors_[i] = list of neighbors of i
+    std::vector<std::size_t> offsets_;     // CSR row offsets, size n + 1
+    std::vector<std::uint32_t> indices_;   // CSR neighbor indices (j > i)
     std::vector<std::array<Real, 3>> last_positions_;  // Positions at last build
     std::size_t num_pairs_ = 0;
+    std::size_t build_count_ = 0;
+    std::size_t pairs_built_ = 0;
+    std::uint64_t build_ns_ = 0;
+    
+    // Cell-list scratch, reused across builds (counting sort by cell index)
+    std::vector<std::size_t> cell_of_;      // cell index of each particle
+    std::vector<std::size_t> cell_start_;   // CSR offsets into cell_members_ (ncells + 1)
+    std::vector<std::size_t> cell_members_; // particle indices grouped by cell
+    Arena scratch_;                         // per-build temporaries (see scratch())
     
     /// Check if distance squared is within cutoff
     bool within_cutoff(Real r2) const { return r2 < cutoff_sq_; }
+    
+    void build_brute_force(const ParticleSystem& system, const Lattice* lattice);
+    
+    /// Returns false (and builds nothing) when the cell grid is unusable.
+    bool build_cells(const ParticleSystem& system, const Lattice* lattice);
 };
 
 /**
@@ -99,16 +200,50 @@ private:
 class NeighborForceField {
 public:
     NeighborForceField(std::shared_ptr<Potential> potential, 
-                       Real cutoff, Real skin);
+                       Real cutoff, Real skin,
+                       NeighborBuild mode = NeighborBuild::Cells);
     
     /// Set the potential
     void set_potential(std::shared_ptr<Potential> potential) {
         potential_ = std::move(potential);
+        energy_cache_.valid = false;
     }
     
     /// Get the potential
     Potential* potential() const { return potential_.get(); }
     
+    /// Parallelize compute_forces over this pool (nullptr or size 1 = serial)
+    void set_thread_pool(std::shared_ptr<ThreadPool> pool) { pool_ = std::move(pool); }
+    
+    /// Cap the vectorized LJ kernel level (clamped to detect_simd_level();
+    /// Scalar forces the generic pair kernel)
+    void set_simd_level(SimdLevel level);
+    SimdLevel simd_level() const { return simd_level_; }
+    
+    /// Arithmetic of the vector LJ kernel (Single = mixed precision, see
+    /// precision.hpp). The scalar pair kernels always run in Real.
+    void set_precision(Precision precision) {
+        precision_ = precision;
+        energy_cache_.valid = false;
+    }
+    Precision precision() const { return precision_; }
+    
+    /// Reorder the particles along a Morton curve (spatial_sort.hpp) before
+    /// every n-th neighbor rebuild, starting with the first; 0 = never.
+    /// Storage order changes, ParticleSystem::id() stays stable.
+    void set_sort_interval(std::size_t n) { sort_interval_ = n; }
+    std::size_t sort_interval() const { return sort_interval_; }
+    /// Sorts done so far and their total time [ns; 0 if profiling is compiled out].
+    std::size_t sort_count() const { return sort_count_; }
+    std::uint64_t sort_ns() const { return sort_ns_; }
+    
+    /// Inner/outer split of the potential for ForceShell passes (r-RESPA).
+    /// The outer shell uses this list; the inner shell a short list of the
+    /// pairs within split + skin, filtered from it at every rebuild done
+    /// here (the full list until then). width is clamped to [0, split].
+    void set_shell_switch(Real split, Real width);
+    const ShellSwitch& shell_switch() const { return shell_switch_; }
+    
     /// Access the neighbor list
     NeighborList& neighbor_list() { return nlist_; }
     const NeighborList& neighbor_list() const { return nlist_; }
@@ -120,17 +255,72 @@ public:
      * @param system Particle system
      * @param lattice Lattice for periodic boundaries
      * @return Total potential energy
+     *
+     * The pair loop is specialized per potential type (see pair_kernel.hpp);
+     * LennardJones in an orthorhombic or open box uses the SIMD kernel
+     * (simd_lj.hpp) when the CPU supports it.
+     * With a thread pool, rows are split into static ranges balanced by CSR
+     * offsets; results are deterministic for a fixed thread count.
+     *
+     * with_energy = false skips the energy sum and returns 0; forces are
+     * identical either way.
+     *
+     * shell = Inner or Outer evaluates only that part of the potential under
+     * shell_switch() (SIMD kernel for LennardJones as above, in double;
+     * returns the shell's energy, which does not update the compute_energy()
+     * cache).
+     *
+     * sampler (observables.hpp) records the pair observables of this pass
+     * (ForceShell::All only). A sampled pass runs the scalar pair kernel
+     * even where the SIMD LJ kernel would be used, so its forces can differ
+     * from an unsampled pass in the last bits (see simd_lj.hpp).
      */
-    Real compute_forces(ParticleSystem& system, const Lattice* lattice = nullptr);
+    Real compute_forces(ParticleSystem& system, const Lattice* lattice = nullptr,
+                        bool with_energy = true, ForceShell shell = ForceShell::All,
+                        PairSampler* sampler = nullptr);
     
-    /// Calculate energy only (uses neighbor list)
+    /**
+     * Calculate energy only (uses neighbor list).
+     * Returns the energy of the last evaluation without touching the pair
+     * loop or the neighbor list when the system's position_version(), the
+     * lattice and the potential are unchanged since then.
+     */
     Real compute_energy(const ParticleSystem& system, const Lattice* lattice = nullptr);
 
 private:
     std::shared_ptr<Potential> potential_;
     NeighborList nlist_;
+    std::shared_ptr<ThreadPool> pool_;
+    ThreadForceBuffers buffers_;
+    SimdLevel simd_level_;
+    Precision precision_{kDefaultPrecision};
+    std::size_t sort_interval_{0};
+    ShellSwitch shell_switch_;
+    std::vector<std::size_t> inner_offsets_;  // inner-shell CSR (set_shell_switch)
+    std::vector<std::uint32_t> inner_indices_;
+    std::size_t inner_build_{0};               // nlist_.build_count() it was filtered at
+    std::size_t rebuilds_{0};      // rebuilds triggered by compute_forces
+    std::size_t sort_count_{0};
+    std::uint64_t sort_ns_{0};
     
-    Real compute_forces_internal(ParticleSystem& system, const Lattice* lattice);
+    /// Potential energy of the last evaluation and what it depended on
+    struct EnergyCache {
+        bool valid{false};
+        std::uint64_t position_version{0};
+        const Lattice* lattice{nullptr};
+        Real basis[9]{};
+        Real epot{0.0};
+    };
+    EnergyCache energy_cache_;
+    
+    Real compute_forces_internal(ParticleSystem& system, const Lattice* lattice, bool with_energy,
+                                 PairSampler* sampler);
+    Real compute_shell_forces(ParticleSystem& system, const Lattice* lattice, bool with_energy,
+                              ForceShell shell);
+    void build_inner_list(const ParticleSystem& system, const Lattice* lattice);
+    bool energy_cache_hit(const ParticleSystem& system, const Lattice* lattice) const;
+    void store_energy(const ParticleSystem& system, const Lattice* lattice, Real epot);
+
 };
 
 } // namespace matsimu
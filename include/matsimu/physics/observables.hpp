@@ -0,0 +1,220 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/lattice/lattice.hpp>
+#include <matsimu/physics/particle.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace matsimu {
+
+/**
+ * On-the-fly analysis.
+ *
+ * Observables are accumulated inside passes an MD step makes anyway instead
+ * of a step callback walking the system again:
+ * - pair observables (RDF histogram, virial for the pressure) in the force
+ *   pair loop (accumulate_pair_rows, through a PairSampler sink);
+ * - the temperature profile in the second Verlet kick (KineticProfile).
+ * Each observable is enabled with its own sampling stride; a pass only
+ * carries the hooks on steps where something is due.
+ */
+
+/// Pair-loop observer that records nothing (the default of accumulate_pair_rows).
+struct NullPairObserver {
+    void pair(Real, Real) const {}
+};
+
+/**
+ * Pair observables of one force pass, one slot per pair-loop thread so the
+ * loop needs no synchronisation: virial Σ r_ij·F_ij (= Σ (F/r)·r²) and,
+ * when rdf_bins() > 0, a histogram of pair distances below rdf_max().
+ * Slots are merged in thread order (deterministic for a fixed thread count).
+ */
+class PairSampler {
+public:
+    /// Handed to the pair loop for one thread: pair(r2, f_div_r) per pair
+    /// inside the potential cutoff.
+    class Sink {
+    public:
+        Sink(Real* virial, std::uint64_t* counts, std::size_t bins, Real rdf_max2, Real inv_width)
+            : virial_(virial), counts_(counts), last_(bins - 1), rdf_max2_(rdf_max2),
+              inv_width_(inv_width) {}
+
+        void pair(Real r2, Real f_div_r) const {
+            *virial_ += f_div_r * r2;
+            if (r2 < rdf_max2_) {
+                const auto k = static_cast<std::size_t>(std::sqrt(r2) * inv_width_);
+                ++counts_[k < last_ ? k : last_];
+            }
+        }
+
+    private:
+        Real* virial_;
+        std::uint64_t* counts_;
+        std::size_t last_;
+        Real rdf_max2_;
+        Real inv_width_;
+    };
+
+    /// Histogram layout (bins = 0: virial only)
+    void set_rdf(std::size_t bins, Real r_max);
+    std::size_t rdf_bins() const { return bins_; }
+    Real rdf_max() const { return r_max_; }
+
+    /// Whether the next passes fill the histogram (off: virial only)
+    void set_histogram(bool on) { histogram_ = on && bins_ > 0; }
+    bool histogram() const { return histogram_; }
+
+    /// Zero the slots for a pass with `threads` participants (0 = no pass yet)
+    void prepare(std::size_t threads);
+    std::size_t threads() const { return threads_; }
+
+    /// Sink of thread tid (valid until the next prepare())
+    Sink sink(std::size_t tid);
+
+    /// Merged results of the last pass
+    Real virial() const;
+    void add_counts(std::vector<std::uint64_t>& hist) const;
+
+private:
+    std::size_t bins_{0};
+    Real r_max_{0};
+    bool histogram_{false};
+    std::size_t threads_{0};
+    std::vector<Real> virial_;            // one per thread
+    std::vector<std::uint64_t> counts_;   // threads_ × bins_, thread-major
+};
+
+/**
+ * Kinetic energy per slab of the cell along one lattice axis, summed in the
+ * last kick of a step while the velocities are in cache (so before any
+ * thermostat acts on them): slab index from
+ * the wrapped fractional coordinate, Σ m v² and atom count per slab.
+ */
+class KineticProfile {
+public:
+    void configure(std::size_t bins, int axis);
+    std::size_t bins() const { return mv2_.size(); }
+    int axis() const { return axis_; }
+
+    /// Start a sweep of an n-particle system in box (zeroes the sums)
+    void begin(const Lattice& box, std::size_t n);
+
+    /// Slots [begin, end) of velocity component d (v = vel(d) after the
+    /// kick). d == 0 bins the slots from their positions first.
+    void add(const ParticleSystem& system, int d, const Real* v, std::size_t begin, std::size_t end);
+
+    /// Σ m v² [J] (twice the kinetic energy) and atom count per slab of the last sweep
+    const std::vector<Real>& mv2() const { return mv2_; }
+    const std::vector<std::uint64_t>& counts() const { return counts_; }
+
+private:
+    int axis_{0};
+    Real inverse_row_[3]{};             // fractional coordinate along axis_ = row · r
+    std::vector<std::uint32_t> bin_;    // slab of every slot
+    std::vector<Real> mv2_;
+    std::vector<std::uint64_t> counts_;
+};
+
+/**
+ * What Observables samples. A stride of n samples every n-th step (steps
+ * counted from 1); 0 disables that observable.
+ */
+struct ObservableParams {
+    std::size_t rdf_stride{0};
+    std::size_t rdf_bins{100};
+    Real rdf_max{0};                    ///< [m]; 0 or above the cutoff = potential cutoff
+    std::size_t pressure_stride{0};
+    std::size_t temperature_profile_stride{0};
+    std::size_t temperature_profile_bins{20};
+    int temperature_profile_axis{0};    ///< Slabs along a1 (0), a2 (1) or a3 (2)
+
+    std::optional<std::string> validate() const;
+    bool any() const { return rdf_stride || pressure_stride || temperature_profile_stride; }
+};
+
+/**
+ * Running averages of the enabled observables. Simulation owns one (see
+ * Simulation::set_observables): per step it asks for the hooks that are
+ * due (pair_sampler, kinetic_profile), hands them to the force pass and the
+ * integrator, and calls finish_step() with the end-of-step state. Both
+ * kinetic observables see the velocities after the last kick and before the
+ * thermostat, the state the step's forces belong to.
+ *
+ * All three need a periodic cell (volume, slab positions); steps without
+ * one record nothing. Pair observables see only pairs inside the potential
+ * cutoff and are not sampled by r-RESPA runs.
+ */
+class Observables {
+public:
+    /// Adopt params (validated by the caller) for a potential with the given
+    /// cutoff [m]; clears all averages.
+    void configure(const ObservableParams& params, Real cutoff);
+    const ObservableParams& params() const { return params_; }
+
+    bool rdf_due(std::size_t step) const { return due(params_.rdf_stride, step); }
+    bool pressure_due(std::size_t step) const { return due(params_.pressure_stride, step); }
+    bool temperature_profile_due(std::size_t step) const {
+        return due(params_.temperature_profile_stride, step);
+    }
+
+    /// Hooks for step `step` (nullptr when nothing of theirs is due)
+    PairSampler* pair_sampler(std::size_t step);
+    KineticProfile* kinetic_profile(std::size_t step, const Lattice* box, std::size_t n);
+
+    /**
+     * Fold the samples of step `step` into the averages. kinetic_energy is
+     * that of the velocities after the last kick, before the thermostat [J]
+     * (pressure P = (2K + W) / 3V), as in the temperature profile.
+     */
+    void finish_step(std::size_t step, const ParticleSystem& system, const Lattice* box,
+                     Real kinetic_energy);
+
+    /// Clear the averages (keeps params)
+    void reset();
+
+    /// g(r) per bin (bin k covers [k, k+1) · rdf_bin_width()); zeros before any sample
+    std::vector<Real> rdf() const;
+    Real rdf_bin_width() const;
+    const std::vector<std::uint64_t>& rdf_counts() const { return rdf_counts_; }
+    std::size_t rdf_samples() const { return rdf_samples_; }
+
+    /// Mean pressure [Pa] and the last sample's pressure and virial [J]
+    Real pressure() const { return pressure_samples_ ? pressure_sum_ / pressure_samples_ : 0.0; }
+    Real last_pressure() const { return last_pressure_; }
+    Real last_virial() const { return last_virial_; }
+    std::size_t pressure_samples() const { return pressure_samples_; }
+
+    /// Mean kinetic temperature per slab [K] (Σ m v² / 3 k_B N over the
+    /// samples; velocities about zero, so a flowing slab reads hotter)
+    std::vector<Real> temperature_profile() const;
+    const KineticProfile& last_profile() const { return profile_; }
+    std::size_t temperature_profile_samples() const { return profile_samples_; }
+
+private:
+    ObservableParams params_;
+    PairSampler sampler_;
+    KineticProfile profile_;
+    bool pair_armed_{false};
+    bool profile_armed_{false};
+
+    std::vector<std::uint64_t> rdf_counts_;
+    Real rdf_norm_{0};                  // Σ over samples of N² / 2V
+    std::size_t rdf_samples_{0};
+    Real pressure_sum_{0};
+    Real last_pressure_{0};
+    Real last_virial_{0};
+    std::size_t pressure_samples_{0};
+    std::vector<Real> profile_mv2_;
+    std::vector<std::uint64_t> profile_counts_;
+    std::size_t profile_samples_{0};
+
+    static bool due(std::size_t stride, std::size_t step) { return stride > 0 && step % stride == 0; }
+};
+
+}  // namespace matsimu
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/physics/observables.hpp>
+#include <matsimu/physics/particle.hpp>
+#include <matsimu/physics/potential.hpp>
+#include <matsimu/lattice/lattice.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <typeinfo>
+#include <utility>
+
+namespace matsimu {
+
+/**
+ * Compile-time pair kernels.
+ *
+ * A kernel type provides `cutoff_squared()` and an inline
+ * `energy_and_force(r2, e, f_div_r)`. accumulate_pair_rows<Kernel> is
+ * instantiated per kernel so the inner loop has no virtual calls;
+ * dispatch_pair_kernel picks the instantiation once per force evaluation.
+ * Potentials without a fused form run through VirtualPairKernel.
+ */
+
+/// Fallback kernel: the two virtual calls of the Potential interface.
+class VirtualPairKernel {
+public:
+    explicit VirtualPairKernel(const Potential& pot)
+        : pot_(pot), cutoff_sq_(pot.cutoff_squared()) {}
+
+    Real cutoff_squared() const { return cutoff_sq_; }
+
+    void energy_and_force(Real r2, Real& e, Real& f_div_r) const {
+        e = pot_.energy(r2);
+        f_div_r = pot_.force_div_r(r2);
+    }
+
+private:
+    const Potential& pot_;
+    Real cutoff_sq_;
+};
+
+/**
+ * Call fn(kernel) with the concrete kernel for pot and return its result.
+ * Exact type match only: a subclass of LennardJones may override energy(),
+ * so it takes the virtual path.
+ */
+template <typename Fn>
+decltype(auto) dispatch_pair_kernel(const Potential& pot, Fn&& fn) {
+    const std::type_info& type = typeid(pot);
+    if (type == typeid(LennardJones))
+        return std::forward<Fn>(fn)(static_cast<const LennardJones&>(pot));
+    if (type == typeid(HarmonicPotential))
+        return std::forward<Fn>(fn)(static_cast<const HarmonicPotential&>(pot));
+    if (type == typeid(TabulatedPotential))
+        return std::forward<Fn>(fn)(static_cast<const TabulatedPotential&>(pot));
+    return std::forward<Fn>(fn)(VirtualPairKernel(pot));
+}
+
+/// Part of a split pair potential a force pass evaluates (r-RESPA, see
+/// RespaIntegrator). Inner + Outer = All.
+enum class ForceShell { All, Inner, Outer };
+
+/**
+ * Split of a pair potential U into an inner shell S·U and an outer shell
+ * (1 - S)·U. S is 1 up to split - width, 0 from split on, and a cubic
+ * smoothstep in between, so both shells have continuous forces and sum to U.
+ * width = 0 is a hard split (force jump at split).
+ */
+struct ShellSwitch {
+    Real split{0};  ///< Inner shell ends here [m]
+    Real width{0};  ///< Switching zone below split [m]
+};
+
+/**
+ * Kernel for one shell of Kernel under a ShellSwitch. Inside the switching
+ * zone F_in/r = S·f/r - S'·U/r; outside it the pair is all inner or all
+ * outer. The inner shell's cutoff is the split, so the pair loop skips
+ * longer pairs before calling the kernel.
+ */
+template <ForceShell Shell, typename Kernel>
+class ShellPairKernel {
+    static_assert(Shell != ForceShell::All, "ShellPairKernel: use Kernel itself for All");
+
+public:
+    ShellPairKernel(const Kernel& kernel, const ShellSwitch& sw)
+        : kernel_(kernel), r_on_(sw.split - sw.width),
+          inv_width_(sw.width > 0.0 ? 1.0 / sw.width : 0.0),
+          on_sq_(r_on_ * r_on_), off_sq_(sw.split * sw.split) {}
+
+    Real cutoff_squared() const {
+        return Shell == ForceShell::Inner ? std::min(off_sq_, kernel_.cutoff_squared())
+                                          : kernel_.cutoff_squared();
+    }
+
+    void energy_and_force(Real r2, Real& e, Real& f_div_r) const {
+        constexpr bool inner = Shell == ForceShell::Inner;
+        if (r2 < on_sq_ || r2 >= off_sq_) {
+            if (inner == (r2 < on_sq_)) {
+                kernel_.energy_and_force(r2, e, f_div_r);
+            } else {
+                e = 0.0;
+                f_div_r = 0.0;
+            }
+            return;
+        }
+        kernel_.energy_and_force(r2, e, f_div_r);
+        const Real r = std::sqrt(r2);
+        const Real x = (r - r_on_) * inv_width_;
+        const Real s = 1.0 - x * x * (3.0 - 2.0 * x);
+        const Real ds_dr = -6.0 * x * (1.0 - x) * inv_width_;
+        const Real e_in = s * e;
+        const Real f_in = s * f_div_r - ds_dr * e / r;
+        if (inner) {
+            e = e_in;
+            f_div_r = f_in;
+        } else {
+            e -= e_in;
+            f_div_r -= f_in;
+        }
+    }
+
+private:
+    const Kernel& kernel_;
+    Real r_on_;
+    Real inv_width_;
+    Real on_sq_;
+    Real off_sq_;
+};
+
+/// Rows of the all-pairs (j > i) loop, in the shape of a neighbor-list row.
+class AllPairsRows {
+public:
+    class Row {
+    public:
+        class iterator {
+        public:
+            explicit iterator(std::size_t j) : j_(j) {}
+            std::size_t operator*() const { return j_; }
+            iterator& operator++() { ++j_; return *this; }
+            bool operator!=(const iterator& o) const { return j_ != o.j_; }
+
+        private:
+            std::size_t j_;
+        };
+
+        Row(std::size_t begin, std::size_t end) : begin_(begin), end_(end) {}
+        iterator begin() const { return iterator(begin_); }
+        iterator end() const { return iterator(end_); }
+
+    private:
+        std::size_t begin_, end_;
+    };
+
+    explicit AllPairsRows(std::size_t n) : n_(n) {}
+    Row operator()(std::size_t i) const { return Row(i + 1, n_); }
+
+private:
+    std::size_t n_;
+};
+
+/**
+ * Accumulate pair forces for rows [begin, end) into f (Newton 3: +F on i,
+ * -F on j) and return the pair energy of those rows. rows(i) yields the j
+ * partners of i. The i-side force is summed in registers and stored once
+ * per row. WithEnergy = false skips the energy sum (returns 0); forces are
+ * unchanged. observer.pair(r2, f_div_r) sees every pair inside the cutoff
+ * (PairSampler::Sink for on-the-fly observables; the default compiles away).
+ */
+template <bool WithEnergy = true, typename Kernel, typename Rows,
+          typename Observer = NullPairObserver>
+Real accumulate_pair_rows(const Kernel& kernel, const Rows& rows,
+                          const ParticleSystem& system, const Lattice* lattice,
+                          std::size_t begin, std::size_t end, Real* const f[3],
+                          Observer observer = Observer()) {
+    const Real* x = system.pos(0);
+    const Real* y = system.pos(1);
+    const Real* z = system.pos(2);
+    Real* fx_arr = f[0];
+    Real* fy_arr = f[1];
+    Real* fz_arr = f[2];
+    const Real rc2 = kernel.cutoff_squared();
+    Real epot = 0.0;
+
+    for (std::size_t i = begin; i < end; ++i) {
+        const Real ri[3] = {x[i], y[i], z[i]};
+        Real fxi = 0.0, fyi = 0.0, fzi = 0.0;
+        for (std::size_t j : rows(i)) {
+            const Real rj[3] = {x[j], y[j], z[j]};
+            Real dx[3] = {ri[0] - rj[0], ri[1] - rj[1], ri[2] - rj[2]};  // r_ij = r_i - r_j
+            if (lattice) lattice->min_image_displacement(rj, ri, dx);
+            const Real r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+            if (r2 < rc2) {
+                Real e, f_div_r;
+                kernel.energy_and_force(r2, e, f_div_r);
+                if (WithEnergy) epot += e;
+                observer.pair(r2, f_div_r);
+                const Real fx = f_div_r * dx[0];
+                const Real fy = f_div_r * dx[1];
+                const Real fz = f_div_r * dx[2];
+                fxi += fx; fyi += fy; fzi += fz;
+                fx_arr[j] -= fx; fy_arr[j] -= fy; fz_arr[j] -= fz;
+            }
+        }
+        fx_arr[i] += fxi; fy_arr[i] += fyi; fz_arr[i] += fzi;
+    }
+    return epot;
+}
+
+}  // namespace matsimu
@@ -3,26 +3,35 @@
 #include <matsimu/core/types.hpp>
 #include <matsimu/lattice/lattice.hpp>
 #include <matsimu/alloc/bounded_allocator.hpp>
+#include <matsimu/alloc/arena.hpp>
+#include <matsimu/alloc/placement.hpp>
 #include <vector>
+#include <cstdint>
 #include <memory>
+#include <type_traits>
 
 namespace matsimu {
 
+class ThreadPool;
+
 /**
  * Single particle (atom) state in 3D.
  * Stores position, velocity, and force vectors.
+ *
+ * Value type used to add particles and to take per-particle copies;
+ * ParticleSystem itself stores state as structure-of-arrays.
  */
 struct Particle {
     Real pos[3] = {0.0, 0.0, 0.0};   // Position [m]
     Real vel[3] = {0.0, 0.0, 0.0};   // Velocity [m/s]
     Real force[3] = {0.0, 0.0, 0.0}; // Force [N]
     Real mass = 1.0;                  // Mass [kg]
-    
+
     /// Zero out the force vector
     void clear_force() {
         force[0] = force[1] = force[2] = 0.0;
     }
-    
+
     /// Add to force vector
     void add_force(Real fx, Real fy, Real fz) {
         force[0] += fx;
@@ -31,70 +40,330 @@ struct Particle {
     }
 };
 
+/// Velocity moments of a ParticleSystem, from one pass over v and m.
+struct KineticMoments {
+    Real kinetic_energy{0};         ///< [J]
+    Real momentum[3]{0, 0, 0};      ///< Total momentum [kg·m/s]
+    Real total_mass{0};             ///< [kg]
+    Real temperature{0};            ///< [K], 3N - 3 degrees of freedom (0 for N <= 1)
+};
+
+/**
+ * Running sums behind KineticMoments: m·v and m·v² per component and Σm, in
+ * four lanes (slot mod 4) so the loops vectorize. The lane layout fixes the
+ * summation order; ranges added in order from slot 0 give the same bits
+ * however they are chunked, as long as chunks start at multiples of 4.
+ */
+struct VelocityMomentSums {
+    Real mv[3][4]{};
+    Real mv2[3][4]{};
+    Real mass[4]{};
+
+    /// Add slots [begin, end) of component d (v = that component's velocity
+    /// array); d == 0 also sums the masses. begin must be a multiple of 4.
+    void add(int d, const Real* m, const Real* v, std::size_t begin, std::size_t end) {
+        Real* p = mv[d];
+        Real* e = mv2[d];
+        std::size_t i = begin;
+        for (; i + 4 <= end; i += 4) {
+            for (int k = 0; k < 4; ++k) {
+                const Real mvi = m[i + k] * v[i + k];
+                p[k] += mvi;
+                e[k] += mvi * v[i + k];
+            }
+            if (d == 0)
+                for (int k = 0; k < 4; ++k) mass[k] += m[i + k];
+        }
+        for (int k = 0; i < end; ++i, ++k) {
+            const Real mvi = m[i] * v[i];
+            p[k] += mvi;
+            e[k] += mvi * v[i];
+            if (d == 0) mass[k] += m[i];
+        }
+    }
+
+    /// Lane-wise sum (partials of consecutive chunks, merged in chunk order).
+    void merge(const VelocityMomentSums& o);
+
+    /// Combine the lanes for an n-particle system.
+    KineticMoments finish(std::size_t n) const;
+};
+
 /**
  * Collection of particles with simulation state.
- * Resource-aware: uses vector with bounded allocator support.
+ * Resource-aware: every array shares one bounded allocator budget.
+ *
+ * Storage is structure-of-arrays: separate contiguous x/y/z arrays for
+ * position, velocity and force, plus mass and inverse-mass arrays. Hot loops
+ * (integrator, thermostats, force kernels) use the stride-1 arrays via
+ * pos(d), vel(d), force(d), masses(), inverse_masses(). operator[] and
+ * particles() return lightweight proxies so `system[i].pos[0]` style code
+ * keeps working.
  */
 class ParticleSystem {
 public:
-    using ParticleAllocator = bounded_allocator<Particle>;
-    
+    using RealAllocator = bounded_allocator<Real, placement_allocator<Real>>;
+    using RealArray = std::vector<Real, RealAllocator>;
+    using IndexArray = std::vector<std::uint32_t, bounded_allocator<std::uint32_t, placement_allocator<std::uint32_t>>>;
+
+    /// Proxy for one 3-vector (pos, vel or force) of particle i.
+    template <bool Const>
+    class Vec3Ref {
+    public:
+        using Array = std::conditional_t<Const, const RealArray, RealArray>;
+        using Value = std::conditional_t<Const, const Real, Real>;
+
+        Vec3Ref(Array* comp, std::size_t i) : comp_(comp), i_(i) {}
+        Value& operator[](int d) const { return comp_[d][i_]; }
+
+    private:
+        Array* comp_;
+        std::size_t i_;
+    };
+
+    /// Proxy for particle i; mirrors the field names of Particle.
+    /// Mass is read-only here; use set_mass() so the inverse mass stays in sync.
+    template <bool Const>
+    class ParticleRef {
+    public:
+        using Owner = std::conditional_t<Const, const ParticleSystem, ParticleSystem>;
+
+        ParticleRef(Owner& s, std::size_t i)
+            : pos(s.pos_, i), vel(s.vel_, i), force(s.force_, i), mass(s.mass_[i]) {}
+
+        Vec3Ref<Const> pos;
+        Vec3Ref<Const> vel;
+        Vec3Ref<Const> force;
+        const Real& mass;
+
+        /// Zero out the force vector
+        template <bool C = Const, typename = std::enable_if_t<!C>>
+        void clear_force() const { force[0] = force[1] = force[2] = 0.0; }
+
+        /// Add to force vector
+        template <bool C = Const, typename = std::enable_if_t<!C>>
+        void add_force(Real fx, Real fy, Real fz) const {
+            force[0] += fx;
+            force[1] += fy;
+            force[2] += fz;
+        }
+
+        /// Copy out as a Particle value
+        operator Particle() const {
+            Particle p;
+            for (int d = 0; d < 3; ++d) {
+                p.pos[d] = pos[d];
+                p.vel[d] = vel[d];
+                p.force[d] = force[d];
+            }
+            p.mass = mass;
+            return p;
+        }
+    };
+
+    /// Iterable range of particle proxies (see particles()).
+    template <bool Const>
+    class ParticleRange {
+    public:
+        using Owner = std::conditional_t<Const, const ParticleSystem, ParticleSystem>;
+
+        class iterator {
+        public:
+            iterator(Owner* s, std::size_t i) : s_(s), i_(i) {}
+            ParticleRef<Const> operator*() const { return ParticleRef<Const>(*s_, i_); }
+            iterator& operator++() { ++i_; return *this; }
+            bool operator==(const iterator& o) const { return i_ == o.i_; }
+            bool operator!=(const iterator& o) const { return i_ != o.i_; }
+
+        private:
+            Owner* s_;
+            std::size_t i_;
+        };
+
+        explicit ParticleRange(Owner& s) : s_(&s) {}
+        iterator begin() const { return iterator(s_, 0); }
+        iterator end() const { return iterator(s_, s_->size()); }
+        std::size_t size() const { return s_->size(); }
+
+    private:
+        Owner* s_;
+    };
+
+    using Ref = ParticleRef<false>;
+    using ConstRef = ParticleRef<true>;
+
     /// Construct with a default limit of 1GB for particles (approx 12M particles)
-    explicit ParticleSystem(std::size_t max_bytes = 1024 * 1024 * 1024) 
-        : particles_(ParticleAllocator(max_bytes)) {}
-        
+    explicit ParticleSystem(std::size_t max_bytes = 1024 * 1024 * 1024)
+        : ParticleSystem(0, max_bytes) {}
+
     /// Construct with initial size and a default limit
-    ParticleSystem(std::size_t n, std::size_t max_bytes = 1024 * 1024 * 1024) 
-        : particles_(n, Particle(), ParticleAllocator(max_bytes)) {}
+    ParticleSystem(std::size_t n, std::size_t max_bytes = 1024 * 1024 * 1024);
+
+    /// Construct with a placement policy for the arrays (alloc/placement.hpp:
+    /// huge pages, parallel first touch); null = plain heap.
+    ParticleSystem(std::size_t n, std::size_t max_bytes,
+                   std::shared_ptr<const MemoryPlacement> placement);
 
     /// Add a particle to the system
-    void add_particle(const Particle& p) {
-        particles_.push_back(p);
-    }
-    
+    void add_particle(const Particle& p);
+
+    /**
+     * Bulk import: append n particles from component arrays (pos[d] and
+     * vel[d] hold n values each; vel == nullptr appends them at rest).
+     * One range insert per array instead of n add_particle calls. Forces
+     * start at zero; appended ids continue the current ones.
+     */
+    void append(std::size_t n, const Real* const pos[3], const Real* const vel[3], const Real* mass);
+
+    /// append() with one mass for all n particles
+    void append(std::size_t n, const Real* const pos[3], const Real* const vel[3], Real mass);
+
     /// Reserve space for n particles
-    void reserve(std::size_t n) {
-        particles_.reserve(n);
-    }
-    
-    /// Access particle by index
-    Particle& operator[](std::size_t i) { return particles_[i]; }
-    const Particle& operator[](std::size_t i) const { return particles_[i]; }
-    
+    void reserve(std::size_t n);
+
+    /// Access particle by index (proxy into the SoA arrays)
+    Ref operator[](std::size_t i) { touch_positions(); touch_velocities(); return Ref(*this, i); }
+    ConstRef operator[](std::size_t i) const { return ConstRef(*this, i); }
+
     /// Number of particles
-    std::size_t size() const { return particles_.size(); }
-    
+    std::size_t size() const { return mass_.size(); }
+
     /// Check if empty
-    bool empty() const { return particles_.empty(); }
-    
-    /// Clear all particles
-    void clear() { particles_.clear(); }
-    
+    bool empty() const { return mass_.empty(); }
+
+    /// Clear all particles (ids restart at identity)
+    void clear();
+
+    /// Resize to n particles; new entries are at rest at the origin with the
+    /// default mass (bulk loads fill the arrays afterwards). Resets ids.
+    void resize(std::size_t n);
+
+    /**
+     * Stable particle ids. Storage order may change (reorder(), e.g. the
+     * spatial sort on neighbor rebuilds); id(i) is the creation index of the
+     * particle now stored in slot i. Identity, with no id array, until the
+     * first reorder(); added particles get id = size() at the time.
+     */
+    std::uint32_t id(std::size_t i) const {
+        return ids_.empty() ? static_cast<std::uint32_t>(i) : ids_[i];
+    }
+    bool reordered() const { return !ids_.empty(); }
+
+    /// Permute storage: slot i takes the particle from slot order[i] (order is
+    /// a permutation of 0..size()-1). All arrays and ids move together. The
+    /// copy buffer comes from scratch when given (kReorderScratchPerParticle
+    /// bytes per particle), else from the heap.
+    void reorder(const std::uint32_t* order, Arena* scratch = nullptr);
+    static constexpr std::size_t kReorderScratchPerParticle = sizeof(Real) + sizeof(std::uint32_t);
+
+    /// Copy size() ids (checkpoint restore); a permutation of 0..size()-1,
+    /// except on DistributedSimulation ranks, which hold a subset of the
+    /// global ids (slots_by_id() does not apply there).
+    void set_ids(const std::uint32_t* ids);
+
+    /// Slot of every id: slots[id(i)] = i (size() entries).
+    void slots_by_id(std::vector<std::uint32_t>& slots) const;
+
+    /// Set mass of particle i [kg] (keeps the inverse-mass array in sync)
+    void set_mass(std::size_t i, Real m);
+
+    /// Copy size() masses [kg] from m and recompute the inverse masses
+    void set_masses(const Real* m);
+
     /// Clear all forces (call before force calculation)
     void clear_forces();
-    
-    /// Calculate total kinetic energy [J]
-    Real kinetic_energy() const;
-    
-    /// Calculate temperature from kinetic energy [K]
-    /// For N particles in 3D: T = 2*E_kin / (3*N*k_B)
-    Real temperature() const;
-    
+
+    /**
+     * Kinetic energy, momentum, total mass and temperature from one fused
+     * pass, cached until velocities or masses change (velocity_version()).
+     * VelocityVerlet::step2 fills the cache as a by-product of the kick, so
+     * the thermostat and energy readouts of a step share one result. With a
+     * pool of more than one thread, large systems are reduced in parallel
+     * (fixed chunks, merged in order: deterministic for a fixed pool size).
+     * The cache is not synchronised: no concurrent calls on one system.
+     */
+    const KineticMoments& kinetic_moments(ThreadPool* pool = nullptr) const;
+
+    /// Store moments computed elsewhere for the current velocities (fused
+    /// loops such as the Verlet kick); the next velocity access drops them.
+    void cache_kinetic_moments(const KineticMoments& m) const;
+
+    /// Total kinetic energy [J] (kinetic_moments())
+    Real kinetic_energy() const { return kinetic_moments().kinetic_energy; }
+
+    /// Temperature from kinetic energy [K]: T = 2*E_kin / ((3N - 3)*k_B)
+    Real temperature() const { return kinetic_moments().temperature; }
+
     /// Get center of mass position
     void center_of_mass(Real com[3]) const;
-    
-    /// Remove center of mass velocity (drift correction)
+
+    /// Remove center of mass velocity (drift correction); updates the cached
+    /// moments instead of dropping them.
     void zero_com_velocity();
-    
+
+    /// Multiply every velocity by lambda (the cached moments are rescaled).
+    void scale_velocities(Real lambda);
+
+    /// Changes on every non-const access that can reach velocities or masses
+    /// (vel(d), operator[], particles(), set_mass, ...); keys kinetic_moments().
+    std::uint64_t velocity_version() const { return vel_version_; }
+
     /// Apply periodic boundary conditions using lattice
     void apply_pbc(const Lattice& lattice);
-    
-    /// Access underlying container
-    const std::vector<Particle, ParticleAllocator>& particles() const { return particles_; }
-    std::vector<Particle, ParticleAllocator>& particles() { return particles_; }
-    
+
+    /// Stride-1 component arrays (d = 0, 1, 2 for x, y, z); size() entries each.
+    Real* pos(int d) { touch_positions(); return pos_[d].data(); }
+    const Real* pos(int d) const { return pos_[d].data(); }
+    Real* vel(int d) { touch_velocities(); return vel_[d].data(); }
+    const Real* vel(int d) const { return vel_[d].data(); }
+    Real* force(int d) { return force_[d].data(); }
+    const Real* force(int d) const { return force_[d].data(); }
+    const Real* masses() const { return mass_.data(); }
+    const Real* inverse_masses() const { return inv_mass_.data(); }
+
+    /// Iterate particles as proxies: `for (auto p : system.particles())`
+    ParticleRange<true> particles() const { return ParticleRange<true>(*this); }
+    ParticleRange<false> particles() {
+        touch_positions();
+        touch_velocities();
+        return ParticleRange<false>(*this);
+    }
+
+    /// Allocator accounting shared by all arrays [bytes].
+    std::size_t bytes_in_use() const { return alloc_state().current_bytes.load(std::memory_order_relaxed); }
+    std::size_t peak_bytes() const { return alloc_state().peak_bytes.load(std::memory_order_relaxed); }
+    std::size_t max_bytes() const { return alloc_state().max_bytes; }
+    /// That budget, for scratch arenas that should count against max_bytes
+    /// (Arena::set_budget).
+    std::shared_ptr<bounded_allocator_state> budget() const { return pos_[0].get_allocator().state; }
+
+    /// Position version: changes on every non-const access that can reach
+    /// positions (pos(d), operator[], particles(), add_particle, clear,
+    /// apply_pbc). Values are unique across all systems, so equal versions
+    /// mean equal positions (a copy shares its source's version until either
+    /// is touched). Used to key cached results such as the potential energy.
+    std::uint64_t position_version() const { return pos_version_; }
+
 private:
-    std::vector<Particle, ParticleAllocator> particles_;
+    ParticleSystem(std::size_t n, const RealAllocator& alloc);
+    /// append() without the mass arrays: positions, velocities, forces, ids
+    void append_state(std::size_t n, const Real* const pos[3], const Real* const vel[3]);
+
+    RealArray pos_[3];
+    RealArray vel_[3];
+    RealArray force_[3];
+    RealArray mass_;
+    RealArray inv_mass_;
+    IndexArray ids_;  // empty = identity
+    std::uint64_t pos_version_;
+    std::uint64_t vel_version_;
+    mutable KineticMoments moments_;
+    mutable std::uint64_t moments_version_{0};  // vel_version_ moments_ belongs to; 0 = none
+
+    void touch_positions() { pos_version_ = next_position_version(); }
+    void touch_velocities() { vel_version_ = next_position_version(); }
+    const RealAllocator::State& alloc_state() const { return *pos_[0].get_allocator().state; }
+    static std::uint64_t next_position_version();
 };
 
 
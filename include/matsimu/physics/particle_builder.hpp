@@ -0,0 +1,87 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/lattice/lattice.hpp>
+#include <matsimu/physics/particle.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace matsimu {
+
+/// Sites per conventional cubic cell: 1 (sc), 2 (bcc), 4 (fcc).
+enum class CrystalBasis { SimpleCubic, BCC, FCC };
+
+/// Number of basis sites of a CrystalBasis.
+std::size_t crystal_sites(CrystalBasis basis);
+
+/// What fill_crystal() builds from one cell.
+struct CrystalSpec {
+    CrystalBasis basis{CrystalBasis::FCC};
+    std::size_t repeats[3]{1, 1, 1};  ///< Copies of the cell along a1, a2, a3
+    Real offset[3]{0, 0, 0};          ///< Fractional shift of every site in its cell
+    Real mass{Particle().mass};       ///< [kg]
+};
+
+/**
+ * Replicate cell (a1..a3, any shape) repeats[0] × repeats[1] × repeats[2]
+ * times with the basis sites of spec and append the atoms to ps at rest, in
+ * one bulk ParticleSystem::append. Site (n1, n2, n3, b) sits at
+ * Σ_k (n_k + b_k + offset_k) a_k; atoms are stored with n1 slowest and the
+ * basis index fastest. Returns the supercell (a_k scaled by repeats[k],
+ * cache updated). Throws std::bad_alloc past the system's memory budget.
+ */
+Lattice fill_crystal(ParticleSystem& ps, const Lattice& cell, const CrystalSpec& spec);
+
+/// Position of site (n[0], n[1], n[2], b) of fill_crystal(cell, spec),
+/// bit-identical to the atom it stores there.
+void crystal_site(const Lattice& cell, const CrystalSpec& spec, const std::size_t n[3],
+                  std::size_t b, Real pos[3]);
+
+/// The supercell fill_crystal(cell, spec) returns
+Lattice supercell(const Lattice& cell, const CrystalSpec& spec);
+
+/**
+ * Overlap rejection for random placement in a periodic box: a cell list of
+ * the accepted positions with cells at least min_distance wide, so a
+ * candidate is tested against the atoms of its 27 surrounding cells only
+ * (O(1) per candidate instead of a scan over everything placed). Distances
+ * use the minimum image of box; min_distance must be below half the box
+ * width along every axis.
+ */
+class PlacementGrid {
+public:
+    PlacementGrid(const Lattice& box, Real min_distance);
+
+    /// No accepted position lies within min_distance of pos
+    bool fits(const Real pos[3]) const;
+
+    /// Record pos as occupied (no overlap test)
+    void insert(const Real pos[3]);
+
+    /// insert() if fits(); returns whether pos was accepted
+    bool try_insert(const Real pos[3]);
+
+    /// Accepted positions, in insertion order
+    std::size_t size() const { return points_.size(); }
+    const Real* position(std::size_t i) const { return points_[i].r; }
+
+    /// Cells per axis
+    const std::size_t* dims() const { return dims_; }
+
+private:
+    struct Point {
+        Real r[3];
+    };
+
+    Lattice box_;
+    Real min_dist2_;
+    std::size_t dims_[3]{1, 1, 1};
+    std::vector<std::int32_t> head_;  // first point per cell, -1 = empty
+    std::vector<std::int32_t> next_;  // next point in the same cell
+    std::vector<Point> points_;
+
+    std::size_t cell_of(const Real pos[3], std::size_t c[3]) const;
+};
+
+}  // namespace matsimu
@@ -2,8 +2,13 @@
 
 #include <matsimu/core/types.hpp>
 #include <matsimu/physics/particle.hpp>
+#include <matsimu/physics/force_buffers.hpp>
+#include <matsimu/physics/observables.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
 #include <matsimu/lattice/lattice.hpp>
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace matsimu {
 
@@ -19,7 +24,7 @@ public:
     virtual Real energy(Real r2) const = 0;
     
     /// Calculate pair force magnitude divided by r (F/r = -dU/dr / r)
-    /// Returns f/r where F = (f/r) * r_vec
+    /// Returns f/r where the force on i is F_i = (f/r) * (r_i - r_j)
     virtual Real force_div_r(Real r2) const = 0;
     
     /// Get cutoff distance squared
@@ -45,9 +50,25 @@ public:
     Real force_div_r(Real r2) const override;
     Real cutoff_squared() const override { return cutoff_sq_; }
     
+    /// Fused energy and F/r sharing one r^-6/r^-12 evaluation (inline for pair kernels).
+    /// Same values as energy(r2) and force_div_r(r2).
+    void energy_and_force(Real r2, Real& e, Real& f_div_r) const {
+        if (!std::isfinite(r2) || r2 <= 1e-30 || r2 >= cutoff_sq_) {
+            e = 0.0;
+            f_div_r = 0.0;
+            return;
+        }
+        Real r2_inv = sigma_sq_ / r2;
+        Real r6_inv = r2_inv * r2_inv * r2_inv;
+        Real r12_inv = r6_inv * r6_inv;
+        e = 4.0 * epsilon_ * (r12_inv - r6_inv) - shift_;
+        f_div_r = 24.0 * epsilon_ * (2.0 * r12_inv - r6_inv) / r2;
+    }
+    
     /// Get potential parameters
     Real epsilon() const { return epsilon_; }
     Real sigma() const { return sigma_; }
+    Real energy_shift() const { return shift_; }
 
 private:
     Real epsilon_;      // Depth of potential well [J]
@@ -74,6 +95,20 @@ public:
     Real force_div_r(Real r2) const override;
     Real cutoff_squared() const override { return cutoff_sq_; }
     
+    /// Fused energy and F/r with a single sqrt (inline for pair kernels).
+    /// Same values as energy(r2) and force_div_r(r2).
+    void energy_and_force(Real r2, Real& e, Real& f_div_r) const {
+        if (!std::isfinite(r2) || r2 < 0.0 || r2 >= cutoff_sq_) {
+            e = 0.0;
+            f_div_r = 0.0;
+            return;
+        }
+        Real r = std::sqrt(r2);
+        Real dr = r - r0_;
+        e = 0.5 * k_ * dr * dr;
+        f_div_r = (r < 1e-30) ? 0.0 : -k_ * dr / r;
+    }
+    
     Real k() const { return k_; }
     Real r0() const { return r0_; }
 
@@ -83,6 +118,85 @@ private:
     Real cutoff_sq_;  // Cutoff radius squared [m^2]
 };
 
+/**
+ * Pair potential tabulated on a uniform grid in s = r², evaluated by a
+ * cubic Hermite spline in s: one multiply to find the interval, then two
+ * short polynomials; no sqrt or division per pair.
+ *
+ * Nodes carry U and dU/ds = -F/(2r), so U is C¹ and F/r = -2·dU/ds is the
+ * exact derivative of the interpolated energy (continuous, energy
+ * conserving). Interpolation error is O(h⁴) in U and O(h³) in F/r.
+ * Below r_min the first interval is extrapolated (choose r_min below the
+ * closest approach); at and beyond the cutoff both are 0.
+ *
+ * Built by sampling any Potential, or from node values (the table file
+ * loader, io/potential_table.hpp).
+ */
+class TabulatedPotential : public Potential {
+public:
+    static constexpr std::size_t kDefaultPoints = 2048;
+
+    /// Sample source at `points` nodes from r_min² to source.cutoff_squared().
+    TabulatedPotential(const Potential& source, Real r_min, std::size_t points = kDefaultPoints);
+
+    /// Node values at s_k = r_min² + k·(cutoff² - r_min²)/(n-1): energy [J]
+    /// and F/r [N/m], n = energy.size() = force_div_r.size() >= 2.
+    /// Throws std::invalid_argument on bad sizes or 0 < r_min < cutoff violated.
+    TabulatedPotential(Real r_min, Real cutoff, const std::vector<Real>& energy,
+                       const std::vector<Real>& force_div_r);
+
+    Real energy(Real r2) const override;
+    Real force_div_r(Real r2) const override;
+    Real cutoff_squared() const override { return cutoff_sq_; }
+
+    /// Fused energy and F/r (inline for pair kernels); same values as
+    /// energy(r2) and force_div_r(r2).
+    void energy_and_force(Real r2, Real& e, Real& f_div_r) const {
+        if (!(r2 < cutoff_sq_)) {  // also NaN
+            e = 0.0;
+            f_div_r = 0.0;
+            return;
+        }
+        const Real x = (r2 - s_min_) * inv_h_;
+        const std::size_t k = x > 0.0 ? std::min(static_cast<std::size_t>(x), last_) : 0;
+        const Real t = x - static_cast<Real>(k);
+        const Segment& c = table_[k];
+        e = c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+        f_div_r = c[4] + t * (c[5] + t * c[6]);
+    }
+
+    Real r_min() const { return std::sqrt(s_min_); }
+    std::size_t points() const { return table_.size() + 1; }
+
+    /// Raw spline for device copies (DeviceForceField): segments() blocks of
+    /// kSegmentStride Reals, c0..c6 as in energy_and_force, interval
+    /// k = (r² - s_min())·inv_h().
+    static constexpr std::size_t kSegmentStride = 8;
+    const Real* segment_data() const { return table_.front().c; }
+    std::size_t segments() const { return table_.size(); }
+    Real s_min() const { return s_min_; }
+    Real inv_h() const { return inv_h_; }
+
+private:
+    // U(t) = c0 + c1 t + c2 t² + c3 t³ and F/r(t) = c4 + c5 t + c6 t² on
+    // one interval (t in [0, 1)); padded to 8 Reals and aligned to that size
+    // (64 bytes in double), so a lookup never straddles two cache lines.
+    struct alignas(kSegmentStride * sizeof(Real)) Segment {
+        Real c[kSegmentStride];
+        Real& operator[](std::size_t i) { return c[i]; }
+        const Real& operator[](std::size_t i) const { return c[i]; }
+    };
+    static_assert(sizeof(Segment) == kSegmentStride * sizeof(Real), "segments must be contiguous");
+
+    std::vector<Segment> table_;
+    Real s_min_;
+    Real inv_h_;
+    Real cutoff_sq_;
+    std::size_t last_;  // table_.size() - 1
+
+    void build(const std::vector<Real>& energy, const std::vector<Real>& force_div_r);
+};
+
 /**
  * Force field calculator for pairwise interactions.
  * Computes forces and potential energy for all particle pairs.
@@ -100,6 +214,9 @@ public:
     /// Get the potential
     Potential* potential() const { return potential_.get(); }
     
+    /// Parallelize compute_forces over this pool (nullptr or size 1 = serial)
+    void set_thread_pool(std::shared_ptr<ThreadPool> pool) { pool_ = std::move(pool); }
+    
     /**
      * Calculate all pairwise forces and return total potential energy.
      * Applies minimum image convention for periodic boundaries.
@@ -107,8 +224,16 @@ public:
      * @param system Particle system
      * @param lattice Lattice for periodic boundaries (nullptr = non-periodic)
      * @return Total potential energy [J]
+     *
+     * The pair loop is specialized per potential type (see pair_kernel.hpp).
+     * With a thread pool, rows i are split into cost-balanced static ranges
+     * and forces are reduced via ThreadForceBuffers (deterministic for a
+     * fixed thread count). Not safe to call concurrently on one ForceField.
+     * with_energy = false skips the energy sum and returns 0.
+     * sampler (observables.hpp) records the pair observables of this pass.
      */
-    Real compute_forces(ParticleSystem& system, const Lattice* lattice = nullptr) const;
+    Real compute_forces(ParticleSystem& system, const Lattice* lattice = nullptr,
+                        bool with_energy = true, PairSampler* sampler = nullptr) const;
     
     /**
      * Calculate potential energy only (no forces).
@@ -118,9 +243,11 @@ public:
 
 private:
     std::shared_ptr<Potential> potential_;
+    std::shared_ptr<ThreadPool> pool_;
+    mutable ThreadForceBuffers buffers_;
     
     /// Squared distance between particles with optional PBC
-    static Real distance_squared(const Particle& p1, const Particle& p2,
+    static Real distance_squared(const ParticleSystem& system, std::size_t i, std::size_t j,
                                   const Lattice* lattice,
                                   Real dx[3]); // Output: displacement vector
 };
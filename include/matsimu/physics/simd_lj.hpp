@@ -0,0 +1,64 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/core/precision.hpp>
+#include <matsimu/physics/particle.hpp>
+#include <matsimu/physics/potential.hpp>
+#include <matsimu/physics/neighbor_list.hpp>
+#include <matsimu/lattice/lattice.hpp>
+#include <matsimu/parallel/simd_level.hpp>
+#include <cstddef>
+#include <cstdint>
+
+namespace matsimu {
+
+/**
+ * Explicitly vectorized Lennard-Jones kernel over CSR neighbor rows.
+ *
+ * Neighbor positions are gathered 4 (AVX2) or 8 (AVX-512) at a time; the
+ * minimum image is taken per axis (orthorhombic boxes or open boundaries),
+ * and energy/F/r are masked to the cutoff in vector registers. Callers pick
+ * the level with detect_simd_level() and serve Scalar with the generic
+ * pair kernel.
+ */
+
+/// Box for the vector kernel: per-axis lengths, or open boundaries.
+struct SimdBox {
+    bool periodic{false};
+    Real length[3]{0.0, 0.0, 0.0};
+    Real inv_length[3]{0.0, 0.0, 0.0};
+};
+
+/**
+ * Fill box from lattice; false when the vector kernel cannot handle it
+ * (non-orthorhombic basis). nullptr lattice = open boundaries.
+ */
+bool make_simd_box(const Lattice* lattice, SimdBox& box);
+
+/**
+ * LJ forces for neighbor rows [begin, end) accumulated into f (Newton 3);
+ * returns their energy (0 if !with_energy). Same contract as
+ * accumulate_pair_rows with the LennardJones kernel, up to floating-point
+ * summation order.
+ * level must not exceed detect_simd_level(); Scalar is not accepted.
+ * Precision::Single evaluates the LJ terms in float on 8 (AVX2) or 16
+ * (AVX-512) lanes; displacements and sums stay double (see precision.hpp).
+ */
+Real lj_neighbor_rows_simd(SimdLevel level, const LennardJones& lj, const NeighborList& nlist,
+                           const ParticleSystem& system, const SimdBox& box,
+                           std::size_t begin, std::size_t end, Real* const f[3],
+                           bool with_energy = true, Precision precision = Precision::Double);
+
+/**
+ * One shell (Inner or Outer) of the LJ potential under sw, as
+ * ShellPairKernel evaluates it, for CSR rows [begin, end) of (offsets,
+ * indices), which may be a shorter list than nlist (r-RESPA inner shell).
+ * Same contract as lj_neighbor_rows_simd otherwise; always in double.
+ */
+Real lj_shell_rows_simd(SimdLevel level, const LennardJones& lj, ForceShell shell,
+                        const ShellSwitch& sw, const std::size_t* offsets,
+                        const std::uint32_t* indices, const ParticleSystem& system,
+                        const SimdBox& box, std::size_t begin, std::size_t end, Real* const f[3],
+                        bool with_energy = true);
+
+}  // namespace matsimu
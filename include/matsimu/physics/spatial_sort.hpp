@@ -0,0 +1,33 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/alloc/arena.hpp>
+#include <matsimu/lattice/lattice.hpp>
+#include <matsimu/physics/particle.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace matsimu {
+
+/// Cells per axis of the Morton grid (10 bits per axis, 30-bit keys).
+constexpr std::uint32_t kMortonCells = 1u << 10;
+
+/// Interleave the low 10 bits of x, y, z into a 30-bit Z-order key.
+std::uint32_t morton_key(std::uint32_t x, std::uint32_t y, std::uint32_t z);
+
+/**
+ * Z-order permutation of the particles: order[i] is the slot that should
+ * move to slot i. Positions are binned in fractional coordinates of lattice
+ * (wrapped into the cell), or in their bounding box without a lattice; ties
+ * keep storage order, so the result is deterministic.
+ */
+void morton_order(const ParticleSystem& system, const Lattice* lattice,
+                  std::vector<std::uint32_t>& order);
+
+/// Reorder system along the Morton curve (ParticleSystem::reorder keeps ids).
+/// Keys and permutation scratch come from scratch when given (reserved to
+/// fit, released on return); otherwise from the heap.
+void sort_particles_morton(ParticleSystem& system, const Lattice* lattice,
+                           Arena* scratch = nullptr);
+
+}  // namespace matsimu
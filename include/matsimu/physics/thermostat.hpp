@@ -2,10 +2,16 @@
 
 #include <matsimu/core/types.hpp>
 #include <matsimu/physics/particle.hpp>
+#include <cstdint>
 #include <cmath>
+#include <memory>
+#include <optional>
+#include <string>
 
 namespace matsimu {
 
+class ThreadPool;
+
 /**
  * Thermostat for temperature control in molecular dynamics.
  * 
@@ -18,11 +24,42 @@ public:
     /// Apply thermostat to particle system
     virtual void apply(ParticleSystem& system, Real dt) = 0;
     
+    /// Apply to one rank's share of a distributed system (DistributedSimulation);
+    /// global_temperature [K] is that of all ranks together. Default: apply().
+    virtual void apply_distributed(ParticleSystem& system, Real dt, Real global_temperature) {
+        (void)global_temperature;
+        apply(system, dt);
+    }
+    
+    /// The factor apply() would multiply every velocity by at temperature
+    /// [K], for callers that keep velocities elsewhere (DeviceSimulation scales
+    /// them on the device). std::nullopt: apply() is not a uniform rescale.
+    virtual std::optional<Real> uniform_scale(Real dt, Real temperature) const {
+        (void)dt;
+        (void)temperature;
+        return std::nullopt;
+    }
+    
     /// Get target temperature [K]
     virtual Real target_temperature() const = 0;
     
     /// Set target temperature [K]
     virtual void set_target_temperature(Real T) = 0;
+    
+    /// Internal state for checkpoint/restart (e.g. RNG); empty when stateless.
+    virtual std::string save_state() const { return {}; }
+    
+    /// Restore a save_state() string; false if it does not parse.
+    virtual bool load_state(const std::string& state) { return state.empty(); }
+    
+    /// Pool for thermostats that can split apply() (set by Simulation).
+    virtual void set_thread_pool(std::shared_ptr<ThreadPool>) {}
+};
+
+/// Random number source of AndersenThermostat.
+enum class ThermostatRng {
+    Sequential,  ///< One mt19937 walked over the particles in storage order
+    Counter      ///< Philox keyed on (seed, apply count, particle id): parallel, order independent
 };
 
 /**
@@ -44,6 +81,12 @@ public:
     
     void apply(ParticleSystem& system, Real dt) override;
     
+    /// Scales by the global temperature, so every rank uses the same factor.
+    void apply_distributed(ParticleSystem& system, Real dt, Real global_temperature) override;
+    
+    /// Berendsen factor sqrt(1 + dt/tau (T_target/T - 1)); 1 when it does not apply.
+    std::optional<Real> uniform_scale(Real dt, Real temperature) const override;
+    
     Real target_temperature() const override { return target_T_; }
     void set_target_temperature(Real T) override { target_T_ = T; }
     
@@ -53,6 +96,8 @@ public:
 private:
     Real target_T_;
     Real tau_;
+    
+    void rescale(ParticleSystem& system, Real dt, Real current_T) const;
 };
 
 /**
@@ -70,8 +115,12 @@ public:
      * @param target_T Target temperature [K]
      * @param nu Collision frequency [1/s]
      * @param seed Random seed (0 = use random device)
+     * @param rng Counter: per-particle draws from CounterRng, so apply() runs
+     *        on the thread pool and the result does not depend on the thread
+     *        count or on the particle storage order
      */
-    AndersenThermostat(Real target_T, Real nu, unsigned seed = 0);
+    AndersenThermostat(Real target_T, Real nu, unsigned seed = 0,
+                       ThermostatRng rng = ThermostatRng::Sequential);
     ~AndersenThermostat() override;
     
     void apply(ParticleSystem& system, Real dt) override;
@@ -81,16 +130,37 @@ public:
     
     Real collision_frequency() const { return nu_; }
     void set_collision_frequency(Real nu) { nu_ = nu; }
+    
+    ThermostatRng rng() const { return rng_; }
+    
+    /// Sequential: mt19937 and normal-distribution state (the standard text
+    /// form). Counter: "philox <seed> <apply count>".
+    std::string save_state() const override;
+    bool load_state(const std::string& state) override;
+    
+    void set_thread_pool(std::shared_ptr<ThreadPool> pool) override { pool_ = std::move(pool); }
 
 private:
     Real target_T_;
     Real nu_;
     unsigned seed_;
+    ThermostatRng rng_;
+    std::uint64_t calls_{0};  // apply() count, the Counter step
+    std::shared_ptr<ThreadPool> pool_;
     
     class Impl;
     std::unique_ptr<Impl> impl_;
 };
 
+/**
+ * Maxwell–Boltzmann velocities at temperature T for every particle, drawn
+ * from CounterRng(seed, kStreamVelocities) by particle id (each particle's
+ * own mass). Parallel over pool and bit-identical for any thread count.
+ * Overwrites the velocities; the centre-of-mass drift is left to the caller.
+ */
+void assign_maxwell_velocities(ParticleSystem& system, Real T, std::uint64_t seed,
+                               ThreadPool* pool = nullptr);
+
 /**
  * No-op thermostat (NVE ensemble - constant energy).
  */
@@ -99,6 +169,7 @@ public:
     NullThermostat() = default;
     
     void apply(ParticleSystem&, Real) override { /* do nothing */ }
+    std::optional<Real> uniform_scale(Real, Real) const override { return 1.0; }
     
     Real target_temperature() const override { return 0.0; }
     void set_target_temperature(Real) override { /* ignore */ }
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/lattice/lattice.hpp>
+#include <matsimu/parallel/device.hpp>
+#include <matsimu/physics/device_force_field.hpp>
+#include <matsimu/physics/particle.hpp>
+#include <matsimu/physics/potential.hpp>
+#include <matsimu/physics/thermostat.hpp>
+#include <matsimu/sim/simulation.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace matsimu {
+
+/**
+ * Molecular dynamics with the particle state resident on the offload device
+ * (parallel/device.hpp): positions, velocities, forces and masses are
+ * uploaded once and stay there across step() calls. Each step runs the
+ * Velocity Verlet kick-drift, the DeviceForceField pass and the second kick
+ * (which also reduces kinetic energy, momentum and the non-finite check) as
+ * device kernels; only scalars come back.
+ *
+ * The host copy is a snapshot: system() downloads the arrays on its first
+ * call after a step (at most once per step), so a trajectory writer or the
+ * 3D view that reads every n-th step transfers every n-th step. Host writes
+ * are found by the system's position and velocity versions (non-const
+ * pos(d) / vel(d), set_masses, append, ...) and uploaded on the next step;
+ * other calls through the non-const system() cost nothing.
+ *
+ * Thermostats with a uniform_scale() (velocity rescaling, none) scale on the
+ * device; others (Andersen) round-trip the velocities through the host on
+ * every apply.
+ *
+ * Uses params dt, end_time, max_steps, neighbor_skin, energy_interval and
+ * max_bytes; the cutoff is the potential's. Needs an orthorhombic lattice
+ * at least 2·(cutoff + skin) wide and a potential DeviceForceField
+ * supports. Not available here: r-RESPA, skin auto-tuning, Morton sorting,
+ * observables, mixed precision (kernels run in Real).
+ */
+class DeviceSimulation {
+public:
+    DeviceSimulation(const SimulationParams& params, std::shared_ptr<Potential> potential);
+
+    bool is_valid() const { return valid_; }
+    const std::string& error_message() const { return error_msg_; }
+
+    /// Periodic cell (see class comment for the constraints)
+    void set_lattice(const Lattice& lattice);
+    const Lattice& lattice() const { return lattice_; }
+
+    /// Replace the potential (one DeviceForceField supports); the next step
+    /// re-initializes.
+    void set_potential(std::shared_ptr<Potential> potential);
+    Potential* potential() const { return force_field_ ? force_field_->potential() : nullptr; }
+
+    /// Host snapshot of the particles (downloaded on the first call after a
+    /// step). Writes that change its position or velocity version reach the
+    /// device on the next step().
+    ParticleSystem& system();
+    const ParticleSystem& system() const;
+
+    void set_thermostat(std::shared_ptr<Thermostat> therm) { thermostat_ = std::move(therm); }
+    Thermostat* thermostat() const { return thermostat_.get(); }
+
+    /// Zero the centre-of-mass velocity, upload the system and compute
+    /// forces and energies; step() calls it first if needed.
+    void initialize();
+
+    /// Advance one step; false when the run ends or fails.
+    bool step();
+
+    /// Step until finished
+    void run();
+
+    bool finished() const;
+    Real time() const { return time_; }
+    std::size_t step_count() const { return step_count_; }
+    const SimulationParams& params() const { return params_; }
+    /// Set time and step count after a checkpoint restore; drops the cached energy.
+    void restore_clock(Real time, std::size_t step_count);
+
+    /// As of the last step (or initialize()); reduced on the device.
+    const KineticMoments& kinetic_moments() const { return kinetic_; }
+    Real kinetic_energy() const { return kinetic_.kinetic_energy; }
+    Real temperature() const { return kinetic_.temperature; }
+    /// Summed on energy_interval steps; otherwise one extra force pass.
+    Real potential_energy();
+    Real total_energy() { return kinetic_energy() + potential_energy(); }
+
+    /// Neighbor list builds, host snapshots (full downloads) and uploads so far
+    std::size_t neighbor_rebuilds() const { return force_field_ ? force_field_->rebuilds() : 0; }
+    std::size_t snapshots() const { return snapshots_; }
+    std::size_t uploads() const { return uploads_; }
+
+private:
+    SimulationParams params_;
+    std::unique_ptr<DeviceForceField> force_field_;
+    Lattice lattice_;
+    mutable ParticleSystem system_;
+    std::shared_ptr<Thermostat> thermostat_;
+
+    DeviceMirror<Real> pos_[3];
+    DeviceMirror<Real> vel_[3];
+    DeviceMirror<Real> force_[3];
+    DeviceMirror<const Real> inv_mass_;
+    DeviceMirror<const Real> mass_;
+
+    bool params_ok_{false};
+    bool has_lattice_{false};
+    bool valid_{false};
+    bool initialized_{false};
+    mutable std::uint64_t synced_pos_version_{0};  // system_ versions when host and device last agreed
+    mutable std::uint64_t synced_vel_version_{0};
+    mutable bool host_stale_{false};    // device ahead of system_
+    mutable std::size_t snapshots_{0};
+    std::size_t uploads_{0};
+    std::string error_msg_;
+    Real time_{0};
+    std::size_t step_count_{0};
+    Real epot_{0};
+    bool epot_valid_{false};
+    KineticMoments kinetic_;
+
+    void configure();                    // check lattice against the force field; sets valid_
+    void release_mirrors();              // unmap every particle array
+    void upload();                       // map system_, compute forces and moments
+    void download() const;               // refresh system_ (snapshot)
+    void mark_synced() const;            // system_ matches the device as of now
+    bool host_changed() const;           // system_ written since mark_synced()
+    DeviceParticleArrays arrays() const;
+    void kick_drift();                   // first half kick, drift, wrap into the box
+    /// v += half_dt·f/m (0: velocities unchanged), then reduce kinetic_;
+    /// false if any position, velocity or force is non-finite or a mass is not positive.
+    bool kick(Real half_dt);
+    void scale_velocities(Real lambda);
+    void apply_thermostat();
+};
+
+}  // namespace matsimu
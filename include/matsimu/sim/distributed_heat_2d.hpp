@@ -0,0 +1,105 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/parallel/communicator.hpp>
+#include <matsimu/parallel/simd_level.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
+#include <matsimu/sim/heat_diffusion_2d.hpp>
+#include <matsimu/sim/model.hpp>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace matsimu {
+
+/**
+ * HeatDiffusion2DModel with the grid partitioned over the ranks of a
+ * Communicator (MPI processes, or LocalCommunicator threads as tile
+ * workers), so the field can outgrow one node's memory.
+ *
+ * The (nx-2)×(ny-2) interior is cut into a px × py grid of tiles, the
+ * factorization of the rank count with the least halo per tile; rank r
+ * holds tile (r mod px, r / px). Each rank stores only its tile inside a
+ * one-cell ghost frame. Frame cells on the physical edge hold T_boundary;
+ * the others mirror the neighbor tiles' edge rows and columns.
+ *
+ * Per step the halo exchange overlaps the bulk of the work: post the edge
+ * rows/columns (isend/irecv), update the tile cells that do not touch the
+ * frame, wait for the halo, then update the one-cell rim. The arithmetic
+ * is heat_step_2d's, so the field matches HeatDiffusion2DModel bit for bit
+ * for any rank count, thread count and SimdLevel.
+ *
+ * Explicit scheme, double precision. Every rank constructs the model with
+ * the same params; step(), advance() and gather() are collective.
+ * num_threads, huge_pages, first_touch and max_bytes apply per rank.
+ */
+class DistributedHeat2DModel : public ISimModel {
+public:
+    using HeatAllocator = HeatDiffusion2DModel::HeatAllocator;
+
+    /// This rank's tile: global cells [i0, i0 + nx) × [j0, j0 + ny)
+    struct Tile {
+        std::size_t i0{0}, j0{0};
+        std::size_t nx{0}, ny{0};
+    };
+
+    DistributedHeat2DModel(const HeatDiffusion2DParams& params, std::shared_ptr<Communicator> comm,
+                           std::size_t max_bytes = 512 * 1024 * 1024);
+
+    bool step() override;
+    bool finished() const override;
+    Real time() const override { return time_; }
+    std::size_t step_count() const override { return step_count_; }
+    const std::string& error_message() const override { return error_msg_; }
+    bool is_valid() const override { return valid_; }
+    /// This rank's padded tile (ghost frame included).
+    std::vector<StateBuffer> state_buffers() override;
+    void restore_clock(Real time, std::size_t step_count) override;
+
+    /// Rank grid (px, py) and this rank's position in it
+    const std::array<int, 2>& grid() const { return grid_; }
+    const std::array<int, 2>& coords() const { return coords_; }
+    const Tile& tile() const { return tile_; }
+
+    /// Padded tile, row-major with pitch() = tile().nx + 2: tile cell (i, j)
+    /// is at (j + 1)·pitch() + i + 1.
+    const std::vector<Real, HeatAllocator>& temperature() const { return T_; }
+    std::size_t pitch() const { return tile_.nx + 2; }
+
+    /// The full nx×ny field on root (layout of HeatDiffusion2DModel::temperature());
+    /// other ranks get an empty out. Collective.
+    void gather(std::vector<Real>& out, int root = 0);
+
+    Communicator& communicator() const { return *comm_; }
+
+    /// Cap the vectorized row kernel (default: detect_simd_level())
+    void set_simd_level(SimdLevel level) { simd_level_ = std::min(level, detect_simd_level()); }
+
+private:
+    HeatDiffusion2DParams params_;
+    std::shared_ptr<Communicator> comm_;
+    std::shared_ptr<ThreadPool> pool_;  // null when num_threads == 1
+    std::shared_ptr<const MemoryPlacement> placement_;
+    std::array<int, 2> grid_{{1, 1}};
+    std::array<int, 2> coords_{{0, 0}};
+    Tile tile_;
+    std::array<int, 4> neighbor_{{-1, -1, -1, -1}};  // west, east, south, north; -1 = edge
+    std::array<std::vector<Real>, 4> send_;         // halo buffers per direction
+    std::array<std::vector<Real>, 4> recv_;
+    std::vector<Real, HeatAllocator> T_;
+    std::vector<Real, HeatAllocator> T_next_;
+    SimdLevel simd_level_{detect_simd_level()};
+    Real time_{0};
+    std::size_t step_count_{0};
+    std::string error_msg_;
+    bool valid_{false};
+
+    void decompose();
+    void initialize();
+    void post_halo();    // pack edges, isend / irecv
+    void unpack_halo();  // after wait_all: received edges into the frame
+};
+
+}  // namespace matsimu
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/parallel/communicator.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
+#include <matsimu/physics/force_buffers.hpp>
+#include <matsimu/physics/integrator.hpp>
+#include <matsimu/physics/neighbor_list.hpp>
+#include <matsimu/physics/particle.hpp>
+#include <matsimu/physics/particle_builder.hpp>
+#include <matsimu/physics/potential.hpp>
+#include <matsimu/physics/thermostat.hpp>
+#include <matsimu/sim/domain_decomposition.hpp>
+#include <matsimu/sim/simulation.hpp>
+#include <memory>
+#include <string>
+
+namespace matsimu {
+
+/**
+ * Molecular dynamics spread over the ranks of a Communicator (one MPI
+ * process per node or socket, or LocalCommunicator threads).
+ *
+ * Every rank constructs one DistributedSimulation with the same parameters,
+ * lattice and global particle set, and then calls the collective members
+ * (scatter, initialize, step, potential_energy, gather) in the same order.
+ * scatter() needs the whole system on every rank, which caps a run at what
+ * one rank's memory (max_bytes) holds; scatter_crystal() builds a crystal
+ * rank by rank instead, each rank generating only its own sites. Particle
+ * ids are 32-bit, so a run holds at most 2^32 particles either way.
+ * The cell is split by DomainDecomposition: each rank integrates only the
+ * particles it owns (Velocity Verlet) and sees the rest through ghost
+ * copies within cutoff + skin, refreshed every step.
+ *
+ * Per step: drift; ghost position update; a global rebuild vote (any rank's
+ * particle moved more than skin/2), which migrates particles to their new
+ * owners and rebuilds ghosts and the neighbor list in open-box coordinates;
+ * forces from owned–owned pairs (Newton 3) and owned–ghost pairs (own side
+ * only, half the energy each, so the global sum counts every pair once);
+ * kick; thermostat; one reduction of kinetic moments, pair energy and the
+ * health flag (the particle count is summed once, in initialize()). Thermostats see the global temperature
+ * (Thermostat::apply_distributed); each rank needs its own instance, and
+ * AndersenThermostat with ThermostatRng::Counter draws by particle id, so
+ * it matches a single-process run. ParticleSystem::id() is the index in the
+ * scattered global system.
+ *
+ * Uses params dt, end_time, max_steps, cutoff, neighbor_skin,
+ * neighbor_build, num_threads (per rank), energy_interval and max_bytes (per
+ * rank). Not available here: r-RESPA (respa_steps must be 1), skin
+ * auto-tuning, Morton sorting and the SIMD LJ kernel (the scalar kernels of
+ * dispatch_pair_kernel run); the non-finite check runs every step.
+ */
+class DistributedSimulation {
+public:
+    DistributedSimulation(const SimulationParams& params, std::shared_ptr<Potential> potential,
+                          std::shared_ptr<Communicator> comm);
+
+    bool is_valid() const { return valid_; }
+    const std::string& error_message() const { return error_msg_; }
+
+    /// Periodic cell; decomposes it over the ranks (call before scatter()).
+    void set_lattice(const Lattice& lattice);
+    const Lattice& lattice() const { return domain_.lattice(); }
+    const DomainDecomposition& domain() const { return domain_; }
+
+    /// Keep the particles of global inside this rank's subdomain, with
+    /// id = index in global. Every rank passes the same system.
+    void scatter(const ParticleSystem& global);
+
+    /// Like scatter() of the system fill_crystal(cell, spec) builds (at
+    /// rest), without building it: each rank generates only the sites it
+    /// owns. The supercell must be lattice() (set_lattice() first).
+    /// Velocities can follow by id, e.g. assign_maxwell_velocities(system(), ...).
+    /// Fails (is_valid() false) when lattice() is not supercell(cell, spec)
+    /// or past 2^32 sites; throws std::bad_alloc past max_bytes.
+    void scatter_crystal(const Lattice& cell, const CrystalSpec& spec);
+
+    /// Zero the global centre-of-mass velocity, build ghosts and neighbor
+    /// list, compute forces and energies. Collective; step() calls it first
+    /// if needed.
+    void initialize();
+
+    /// Advance one step. Collective; false when the run ends or fails (on
+    /// every rank alike).
+    bool step();
+
+    /// Step until finished
+    void run();
+
+    bool finished() const;
+    Real time() const { return time_; }
+    std::size_t step_count() const { return step_count_; }
+    const SimulationParams& params() const { return params_; }
+
+    /// This rank's particles (ids are global)
+    ParticleSystem& system() { return system_; }
+    const ParticleSystem& system() const { return system_; }
+
+    Communicator& communicator() const { return *comm_; }
+
+    /// Thermostat instance of this rank (see class comment)
+    void set_thermostat(std::shared_ptr<Thermostat> therm) {
+        thermostat_ = std::move(therm);
+        if (thermostat_) thermostat_->set_thread_pool(thread_pool_);
+    }
+    Thermostat* thermostat() const { return thermostat_.get(); }
+
+    // Global observables as of the last step (or initialize())
+    std::size_t global_count() const { return global_count_; }
+    const KineticMoments& kinetic_moments() const { return global_kinetic_; }
+    Real kinetic_energy() const { return global_kinetic_.kinetic_energy; }
+    Real temperature() const { return global_kinetic_.temperature; }
+    /// Summed on energy_interval steps; otherwise evaluated on demand, which
+    /// makes this call collective.
+    Real potential_energy();
+    Real total_energy() { return kinetic_energy() + potential_energy(); }
+
+    /// Every particle on root, in id order (positions, velocities, masses);
+    /// other ranks get an empty out. Collective.
+    void gather(ParticleSystem& out, int root = 0);
+
+    /// Ghosts held by this rank and neighbor rebuilds so far
+    std::size_t ghost_count() const { return domain_.ghost_count(); }
+    std::size_t neighbor_rebuilds() const { return rebuilds_; }
+
+private:
+    SimulationParams params_;
+    std::shared_ptr<Potential> potential_;
+    std::shared_ptr<Communicator> comm_;
+    std::shared_ptr<ThreadPool> thread_pool_;
+    ParticleSystem system_;  // owned particles
+    ParticleSystem local_;   // owned positions, then ghosts (force evaluation)
+    DomainDecomposition domain_;
+    NeighborList nlist_;
+    ThreadForceBuffers buffers_;
+    VelocityVerlet integrator_;
+    std::shared_ptr<Thermostat> thermostat_;
+
+    bool valid_{false};
+    bool initialized_{false};
+    std::string error_msg_;
+    Real time_{0};
+    std::size_t step_count_{0};
+    std::size_t rebuilds_{0};
+
+    Real local_epot_{0};          // this rank's share of the pair energy
+    bool local_epot_valid_{false};
+    Real global_epot_{0};
+    bool epot_valid_{false};
+    KineticMoments global_kinetic_;
+    std::size_t global_count_{0};
+
+    void rebuild();
+    void refresh_ghosts();        // update, vote, rebuild if any rank needs it
+    void compute_forces(bool with_energy);
+    void reduce_kinetic();        // global_kinetic_ only
+    bool reduce_step(bool healthy);  // + energy and health; false if any rank failed
+};
+
+}  // namespace matsimu
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/lattice/lattice.hpp>
+#include <matsimu/parallel/communicator.hpp>
+#include <matsimu/physics/particle.hpp>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace matsimu {
+
+/**
+ * Spatial domain decomposition of a periodic cell over the ranks of a
+ * Communicator (DistributedSimulation).
+ *
+ * The cell is cut into a p0 × p1 × p2 grid of subdomains in fractional
+ * coordinates, so triclinic cells work as in the neighbor-list binning; rank
+ * r holds grid cell (r mod p0, r / p0 mod p1, r / (p0·p1)). The grid is the
+ * factorization of the rank count with the least halo surface (Σ p_d / h_d,
+ * h_d the cell's perpendicular width along a_d) among those whose
+ * subdomains are at least one halo wide.
+ *
+ * Each rank owns the particles inside its subdomain and keeps ghost copies
+ * of every particle within `halo` (cutoff + skin) of it. Ghosts are found in
+ * six staged swaps (-x, +x, -y, +y, -z, +z), each forwarding the particles
+ * received by the earlier axes, so edge and corner neighbors need no
+ * messages of their own; crossing the periodic boundary adds ∓a_d to the
+ * copy. A grid dimension of 1 swaps with the rank itself and so produces
+ * the periodic images.
+ *
+ * All members that take a Communicator are collective.
+ */
+class DomainDecomposition {
+public:
+    DomainDecomposition() = default;
+
+    /// Decompose lattice for comm's ranks with ghost shell width halo [m].
+    DomainDecomposition(const Lattice& lattice, Real halo, const Communicator& comm);
+
+    /// False when the cell is degenerate or too small for the rank count
+    /// (no grid with subdomains >= halo wide); see error_message().
+    bool is_valid() const { return error_.empty(); }
+    const std::string& error_message() const { return error_; }
+
+    const std::array<int, 3>& grid() const { return grid_; }
+    const std::array<int, 3>& coords() const { return coords_; }
+    Real halo() const { return halo_; }
+    const Lattice& lattice() const { return lattice_; }
+
+    /// Rank owning a Cartesian position (taken modulo the cell)
+    int owner_of(const Real pos[3]) const;
+
+    /**
+     * Wrap owned positions into the cell and hand particles that left this
+     * subdomain to their new owners (velocity, mass and id travel along;
+     * forces do not). Particles must not have crossed more than one
+     * subdomain per axis since the last call, which the skin/2 rebuild
+     * criterion guarantees. Storage order of the remaining particles is kept.
+     */
+    void migrate(ParticleSystem& owned, Communicator& comm);
+
+    /**
+     * local = owned positions followed by ghosts; records the swap pattern
+     * for update_ghosts(). Local masses and velocities are not maintained.
+     */
+    void build_ghosts(const ParticleSystem& owned, ParticleSystem& local, Communicator& comm);
+
+    /// Copy owned positions into local and refresh the ghosts along the
+    /// pattern of the last build_ghosts() (no change in ghost count).
+    void update_ghosts(const ParticleSystem& owned, ParticleSystem& local, Communicator& comm);
+
+    /// Ghosts created by the last build_ghosts()
+    std::size_t ghost_count() const { return ghost_count_; }
+
+private:
+    /// One of the six staged ghost swaps
+    struct Swap {
+        int dest{0};                       // rank receiving our copies
+        int src{0};                        // rank whose copies we receive
+        Real shift[3]{0, 0, 0};            // added to every position sent [m]
+        std::vector<std::uint32_t> send;   // local indices sent
+        std::size_t recv_begin{0};         // first local slot received into
+        std::size_t recv_count{0};
+    };
+
+    Lattice lattice_;
+    Real halo_{0};
+    std::array<int, 3> grid_{{1, 1, 1}};
+    std::array<int, 3> coords_{{0, 0, 0}};
+    std::array<int, 3> lower_{{0, 0, 0}};  // rank below / above along each axis
+    std::array<int, 3> upper_{{0, 0, 0}};
+    Real halo_frac_[3]{0, 0, 0};           // halo in fractional units per axis
+    std::array<Swap, 6> swaps_;
+    std::size_t ghost_count_{0};
+    std::string error_;
+    std::vector<Real> send_buf_;
+    std::vector<Real> recv_buf_;
+
+    int rank_at(int c0, int c1, int c2) const;
+    int grid_coord(Real s, int d) const;   // subdomain index of fractional coordinate s
+};
+
+}  // namespace matsimu
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/sim/simulation.hpp>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace matsimu {
+
+/// Start configuration shared by replicas (load_particles, io/checkpoint.hpp):
+/// periodic box plus positions, velocities and masses. Loaded once, copied
+/// into each replica's own system.
+struct ParticleSource {
+    Lattice lattice;
+    ParticleSystem particles;
+};
+
+/// Thermostat attached to each replica.
+enum class ReplicaThermostat { None, Rescale, Andersen };
+
+/**
+ * Particle system built for every replica: an fcc LJ crystal of 4·cells³
+ * atoms with Maxwell–Boltzmann velocities at params.temperature
+ * (assign_maxwell_velocities; Andersen uses ThermostatRng::Counter, so a
+ * replica's trajectory does not depend on params.num_threads).
+ * Defaults are argon.
+ *
+ * With `source` set, its box and particles replace the crystal (cells,
+ * spacing and mass unused); the file's velocities are kept unless they are
+ * all zero, in which case they are drawn as for the crystal. With
+ * `potential` set it replaces LJ(epsilon, sigma); potentials are stateless
+ * in evaluation, so concurrent replicas may share one.
+ */
+struct ReplicaSystem {
+    std::size_t cells{5};               ///< Cubic unit cells per box edge
+    Real spacing{5.26e-10};             ///< fcc lattice constant [m]
+    Real mass{6.63e-26};                ///< Atom mass [kg]
+    Real epsilon{1.654e-21};            ///< LJ well depth [J]
+    Real sigma{3.405e-10};              ///< LJ length [m]; cutoff comes from params
+    ReplicaThermostat thermostat{ReplicaThermostat::None};
+    Real thermostat_tau{1e-13};         ///< Rescale τ [s]; Andersen collision rate 1/τ
+    std::shared_ptr<const ParticleSource> source;  ///< Preloaded particles (null = crystal)
+    std::shared_ptr<Potential> potential;          ///< Pair potential (null = LJ)
+
+    /// Returns error message if invalid, std::nullopt otherwise.
+    std::optional<std::string> validate() const;
+};
+
+/// One independent run of an ensemble.
+struct ReplicaSpec {
+    std::size_t index{0};
+    SimulationParams params;
+    ReplicaSystem system;
+    unsigned seed{1};                   ///< Velocity and Andersen RNG seed
+    std::vector<std::string> tags;      ///< Sweep values of this replica (for reports)
+};
+
+/// Final state of one replica. ok = false keeps the reason in error.
+struct ReplicaResult {
+    std::size_t index{0};
+    bool ok{false};
+    std::string error;
+    std::size_t atoms{0};
+    std::size_t steps{0};
+    Real time{0};                       ///< Simulated time [s]
+    Real kinetic_energy{0};             ///< [J]
+    Real potential_energy{0};           ///< [J]
+    Real total_energy{0};               ///< [J]
+    Real temperature{0};                ///< [K]
+    double wall_seconds{0};
+};
+
+/**
+ * Options for run_ensemble.
+ *
+ * threads:   replicas run concurrently (each replica still uses its own
+ *            params.num_threads for forces)
+ * max_bytes: total particle memory cap; every concurrently running replica
+ *            gets its own bounded_allocator budget of max_bytes / threads
+ *            (or params.max_bytes if smaller)
+ */
+struct EnsembleOptions {
+    std::size_t threads{1};
+    std::size_t max_bytes{4ull * 1024 * 1024 * 1024};
+};
+
+/// Build spec.system into sim (lattice, particles, potential, thermostat).
+/// Throws std::bad_alloc when the particles exceed sim's max_bytes budget.
+void build_replica(Simulation& sim, const ReplicaSpec& spec);
+
+/// Build and run one replica to completion within a byte budget.
+ReplicaResult run_replica(const ReplicaSpec& spec, std::size_t max_bytes);
+
+/**
+ * Run all replicas and return their results in spec order.
+ *
+ * Workers claim the next unstarted replica from a shared atomic counter,
+ * so long and short runs balance dynamically; results do not depend on
+ * which worker ran which replica. Failures (invalid params, budget
+ * exceeded, non-finite state) are reported per replica.
+ */
+std::vector<ReplicaResult> run_ensemble(const std::vector<ReplicaSpec>& specs,
+                                        const EnsembleOptions& options = {});
+
+}  // namespace matsimu
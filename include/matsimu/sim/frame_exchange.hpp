@@ -0,0 +1,83 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/physics/particle.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace matsimu {
+
+class Simulation;
+
+/**
+ * Immutable render snapshot of a Simulation, as seen by View3D.
+ *
+ * Particles: positions and velocities (SoA, SI).
+ * Field2D:   row-major temperature field (nx*ny) with fixed colormap bounds.
+ * Empty:     nothing to draw (e.g. 1D/3D heat, or before the first frame).
+ */
+struct SimFrame {
+    enum class Kind { Empty, Particles, Field2D };
+
+    Kind kind{Kind::Empty};
+    std::size_t step{0};
+    Real time{0};
+
+    std::vector<Real> pos[3];
+    std::vector<Real> vel[3];
+
+    std::vector<Real> field;
+    std::size_t nx{0};
+    std::size_t ny{0};
+    Real T_cold{0};
+    Real T_hot{1};
+
+    std::size_t particle_count() const { return pos[0].size(); }
+};
+
+/// Fill frame from sim (MD: particles; HeatDiffusion2D: field). Reuses the
+/// frame's vector capacity, so a recycled frame costs one copy, no allocation.
+void capture_frame(const Simulation& sim, SimFrame& frame);
+/// Fill frame with the particles of ps (e.g. a freshly built system).
+void capture_frame(const ParticleSystem& ps, SimFrame& frame);
+
+/**
+ * Triple-buffered hand-off of SimFrames from the simulation to the renderer.
+ *
+ * Producer: SimFrame& f = begin_write(); capture_frame(sim, f); publish();
+ * Reader:   std::shared_ptr<const SimFrame> f = latest();  (hold while drawing)
+ *
+ * begin_write() returns a pooled frame that is neither the published one nor
+ * held by any reader, so filling it never races a draw and the reader never
+ * copies. With one frame published and one being drawn, the third buffer is
+ * always free; only a reader holding several old frames makes the pool grow
+ * (see buffers()). One producer; any number of reader threads.
+ */
+class FrameExchange {
+public:
+    explicit FrameExchange(std::size_t buffers = 3);
+
+    /// Frame to fill next; valid until publish(). Contents are a stale frame.
+    SimFrame& begin_write();
+    /// Make the frame from begin_write() the latest one.
+    void publish();
+    /// Most recently published frame (null before the first publish()).
+    std::shared_ptr<const SimFrame> latest() const;
+
+    /// Number of publish() calls so far; readers can skip redraws when unchanged.
+    std::uint64_t generation() const;
+    /// Frame buffers allocated so far (3 in steady state).
+    std::size_t buffers() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<SimFrame>> pool_;
+    std::shared_ptr<SimFrame> writing_;
+    std::shared_ptr<SimFrame> published_;
+    std::uint64_t generation_{0};
+};
+
+}  // namespace matsimu
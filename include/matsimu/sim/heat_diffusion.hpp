@@ -3,6 +3,7 @@
 #include <matsimu/core/types.hpp>
 #include <matsimu/sim/model.hpp>
 #include <matsimu/alloc/bounded_allocator.hpp>
+#include <matsimu/sim/heat_implicit.hpp>
 #include <vector>
 #include <string>
 #include <optional>
@@ -11,8 +12,9 @@
 namespace matsimu {
 
 /**
- * Parameters for 1D explicit heat diffusion (SI).
- * Invariants: alpha > 0, dx > 0, dt > 0, dt <= stability_limit (dx²/(2*alpha)).
+ * Parameters for 1D heat diffusion (SI).
+ * Invariants: alpha > 0, dx > 0, dt > 0; dt <= stability_limit (dx²/(2*alpha))
+ * for the explicit scheme only (Implicit = Crank–Nicolson, any dt).
  */
 struct HeatDiffusionParams {
   Real alpha{1e-5};        /// Thermal diffusivity [m²/s]
@@ -21,6 +23,7 @@ struct HeatDiffusionParams {
   Real end_time{1e-3};     /// End time [s]
   std::size_t max_steps{1000000};
   std::size_t n_cells{100}; /// Number of cells (1D rod)
+  HeatScheme scheme{HeatScheme::Explicit};  /// Time discretization
 
   /// Stability limit for explicit Euler: dt <= dx²/(2*alpha).
   Real stability_limit() const;
@@ -30,7 +33,7 @@ struct HeatDiffusionParams {
 };
 
 /**
- * 1D explicit heat diffusion model.
+ * 1D heat diffusion model (explicit Euler or Crank–Nicolson).
  * ∂T/∂t = α ∂²T/∂x²; Dirichlet boundaries (fixed end temperatures).
  * All units SI; conversions at I/O only.
  */
@@ -42,11 +45,17 @@ public:
                               std::size_t max_bytes = 256 * 1024 * 1024);
 
   bool step() override;
+  /// Temporal blocking: kHeatTimeBlock1D steps per pass over the rod
+  /// (explicit scheme; Implicit takes single steps).
+  std::size_t advance(std::size_t k) override;
   bool finished() const override;
   Real time() const override;
   std::size_t step_count() const override;
   const std::string& error_message() const override;
   bool is_valid() const override;
+  /// The temperature field.
+  std::vector<StateBuffer> state_buffers() override;
+  void restore_clock(Real time, std::size_t step_count) override;
 
   /// Temperature field [K] at current time (read-only).
   const std::vector<Real, HeatAllocator>& temperature() const { return T_; }
@@ -58,12 +67,16 @@ private:
   std::size_t n_{0};
   std::vector<Real, HeatAllocator> T_;
   std::vector<Real, HeatAllocator> T_next_;
+  std::vector<Real, HeatAllocator> scratch_;  // heat_advance_1d tile buffers
+  TridiagonalSolver solver_;                  // Implicit scheme only
   Real time_{0};
   std::size_t step_count_{0};
   std::string error_msg_;
   bool valid_{false};
 
   void initialize();
+  /// Book up to max_steps steps exactly as step() would; returns the count.
+  std::size_t take_steps(std::size_t max_steps);
 };
 
 
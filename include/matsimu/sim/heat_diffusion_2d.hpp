@@ -1,12 +1,20 @@
 #pragma once
 
 #include <matsimu/core/types.hpp>
+#include <matsimu/core/precision.hpp>
 #include <matsimu/sim/model.hpp>
 #include <matsimu/alloc/bounded_allocator.hpp>
+#include <matsimu/alloc/placement.hpp>
+#include <matsimu/sim/heat_implicit.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
+#include <matsimu/parallel/simd_level.hpp>
+#include <matsimu/parallel/device.hpp>
 #include <vector>
 #include <string>
 #include <optional>
 #include <cstddef>
+#include <memory>
+#include <algorithm>
 
 namespace matsimu {
 
@@ -22,7 +30,7 @@ namespace matsimu {
 enum class HeatIC2D { HotCenter, UniformHot };
 
 /**
- * Parameters for 2D explicit heat diffusion on a uniform NxN grid (SI).
+ * Parameters for 2D heat diffusion on a uniform NxN grid (SI).
  *
  * PDE:   ∂T/∂t = α ∇²T   (isotropic Fourier heat equation)
  * BCs:   Dirichlet — all edges fixed at T_boundary.
@@ -30,10 +38,13 @@ enum class HeatIC2D { HotCenter, UniformHot };
  *
  * Invariants:
  *   - alpha > 0, dx > 0, dt > 0
- *   - dt ≤ stability_limit()  (explicit Euler, 5-point stencil)
+ *   - dt ≤ stability_limit()  (Explicit scheme only; Implicit = ADI, any dt)
  *   - nx >= 3, ny >= 3  (at least one interior cell)
  *   - T_hot > T_boundary >= 0
  *   - hot_radius_frac > 0 (only used for HotCenter)
+ *   - num_threads >= 1
+ *   - precision == Single requires scheme == Explicit
+ *   - backend == Device requires scheme == Explicit, precision == Double
  *
  * Unit system: SI throughout (m, s, K, m²/s).
  */
@@ -49,6 +60,12 @@ struct HeatDiffusion2DParams {
     HeatIC2D ic{HeatIC2D::HotCenter}; ///< Initial condition preset
     Real T_hot{1200.0};          ///< Hot region temperature [K]
     Real hot_radius_frac{0.12};  ///< Gaussian σ as fraction of domain width (HotCenter only)
+    std::size_t num_threads{1};  ///< Stencil sweep threads (1 = serial)
+    bool huge_pages{false};      ///< THP-advised, 2 MiB-aligned fields (alloc/placement.hpp)
+    bool first_touch{false};     ///< Fault the fields in on the sweep threads (NUMA placement)
+    HeatScheme scheme{HeatScheme::Explicit};  ///< Time discretization
+    Precision precision{kDefaultPrecision};   ///< Stencil arithmetic (Single: float field)
+    ComputeBackend backend{ComputeBackend::Host};  ///< Device: field resident on the offload device
 
     /// Stability limit for 2D explicit Euler: dt ≤ dx² / (4·α).
     Real stability_limit() const;
@@ -58,32 +75,50 @@ struct HeatDiffusion2DParams {
 };
 
 /**
- * 2D explicit heat diffusion model on a uniform Cartesian grid.
+ * 2D heat diffusion model on a uniform Cartesian grid.
  *
  * ∂T/∂t = α (∂²T/∂x² + ∂²T/∂y²)
  *
- * Discretization:  5-point Laplacian, forward Euler in time.
+ * Discretization:  5-point Laplacian; forward Euler (Explicit) or
+ *                  Peaceman–Rachford ADI (Implicit) in time.
  * Storage:         Row-major (T[j * nx + i] → cell at column i, row j).
  * Boundaries:      Dirichlet (first/last row/column fixed at T_boundary).
+ * Sweep:           heat_step_2d — tiled, vectorized, one row band per thread;
+ *                  boundary cells written in the same pass.
+ * Precision:       Single steps a float copy of the field (half the memory
+ *                  traffic, twice the lanes); temperature() converts back.
+ * Backend:         Device keeps both fields on the offload device for the
+ *                  life of the model (heat_step_2d_device, one step per
+ *                  launch); temperature() and state_buffers() download the
+ *                  field once per step at most, restore_clock() uploads it.
  *
  * All units SI; conversions at I/O only.
  */
 class HeatDiffusion2DModel : public ISimModel {
 public:
-    using HeatAllocator = bounded_allocator<Real>;
+    using HeatAllocator = bounded_allocator<Real, placement_allocator<Real>>;
+    using FloatAllocator = bounded_allocator<float, placement_allocator<float>>;
 
     explicit HeatDiffusion2DModel(const HeatDiffusion2DParams& params,
                                   std::size_t max_bytes = 512 * 1024 * 1024);
 
     bool step() override;
+    /// Temporal blocking: heat_time_block_2d(nx, ny) steps per pass over the grid
+    /// (explicit host scheme; Implicit and Device take single steps).
+    std::size_t advance(std::size_t k) override;
     bool finished() const override;
     Real time() const override;
     std::size_t step_count() const override;
     const std::string& error_message() const override;
     bool is_valid() const override;
+    /// The field that steps (the float copy with Precision::Single).
+    std::vector<StateBuffer> state_buffers() override;
+    void restore_clock(Real time, std::size_t step_count) override;
 
-    /// Temperature field [K] at current time (row-major, read-only).
-    const std::vector<Real, HeatAllocator>& temperature() const { return T_; }
+    /// Temperature field [K] at current time (row-major, read-only). With
+    /// Precision::Single (ComputeBackend::Device) this is refreshed from the
+    /// float field (the device) on the first call after a step.
+    const std::vector<Real, HeatAllocator>& temperature() const;
 
     /// Grid dimensions.
     std::size_t nx() const { return nx_; }
@@ -93,12 +128,28 @@ public:
     Real T_cold() const { return params_.T_boundary; }
     Real T_hot()  const { return params_.T_hot; }
 
+    /// Cap the vectorized row kernel (default: detect_simd_level()); results
+    /// are bit-identical at every level.
+    void set_simd_level(SimdLevel level) { simd_level_ = std::min(level, detect_simd_level()); }
+
 private:
     HeatDiffusion2DParams params_;
     std::size_t nx_{0};
     std::size_t ny_{0};
-    std::vector<Real, HeatAllocator> T_;
+    std::shared_ptr<ThreadPool> pool_;  // null when num_threads == 1
+    std::shared_ptr<const MemoryPlacement> placement_;  // fields below; null = plain heap
+    mutable std::vector<Real, HeatAllocator> T_;  // mutable: Single-precision mirror
     std::vector<Real, HeatAllocator> T_next_;
+    std::vector<Real, HeatAllocator> scratch_;  // heat_advance_2d ring buffers
+    std::vector<float, FloatAllocator> Tf_;       // Precision::Single only
+    std::vector<float, FloatAllocator> Tf_next_;
+    std::vector<float, FloatAllocator> scratch_f_;
+    DeviceMirror<Real> device_T_;                 // ComputeBackend::Device only
+    DeviceMirror<Real> device_T_next_;
+    mutable bool mirror_stale_{false};            // T_ behind Tf_ (the device)
+    TridiagonalSolver x_solver_;  // Implicit scheme only
+    TridiagonalSolver y_solver_;
+    SimdLevel simd_level_{detect_simd_level()};
     Real time_{0};
     std::size_t step_count_{0};
     std::string error_msg_;
@@ -108,6 +159,8 @@ private:
     void apply_initial_condition_hot_center();
     void apply_initial_condition_uniform_hot();
     void apply_boundary_conditions(std::vector<Real, HeatAllocator>& field);
+    /// Book up to max_steps steps exactly as step() would; returns the count.
+    std::size_t take_steps(std::size_t max_steps);
 };
 
 
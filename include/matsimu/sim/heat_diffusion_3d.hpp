@@ -0,0 +1,150 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/sim/model.hpp>
+#include <matsimu/sim/heat_stencil.hpp>
+#include <matsimu/alloc/bounded_allocator.hpp>
+#include <matsimu/alloc/placement.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
+#include <matsimu/parallel/simd_level.hpp>
+#include <matsimu/parallel/device.hpp>
+#include <vector>
+#include <string>
+#include <optional>
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+
+namespace matsimu {
+
+/**
+ * Initial condition presets for 3D heat diffusion (see HeatIC2D).
+ *
+ * HotCenter:   Gaussian hot spot at the domain center.
+ * UniformHot:  Entire interior at T_hot; faces fixed at T_boundary.
+ */
+enum class HeatIC3D { HotCenter, UniformHot };
+
+/**
+ * Parameters for 3D explicit heat diffusion on a uniform nx×ny×nz grid (SI).
+ *
+ * PDE:   ∂T/∂t = α ∇²T
+ * BCs:   Dirichlet — all six faces fixed at T_boundary.
+ *
+ * Invariants:
+ *   - alpha > 0, dx > 0, dt > 0
+ *   - dt ≤ stability_limit()  (explicit Euler, 7-point stencil)
+ *   - nx, ny, nz >= 3
+ *   - T_hot > T_boundary >= 0
+ *   - hot_radius_frac > 0 (only used for HotCenter)
+ *   - num_threads >= 1
+ *
+ * Unit system: SI throughout (m, s, K, m²/s).
+ */
+struct HeatDiffusion3DParams {
+    Real alpha{1.11e-4};         ///< Thermal diffusivity [m²/s]
+    Real dx{1.25e-3};            ///< Grid spacing [m]
+    Real dt{2.0e-3};             ///< Time step [s]
+    Real end_time{0.0};          ///< End time [s]; 0 = run continuously
+    std::size_t max_steps{10000000};
+    std::size_t nx{48};          ///< Grid cells in x
+    std::size_t ny{48};          ///< Grid cells in y
+    std::size_t nz{48};          ///< Grid cells in z
+    Real T_boundary{300.0};      ///< Dirichlet boundary temperature [K]
+    HeatIC3D ic{HeatIC3D::HotCenter}; ///< Initial condition preset
+    Real T_hot{1200.0};          ///< Hot region temperature [K]
+    Real hot_radius_frac{0.12};  ///< Gaussian σ as fraction of domain width (HotCenter only)
+    std::size_t num_threads{1};  ///< Stencil sweep threads (1 = serial)
+    bool huge_pages{false};      ///< THP-advised, 2 MiB-aligned fields (alloc/placement.hpp)
+    bool first_touch{false};     ///< Fault the fields in on the sweep threads (NUMA placement)
+    ComputeBackend backend{ComputeBackend::Host};  ///< Device: field resident on the offload device
+
+    /// Stability limit for 3D explicit Euler: dt ≤ dx² / (6·α).
+    Real stability_limit() const;
+
+    /// Returns error message if invalid, std::nullopt otherwise.
+    std::optional<std::string> validate() const;
+};
+
+/**
+ * 3D explicit heat diffusion model on a uniform Cartesian grid.
+ *
+ * Discretization:  7-point Laplacian, forward Euler in time.
+ * Storage:         Padded planes (HeatGrid3D): rows start on cache-line
+ *                  multiples and the plane stride avoids 4 KiB aliasing.
+ *                  Both fields share one bounded_allocator budget; a grid
+ *                  that does not fit is reported by is_valid()/error_message().
+ * Sweep:           heat_step_3d — x/y tiles streamed through z, one plane
+ *                  band per thread, faces written in the same pass.
+ * Backend:         Device keeps both fields on the offload device
+ *                  (heat_step_3d_device); the accessors below download the
+ *                  field on their first call after a step.
+ *
+ * All units SI; conversions at I/O only.
+ */
+class HeatDiffusion3DModel : public ISimModel {
+public:
+    using HeatAllocator = bounded_allocator<Real, placement_allocator<Real>>;
+
+    explicit HeatDiffusion3DModel(const HeatDiffusion3DParams& params,
+                                  std::size_t max_bytes = 1024ull * 1024 * 1024);
+
+    bool step() override;
+    bool finished() const override;
+    Real time() const override;
+    std::size_t step_count() const override;
+    const std::string& error_message() const override;
+    bool is_valid() const override;
+    /// The padded field (storage()).
+    std::vector<StateBuffer> state_buffers() override;
+    void restore_clock(Real time, std::size_t step_count) override;
+
+    /// Grid dimensions and padded layout.
+    std::size_t nx() const { return grid_.nx; }
+    std::size_t ny() const { return grid_.ny; }
+    std::size_t nz() const { return grid_.nz; }
+    const HeatGrid3D& grid() const { return grid_; }
+
+    /// Temperature [K] of cell (i, j, k).
+    Real temperature(std::size_t i, std::size_t j, std::size_t k) const {
+        sync_host();
+        return T_[grid_.index(i, j, k)];
+    }
+    /// Padded field (index with grid().index(i, j, k); padding is unspecified).
+    const std::vector<Real, HeatAllocator>& storage() const {
+        sync_host();
+        return T_;
+    }
+
+    /// Fixed colormap bounds — use these for consistent visualization.
+    Real T_cold() const { return params_.T_boundary; }
+    Real T_hot()  const { return params_.T_hot; }
+
+    /// Cap the vectorized row kernel (default: detect_simd_level()).
+    void set_simd_level(SimdLevel level) { simd_level_ = std::min(level, detect_simd_level()); }
+
+private:
+    HeatDiffusion3DParams params_;
+    HeatGrid3D grid_;
+    std::shared_ptr<ThreadPool> pool_;  // null when num_threads == 1
+    std::vector<Real, HeatAllocator> T_;
+    std::vector<Real, HeatAllocator> T_next_;
+    DeviceMirror<Real> device_T_;        // ComputeBackend::Device only
+    DeviceMirror<Real> device_T_next_;
+    mutable bool device_stale_{false};   // T_ behind the device copy
+    SimdLevel simd_level_{detect_simd_level()};
+    Real time_{0};
+    std::size_t step_count_{0};
+    std::string error_msg_;
+    bool valid_{false};
+
+    void initialize();
+    void sync_host() const {
+        if (device_stale_) {
+            device_T_.download();
+            device_stale_ = false;
+        }
+    }
+};
+
+}  // namespace matsimu
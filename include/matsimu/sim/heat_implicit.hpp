@@ -0,0 +1,70 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace matsimu {
+
+/**
+ * Time discretization for the heat models.
+ *
+ * Explicit: forward Euler; dt is capped by the stability limit.
+ * Implicit: Crank–Nicolson in 1D (one tridiagonal solve per step) and
+ *           Peaceman–Rachford ADI in 2D (x-implicit then y-implicit half
+ *           steps). Both are unconditionally stable and second order in
+ *           time; at r = α·dt/dx² ≫ 1 the shortest wavelengths decay slowly
+ *           and may alternate in sign, so dt is an accuracy choice only.
+ */
+enum class HeatScheme { Explicit, Implicit };
+
+/**
+ * Thomas algorithm for the constant-coefficient tridiagonal system
+ *   a·x[k-1] + b·x[k] + c·x[k+1] = d[k],  k = 0 .. n-1.
+ * The elimination factors depend only on k, so they are computed once and
+ * each solve is one forward and one backward sweep. Requires |b| > |a| + |c|
+ * (diagonal dominance; always true for the heat operators).
+ */
+class TridiagonalSolver {
+public:
+    TridiagonalSolver() = default;
+    TridiagonalSolver(std::size_t n, Real a, Real b, Real c);
+
+    std::size_t size() const { return m_.size(); }
+
+    /**
+     * Solve in place for `count` interleaved systems: unknown k of system s
+     * is d[k * stride + s]. count = 1, stride = 1 is one contiguous system;
+     * count columns of a row-major grid (stride = row length) are solved
+     * together with a unit-stride inner loop.
+     */
+    void solve(Real* d, std::size_t count = 1, std::size_t stride = 1) const;
+
+private:
+    Real a_{0.0};
+    std::vector<Real> cp_;  // modified upper coefficients c'_k
+    std::vector<Real> m_;   // 1 / (b - a·c'_{k-1})
+};
+
+/**
+ * One Crank–Nicolson step on n >= 2 cells, r = α·dt/dx²:
+ *   (I − r/2·δ²) dst = (I + r/2·δ²) src; the end cells keep their src values.
+ * solver: TridiagonalSolver(n − 2, −r/2, 1 + r, −r/2).
+ */
+void heat_cn_step_1d(const TridiagonalSolver& solver, const Real* src, Real* dst,
+                     std::size_t n, Real r);
+
+/**
+ * One Peaceman–Rachford ADI step in place on the row-major nx×ny field T
+ * with Dirichlet edges at T_boundary:
+ *   (I − r/2·δx²) T* = (I + r/2·δy²) Tⁿ,   (I − r/2·δy²) Tⁿ⁺¹ = (I + r/2·δx²) T*.
+ * work (nx·ny) receives T*. Row solves, then column-block solves, are split
+ * over pool threads (nullptr = serial); results do not depend on the split.
+ * x_solver / y_solver: TridiagonalSolver(nx − 2 / ny − 2, −r/2, 1 + r, −r/2).
+ */
+void heat_adi_step_2d(const TridiagonalSolver& x_solver, const TridiagonalSolver& y_solver,
+                      Real* T, Real* work, std::size_t nx, std::size_t ny, Real r,
+                      Real T_boundary, ThreadPool* pool);
+
+}  // namespace matsimu
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
+#include <matsimu/parallel/simd_level.hpp>
+#include <cstddef>
+
+namespace matsimu {
+
+/**
+ * Explicit heat-diffusion stencil sweeps shared by the grid models.
+ *
+ * One call writes every cell of dst exactly once: interior cells get the
+ * forward-Euler update, Dirichlet edge cells get T_boundary inside the same
+ * sweep. Rows are split into one contiguous band per pool thread; each band
+ * is swept in column tiles so the three input rows of a tile stay in cache
+ * while the band walks down. The inner loop is explicitly vectorized
+ * (AVX2, no FMA) and evaluates the same expression in the same order as the
+ * scalar loop, so results are bit-identical for every SimdLevel and
+ * thread count.
+ */
+
+/// Columns per tile (a 512-cell row segment is 4 KiB in double precision).
+constexpr std::size_t kHeatTileCols = 512;
+
+/**
+ * One 5-point step on a row-major nx×ny grid (nx, ny >= 3):
+ *   dst[j,i] = src[j,i] + r·(src[j,i-1] + src[j,i+1] + src[j-1,i] + src[j+1,i] − 4·src[j,i])
+ * with r = α·dt/dx². src and dst must not overlap. pool may be nullptr (serial).
+ */
+void heat_step_2d(const Real* src, Real* dst, std::size_t nx, std::size_t ny,
+                  Real r, Real T_boundary, ThreadPool* pool, SimdLevel level);
+
+/// Single-precision field (Precision::Single): same sweep with float rows,
+/// 8 cells per AVX2 vector; r and T_boundary are rounded to float once.
+void heat_step_2d(const float* src, float* dst, std::size_t nx, std::size_t ny,
+                  Real r, Real T_boundary, ThreadPool* pool, SimdLevel level);
+
+/**
+ * The heat_step_2d update of the cells [i_begin, i_end) × [j_begin, j_end)
+ * of a row-major grid with row pitch `pitch`; nothing else in dst is
+ * written. Every cell of the rectangle needs its four neighbors inside the
+ * grid. Rows are split over pool. Lets a tile sweep its interior while the
+ * halo is still in flight and its rim afterwards (DistributedHeat2DModel).
+ */
+void heat_update_rect_2d(const Real* src, Real* dst, std::size_t pitch,
+                         std::size_t i_begin, std::size_t i_end,
+                         std::size_t j_begin, std::size_t j_end,
+                         Real r, ThreadPool* pool, SimdLevel level);
+
+/**
+ * Temporal blocking: k fused steps per pass over the grid.
+ *
+ * 2D: a line-buffer wavefront down the rows. Intermediate time levels live
+ * in 3-row ring buffers, so src is read and dst written once per k steps.
+ * Thread bands overlap by k-1 rows at each level and recompute that halo.
+ * 1D: overlapped tiles of kHeatTileCols cells (halo k) are advanced in a
+ * private buffer pair. Both are bit-identical to k single steps.
+ */
+
+/// Fused-step depth for an nx×ny grid of cell_bytes cells: ring buffers stay
+/// within ~1 MiB; 1 when both fields already fit in that budget (nothing to save).
+std::size_t heat_time_block_2d(std::size_t nx, std::size_t ny,
+                               std::size_t cell_bytes = sizeof(Real));
+
+/// Scratch Reals heat_advance_2d needs (0 for k == 1).
+std::size_t heat_scratch_size_2d(std::size_t nx, std::size_t k, std::size_t threads);
+
+/// k >= 1 fused 5-point steps from src into dst (same contract as heat_step_2d).
+void heat_advance_2d(const Real* src, Real* dst, std::size_t nx, std::size_t ny,
+                     Real r, Real T_boundary, std::size_t k, Real* scratch,
+                     ThreadPool* pool, SimdLevel level);
+void heat_advance_2d(const float* src, float* dst, std::size_t nx, std::size_t ny,
+                     Real r, Real T_boundary, std::size_t k, float* scratch,
+                     ThreadPool* pool, SimdLevel level);
+
+/**
+ * Storage geometry of a padded 3D grid: cell (i, j, k) lives at
+ * k·plane + j·pitch + i. pitch rounds nx up to a whole number of 64-byte
+ * lines; plane is padded off multiples of 4 KiB so the k±1 neighbors of a
+ * cell do not alias in the same cache sets.
+ */
+struct HeatGrid3D {
+    std::size_t nx{0}, ny{0}, nz{0};
+    std::size_t pitch{0};  ///< cells between rows
+    std::size_t plane{0};  ///< cells between planes
+    std::size_t size() const { return nz * plane; }
+    std::size_t index(std::size_t i, std::size_t j, std::size_t k) const {
+        return k * plane + j * pitch + i;
+    }
+};
+
+/// Padded geometry for an nx×ny×nz grid.
+HeatGrid3D make_heat_grid_3d(std::size_t nx, std::size_t ny, std::size_t nz);
+
+/// Rows per tile in the 3D sweep (with kHeatTileCols columns: 3 planes × tile ≈ 192 KiB).
+constexpr std::size_t kHeatTileRows3D = 16;
+
+/**
+ * One 7-point step (nx, ny, nz >= 3):
+ *   dst = src + r·(sum of the six face neighbors − 6·src), faces = T_boundary.
+ * Planes are split into one band per pool thread; each band is tiled in
+ * x and y and streams through its planes, writing every logical cell once.
+ * Padding cells are left untouched. Bit-identical for any SimdLevel and
+ * thread count.
+ */
+void heat_step_3d(const Real* src, Real* dst, const HeatGrid3D& grid, Real r,
+                  Real T_boundary, ThreadPool* pool, SimdLevel level);
+
+/**
+ * heat_step_2d / heat_step_3d on the offload device (parallel/device.hpp)
+ * for ComputeBackend::Device: src and dst must be resident (DeviceMirror of
+ * all nx·ny, respectively grid.size(), cells). One cell per device thread,
+ * same arithmetic as the host kernels (bit-identical when run on the host;
+ * device compilers may contract to FMA).
+ */
+void heat_step_2d_device(const Real* src, Real* dst, std::size_t nx, std::size_t ny,
+                         Real r, Real T_boundary);
+void heat_step_3d_device(const Real* src, Real* dst, const HeatGrid3D& grid, Real r,
+                         Real T_boundary);
+
+/// Fused-step depth used by HeatDiffusionModel::advance.
+constexpr std::size_t kHeatTimeBlock1D = 16;
+
+/// Scratch Reals heat_advance_1d needs.
+std::size_t heat_scratch_size_1d(std::size_t k);
+
+/**
+ * k >= 1 fused steps of T[i] += r·(T[i-1] − 2·T[i] + T[i+1]) on n >= 2
+ * cells; the end cells keep their src values.
+ */
+void heat_advance_1d(const Real* src, Real* dst, std::size_t n, Real r,
+                     std::size_t k, Real* scratch);
+
+}  // namespace matsimu
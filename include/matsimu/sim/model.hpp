@@ -3,9 +3,16 @@
 #include <matsimu/core/types.hpp>
 #include <cstddef>
 #include <string>
+#include <vector>
 
 namespace matsimu {
 
+/// One contiguous array of model state (see ISimModel::state_buffers).
+struct StateBuffer {
+  void* data;
+  std::size_t bytes;
+};
+
 /**
  * Interface for physics models used by Simulation.
  * Simulation orchestrates stepping and termination; model implements the math.
@@ -16,6 +23,14 @@ public:
 
   /// Advance one step. Returns false when step failed or simulation finished.
   virtual bool step() = 0;
+  /// Advance up to k steps; returns how many were taken (fewer than k once
+  /// finished or failed). Models may fuse the steps into fewer grid passes;
+  /// the state afterwards is identical to k calls of step().
+  virtual std::size_t advance(std::size_t k) {
+    std::size_t n = 0;
+    while (n < k && step()) ++n;
+    return n;
+  }
   /// True when simulation has reached end condition (time, steps, or error).
   virtual bool finished() const = 0;
   /// Current simulation time [s].
@@ -26,6 +41,14 @@ public:
   virtual const std::string& error_message() const = 0;
   /// Whether the model is valid and can step.
   virtual bool is_valid() const = 0;
+
+  /// Checkpoint/restart: the arrays that make up the current state, in a
+  /// fixed order. Their sizes follow from the params, so a restore writes
+  /// into the views of a model built from the same params and then calls
+  /// restore_clock(). Empty = nothing beyond the clock.
+  virtual std::vector<StateBuffer> state_buffers() { return {}; }
+  /// Set time and step count after a restore (buffers already filled).
+  virtual void restore_clock(Real time, std::size_t step_count) = 0;
 };
 
 }  // namespace matsimu
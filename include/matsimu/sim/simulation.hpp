@@ -1,15 +1,22 @@
 #pragma once
 
 #include <matsimu/core/types.hpp>
+#include <matsimu/core/precision.hpp>
 #include <matsimu/physics/particle.hpp>
 #include <matsimu/physics/integrator.hpp>
 #include <matsimu/physics/potential.hpp>
 #include <matsimu/physics/neighbor_list.hpp>
+#include <matsimu/physics/observables.hpp>
 #include <matsimu/physics/thermostat.hpp>
 #include <matsimu/lattice/lattice.hpp>
+#include <matsimu/parallel/device.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
 #include <matsimu/sim/model.hpp>
 #include <matsimu/sim/heat_diffusion.hpp>
 #include <matsimu/sim/heat_diffusion_2d.hpp>
+#include <matsimu/sim/heat_diffusion_3d.hpp>
+#include <matsimu/sim/skin_tuner.hpp>
+#include <matsimu/sim/step_stats.hpp>
 #include <memory>
 #include <optional>
 #include <string>
@@ -17,6 +24,17 @@
 
 namespace matsimu {
 
+/**
+ * When MD steps verify that particle state is still finite.
+ * - EveryStep: full scan after every step (default).
+ * - Interval:  full scan every health_check_interval steps.
+ * - DebugOnly: full scan every step in debug builds (!NDEBUG), never otherwise.
+ * - Fused:     checked inside the Velocity Verlet update loops (no extra
+ *              pass); thermostat output is not re-checked.
+ * A failed check stops the run with "Particle state became non-finite".
+ */
+enum class HealthCheck { EveryStep, Interval, DebugOnly, Fused };
+
 /**
  * Enhanced simulation parameters for molecular dynamics.
  * dx is used by UI and by heat-diffusion; for MD it may be unused.
@@ -31,15 +49,41 @@ struct SimulationParams {
     Real temperature{300.0};  // target temperature [K]
     Real cutoff{1.0e-9};      // force cutoff [m]
     bool use_neighbor_list{true};  // use neighbor list optimization
-    Real neighbor_skin{0.2e-9};   // neighbor list skin [m]
+    Real neighbor_skin{0.2e-9};   // neighbor list skin [m] (initial value when auto-tuned)
+    std::size_t sort_interval{0};  // Morton-reorder particles every n-th neighbor rebuild (0 = off)
+    bool neighbor_skin_auto{false};  // tune the skin at run time for speed (sim/skin_tuner.hpp)
+    Real neighbor_skin_min{0};    // auto-tune bounds [m]; 0 = 0.05 / 0.6 × cutoff
+    Real neighbor_skin_max{0};
+    NeighborBuild neighbor_build{NeighborBuild::Cells};  // neighbor list pair search
+    std::size_t num_threads{1};   // force evaluation threads (1 = serial)
+    std::size_t respa_steps{1};   // r-RESPA inner steps per dt (1 = plain Velocity Verlet; needs the neighbor list)
+    Real respa_split{0};          // inner/outer shell radius [m]; 0 = 0.6 × cutoff
+    Real respa_switch{0};         // switching zone below respa_split [m]; 0 = 0.2 × respa_split
+    HealthCheck health_check{HealthCheck::EveryStep};  // non-finite state detection
+    std::size_t health_check_interval{100};  // steps between scans (Interval)
+    std::size_t energy_interval{1};  // steps between energy sums (0 = on demand only)
+    Precision precision{kDefaultPrecision};  // LJ vector kernel arithmetic (neighbor list path)
+    std::size_t max_bytes{1024ull * 1024 * 1024};  // particle array budget [bytes] (bounded_allocator)
+    bool huge_pages{false};        // 2 MiB-aligned, THP-advised particle arrays (alloc/placement.hpp)
+    bool first_touch{false};       // fault particle arrays in on the num_threads pool (NUMA)
+    bool profile{false};           // time step phases into stats() (MD; see core/profile.hpp)
+    ComputeBackend backend{ComputeBackend::Host};  // Device: MD state on the offload device (DeviceSimulation)
     
     std::optional<std::string> validate() const;
+
+    /// respa_split / respa_switch with the 0 defaults resolved [m].
+    Real resolved_respa_split() const { return respa_split > 0.0 ? respa_split : 0.6 * cutoff; }
+    Real resolved_respa_switch() const {
+        return respa_switch > 0.0 ? respa_switch : 0.2 * resolved_respa_split();
+    }
 };
 
 /**
  * Simulation mode: which physics model is active.
  */
-enum class SimMode { MD, HeatDiffusion, HeatDiffusion2D };
+enum class SimMode { MD, HeatDiffusion, HeatDiffusion2D, HeatDiffusion3D };
+
+class DeviceSimulation;
 
 /**
  * Molecular dynamics simulation with full physics engine.
@@ -51,12 +95,19 @@ enum class SimMode { MD, HeatDiffusion, HeatDiffusion2D };
  * - Thermostats for temperature control
  * - Periodic boundary conditions
  * - Energy and trajectory tracking
+ *
+ * With params.backend == Device the MD state lives on the offload device:
+ * lattice, potential, thermostat, stepping, system() and the energies go
+ * to a DeviceSimulation (sim/device_simulation.hpp, which lists what it
+ * needs and lacks). set_integrator() has no effect there, set_observables()
+ * fails and stats() reports steps only.
  */
 class Simulation {
 public:
     /// Construct MD simulation.
     Simulation(const SimulationParams& params,
                std::shared_ptr<Potential> potential = nullptr);
+    ~Simulation();
 
     /// Construct 1D heat-diffusion simulation (orchestrates stepping; math in HeatDiffusionModel).
     explicit Simulation(const HeatDiffusionParams& heat_params);
@@ -64,6 +115,9 @@ public:
     /// Construct 2D heat-diffusion simulation (math in HeatDiffusion2DModel).
     explicit Simulation(const HeatDiffusion2DParams& heat_2d_params);
 
+    /// Construct 3D heat-diffusion simulation (math in HeatDiffusion3DModel).
+    explicit Simulation(const HeatDiffusion3DParams& heat_3d_params);
+
     /// Check if simulation is valid
     bool is_valid() const;
 
@@ -73,6 +127,10 @@ public:
     /// Advance one step (MD or heat depending on mode)
     bool step();
 
+    /// Advance up to k steps; returns how many were taken (fewer than k when
+    /// the run ends or fails). Heat models fuse the steps (ISimModel::advance).
+    std::size_t advance(std::size_t k);
+
     /// Run simulation to completion
     void run();
 
@@ -93,35 +151,71 @@ public:
     const SimulationParams& params() const { return params_; }
     
     // System access
-    ParticleSystem& system() { return system_; }
-    const ParticleSystem& system() const { return system_; }
+    ParticleSystem& system();
+    const ParticleSystem& system() const;
     
     // Lattice/boundary conditions
-    void set_lattice(const Lattice& lat) { lattice_ = lat; }
+    void set_lattice(const Lattice& lat);
     const Lattice* lattice() const { return &lattice_; }
     bool has_lattice() const { return lattice_.volume() != 0.0; }
     
     // Potential
     void set_potential(std::shared_ptr<Potential> pot);
-    Potential* potential() const { return force_field_ ? force_field_->potential() : nullptr; }
+    Potential* potential() const;
     
     // Thermostat
-    void set_thermostat(std::shared_ptr<Thermostat> therm) { thermostat_ = std::move(therm); }
+    void set_thermostat(std::shared_ptr<Thermostat> therm);
     Thermostat* thermostat() const { return thermostat_.get(); }
     
     // Integrator
+    /// A RespaIntegrator (r-RESPA) sets the neighbor force field's shell
+    /// split and needs use_neighbor_list; call initialize() after switching.
     void set_integrator(std::unique_ptr<VelocityVerlet> integrator);
     VelocityVerlet* integrator() const { return integrator_.get(); }
     
     // Energy tracking
-    Real kinetic_energy() const { return system_.kinetic_energy(); }
-    Real potential_energy() const { return last_epot_; }
+    /// Kinetic energy, momentum and temperature of the current velocities;
+    /// shared per step with the thermostat (cached by the second Verlet kick),
+    /// recomputed on the thread pool after other velocity changes.
+    const KineticMoments& kinetic_moments() const;
+    Real kinetic_energy() const { return kinetic_moments().kinetic_energy; }
+    /// Potential energy at the current positions. Cheap on steps that summed
+    /// it (see energy_interval); otherwise evaluated on demand and cached.
+    Real potential_energy() const;
     Real total_energy() const { return kinetic_energy() + potential_energy(); }
-    Real temperature() const { return system_.temperature(); }
+    Real temperature() const { return kinetic_moments().temperature; }
     
     /// Access the 2D heat model (nullptr if mode != HeatDiffusion2D).
     const HeatDiffusion2DModel* heat_2d_model() const;
 
+    /// Access the 3D heat model (nullptr if mode != HeatDiffusion3D).
+    const HeatDiffusion3DModel* heat_3d_model() const;
+
+    /// Access the device MD run (nullptr unless params.backend == Device).
+    const DeviceSimulation* device_simulation() const { return device_.get(); }
+
+    /// Checkpoint/restart (io/checkpoint.hpp): the active model's state
+    /// arrays (empty in MD mode, where the state is system() and lattice()).
+    std::vector<StateBuffer> model_state_buffers() const;
+    /// Set time and step count after the state has been restored; drops
+    /// cached energies.
+    void restore_clock(Real time, std::size_t step_count);
+
+    /// Instrumentation: per-phase times (params.profile), step and neighbor
+    /// rebuild counts, particle allocator usage. Heat modes report steps only.
+    StepStats stats() const;
+    /// Zero times and counters (the allocator high-water mark is kept).
+    void reset_stats();
+
+    /// On-the-fly analysis (physics/observables.hpp): RDF, pressure and
+    /// temperature profile, each sampled every n-th step inside the force
+    /// pass and the last Verlet kick instead of an extra sweep. The RDF range
+    /// is clamped to params().cutoff. Returns an error (and changes nothing)
+    /// for invalid params; otherwise the averages restart.
+    std::optional<std::string> set_observables(const ObservableParams& params);
+    const Observables& observables() const { return observables_; }
+    Observables& observables() { return observables_; }
+
     // Callbacks
     using StepCallback = std::function<void(const Simulation&)>;
     void set_step_callback(StepCallback cb) { step_callback_ = std::move(cb); }
@@ -137,18 +231,37 @@ private:
     std::string error_msg_;
 
     // Physics components (MD only)
+    std::shared_ptr<ThreadPool> thread_pool_;  // null when num_threads == 1; first-touches system_
     ParticleSystem system_;
     Lattice lattice_;
     std::unique_ptr<VelocityVerlet> integrator_;
     std::unique_ptr<ForceField> force_field_;
     std::unique_ptr<NeighborForceField> neighbor_force_field_;
     std::shared_ptr<Thermostat> thermostat_;
+    std::unique_ptr<DeviceSimulation> device_;  // backend == Device: holds the MD state instead
 
     // State (MD only)
-    Real last_epot_{0.0};
+    mutable Real last_epot_{0.0};
+    mutable bool epot_valid_{false};  // last_epot_ matches current positions
     StepCallback step_callback_;
+    Observables observables_;
+    std::unique_ptr<SkinTuner> skin_tuner_;  // neighbor_skin_auto with a neighbor list
+    StepStats stats_;
+    std::size_t stats_step_base_{0};  // step_count() at the last reset_stats()
 
-    void compute_forces();
+    /// Returns the time spent rebuilding the neighbor list [ns]. A shell pass
+    /// leaves that shell's energy in last_epot_ (not marked valid).
+    std::uint64_t compute_forces(bool with_energy = true, ForceShell shell = ForceShell::All,
+                                 PairSampler* sampler = nullptr);
+    RespaIntegrator* respa_integrator() const;  // integrator_ if it is one
+    void apply_shell_switch();                   // integrator split -> neighbor force field
+    /// Verlet or r-RESPA part of step(); false on a failed fused check.
+    bool integrate_verlet(PhaseTimer& timer, bool energy_due, bool fused, PairSampler* sampler,
+                          KineticProfile* profile);
+    bool integrate_respa(RespaIntegrator& respa, PhaseTimer& timer, bool energy_due, bool fused,
+                         KineticProfile* profile);
+    void tune_skin(std::uint64_t force_ns, bool rebuilt);
+    bool health_check_due() const;  // full scan this step (not Fused)
 };
 
 }  // namespace matsimu
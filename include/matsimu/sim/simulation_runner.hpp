@@ -0,0 +1,62 @@
+#pragma once
+
+#include <matsimu/sim/frame_exchange.hpp>
+#include <matsimu/sim/simulation.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+namespace matsimu {
+
+/**
+ * Steps a Simulation on a dedicated worker thread and publishes render
+ * frames into a FrameExchange.
+ *
+ * The worker advances in chunks of steps_per_chunk (heat models fuse them
+ * into one grid pass) as fast as it can, and captures a frame whenever
+ * frame_interval has passed, plus one final frame when the run ends. The
+ * GUI polls finished() and frames.latest(); it never touches the
+ * Simulation while the runner is active. stop() (or the destructor) asks
+ * the worker to exit after its current chunk and joins it, after which the
+ * Simulation may be used from the caller's thread again.
+ */
+class SimulationRunner {
+public:
+    SimulationRunner(Simulation& sim, FrameExchange& frames,
+                     std::size_t steps_per_chunk = 10,
+                     std::chrono::microseconds frame_interval = std::chrono::microseconds(16000));
+    ~SimulationRunner();
+
+    SimulationRunner(const SimulationRunner&) = delete;
+    SimulationRunner& operator=(const SimulationRunner&) = delete;
+
+    /// Start the worker thread (no-op if already started).
+    void start();
+    /// Request exit after the current chunk and join. Idempotent.
+    void stop();
+
+    /// True once the simulation ended by itself (end time, max steps, error).
+    bool finished() const { return finished_.load(std::memory_order_acquire); }
+    /// Steps taken by the worker so far.
+    std::size_t steps() const { return steps_.load(std::memory_order_relaxed); }
+    /// Exception message if a step threw (read after stop() / finished()).
+    const std::string& error() const { return error_; }
+
+private:
+    Simulation& sim_;
+    FrameExchange& frames_;
+    std::size_t steps_per_chunk_;
+    std::chrono::microseconds frame_interval_;
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> finished_{false};
+    std::atomic<std::size_t> steps_{0};
+    std::string error_;
+
+    void run();
+    void publish();
+};
+
+}  // namespace matsimu
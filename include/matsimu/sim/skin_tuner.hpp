@@ -0,0 +1,63 @@
+#pragma once
+
+#include <matsimu/core/types.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace matsimu {
+
+/**
+ * Run-time Verlet skin tuning (SimulationParams::neighbor_skin_auto).
+ *
+ * Each force evaluation reports its wall time and whether it rebuilt the
+ * list. Over a window of rebuilds the tuner estimates
+ *   f = cost of a step without rebuild, b = extra cost of a rebuild,
+ *   I = steps between rebuilds,
+ * and models a candidate skin s' against the current s with
+ *   g(s') = ((rc + s') / (rc + s))³        (pair count, force and build work)
+ *   cost(s') = g·f + g·b / (I · s' / s)    (rebuild interval ∝ skin)
+ * picking the cheapest of s·2^(k/4), k = -4..4, within [min_skin, max_skin].
+ * A new skin is returned only when it is predicted to save at least 2 %;
+ * the caller then applies it and invalidates the list. The rebuild that
+ * invalidation forces is not recorded: it says nothing about the interval.
+ */
+class SkinTuner {
+public:
+    /// Defaults bound the skin to [0.05, 0.6]·cutoff.
+    SkinTuner(Real cutoff, Real skin, Real min_skin = 0, Real max_skin = 0);
+
+    /// Record one force evaluation; returns the new skin when it should change
+    /// (the caller must then invalidate the list).
+    std::optional<Real> record(std::uint64_t ns, bool rebuilt);
+
+    Real skin() const { return skin_; }
+    Real min_skin() const { return min_skin_; }
+    Real max_skin() const { return max_skin_; }
+    std::size_t adjustments() const { return adjustments_; }
+
+    static constexpr std::size_t kWindowRebuilds = 4;   ///< Rebuilds per estimate
+    static constexpr std::size_t kMaxWindowSteps = 400;  ///< Estimate anyway after this many steps
+
+    /// Monotonic clock [ns] used for the measurements (independent of core/profile.hpp).
+    static std::uint64_t clock_ns();
+
+private:
+    Real cutoff_;
+    Real skin_;
+    Real min_skin_;
+    Real max_skin_;
+    std::size_t adjustments_{0};
+
+    // Current window
+    std::size_t steps_{0};
+    std::size_t rebuilds_{0};
+    std::uint64_t plain_ns_{0};
+    std::uint64_t rebuild_ns_{0};
+    double last_build_extra_{0};  // b from the last window that saw a rebuild [ns]
+    bool skip_forced_rebuild_{false};  // skin just changed: next rebuild is the caller's
+
+    void reset_window();
+};
+
+}  // namespace matsimu
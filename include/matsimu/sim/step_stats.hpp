@@ -0,0 +1,88 @@
+#pragma once
+
+#include <matsimu/core/profile.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace matsimu {
+
+/// Phases of one MD step, in execution order.
+enum class StepPhase {
+    Integrate1,   ///< Velocity Verlet half kick + drift (step1)
+    Boundary,     ///< apply_pbc
+    Neighbor,     ///< Neighbor list rebuilds (and spatial sorts)
+    Forces,       ///< Force evaluation (excluding rebuilds)
+    Integrate2,   ///< Second half kick (step2)
+    Thermostat,
+    HealthCheck,  ///< Separate finiteness scan (folded into Integrate1/2 when fused)
+    Count
+};
+
+constexpr std::size_t kStepPhaseCount = static_cast<std::size_t>(StepPhase::Count);
+
+/// Short lower-case phase name ("integrate1", "forces", ...).
+const char* step_phase_name(StepPhase phase);
+
+/**
+ * Counters returned by Simulation::stats().
+ *
+ * phase_ns is filled only for MD runs with SimulationParams::profile set
+ * (and not compiled out, see core/profile.hpp). The other fields are always
+ * maintained. Byte counts are for the particle arrays' bounded_allocator
+ * (including the neighbor list scratch arena charged to it).
+ */
+struct StepStats {
+    std::array<std::uint64_t, kStepPhaseCount> phase_ns{};  ///< Cumulative time per phase [ns]
+    std::size_t steps{0};                 ///< Steps since construction or reset_stats()
+    std::size_t neighbor_rebuilds{0};     ///< Neighbor list builds (incl. the initial one)
+    std::size_t neighbor_pairs{0};        ///< Sum of pair counts over those builds
+    double neighbor_skin{0};              ///< Current Verlet skin [m] (0 without a neighbor list)
+    std::size_t skin_adjustments{0};      ///< Skin changes by the auto-tuner
+    std::size_t particle_sorts{0};        ///< Morton reorders (SimulationParams::sort_interval)
+    std::size_t bytes_in_use{0};
+    std::size_t peak_bytes{0};            ///< High-water mark since the system was created
+    std::size_t max_bytes{0};             ///< Budget
+
+    std::uint64_t ns(StepPhase phase) const { return phase_ns[static_cast<std::size_t>(phase)]; }
+    std::uint64_t total_ns() const {
+        std::uint64_t t = 0;
+        for (std::uint64_t v : phase_ns) t += v;
+        return t;
+    }
+    double average_pairs_per_rebuild() const {
+        return neighbor_rebuilds ? static_cast<double>(neighbor_pairs) / neighbor_rebuilds : 0.0;
+    }
+};
+
+/// Charges elapsed time to consecutive phases; no clock reads when disabled.
+class PhaseTimer {
+public:
+    PhaseTimer(StepStats& stats, bool enabled)
+        : stats_(stats), enabled_(kProfileCompiled && enabled),
+          last_(enabled_ ? profile_clock_ns() : 0) {}
+
+    bool enabled() const { return enabled_; }
+
+    /// Add the time since the previous mark (or construction) to phase.
+    void mark(StepPhase phase) {
+        if (!enabled_) return;
+        const std::uint64_t now = profile_clock_ns();
+        stats_.phase_ns[static_cast<std::size_t>(phase)] += now - last_;
+        last_ = now;
+    }
+
+    /// Re-attribute ns already charged to from (e.g. a rebuild inside forces).
+    void transfer(StepPhase from, StepPhase to, std::uint64_t ns) {
+        if (!enabled_) return;
+        stats_.phase_ns[static_cast<std::size_t>(from)] -= ns;
+        stats_.phase_ns[static_cast<std::size_t>(to)] += ns;
+    }
+
+private:
+    StepStats& stats_;
+    bool enabled_;
+    std::uint64_t last_;
+};
+
+}  // namespace matsimu
@@ -17,7 +17,9 @@ class Simulation;
 /**
  * Main application window: menu bar, tabbed central area, status bar.
  * Owns all UI controllers and views; does not modify simulation/lattice logic.
- * Uses timer-based simulation stepping to keep UI responsive.
+ * Steps the simulation on a SimulationRunner worker thread; a UI timer only
+ * picks up the latest published frame, so rendering and stepping never wait
+ * on each other.
  */
 class MainWindow : public QMainWindow {
   Q_OBJECT
@@ -36,7 +38,7 @@ class MainWindow : public QMainWindow {
   void on_reset();
   void on_about();
   void update_status(const QString& text);
-  void on_simulation_timer();  ///< Timer callback for non-blocking simulation steps
+  void on_simulation_timer();  ///< Timer callback: show the newest frame, detect run end
   void finish_simulation();    ///< Clean up after simulation completes
 
  private:
@@ -6,16 +6,24 @@
 #include <QWheelEvent>
 #include <matsimu/core/types.hpp>
 #include <matsimu/lattice/lattice.hpp>
-#include <matsimu/physics/particle.hpp>
+#include <matsimu/sim/frame_exchange.hpp>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 namespace matsimu {
 
+class View3DRenderer;
+
 /**
- * 3D OpenGL view: draws lattice unit cell (axes + box) and particle system.
- * Read-only use of Lattice and ParticleSystem; no modification of simulation state.
+ * 3D OpenGL view: draws lattice unit cell (axes + box) and the latest SimFrame
+ * (particles or 2D temperature heatmap). Frames are shared immutable snapshots
+ * from a FrameExchange; the view keeps a reference, never a copy.
+ *
+ * Drawing goes through View3DRenderer (VBO point sprites, heat-map texture)
+ * when the context supports GLSL 1.20; otherwise, or with the environment
+ * variable MATSIMU_GL_IMMEDIATE set, the immediate-mode path is used.
  */
 class View3D : public QOpenGLWidget, protected QOpenGLFunctions {
    Q_OBJECT
@@ -26,11 +34,11 @@ class View3D : public QOpenGLWidget, protected QOpenGLFunctions {
    /// Set lattice to visualize (copy; thread-safe from UI thread).
    void set_lattice(const Lattice& lat);
 
-   /// Set particle system to visualize (stores shared_ptr, thread-safe if system is not modified during render).
-   void set_particle_system(std::shared_ptr<const ParticleSystem> system);
+   /// Show frame (particles or temperature field); held until the next frame.
+   void set_frame(std::shared_ptr<const SimFrame> frame);
 
-   /// Clear particle system reference.
-   void clear_particle_system();
+   /// Drop the frame (back to lattice-only view).
+   void clear_frame();
 
    /// Optional: set scale for view (e.g. from config).
    void set_scale(Real scale);
@@ -44,15 +52,6 @@ class View3D : public QOpenGLWidget, protected QOpenGLFunctions {
    /// Enable/disable lattice cell rendering.
    void set_show_lattice(bool show);
 
-   /// Set a 2D temperature field for heatmap visualization.
-   /// T: row-major temperature array (size nx*ny), T_cold/T_hot: fixed colormap bounds.
-   void set_temperature_field(const std::vector<Real>& T,
-                              std::size_t nx, std::size_t ny,
-                              Real T_cold, Real T_hot);
-
-   /// Clear the temperature field (switch back to particle/lattice view).
-   void clear_temperature_field();
-
    /// Update simulation state used for live 3D feedback while running.
    void set_simulation_state(bool running, Real time_s, Real end_time_s, std::size_t step_count);
 
@@ -75,8 +74,14 @@ class View3D : public QOpenGLWidget, protected QOpenGLFunctions {
    void draw_temperature_field();
    static void colormap_thermal(float t, float& r, float& g, float& b);
 
+   bool has_particles() const;
+   bool has_field() const;
+
    Lattice lattice_;
-   std::shared_ptr<const ParticleSystem> particle_system_;
+   std::shared_ptr<const SimFrame> frame_;
+   std::unique_ptr<View3DRenderer> renderer_;  // null = immediate-mode fallback
+   std::uint64_t frame_serial_{0};     // bumped by set_frame()
+   std::uint64_t uploaded_serial_{0};  // frame_serial_ last uploaded to renderer_
    Real scale_{1.0};   // display scale: lattice (m) * scale_ = GL coords
    float particle_radius_{0.08f};
    bool show_particles_{true};
@@ -85,12 +90,6 @@ class View3D : public QOpenGLWidget, protected QOpenGLFunctions {
    Real sim_time_{0.0};
    Real sim_end_time_{0.0};
    std::size_t sim_step_count_{0};
-   // Temperature field (2D heatmap)
-   std::vector<Real> temp_field_;
-   std::size_t temp_nx_{0};
-   std::size_t temp_ny_{0};
-   Real temp_T_cold_{0.0};
-   Real temp_T_hot_{1.0};
 
    float rot_x_{0.f};
    float rot_y_{0.f};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QOpenGLBuffer>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <matsimu/sim/frame_exchange.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace matsimu {
+
+/**
+ * Buffer-object renderer behind View3D (GLSL 1.20, GL 2.1 compatibility).
+ *
+ * Particles: one persistent VBO of {x, y, z, heat} per atom, refilled with
+ *            glBufferSubData when a new frame arrives and drawn with a single
+ *            glDrawArrays(GL_POINTS) as shaded point sprites.
+ * Field2D:   the temperature field is uploaded as a 16-bit luminance texture
+ *            (normalized to [T_cold, T_hot]) and one textured quad applies
+ *            the thermal colormap in the fragment shader; linear filtering
+ *            gives the same smooth gradient as the per-vertex path.
+ *
+ * GL 2.1 has no instanced arrays, so "one instance per atom" is a point
+ * sprite per vertex. initialize() returns false when the context cannot
+ * compile the shaders; View3D then keeps its immediate-mode path. All calls
+ * need the owning widget's context current.
+ */
+class View3DRenderer : protected QOpenGLFunctions {
+ public:
+  View3DRenderer() = default;
+  ~View3DRenderer();
+  View3DRenderer(const View3DRenderer&) = delete;
+  View3DRenderer& operator=(const View3DRenderer&) = delete;
+
+  /// Compile shaders and create buffers; false = use the fallback path.
+  bool initialize();
+
+  /// Refill the particle VBO from frame (positions in metres, speed colour).
+  void upload_particles(const SimFrame& frame);
+  /// Draw uploaded particles at (pos - center) * scale, point_size in pixels.
+  void draw_particles(const float center[3], float scale, float point_size);
+
+  /// Upload frame.field as the heat-map texture (reallocated on size change).
+  void upload_field(const SimFrame& frame);
+  /// Draw the heat map on the [-1, 1]² quad at z = 0.
+  void draw_field();
+
+ private:
+  QOpenGLShaderProgram particle_program_;
+  QOpenGLShaderProgram field_program_;
+  QOpenGLBuffer particle_vbo_{QOpenGLBuffer::VertexBuffer};
+  QOpenGLBuffer quad_vbo_{QOpenGLBuffer::VertexBuffer};
+  std::vector<float> particle_staging_;
+  std::vector<std::uint16_t> field_staging_;
+  std::size_t particle_capacity_{0};  // bytes allocated in particle_vbo_
+  std::size_t particle_count_{0};     // finite atoms in the last upload
+  GLuint field_texture_{0};
+  std::size_t texture_nx_{0};
+  std::size_t texture_ny_{0};
+  bool ready_{false};
+};
+
+}  // namespace matsimu
@@ -2,10 +2,10 @@
 
 #include <QWidget>
 #include <cstddef>
-#include <vector>
+#include <memory>
 #include <matsimu/core/types.hpp>
 #include <matsimu/lattice/lattice.hpp>
-#include <matsimu/physics/particle.hpp>
+#include <matsimu/sim/frame_exchange.hpp>
 
 class QLabel;
 class QPushButton;
@@ -24,12 +24,9 @@ class View3DTab : public QWidget {
   ~View3DTab() override;
 
   void set_lattice(const Lattice& lat);
-  void set_particles(const ParticleSystem& system);
-  void clear_particles();
-  void set_temperature_field(const std::vector<Real>& T,
-                             std::size_t nx, std::size_t ny,
-                             Real T_cold, Real T_hot);
-  void clear_temperature_field();
+  /// Show the latest frame from a FrameExchange (shared, not copied).
+  void set_frame(std::shared_ptr<const SimFrame> frame);
+  void clear_frame();
   void set_simulation_state(bool running, Real time_s, Real end_time_s, std::size_t step_count);
 
  private:
@@ -2,7 +2,7 @@
 #
 # MATSIMU single entry point: dependencies, compile, run.
 # Default (no options): opens the desktop GUI and runs the main engine (Qt 6 if available).
-# Usage: ./run.sh [--clean] [--debug] [--example NAME] [--test] [--] [args...]
+# Usage: ./run.sh [--clean] [--debug] [--single] [--example NAME] [--test] [--bench] [--] [args...]
 #
 set -euo pipefail
 
@@ -10,9 +10,11 @@ SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
 BUILD_DIR="${SCRIPT_DIR}/build"
 BINARY="${BUILD_DIR}/matsimu"
 TEST_BINARY="${BUILD_DIR}/matsimu_test"
+BENCH_BINARY="${BUILD_DIR}/matsimu_bench"
 INCLUDE_DIR="${SCRIPT_DIR}/include"
 SRC_DIR="${SCRIPT_DIR}/src"
 TESTS_DIR="${SCRIPT_DIR}/tests"
+BENCH_DIR="${SCRIPT_DIR}/bench"
 INCLUDE_UI="${INCLUDE_DIR}/matsimu/ui"
 
 show_usage() {
@@ -24,16 +26,23 @@ show_usage() {
   echo "Options:"
   echo "  --clean         Remove build directory and exit"
   echo "  --debug         Build with debug symbols (default: release)"
-  echo "  --example NAME  Run the specified example (lattice, heat)"
+  echo "  --single        Default the LJ and heat kernels to mixed single precision"
+  echo "  --example NAME  Run the specified example (lattice, heat, distributed, distributed-heat, device)"
   echo "  --test          Build and run C++ tests (unit + integration), then exit"
+  echo "  --bench         Build and run micro-benchmarks (CSV; pass -- --json or -- --quick), then exit"
   echo "  -h, --help      Show this help message"
+  echo ""
+  echo "Environment: MATSIMU_USE_MPI=1 builds with mpicxx (run with mpirun -np N build/matsimu --example distributed)"
+  echo "             MATSIMU_USE_OFFLOAD=1 builds with OpenMP target offload (device backend; extra flags in MATSIMU_OFFLOAD_FLAGS)"
   exit 0
 }
 
 # Defaults
 BUILD_TYPE="release"
+PRECISION="double"
 RUN_EXAMPLE=""
 RUN_TEST=false
+RUN_BENCH=false
 CLEAN=false
 
 # CLI parsing
@@ -41,8 +50,10 @@ while [[ $# -gt 0 ]]; do
   case "$1" in
     --clean)    CLEAN=true; shift ;;
     --debug)   BUILD_TYPE="debug"; shift ;;
+    --single)  PRECISION="single"; shift ;;
     --example) RUN_EXAMPLE="${2:-}"; shift 2 ;;
     --test)    RUN_TEST=true; shift ;;
+    --bench)   RUN_BENCH=true; shift ;;
     -h|--help) show_usage ;;
     --)        shift; break ;;
     *)         break ;;
@@ -56,22 +67,63 @@ if [[ "$CLEAN" == true ]]; then
 fi
 
 # Compiler and Flags
+# MATSIMU_USE_MPI=1 builds with mpicxx for multi-node runs (DistributedSimulation);
+# start with e.g. mpirun -np 8 build/matsimu --example distributed.
+if [[ "${MATSIMU_USE_MPI:-0}" == "1" ]]; then
+  if ! command -v mpicxx &>/dev/null; then
+    echo "Error: MATSIMU_USE_MPI=1 but mpicxx not found. Install with: sudo apt install libopenmpi-dev" >&2
+    exit 1
+  fi
+  CXX="mpicxx"
+fi
 CXX="${CXX:-g++}"
 if ! command -v "$CXX" &>/dev/null; then
   echo "Error: C++ compiler '$CXX' not found. Install with: sudo apt install build-essential" >&2
   exit 1
 fi
 
-CXXFLAGS="-Wall -Wextra"
+CXXFLAGS="-Wall -Wextra -pthread"
 if [[ "$BUILD_TYPE" == "debug" ]]; then
   CXXFLAGS+=" -g -O0 -DDEBUG"
 else
   CXXFLAGS+=" -O2 -DNDEBUG"
 fi
+if [[ "$PRECISION" == "single" ]]; then
+  CXXFLAGS+=" -DMATSIMU_SINGLE_PRECISION"
+fi
+if [[ "${MATSIMU_USE_MPI:-0}" == "1" ]]; then
+  CXXFLAGS+=" -DMATSIMU_USE_MPI"
+fi
+# MATSIMU_USE_OFFLOAD=1 compiles the device kernels as OpenMP target regions
+# (DeviceSimulation, heat backend=device); without it they run as host loops.
+# Target-specific flags go in MATSIMU_OFFLOAD_FLAGS, e.g. -foffload=nvptx-none.
+if [[ "${MATSIMU_USE_OFFLOAD:-0}" == "1" ]]; then
+  CXXFLAGS+=" -fopenmp -DMATSIMU_USE_OFFLOAD ${MATSIMU_OFFLOAD_FLAGS:-}"
+fi
+# Optional zlib for compressed trajectories; MATSIMU_USE_ZLIB=0 disables.
+LDLIBS=""
+if [[ "${MATSIMU_USE_ZLIB:-1}" != "0" ]] && echo '#include <zlib.h>' | "$CXX" -x c++ -fsyntax-only - &>/dev/null; then
+  CXXFLAGS+=" -DMATSIMU_USE_ZLIB"
+  LDLIBS="-lz"
+fi
 
 # Sources: Automate discovery
 SOURCES=($(find "${SRC_DIR}" -maxdepth 2 -name "*.cpp" ! -path "*/ui/*"))
 
+if [[ "$RUN_BENCH" == true ]]; then
+  # Benchmark binary: all lib sources (no main, no UI) + bench driver.
+  # Runs before Qt detection so stdout carries only the CSV/JSON records.
+  mkdir -p "$BUILD_DIR"
+  LIB_SOURCES=($(find "${SRC_DIR}" -maxdepth 2 -name "*.cpp" ! -path "*/ui/*" ! -name "main.cpp"))
+  echo "Compiling benchmarks (${BUILD_TYPE})..." >&2
+  if ! "$CXX" $CXXFLAGS -I"$INCLUDE_DIR" -std=c++17 "${LIB_SOURCES[@]}" "${BENCH_DIR}/bench_main.cpp" -o "$BENCH_BINARY" $LDLIBS; then
+    echo "Benchmark build failed." >&2
+    exit 1
+  fi
+  echo "Running benchmarks..." >&2
+  exec "$BENCH_BINARY" "$@"
+fi
+
 # Qt 6 UI Detection (requires >= 6.2; all APIs used are available since 6.2)
 USE_QT=""
 QT_LIBS=""
@@ -245,7 +297,7 @@ if [[ "$RUN_TEST" == true ]]; then
     TEST_SOURCES+=("${TESTS_DIR}/test_main.cpp")
   fi
   echo "Compiling tests (${BUILD_TYPE})..."
-  if ! "$CXX" $CXXFLAGS -I"$INCLUDE_DIR" -std=c++17 "${TEST_SOURCES[@]}" -o "$TEST_BINARY"; then
+  if ! "$CXX" $CXXFLAGS -I"$INCLUDE_DIR" -std=c++17 "${TEST_SOURCES[@]}" -o "$TEST_BINARY" $LDLIBS; then
     echo "Test build failed." >&2
     exit 1
   fi
@@ -257,7 +309,7 @@ echo "Compiling (${BUILD_TYPE})..."
 COMPILE_CMD=("$CXX" $CXXFLAGS -I"$INCLUDE_DIR" -std=c++17 "${SOURCES[@]}" -o "$BINARY")
 [[ -n "$USE_QT" ]] && COMPILE_CMD+=("-fPIC")
 
-if ! "${COMPILE_CMD[@]}" $QT_LIBS; then
+if ! "${COMPILE_CMD[@]}" $QT_LIBS $LDLIBS; then
   echo "Compilation failed." >&2
   exit 1
 fi
@@ -0,0 +1,69 @@
+#include <matsimu/alloc/arena.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace matsimu {
+
+Arena::Arena(std::size_t capacity, bool huge_pages) : huge_pages_(huge_pages) {
+    if (capacity > 0) reserve(capacity);
+}
+
+Arena::~Arena() { free_region(); }
+
+void Arena::free_region() noexcept {
+    if (budget_) budget_->refund(capacity_);
+    std::free(base_);
+    base_ = nullptr;
+    capacity_ = 0;
+}
+
+bool Arena::reserve(std::size_t bytes) {
+    if (bytes <= capacity_) return true;
+    if (top_ != 0) return false;
+    std::size_t size = std::max(bytes, capacity_ + capacity_ / 2);
+    const std::size_t align = huge_pages_ ? kHugePageBytes : std::size_t(64);
+    size = (size + align - 1) / align * align;
+    free_region();  // empty, so nothing to copy; frees the budget for the new region
+    if (budget_) budget_->charge(size);
+    void* p = std::aligned_alloc(align, size);
+    if (!p) {
+        if (budget_) budget_->refund(size);
+        throw std::bad_alloc();
+    }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (huge_pages_) madvise(p, size, MADV_HUGEPAGE);  // advisory: falls back to 4 KiB pages
+#endif
+    base_ = static_cast<char*>(p);
+    capacity_ = size;
+    ++regions_;
+    return true;
+}
+
+bool Arena::set_budget(std::shared_ptr<bounded_allocator_state> budget) {
+    if (budget == budget_) return true;
+    if (top_ != 0) return false;
+    free_region();
+    budget_ = std::move(budget);
+    return true;
+}
+
+void* Arena::allocate(std::size_t bytes, std::size_t align) {
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(base_);
+    const std::uintptr_t start = (base + top_ + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+    const std::size_t offset = static_cast<std::size_t>(start - base);
+    if (!base_ || offset > capacity_ || bytes > capacity_ - offset) throw std::bad_alloc();
+    top_ = offset + bytes;
+    peak_ = std::max(peak_, top_);
+    return base_ + offset;
+}
+
+void Arena::deallocate(void* p, std::size_t bytes) noexcept {
+    char* c = static_cast<char*>(p);
+    if (c && c + bytes == base_ + top_) top_ = static_cast<std::size_t>(c - base_);
+}
+
+}  // namespace matsimu
@@ -0,0 +1,57 @@
+#include <matsimu/alloc/placement.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
+#include <cstdlib>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace matsimu {
+
+namespace {
+
+constexpr std::size_t kSmallPageBytes = 4096;
+
+}  // namespace
+
+void* placement_allocate(std::size_t bytes, const MemoryPlacement* policy) {
+    if (!policy || !policy->placed(bytes)) return ::operator new(bytes);
+
+    const std::size_t page = policy->huge_pages ? MemoryPlacement::kHugePageBytes : kSmallPageBytes;
+    const std::size_t size = (bytes + page - 1) / page * page;
+    void* p = std::aligned_alloc(page, size);
+    if (!p) throw std::bad_alloc();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (policy->huge_pages) madvise(p, size, MADV_HUGEPAGE);  // advisory
+#endif
+    if (ThreadPool* pool = policy->first_touch.get()) {
+        // Chunk t (in whole pages) is faulted in by thread t.
+        char* base = static_cast<char*>(p);
+        const std::size_t pages = size / page;
+        const std::size_t parts = pool->size();
+        pool->run([&](std::size_t tid) {
+            const std::size_t end = pages * (tid + 1) / parts;
+            for (std::size_t k = pages * tid / parts; k < end; ++k)
+                for (std::size_t off = 0; off < page; off += kSmallPageBytes)
+                    base[k * page + off] = 0;
+        });
+    }
+    return p;
+}
+
+void placement_deallocate(void* p, std::size_t bytes, const MemoryPlacement* policy) noexcept {
+    if (!p) return;
+    if (!policy || !policy->placed(bytes)) ::operator delete(p);
+    else std::free(p);
+}
+
+std::shared_ptr<const MemoryPlacement> make_memory_placement(bool huge_pages, bool first_touch,
+                                                             std::shared_ptr<ThreadPool> pool) {
+    if (!huge_pages && !(first_touch && pool && pool->size() > 1)) return nullptr;
+    auto policy = std::make_shared<MemoryPlacement>();
+    policy->huge_pages = huge_pages;
+    if (first_touch && pool && pool->size() > 1) policy->first_touch = std::move(pool);
+    return policy;
+}
+
+}  // namespace matsimu
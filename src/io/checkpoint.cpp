@@ -0,0 +1,332 @@
+#include <matsimu/io/checkpoint.hpp>
+#include <matsimu/io/mapped_file.hpp>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <vector>
+
+namespace matsimu {
+
+namespace {
+
+constexpr char kMagic[8] = {'M', 'A', 'T', 'S', 'C', 'K', 'P', 'T'};
+
+enum class Tag : std::uint32_t { Lattice = 1, Particles = 2, Thermostat = 3, Field = 4, ParticleIds = 5 };
+
+struct FileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t mode;
+  std::uint32_t real_bytes;
+  std::uint32_t reserved;
+  Real time;
+  std::uint64_t step_count;
+};
+
+struct RecordHeader {
+  std::uint32_t tag;
+  std::uint32_t reserved;
+  std::uint64_t bytes;
+};
+
+std::uint64_t padded(std::uint64_t n) { return (n + 7) & ~std::uint64_t(7); }
+
+/// Unformatted writes; remembers the first failure.
+class Writer {
+ public:
+  explicit Writer(std::FILE* f) : f_(f) {}
+  bool ok() const { return ok_; }
+
+  void raw(const void* p, std::size_t n) {
+    if (ok_ && n > 0 && std::fwrite(p, 1, n, f_) != n) ok_ = false;
+  }
+  void begin(Tag tag, std::uint64_t bytes) {
+    const RecordHeader h{static_cast<std::uint32_t>(tag), 0, bytes};
+    raw(&h, sizeof(h));
+    pad_ = padded(bytes) - bytes;
+  }
+  void end() {
+    static const char zeros[8] = {};
+    raw(zeros, pad_);
+  }
+
+ private:
+  std::FILE* f_;
+  std::uint64_t pad_{0};
+  bool ok_{true};
+};
+
+constexpr std::size_t kParticleArrays = 10;  // pos, vel, force (x/y/z each), mass
+
+FileHeader make_header(SimMode mode, Real time, std::uint64_t step_count) {
+  FileHeader h{};
+  std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.version = kCheckpointVersion;
+  h.mode = static_cast<std::uint32_t>(mode);
+  h.real_bytes = sizeof(Real);
+  h.time = time;
+  h.step_count = step_count;
+  return h;
+}
+
+void write_lattice(Writer& w, const Lattice& lat) {
+  w.begin(Tag::Lattice, 9 * sizeof(Real));
+  w.raw(lat.a1, sizeof(lat.a1));
+  w.raw(lat.a2, sizeof(lat.a2));
+  w.raw(lat.a3, sizeof(lat.a3));
+  w.end();
+}
+
+void write_particles(Writer& w, const ParticleSystem& ps) {
+  const std::uint64_t n = ps.size();
+  const std::size_t array_bytes = ps.size() * sizeof(Real);
+  w.begin(Tag::Particles, sizeof(n) + kParticleArrays * array_bytes);
+  w.raw(&n, sizeof(n));
+  for (int d = 0; d < 3; ++d) w.raw(ps.pos(d), array_bytes);
+  for (int d = 0; d < 3; ++d) w.raw(ps.vel(d), array_bytes);
+  for (int d = 0; d < 3; ++d) w.raw(ps.force(d), array_bytes);
+  w.raw(ps.masses(), array_bytes);
+  w.end();
+}
+
+/// Write the header and write_records(w) to path.tmp, then rename it over path.
+template <typename WriteRecords>
+CheckpointResult write_file(const std::string& path, const FileHeader& h,
+                            WriteRecords write_records) {
+  const std::string tmp = path + ".tmp";
+  std::FILE* f = std::fopen(tmp.c_str(), "wb");
+  if (!f) return CheckpointResult::failure("Cannot open checkpoint file for writing: " + tmp);
+  Writer w(f);
+  w.raw(&h, sizeof(h));
+  write_records(w);
+  const bool closed = std::fclose(f) == 0;
+  if (!w.ok() || !closed) {
+    std::remove(tmp.c_str());
+    return CheckpointResult::failure("Error writing checkpoint file: " + tmp);
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::remove(tmp.c_str());
+    return CheckpointResult::failure("Cannot move checkpoint into place: " + path);
+  }
+  return CheckpointResult::success();
+}
+
+/// Check magic, version and Real size; h receives the header.
+CheckpointResult read_header(const MappedFile& file, const std::string& path, FileHeader& h) {
+  if (!file.data()) return CheckpointResult::failure("Cannot open checkpoint file: " + path);
+  if (file.size() < sizeof(FileHeader))
+    return CheckpointResult::failure("Checkpoint file is truncated: " + path);
+  std::memcpy(&h, file.data(), sizeof(h));
+  if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0)
+    return CheckpointResult::failure("Not a checkpoint file: " + path);
+  if (h.version != kCheckpointVersion)
+    return CheckpointResult::failure("Unsupported checkpoint version " + std::to_string(h.version));
+  if (h.real_bytes != sizeof(Real))
+    return CheckpointResult::failure("Checkpoint was written with a different Real size");
+  return CheckpointResult::success();
+}
+
+/// Call on_record(tag, payload, bytes) for every record after the header;
+/// stops at the first failure it returns.
+template <typename OnRecord>
+CheckpointResult for_each_record(const MappedFile& file, OnRecord on_record) {
+  const char* p = file.data() + sizeof(FileHeader);
+  const char* const end = file.data() + file.size();
+  while (p != end) {
+    RecordHeader rec;
+    if (static_cast<std::size_t>(end - p) < sizeof(rec))
+      return CheckpointResult::failure("Checkpoint record header is truncated");
+    std::memcpy(&rec, p, sizeof(rec));
+    p += sizeof(rec);
+    if (padded(rec.bytes) > static_cast<std::uint64_t>(end - p))
+      return CheckpointResult::failure("Checkpoint record is truncated");
+    const char* payload = p;
+    p += padded(rec.bytes);
+    CheckpointResult r = on_record(static_cast<Tag>(rec.tag), payload, rec.bytes);
+    if (!r.ok) return r;
+  }
+  return CheckpointResult::success();
+}
+
+/// Lattice record payload into lat.
+void read_lattice(const char* payload, Lattice& lat) {
+  std::memcpy(lat.a1, payload, sizeof(lat.a1));
+  std::memcpy(lat.a2, payload + sizeof(lat.a1), sizeof(lat.a2));
+  std::memcpy(lat.a3, payload + sizeof(lat.a1) + sizeof(lat.a2), sizeof(lat.a3));
+}
+
+/// Particles record into ps (forces only if with_forces); false on a size mismatch.
+bool read_particles(const char* payload, std::uint64_t bytes, ParticleSystem& ps, bool with_forces) {
+  std::uint64_t n = 0;
+  if (bytes >= sizeof(n)) std::memcpy(&n, payload, sizeof(n));
+  const std::size_t array_bytes = static_cast<std::size_t>(n) * sizeof(Real);
+  if (bytes < sizeof(n) || n > (bytes - sizeof(n)) / sizeof(Real)
+      || bytes != sizeof(n) + kParticleArrays * array_bytes)
+    return false;
+  ps.resize(static_cast<std::size_t>(n));
+  const char* a = payload + sizeof(n);
+  for (int d = 0; d < 3; ++d, a += array_bytes) std::memcpy(ps.pos(d), a, array_bytes);
+  for (int d = 0; d < 3; ++d, a += array_bytes) std::memcpy(ps.vel(d), a, array_bytes);
+  for (int d = 0; d < 3; ++d, a += array_bytes)
+    if (with_forces) std::memcpy(ps.force(d), a, array_bytes);
+  std::vector<Real> mass(ps.size());
+  std::memcpy(mass.data(), a, array_bytes);
+  ps.set_masses(mass.data());
+  return true;
+}
+
+}  // namespace
+
+CheckpointResult save_checkpoint(const Simulation& sim, const std::string& path) {
+  if (!sim.is_valid())
+    return CheckpointResult::failure("Cannot checkpoint an invalid simulation: " + sim.error_message());
+  const FileHeader h = make_header(sim.mode(), sim.time(), sim.step_count());
+  return write_file(path, h, [&](Writer& w) {
+    if (sim.mode() == SimMode::MD) {
+      write_lattice(w, *sim.lattice());
+      const ParticleSystem& ps = sim.system();
+      write_particles(w, ps);
+
+      if (ps.reordered()) {
+        std::vector<std::uint32_t> ids(ps.size());
+        for (std::size_t i = 0; i < ids.size(); ++i) ids[i] = ps.id(i);
+        w.begin(Tag::ParticleIds, ids.size() * sizeof(std::uint32_t));
+        w.raw(ids.data(), ids.size() * sizeof(std::uint32_t));
+        w.end();
+      }
+
+      if (const Thermostat* therm = sim.thermostat()) {
+        const std::string state = therm->save_state();
+        if (!state.empty()) {
+          w.begin(Tag::Thermostat, state.size());
+          w.raw(state.data(), state.size());
+          w.end();
+        }
+      }
+    }
+
+    for (const StateBuffer& buf : sim.model_state_buffers()) {
+      w.begin(Tag::Field, buf.bytes);
+      w.raw(buf.data, buf.bytes);
+      w.end();
+    }
+  });
+}
+
+CheckpointResult load_checkpoint(Simulation& sim, const std::string& path) {
+  const MappedFile file(path);
+  FileHeader h;
+  CheckpointResult header = read_header(file, path, h);
+  if (!header.ok) return header;
+  if (h.mode != static_cast<std::uint32_t>(sim.mode()))
+    return CheckpointResult::failure("Checkpoint simulation mode does not match");
+
+  const std::vector<StateBuffer> fields = sim.model_state_buffers();
+  std::size_t next_field = 0;
+  CheckpointResult records = CheckpointResult::success();
+  try {
+    records = for_each_record(file, [&](Tag tag, const char* payload, std::uint64_t bytes) {
+      switch (tag) {
+        case Tag::Lattice: {
+          if (bytes != 9 * sizeof(Real))
+            return CheckpointResult::failure("Checkpoint lattice record has the wrong size");
+          Lattice lat = *sim.lattice();
+          read_lattice(payload, lat);
+          sim.set_lattice(lat);
+          break;
+        }
+        case Tag::Particles:
+          if (!read_particles(payload, bytes, sim.system(), true))
+            return CheckpointResult::failure("Checkpoint particle record has the wrong size");
+          break;
+        case Tag::ParticleIds: {
+          ParticleSystem& ps = sim.system();
+          if (bytes != ps.size() * sizeof(std::uint32_t))
+            return CheckpointResult::failure("Checkpoint particle id record has the wrong size");
+          std::vector<std::uint32_t> ids(ps.size());
+          std::memcpy(ids.data(), payload, static_cast<std::size_t>(bytes));
+          std::vector<bool> seen(ids.size(), false);
+          for (std::uint32_t id : ids) {
+            if (id >= ids.size() || seen[id])
+              return CheckpointResult::failure("Checkpoint particle ids are not a permutation");
+            seen[id] = true;
+          }
+          ps.set_ids(ids.data());
+          break;
+        }
+        case Tag::Thermostat: {
+          Thermostat* therm = sim.thermostat();
+          if (!therm)
+            return CheckpointResult::failure("Checkpoint has thermostat state but the simulation has no thermostat");
+          if (!therm->load_state(std::string(payload, static_cast<std::size_t>(bytes))))
+            return CheckpointResult::failure("Checkpoint thermostat state does not match the thermostat type");
+          break;
+        }
+        case Tag::Field: {
+          if (next_field == fields.size() || fields[next_field].bytes != bytes)
+            return CheckpointResult::failure("Checkpoint field does not match the model size (same params?)");
+          std::memcpy(fields[next_field].data, payload, fields[next_field].bytes);
+          ++next_field;
+          break;
+        }
+        default:
+          return CheckpointResult::failure("Unknown checkpoint record tag "
+                                           + std::to_string(static_cast<std::uint32_t>(tag)));
+      }
+      return CheckpointResult::success();
+    });
+  } catch (const std::bad_alloc&) {
+    return CheckpointResult::failure("Checkpoint exceeds the simulation's particle memory budget: " + path);
+  }
+  if (!records.ok) return records;
+  if (next_field != fields.size())
+    return CheckpointResult::failure("Checkpoint is missing model fields");
+
+  sim.restore_clock(h.time, static_cast<std::size_t>(h.step_count));
+  return CheckpointResult::success();
+}
+
+CheckpointResult save_particles(const ParticleSystem& particles, const Lattice& lattice,
+                                const std::string& path) {
+  return write_file(path, make_header(SimMode::MD, 0.0, 0), [&](Writer& w) {
+    write_lattice(w, lattice);
+    write_particles(w, particles);
+  });
+}
+
+ParticleFileResult load_particles(const std::string& path, std::size_t max_bytes) {
+  const MappedFile file(path);
+  FileHeader h;
+  CheckpointResult header = read_header(file, path, h);
+  if (!header.ok) return ParticleFileResult::failure(header.error);
+  if (h.mode != static_cast<std::uint32_t>(SimMode::MD))
+    return ParticleFileResult::failure("Not an MD particle file: " + path);
+
+  auto source = std::make_shared<ParticleSource>(ParticleSource{Lattice(), ParticleSystem(0, max_bytes)});
+  bool have_lattice = false, have_particles = false;
+  try {
+    CheckpointResult records = for_each_record(file, [&](Tag tag, const char* payload, std::uint64_t bytes) {
+      if (tag == Tag::Lattice) {
+        if (bytes != 9 * sizeof(Real))
+          return CheckpointResult::failure("Particle file lattice record has the wrong size");
+        read_lattice(payload, source->lattice);
+        have_lattice = true;
+      } else if (tag == Tag::Particles) {
+        if (!read_particles(payload, bytes, source->particles, false))
+          return CheckpointResult::failure("Particle file particle record has the wrong size");
+        have_particles = true;
+      }
+      return CheckpointResult::success();
+    });
+    if (!records.ok) return ParticleFileResult::failure(records.error);
+  } catch (const std::bad_alloc&) {
+    return ParticleFileResult::failure("Particle file exceeds the memory budget of "
+                                       + std::to_string(max_bytes) + " bytes: " + path);
+  }
+  if (!have_lattice || !have_particles)
+    return ParticleFileResult::failure("Particle file has no box or no particles: " + path);
+  source->lattice.update_cache();
+  return ParticleFileResult::success(std::move(source));
+}
+
+}  // namespace matsimu
@@ -1,106 +1,187 @@
 #include <matsimu/io/config.hpp>
-#include <fstream>
-#include <sstream>
+#include <matsimu/io/mapped_file.hpp>
 #include <cctype>
 #include <algorithm>
-#include <unordered_map>
 
 namespace matsimu {
 
 namespace {
 
-std::string trim(const std::string& s) {
-  auto start = s.find_first_not_of(" \t\r\n");
-  if (start == std::string::npos) return "";
-  auto end = s.find_last_not_of(" \t\r\n");
-  return s.substr(start, end - start + 1);
+bool parse_double(std::string_view value, Real& out) {
+  return parse_config_number(value, out);
 }
 
-bool parse_double(const std::string& value, Real& out) {
-  std::istringstream is(value);
-  Real x;
-  if (!(is >> x)) return false;
-  char c;
-  if (is >> c) return false;
-  out = x;
-  return true;
+bool parse_size_t(std::string_view value, std::size_t& out) {
+  return parse_config_number(value, out);
 }
 
-bool parse_size_t(const std::string& value, std::size_t& out) {
-  std::istringstream is(value);
-  unsigned long x;
-  if (!(is >> x)) return false;
-  char c;
-  if (is >> c) return false;
-  out = static_cast<std::size_t>(x);
-  return true;
+bool parse_bool(std::string_view value, bool& out) {
+  return parse_config_bool(value, out);
+}
+
+bool parse_neighbor_build(std::string_view v, NeighborBuild& out) {
+  if (config_equals(v, "cells")) { out = NeighborBuild::Cells; return true; }
+  if (config_equals(v, "brute")) { out = NeighborBuild::BruteForce; return true; }
+  return false;
+}
+
+bool parse_health_check(std::string_view v, HealthCheck& out) {
+  if (config_equals(v, "every_step")) { out = HealthCheck::EveryStep; return true; }
+  if (config_equals(v, "interval")) { out = HealthCheck::Interval; return true; }
+  if (config_equals(v, "debug")) { out = HealthCheck::DebugOnly; return true; }
+  if (config_equals(v, "fused")) { out = HealthCheck::Fused; return true; }
+  return false;
+}
+
+bool parse_precision(std::string_view v, Precision& out) {
+  if (config_equals(v, "double")) { out = Precision::Double; return true; }
+  if (config_equals(v, "single")) { out = Precision::Single; return true; }
+  return false;
 }
 
-bool parse_bool(const std::string& value, bool& out) {
-  std::string v = value;
-  std::transform(v.begin(), v.end(), v.begin(), [](unsigned char c) { return std::tolower(c); });
-  if (v == "1" || v == "true" || v == "yes") { out = true; return true; }
-  if (v == "0" || v == "false" || v == "no") { out = false; return true; }
+bool parse_backend(std::string_view v, ComputeBackend& out) {
+  if (config_equals(v, "host")) { out = ComputeBackend::Host; return true; }
+  if (config_equals(v, "device")) { out = ComputeBackend::Device; return true; }
   return false;
 }
 
 }  // namespace
 
+std::string_view trim_config(std::string_view value) {
+  const auto start = value.find_first_not_of(" \t\r\n");
+  if (start == std::string_view::npos) return {};
+  const auto end = value.find_last_not_of(" \t\r\n");
+  return value.substr(start, end - start + 1);
+}
+
+bool config_equals(std::string_view value, std::string_view keyword) {
+  if (value.size() != keyword.size()) return false;
+  for (std::size_t i = 0; i < value.size(); ++i)
+    if (std::tolower(static_cast<unsigned char>(value[i])) != keyword[i]) return false;
+  return true;
+}
+
+bool parse_config_bool(std::string_view v, bool& out) {
+  if (v == "1" || config_equals(v, "true") || config_equals(v, "yes")) { out = true; return true; }
+  if (v == "0" || config_equals(v, "false") || config_equals(v, "no")) { out = false; return true; }
+  return false;
+}
+
+std::optional<std::string> apply_config_value(SimulationParams& p, std::string_view key,
+                                              std::string_view value) {
+  if (key == "dt") {
+    if (!parse_double(value, p.dt))
+      return "invalid dt value";
+  } else if (key == "dx") {
+    if (!parse_double(value, p.dx))
+      return "invalid dx value";
+  } else if (key == "end_time") {
+    if (!parse_double(value, p.end_time))
+      return "invalid end_time value";
+  } else if (key == "max_steps") {
+    if (!parse_size_t(value, p.max_steps))
+      return "invalid max_steps value";
+  } else if (key == "temperature") {
+    if (!parse_double(value, p.temperature))
+      return "invalid temperature value";
+  } else if (key == "cutoff") {
+    if (!parse_double(value, p.cutoff))
+      return "invalid cutoff value";
+  } else if (key == "neighbor_skin") {
+    if (!parse_double(value, p.neighbor_skin))
+      return "invalid neighbor_skin value";
+  } else if (key == "sort_interval") {
+    if (!parse_size_t(value, p.sort_interval))
+      return "invalid sort_interval value";
+  } else if (key == "neighbor_skin_auto") {
+    if (!parse_bool(value, p.neighbor_skin_auto))
+      return "invalid neighbor_skin_auto value";
+  } else if (key == "neighbor_skin_min") {
+    if (!parse_double(value, p.neighbor_skin_min))
+      return "invalid neighbor_skin_min value";
+  } else if (key == "neighbor_skin_max") {
+    if (!parse_double(value, p.neighbor_skin_max))
+      return "invalid neighbor_skin_max value";
+  } else if (key == "use_neighbor_list") {
+    if (!parse_bool(value, p.use_neighbor_list))
+      return "invalid use_neighbor_list value";
+  } else if (key == "neighbor_build") {
+    if (!parse_neighbor_build(value, p.neighbor_build))
+      return "invalid neighbor_build value (expected cells|brute)";
+  } else if (key == "num_threads") {
+    if (!parse_size_t(value, p.num_threads))
+      return "invalid num_threads value";
+  } else if (key == "respa_steps") {
+    if (!parse_size_t(value, p.respa_steps))
+      return "invalid respa_steps value";
+  } else if (key == "respa_split") {
+    if (!parse_double(value, p.respa_split))
+      return "invalid respa_split value";
+  } else if (key == "respa_switch") {
+    if (!parse_double(value, p.respa_switch))
+      return "invalid respa_switch value";
+  } else if (key == "health_check") {
+    if (!parse_health_check(value, p.health_check))
+      return "invalid health_check value (expected every_step|interval|debug|fused)";
+  } else if (key == "health_check_interval") {
+    if (!parse_size_t(value, p.health_check_interval))
+      return "invalid health_check_interval value";
+  } else if (key == "energy_interval") {
+    if (!parse_size_t(value, p.energy_interval))
+      return "invalid energy_interval value";
+  } else if (key == "precision") {
+    if (!parse_precision(value, p.precision))
+      return "invalid precision value (expected double|single)";
+  } else if (key == "profile") {
+    if (!parse_bool(value, p.profile))
+      return "invalid profile value";
+  } else if (key == "max_bytes") {
+    if (!parse_size_t(value, p.max_bytes))
+      return "invalid max_bytes value";
+  } else if (key == "huge_pages") {
+    if (!parse_bool(value, p.huge_pages))
+      return "invalid huge_pages value";
+  } else if (key == "first_touch") {
+    if (!parse_bool(value, p.first_touch))
+      return "invalid first_touch value";
+  } else if (key == "backend") {
+    if (!parse_backend(value, p.backend))
+      return "invalid backend value (expected host|device)";
+  } else {
+    return "unknown key '" + std::string(key) + "'";
+  }
+  return std::nullopt;
+}
+
 ConfigResult load_config(const std::string& path) {
   SimulationParams p;
   if (path.empty())
     return ConfigResult::success(p);
 
-  std::ifstream f(path);
-  if (!f.is_open())
+  const MappedFile file(path);
+  if (!file.is_open())
     return ConfigResult::failure("Cannot open config file: " + path);
 
-  std::string line;
+  const std::string_view text = file.view();
   int line_no = 0;
-  while (std::getline(f, line)) {
+  for (std::size_t pos = 0; pos < text.size();) {
+    const std::size_t nl = std::min(text.find('\n', pos), text.size());
+    const std::string_view line = trim_config(text.substr(pos, nl - pos));
+    pos = nl + 1;
     ++line_no;
-    line = trim(line);
     if (line.empty() || line[0] == '#') continue;
-    std::size_t eq = line.find('=');
-    if (eq == std::string::npos)
+    const std::size_t eq = line.find('=');
+    if (eq == std::string_view::npos)
       return ConfigResult::failure("Invalid line " + std::to_string(line_no) + ": missing '='");
-    std::string key = trim(line.substr(0, eq));
-    std::string value = trim(line.substr(eq + 1));
+    const std::string_view key = trim_config(line.substr(0, eq));
+    const std::string_view value = trim_config(line.substr(eq + 1));
     if (key.empty())
       return ConfigResult::failure("Invalid line " + std::to_string(line_no) + ": empty key");
 
-    if (key == "dt") {
-      if (!parse_double(value, p.dt))
-        return ConfigResult::failure("Line " + std::to_string(line_no) + ": invalid dt value");
-    } else if (key == "dx") {
-      if (!parse_double(value, p.dx))
-        return ConfigResult::failure("Line " + std::to_string(line_no) + ": invalid dx value");
-    } else if (key == "end_time") {
-      if (!parse_double(value, p.end_time))
-        return ConfigResult::failure("Line " + std::to_string(line_no) + ": invalid end_time value");
-    } else if (key == "max_steps") {
-      if (!parse_size_t(value, p.max_steps))
-        return ConfigResult::failure("Line " + std::to_string(line_no) + ": invalid max_steps value");
-    } else if (key == "temperature") {
-      if (!parse_double(value, p.temperature))
-        return ConfigResult::failure("Line " + std::to_string(line_no) + ": invalid temperature value");
-    } else if (key == "cutoff") {
-      if (!parse_double(value, p.cutoff))
-        return ConfigResult::failure("Line " + std::to_string(line_no) + ": invalid cutoff value");
-    } else if (key == "neighbor_skin") {
-      if (!parse_double(value, p.neighbor_skin))
-        return ConfigResult::failure("Line " + std::to_string(line_no) + ": invalid neighbor_skin value");
-    } else if (key == "use_neighbor_list") {
-      if (!parse_bool(value, p.use_neighbor_list))
-        return ConfigResult::failure("Line " + std::to_string(line_no) + ": invalid use_neighbor_list value");
-    } else {
-      return ConfigResult::failure("Line " + std::to_string(line_no) + ": unknown key '" + key + "'");
-    }
+    if (auto err = apply_config_value(p, key, value))
+      return ConfigResult::failure("Line " + std::to_string(line_no) + ": " + *err);
   }
 
-  if (!f.eof())
-    return ConfigResult::failure("Error reading config file");
-
   auto validation = p.validate();
   if (validation)
     return ConfigResult::failure("Config validation failed: " + *validation);
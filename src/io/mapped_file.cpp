@@ -0,0 +1,47 @@
+#include <matsimu/io/mapped_file.hpp>
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MATSIMU_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace matsimu {
+
+MappedFile::MappedFile(const std::string& path) {
+#ifdef MATSIMU_HAVE_MMAP
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat st;
+  open_ = ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+  if (open_ && st.st_size > 0) {
+    void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+      data_ = static_cast<const char*>(p);
+      size_ = static_cast<std::size_t>(st.st_size);
+      mapped_ = true;
+    }
+  }
+  ::close(fd);
+#else
+  std::ifstream f(path, std::ios::binary);
+  if (!f) return;
+  open_ = true;
+  copy_.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  if (copy_.empty()) return;
+  data_ = copy_.data();
+  size_ = copy_.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef MATSIMU_HAVE_MMAP
+  if (mapped_) ::munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+}  // namespace matsimu
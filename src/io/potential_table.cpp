@@ -0,0 +1,85 @@
+#include <matsimu/io/potential_table.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace matsimu {
+
+namespace {
+
+struct TableRow {
+  Real r;
+  Real energy;
+  Real force;
+};
+
+// U(r) and F(r) = -dU/dr at r in [rows.front().r, rows.back().r], cubic
+// Hermite between the bracketing rows.
+void interpolate_row(const std::vector<TableRow>& rows, Real r, Real& energy, Real& force) {
+  auto hi = std::upper_bound(rows.begin(), rows.end(), r,
+                             [](Real x, const TableRow& row) { return x < row.r; });
+  if (hi == rows.end()) --hi;
+  if (hi == rows.begin()) ++hi;
+  const TableRow& a = *(hi - 1);
+  const TableRow& b = *hi;
+  const Real h = b.r - a.r;
+  const Real t = (r - a.r) / h;
+  const Real d0 = -a.force * h;  // dU/dt
+  const Real d1 = -b.force * h;
+  const Real c2 = 3.0 * (b.energy - a.energy) - 2.0 * d0 - d1;
+  const Real c3 = 2.0 * (a.energy - b.energy) + d0 + d1;
+  energy = a.energy + t * (d0 + t * (c2 + t * c3));
+  force = -(d0 + t * (2.0 * c2 + t * 3.0 * c3)) / h;
+}
+
+}  // namespace
+
+PotentialTableResult load_potential_table(const std::string& path, std::size_t points) {
+  std::ifstream f(path);
+  if (!f.is_open())
+    return PotentialTableResult::failure("Cannot open potential table: " + path);
+  if (points < 2)
+    return PotentialTableResult::failure("Potential table needs at least 2 grid points");
+
+  std::vector<TableRow> rows;
+  std::string line;
+  int line_no = 0;
+  while (std::getline(f, line)) {
+    ++line_no;
+    const std::size_t start = line.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos || line[start] == '#') continue;
+    std::istringstream is(line);
+    TableRow row;
+    std::string extra;
+    const std::string where = "Line " + std::to_string(line_no) + ": ";
+    if (!(is >> row.r >> row.energy >> row.force) || (is >> extra))
+      return PotentialTableResult::failure(where + "expected 'r energy force'");
+    if (!std::isfinite(row.r) || !std::isfinite(row.energy) || !std::isfinite(row.force))
+      return PotentialTableResult::failure(where + "non-finite value");
+    if (!(row.r > 0.0) || (!rows.empty() && !(row.r > rows.back().r)))
+      return PotentialTableResult::failure(where + "r must be positive and increasing");
+    rows.push_back(row);
+  }
+  if (!f.eof())
+    return PotentialTableResult::failure("Error reading potential table");
+  if (rows.size() < 2)
+    return PotentialTableResult::failure("Potential table needs at least 2 rows");
+
+  const Real r_min = rows.front().r;
+  const Real cutoff = rows.back().r;
+  const Real s_min = r_min * r_min;
+  const Real h = (cutoff * cutoff - s_min) / static_cast<Real>(points - 1);
+  std::vector<Real> energy(points), force_div_r(points);
+  for (std::size_t k = 0; k < points; ++k) {
+    const Real r = k + 1 == points ? cutoff : std::sqrt(s_min + static_cast<Real>(k) * h);
+    Real force;
+    interpolate_row(rows, r, energy[k], force);
+    force_div_r[k] = force / r;
+  }
+  return PotentialTableResult::success(
+      std::make_shared<TabulatedPotential>(r_min, cutoff, energy, force_div_r));
+}
+
+}  // namespace matsimu
@@ -0,0 +1,398 @@
+#include <matsimu/io/run_file.hpp>
+#include <matsimu/io/checkpoint.hpp>
+#include <matsimu/io/config.hpp>
+#include <matsimu/io/mapped_file.hpp>
+#include <matsimu/io/potential_table.hpp>
+#include <matsimu/io/sweep.hpp>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <new>
+
+namespace matsimu {
+
+namespace {
+
+/// One key=value line, viewed in the mapped file.
+struct Entry {
+  int line{0};
+  std::string_view key;
+  std::string_view value;
+};
+
+/// One [run] section.
+struct Section {
+  int line{0};
+  std::string name;
+  std::vector<Entry> entries;
+};
+
+std::optional<std::string> unknown(std::string_view key) {
+  return "unknown key '" + std::string(key) + "'";
+}
+
+/// apply_*_value reports keys it does not take as "unknown key '...'".
+bool is_unknown(const std::optional<std::string>& err) {
+  return err && err->rfind("unknown key", 0) == 0;
+}
+
+template <typename T>
+std::optional<std::string> number(std::string_view key, std::string_view value, T& out) {
+  if (parse_config_number(value, out)) return std::nullopt;
+  return "invalid " + std::string(key) + " value";
+}
+
+std::optional<std::string> flag(std::string_view key, std::string_view value, bool& out) {
+  if (parse_config_bool(value, out)) return std::nullopt;
+  return "invalid " + std::string(key) + " value";
+}
+
+std::optional<std::string> scheme(std::string_view value, HeatScheme& out) {
+  if (config_equals(value, "explicit")) out = HeatScheme::Explicit;
+  else if (config_equals(value, "implicit")) out = HeatScheme::Implicit;
+  else return "invalid scheme value (expected explicit|implicit)";
+  return std::nullopt;
+}
+
+/// HeatIC2D and HeatIC3D share their enumerators.
+template <typename IC>
+std::optional<std::string> initial_condition(std::string_view value, IC& out) {
+  if (config_equals(value, "hot_center")) out = IC::HotCenter;
+  else if (config_equals(value, "uniform_hot")) out = IC::UniformHot;
+  else return "invalid ic value (expected hot_center|uniform_hot)";
+  return std::nullopt;
+}
+
+bool parse_model(std::string_view value, RunModel& out) {
+  for (RunModel m : {RunModel::MD, RunModel::Heat, RunModel::Heat2D, RunModel::Heat3D}) {
+    if (config_equals(value, run_model_name(m))) {
+      out = m;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::optional<std::string> apply_heat_value(HeatDiffusionParams& p, std::string_view key,
+                                            std::string_view value) {
+  if (key == "alpha") return number(key, value, p.alpha);
+  if (key == "dx") return number(key, value, p.dx);
+  if (key == "dt") return number(key, value, p.dt);
+  if (key == "end_time") return number(key, value, p.end_time);
+  if (key == "max_steps") return number(key, value, p.max_steps);
+  if (key == "n_cells") return number(key, value, p.n_cells);
+  if (key == "scheme") return scheme(value, p.scheme);
+  return unknown(key);
+}
+
+/// Fields HeatDiffusion2DParams and HeatDiffusion3DParams share.
+template <typename P>
+std::optional<std::string> apply_grid_value(P& p, std::string_view key, std::string_view value) {
+  if (key == "alpha") return number(key, value, p.alpha);
+  if (key == "dx") return number(key, value, p.dx);
+  if (key == "dt") return number(key, value, p.dt);
+  if (key == "end_time") return number(key, value, p.end_time);
+  if (key == "max_steps") return number(key, value, p.max_steps);
+  if (key == "nx") return number(key, value, p.nx);
+  if (key == "ny") return number(key, value, p.ny);
+  if (key == "T_boundary") return number(key, value, p.T_boundary);
+  if (key == "ic") return initial_condition(value, p.ic);
+  if (key == "T_hot") return number(key, value, p.T_hot);
+  if (key == "hot_radius_frac") return number(key, value, p.hot_radius_frac);
+  if (key == "num_threads") return number(key, value, p.num_threads);
+  if (key == "huge_pages") return flag(key, value, p.huge_pages);
+  if (key == "first_touch") return flag(key, value, p.first_touch);
+  if (key == "backend") {
+    if (config_equals(value, "host")) p.backend = ComputeBackend::Host;
+    else if (config_equals(value, "device")) p.backend = ComputeBackend::Device;
+    else return "invalid backend value (expected host|device)";
+    return std::nullopt;
+  }
+  return unknown(key);
+}
+
+std::optional<std::string> apply_heat_2d_value(HeatDiffusion2DParams& p, std::string_view key,
+                                               std::string_view value) {
+  if (key == "scheme") return scheme(value, p.scheme);
+  if (key == "precision") {
+    if (config_equals(value, "double")) p.precision = Precision::Double;
+    else if (config_equals(value, "single")) p.precision = Precision::Single;
+    else return "invalid precision value (expected double|single)";
+    return std::nullopt;
+  }
+  return apply_grid_value(p, key, value);
+}
+
+std::optional<std::string> apply_heat_3d_value(HeatDiffusion3DParams& p, std::string_view key,
+                                               std::string_view value) {
+  if (key == "nz") return number(key, value, p.nz);
+  return apply_grid_value(p, key, value);
+}
+
+/// Loads each particle file and potential table once, for all runs.
+class SharedInputs {
+ public:
+  explicit SharedInputs(const std::string& run_file) {
+    const std::size_t slash = run_file.find_last_of('/');
+    if (slash != std::string::npos) dir_ = run_file.substr(0, slash + 1);
+  }
+
+  std::optional<std::string> particles(std::string_view value, ReplicaSystem& s) {
+    const std::string path = resolve(value);
+    auto it = sources_.find(path);
+    if (it == sources_.end()) {
+      ParticleFileResult r = load_particles(path);
+      if (!r.ok) return r.error;
+      it = sources_.emplace(path, std::move(r.source)).first;
+    }
+    s.source = it->second;
+    return std::nullopt;
+  }
+
+  std::optional<std::string> potential_table(std::string_view value, ReplicaSpec& spec) {
+    const std::string path = resolve(value);
+    auto it = tables_.find(path);
+    if (it == tables_.end()) {
+      PotentialTableResult r = load_potential_table(path);
+      if (!r.ok) return r.error;
+      it = tables_.emplace(path, std::move(r.potential)).first;
+    }
+    spec.system.potential = it->second;
+    return std::nullopt;
+  }
+
+ private:
+  std::string dir_;
+  std::map<std::string, std::shared_ptr<const ParticleSource>> sources_;
+  std::map<std::string, std::shared_ptr<TabulatedPotential>> tables_;
+
+  std::string resolve(std::string_view value) const {
+    if (!value.empty() && value[0] == '/') return std::string(value);
+    return dir_ + std::string(value);
+  }
+};
+
+std::optional<std::string> apply_run_value(RunSpec& run, SharedInputs& inputs,
+                                           std::string_view key, std::string_view value) {
+  switch (run.model) {
+    case RunModel::MD:
+      if (key == "particles") return inputs.particles(value, run.md.system);
+      if (key == "potential_table") return inputs.potential_table(value, run.md);
+      return apply_replica_value(run.md, key, value);
+    case RunModel::Heat:
+      return apply_heat_value(run.heat, key, value);
+    case RunModel::Heat2D:
+      return apply_heat_2d_value(run.heat_2d, key, value);
+    case RunModel::Heat3D:
+      return apply_heat_3d_value(run.heat_3d, key, value);
+  }
+  return unknown(key);
+}
+
+std::optional<std::string> validate_run(const RunSpec& run) {
+  switch (run.model) {
+    case RunModel::MD:
+      if (auto err = run.md.system.validate()) return err;
+      return run.md.params.validate();
+    case RunModel::Heat:
+      return run.heat.validate();
+    case RunModel::Heat2D:
+      return run.heat_2d.validate();
+    case RunModel::Heat3D:
+      return run.heat_3d.validate();
+  }
+  return std::nullopt;
+}
+
+/// Last model key of entries, if any; false on a bad value.
+bool find_model(const std::vector<Entry>& entries, RunModel& model, std::string& error) {
+  for (const Entry& e : entries) {
+    if (e.key != "model") continue;
+    if (!parse_model(e.value, model)) {
+      error = "Line " + std::to_string(e.line) + ": invalid model value (expected md|heat|heat2d|heat3d)";
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Run one grid model on the calling thread.
+template <typename Params>
+ReplicaResult run_grid(const Params& params, std::size_t index) {
+  ReplicaResult r;
+  r.index = index;
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    Simulation sim(params);
+    if (sim.is_valid()) sim.run();
+    r.steps = sim.step_count();
+    r.time = sim.time();
+    r.error = sim.error_message();
+    r.ok = r.error.empty();
+  } catch (const std::bad_alloc&) {
+    r.error = "Run exceeds its memory budget.";
+  }
+  r.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return r;
+}
+
+}  // namespace
+
+const char* run_model_name(RunModel model) {
+  switch (model) {
+    case RunModel::MD: return "md";
+    case RunModel::Heat: return "heat";
+    case RunModel::Heat2D: return "heat2d";
+    case RunModel::Heat3D: return "heat3d";
+  }
+  return "md";
+}
+
+RunPlanResult load_run_file(const std::string& path) {
+  const MappedFile file(path);
+  if (!file.is_open())
+    return RunPlanResult::failure("Cannot open run file: " + path);
+
+  RunPlan plan;
+  std::vector<Entry> defaults;
+  std::vector<Section> sections;
+  std::vector<Entry>* target = nullptr;  // null before the first section
+  const std::string_view text = file.view();
+  int line_no = 0;
+  for (std::size_t pos = 0; pos < text.size();) {
+    const std::size_t nl = std::min(text.find('\n', pos), text.size());
+    const std::string_view line = trim_config(text.substr(pos, nl - pos));
+    pos = nl + 1;
+    ++line_no;
+    if (line.empty() || line[0] == '#') continue;
+    const std::string where = "Line " + std::to_string(line_no) + ": ";
+
+    if (line.front() == '[') {
+      if (line.back() != ']')
+        return RunPlanResult::failure(where + "missing ']'");
+      const std::string_view header = trim_config(line.substr(1, line.size() - 2));
+      const std::string_view word = header.substr(0, header.find_first_of(" \t"));
+      if (word == "defaults" && header == word) {
+        target = &defaults;
+      } else if (word == "run") {
+        Section s;
+        s.line = line_no;
+        s.name = std::string(trim_config(header.substr(word.size())));
+        if (s.name.empty()) s.name = "run" + std::to_string(sections.size());
+        sections.push_back(std::move(s));
+        target = &sections.back().entries;
+      } else {
+        return RunPlanResult::failure(where + "unknown section '" + std::string(header)
+                                      + "' (expected [defaults] or [run NAME])");
+      }
+      continue;
+    }
+
+    const std::size_t eq = line.find('=');
+    if (eq == std::string_view::npos)
+      return RunPlanResult::failure(where + "missing '='");
+    const std::string_view key = trim_config(line.substr(0, eq));
+    const std::string_view value = trim_config(line.substr(eq + 1));
+    if (key.empty())
+      return RunPlanResult::failure(where + "empty key");
+
+    if (target) {
+      target->push_back({line_no, key, value});
+    } else if (key == "output") {
+      plan.output = std::string(value);
+    } else if (key == "threads") {
+      if (!parse_config_number(value, plan.options.threads) || plan.options.threads == 0)
+        return RunPlanResult::failure(where + "invalid threads value");
+    } else if (key == "memory_limit") {
+      if (!parse_config_number(value, plan.options.max_bytes) || plan.options.max_bytes == 0)
+        return RunPlanResult::failure(where + "invalid memory_limit value");
+    } else {
+      return RunPlanResult::failure(where + "unknown key '" + std::string(key)
+                                    + "' outside a section (expected threads|memory_limit|output)");
+    }
+  }
+  if (sections.empty())
+    return RunPlanResult::failure("Run file has no [run] section: " + path);
+
+  SharedInputs inputs(path);
+  std::string error;
+  RunModel default_model = RunModel::MD;
+  if (!find_model(defaults, default_model, error)) return RunPlanResult::failure(error);
+  // A defaults key must suit at least one model.
+  for (const Entry& e : defaults) {
+    if (e.key == "model") continue;
+    std::optional<std::string> first_error;
+    bool accepted = false;
+    for (RunModel m : {RunModel::MD, RunModel::Heat, RunModel::Heat2D, RunModel::Heat3D}) {
+      RunSpec scratch;
+      scratch.model = m;
+      const std::optional<std::string> err = apply_run_value(scratch, inputs, e.key, e.value);
+      if (!err) accepted = true;
+      else if (!is_unknown(err) && !first_error) first_error = err;
+    }
+    if (!accepted)
+      return RunPlanResult::failure("Line " + std::to_string(e.line) + ": "
+                                    + (first_error ? *first_error : *unknown(e.key)));
+  }
+
+  plan.runs.reserve(sections.size());
+  for (const Section& s : sections) {
+    RunSpec run;
+    run.name = s.name;
+    run.model = default_model;
+    if (!find_model(s.entries, run.model, error)) return RunPlanResult::failure(error);
+    run.md.index = plan.runs.size();
+    for (const Entry& e : defaults) {
+      if (e.key == "model") continue;
+      const std::optional<std::string> err = apply_run_value(run, inputs, e.key, e.value);
+      if (err && !is_unknown(err))
+        return RunPlanResult::failure("Line " + std::to_string(e.line) + ": " + *err);
+    }
+    for (const Entry& e : s.entries) {
+      if (e.key == "model") continue;
+      if (auto err = apply_run_value(run, inputs, e.key, e.value))
+        return RunPlanResult::failure("Line " + std::to_string(e.line) + ": " + *err);
+    }
+    // The table defines where the potential ends.
+    if (run.model == RunModel::MD && run.md.system.potential)
+      run.md.params.cutoff = run.md.system.potential->cutoff();
+    if (auto err = validate_run(run))
+      return RunPlanResult::failure("Run '" + run.name + "' (line " + std::to_string(s.line)
+                                    + "): " + *err);
+    plan.runs.push_back(std::move(run));
+  }
+  return RunPlanResult::success(std::move(plan));
+}
+
+std::vector<ReplicaResult> run_plan(const RunPlan& plan) {
+  std::vector<ReplicaSpec> md;
+  for (const RunSpec& run : plan.runs)
+    if (run.model == RunModel::MD) md.push_back(run.md);
+  const std::vector<ReplicaResult> md_results = run_ensemble(md, plan.options);
+
+  std::vector<ReplicaResult> results(plan.runs.size());
+  std::size_t next_md = 0;
+  for (std::size_t i = 0; i < plan.runs.size(); ++i) {
+    const RunSpec& run = plan.runs[i];
+    switch (run.model) {
+      case RunModel::MD: results[i] = md_results[next_md++]; break;
+      case RunModel::Heat: results[i] = run_grid(run.heat, i); break;
+      case RunModel::Heat2D: results[i] = run_grid(run.heat_2d, i); break;
+      case RunModel::Heat3D: results[i] = run_grid(run.heat_3d, i); break;
+    }
+    results[i].index = i;
+  }
+  return results;
+}
+
+void write_run_csv(std::ostream& out, const RunPlan& plan,
+                   const std::vector<ReplicaResult>& results) {
+  SweepPlan columns;
+  columns.axes = {{"name", {}}, {"model", {}}};
+  std::vector<ReplicaSpec> rows(plan.runs.size());
+  for (std::size_t i = 0; i < rows.size(); ++i)
+    rows[i].tags = {plan.runs[i].name, run_model_name(plan.runs[i].model)};
+  write_ensemble_csv(out, columns, rows, results);
+}
+
+}  // namespace matsimu
@@ -0,0 +1,204 @@
+#include <matsimu/io/sweep.hpp>
+#include <matsimu/io/config.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace matsimu {
+
+namespace {
+
+std::string trim(const std::string& s) {
+  return std::string(trim_config(s));
+}
+
+template <typename T>
+bool parse_value(const std::string& value, T& out) {
+  return parse_config_number(value, out);
+}
+
+bool parse_thermostat(std::string_view v, ReplicaThermostat& out) {
+  if (config_equals(v, "none")) { out = ReplicaThermostat::None; return true; }
+  if (config_equals(v, "rescale")) { out = ReplicaThermostat::Rescale; return true; }
+  if (config_equals(v, "andersen")) { out = ReplicaThermostat::Andersen; return true; }
+  return false;
+}
+
+/// "a, b, c" or "lo:hi" (inclusive integers) -> values; a plain value -> {value}.
+std::vector<std::string> split_values(const std::string& value) {
+  std::vector<std::string> out;
+  const std::size_t colon = value.find(':');
+  unsigned long lo = 0, hi = 0;
+  if (value.find(',') == std::string::npos && colon != std::string::npos &&
+      parse_value(trim(value.substr(0, colon)), lo) && parse_value(trim(value.substr(colon + 1)), hi) &&
+      lo <= hi) {
+    for (unsigned long v = lo; v <= hi; ++v) out.push_back(std::to_string(v));
+    return out;
+  }
+  std::size_t begin = 0;
+  for (;;) {
+    const std::size_t comma = value.find(',', begin);
+    out.push_back(trim(value.substr(begin, comma - begin)));
+    if (comma == std::string::npos) break;
+    begin = comma + 1;
+  }
+  return out;
+}
+
+std::string csv_quote(const std::string& s) {
+  if (s.find_first_of(",\"\n") == std::string::npos) return s;
+  std::string q = "\"";
+  for (char c : s) {
+    if (c == '"') q += '"';
+    q += c;
+  }
+  return q + "\"";
+}
+
+}  // namespace
+
+std::optional<std::string> apply_replica_value(ReplicaSpec& spec, std::string_view key,
+                                               std::string_view value) {
+  ReplicaSystem& s = spec.system;
+  bool ok = true;
+  if (key == "cells") ok = parse_config_number(value, s.cells);
+  else if (key == "spacing") ok = parse_config_number(value, s.spacing);
+  else if (key == "mass") ok = parse_config_number(value, s.mass);
+  else if (key == "epsilon") ok = parse_config_number(value, s.epsilon);
+  else if (key == "sigma") ok = parse_config_number(value, s.sigma);
+  else if (key == "thermostat_tau") ok = parse_config_number(value, s.thermostat_tau);
+  else if (key == "seed") ok = parse_config_number(value, spec.seed);
+  else if (key == "thermostat") {
+    if (!parse_thermostat(value, s.thermostat))
+      return "invalid thermostat value (expected none|rescale|andersen)";
+  } else {
+    return apply_config_value(spec.params, key, value);
+  }
+  if (!ok) return "invalid " + std::string(key) + " value";
+  return std::nullopt;
+}
+
+std::size_t SweepPlan::size() const {
+  std::size_t n = 1;
+  for (const SweepAxis& a : axes) n *= a.values.size();
+  return n;
+}
+
+SweepResult load_sweep(const std::string& path) {
+  std::ifstream f(path);
+  if (!f.is_open())
+    return SweepResult::failure("Cannot open batch file: " + path);
+
+  SweepPlan plan;
+  std::string base_path;
+  std::vector<std::pair<int, std::pair<std::string, std::string>>> entries;
+  std::string line;
+  int line_no = 0;
+  while (std::getline(f, line)) {
+    ++line_no;
+    line = trim(line);
+    if (line.empty() || line[0] == '#') continue;
+    std::size_t eq = line.find('=');
+    if (eq == std::string::npos)
+      return SweepResult::failure("Invalid line " + std::to_string(line_no) + ": missing '='");
+    std::string key = trim(line.substr(0, eq));
+    std::string value = trim(line.substr(eq + 1));
+    if (key.empty())
+      return SweepResult::failure("Invalid line " + std::to_string(line_no) + ": empty key");
+
+    const std::string where = "Line " + std::to_string(line_no) + ": ";
+    if (key == "base") {
+      base_path = value;
+    } else if (key == "output") {
+      plan.output = value;
+    } else if (key == "threads") {
+      if (!parse_value(value, plan.options.threads) || plan.options.threads == 0)
+        return SweepResult::failure(where + "invalid threads value");
+    } else if (key == "memory_limit") {
+      if (!parse_value(value, plan.options.max_bytes) || plan.options.max_bytes == 0)
+        return SweepResult::failure(where + "invalid memory_limit value");
+    } else {
+      entries.push_back({line_no, {key, value}});
+    }
+  }
+  if (!f.eof())
+    return SweepResult::failure("Error reading batch file");
+
+  // The base config is the starting point wherever the line appears.
+  if (!base_path.empty()) {
+    if (base_path[0] != '/') {
+      const std::size_t slash = path.find_last_of('/');
+      if (slash != std::string::npos) base_path = path.substr(0, slash + 1) + base_path;
+    }
+    ConfigResult base = load_config(base_path);
+    if (!base.ok)
+      return SweepResult::failure("Base config: " + base.error);
+    plan.base.params = base.params;
+  }
+
+  for (const auto& [no, kv] : entries) {
+    const auto& [key, value] = kv;
+    const std::string where = "Line " + std::to_string(no) + ": ";
+    std::vector<std::string> values = split_values(value);
+    for (const std::string& v : values) {
+      ReplicaSpec scratch = plan.base;
+      if (auto err = apply_replica_value(scratch, key, v))
+        return SweepResult::failure(where + *err);
+    }
+    if (values.size() == 1) {
+      apply_replica_value(plan.base, key, values.front());
+    } else {
+      auto dup = std::find_if(plan.axes.begin(), plan.axes.end(),
+                              [&](const SweepAxis& a) { return a.key == key; });
+      if (dup != plan.axes.end())
+        return SweepResult::failure(where + "key '" + key + "' is swept twice");
+      plan.axes.push_back({key, std::move(values)});
+    }
+  }
+  return SweepResult::success(std::move(plan));
+}
+
+std::vector<ReplicaSpec> expand_sweep(const SweepPlan& plan) {
+  const std::size_t n = plan.size();
+  std::vector<ReplicaSpec> specs;
+  specs.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    ReplicaSpec spec = plan.base;
+    spec.index = i;
+    spec.tags.resize(plan.axes.size());
+    std::size_t rest = i;
+    for (std::size_t a = plan.axes.size(); a-- > 0;) {
+      const SweepAxis& axis = plan.axes[a];
+      spec.tags[a] = axis.values[rest % axis.values.size()];
+      rest /= axis.values.size();
+    }
+    for (std::size_t a = 0; a < plan.axes.size(); ++a)
+      apply_replica_value(spec, plan.axes[a].key, spec.tags[a]);  // checked by load_sweep
+    specs.push_back(std::move(spec));
+  }
+  return specs;
+}
+
+void write_ensemble_csv(std::ostream& out, const SweepPlan& plan,
+                        const std::vector<ReplicaSpec>& specs,
+                        const std::vector<ReplicaResult>& results) {
+  out << "index";
+  for (const SweepAxis& a : plan.axes) out << ',' << csv_quote(a.key);
+  out << ",atoms,status,steps,time_s,ekin_J,epot_J,etot_J,temperature_K,wall_s\n";
+  const auto flags = out.flags();
+  const auto precision = out.precision();
+  out << std::setprecision(10);
+  for (std::size_t i = 0; i < results.size() && i < specs.size(); ++i) {
+    const ReplicaResult& r = results[i];
+    out << r.index;
+    for (const std::string& tag : specs[i].tags) out << ',' << csv_quote(tag);
+    out << ',' << r.atoms << ',' << (r.ok ? std::string("ok") : csv_quote(r.error)) << ',' << r.steps
+        << ',' << r.time << ',' << r.kinetic_energy << ',' << r.potential_energy << ','
+        << r.total_energy << ',' << r.temperature << ',' << std::setprecision(4) << r.wall_seconds
+        << std::setprecision(10) << '\n';
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+
+}  // namespace matsimu
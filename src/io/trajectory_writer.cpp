@@ -0,0 +1,252 @@
+#include <matsimu/io/trajectory_writer.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef MATSIMU_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace matsimu {
+
+namespace {
+
+constexpr Real kMetresToAngstrom = 1e10;
+
+struct TrajectoryHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t real_bytes;
+  std::uint64_t atoms;
+};
+
+}  // namespace
+
+std::optional<std::string> TrajectoryOptions::validate() const {
+  if (stride == 0)
+    return "Trajectory stride must be at least 1.";
+  if (queue_depth < 2)
+    return "Trajectory queue depth must be at least 2 (double buffering).";
+#ifdef MATSIMU_USE_ZLIB
+  if (compress && (compression_level < 1 || compression_level > 9))
+    return "Trajectory compression level must be in 1..9.";
+#else
+  if (compress)
+    return "Trajectory compression needs a build with zlib (MATSIMU_USE_ZLIB).";
+#endif
+  if (format == TrajectoryFormat::XYZ && xyz_symbol.empty())
+    return "XYZ element symbol must not be empty.";
+  return std::nullopt;
+}
+
+/// Output file: plain stdio, or a gzip stream when compressing.
+class TrajectoryWriter::Sink {
+ public:
+  Sink(const std::string& path, const TrajectoryOptions& opts) {
+#ifdef MATSIMU_USE_ZLIB
+    if (opts.compress) {
+      const std::string mode = "wb" + std::to_string(opts.compression_level);
+      gz_ = gzopen(path.c_str(), mode.c_str());
+      return;
+    }
+#endif
+    (void)opts;
+    f_ = std::fopen(path.c_str(), "wb");
+  }
+  ~Sink() { close(); }
+
+  bool is_open() const {
+#ifdef MATSIMU_USE_ZLIB
+    if (gz_) return true;
+#endif
+    return f_ != nullptr;
+  }
+
+  bool write(const void* p, std::size_t n) {
+    if (n == 0) return true;
+#ifdef MATSIMU_USE_ZLIB
+    if (gz_) return gzwrite(gz_, p, static_cast<unsigned>(n)) == static_cast<int>(n);
+#endif
+    return f_ && std::fwrite(p, 1, n, f_) == n;
+  }
+
+  bool close() {
+    bool ok = true;
+#ifdef MATSIMU_USE_ZLIB
+    if (gz_) ok = gzclose(gz_) == Z_OK;
+    gz_ = nullptr;
+#endif
+    if (f_) ok = std::fclose(f_) == 0 && ok;
+    f_ = nullptr;
+    return ok;
+  }
+
+ private:
+  std::FILE* f_{nullptr};
+#ifdef MATSIMU_USE_ZLIB
+  gzFile gz_{nullptr};
+#endif
+};
+
+TrajectoryWriter::TrajectoryWriter(const std::string& path, const TrajectoryOptions& opts)
+    : opts_(opts) {
+  if (auto err = opts_.validate()) {
+    error_ = *err;
+    return;
+  }
+  sink_ = std::make_unique<Sink>(path, opts_);
+  if (!sink_->is_open()) {
+    error_ = "Cannot open trajectory file for writing: " + path;
+    return;
+  }
+  frames_.resize(opts_.queue_depth);
+  for (Frame& f : frames_) free_.push_back(&f);
+  open_ = true;
+  thread_ = std::thread([this] { run(); });
+}
+
+TrajectoryWriter::~TrajectoryWriter() { close(); }
+
+std::string TrajectoryWriter::error_message() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return error_;
+}
+
+std::size_t TrajectoryWriter::frames_written() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return written_;
+}
+
+void TrajectoryWriter::submit(const Simulation& sim) {
+  if (!open_) return;
+  const ParticleSystem& ps = sim.system();
+  Frame* f = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!error_.empty()) return;
+    if (atoms_ == 0) atoms_ = ps.size();
+    if (ps.size() != atoms_) {
+      error_ = "Trajectory atom count changed between frames.";
+      return;
+    }
+    if (free_.empty()) {
+      ++stalls_;
+      free_cv_.wait(lock, [this] { return !free_.empty(); });
+    }
+    f = free_.back();
+    free_.pop_back();
+  }
+
+  // Copy outside the lock; the writer thread never touches a free frame.
+  f->step = sim.step_count();
+  f->time = sim.time();
+  const Lattice& lat = *sim.lattice();
+  std::copy(lat.a1, lat.a1 + 3, f->box);
+  std::copy(lat.a2, lat.a2 + 3, f->box + 3);
+  std::copy(lat.a3, lat.a3 + 3, f->box + 6);
+  if (ps.reordered()) {
+    // Atoms are written in id order whatever the storage order.
+    const std::size_t n = ps.size();
+    f->x.resize(n);
+    f->y.resize(n);
+    f->z.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      const std::uint32_t id = ps.id(i);
+      f->x[id] = ps.pos(0)[i];
+      f->y[id] = ps.pos(1)[i];
+      f->z[id] = ps.pos(2)[i];
+    }
+  } else {
+    f->x.assign(ps.pos(0), ps.pos(0) + ps.size());
+    f->y.assign(ps.pos(1), ps.pos(1) + ps.size());
+    f->z.assign(ps.pos(2), ps.pos(2) + ps.size());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_.push_back(f);
+  }
+  ready_cv_.notify_one();
+}
+
+void TrajectoryWriter::run() {
+  for (;;) {
+    Frame* f = nullptr;
+    bool failed = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_cv_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+      if (ready_.empty()) return;  // stopping and drained
+      f = ready_.front();
+      ready_.pop_front();
+      failed = !error_.empty();
+    }
+    const bool ok = !failed && write_frame(*f);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (ok) ++written_;
+      else if (error_.empty()) error_ = "Error writing trajectory frame.";
+      free_.push_back(f);
+    }
+    free_cv_.notify_one();
+  }
+}
+
+bool TrajectoryWriter::write_frame(const Frame& f) {
+  const std::size_t n = f.x.size();
+  if (opts_.format == TrajectoryFormat::Binary) {
+    if (!header_written_) {
+      TrajectoryHeader h{};
+      std::memcpy(h.magic, kTrajectoryMagic, sizeof(kTrajectoryMagic));
+      h.version = kTrajectoryVersion;
+      h.real_bytes = sizeof(Real);
+      h.atoms = n;
+      if (!sink_->write(&h, sizeof(h))) return false;
+      header_written_ = true;
+    }
+    return sink_->write(&f.step, sizeof(f.step)) && sink_->write(&f.time, sizeof(f.time))
+        && sink_->write(f.box, sizeof(f.box)) && sink_->write(f.x.data(), n * sizeof(Real))
+        && sink_->write(f.y.data(), n * sizeof(Real)) && sink_->write(f.z.data(), n * sizeof(Real));
+  }
+
+  // Extended XYZ; one formatted buffer per frame keeps the writes large.
+  const double a = kMetresToAngstrom;
+  std::string out;
+  out.reserve(64 * (n + 2));
+  char line[256];
+  std::snprintf(line, sizeof(line), "%zu\n", n);
+  out += line;
+  std::snprintf(line, sizeof(line),
+                "step=%llu time=%.9g Lattice=\"%.8f %.8f %.8f %.8f %.8f %.8f %.8f %.8f %.8f\" "
+                "Properties=species:S:1:pos:R:3\n",
+                static_cast<unsigned long long>(f.step), static_cast<double>(f.time),
+                f.box[0] * a, f.box[1] * a, f.box[2] * a, f.box[3] * a, f.box[4] * a,
+                f.box[5] * a, f.box[6] * a, f.box[7] * a, f.box[8] * a);
+  out += line;
+  for (std::size_t i = 0; i < n; ++i) {
+    std::snprintf(line, sizeof(line), "%s %.8f %.8f %.8f\n", opts_.xyz_symbol.c_str(),
+                  f.x[i] * a, f.y[i] * a, f.z[i] * a);
+    out += line;
+  }
+  return sink_->write(out.data(), out.size());
+}
+
+bool TrajectoryWriter::close() {
+  if (thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    ready_cv_.notify_one();
+    thread_.join();
+  }
+  if (sink_ && !sink_->close()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error_.empty()) error_ = "Error closing trajectory file.";
+  }
+  open_ = false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return error_.empty();
+}
+
+}  // namespace matsimu
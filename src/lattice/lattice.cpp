@@ -1,8 +1,24 @@
 #include <matsimu/lattice/lattice.hpp>
 #include <cmath> // For std::fabs, std::isfinite
+#include <limits>
 
 namespace matsimu {
 
+namespace {
+
+Real norm3(const Real v[3]) {
+  return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+// Degenerate relative to the basis scale: |V| <= eps * |a1||a2||a3|.
+// An absolute epsilon would flag every nanometre-sized SI cell.
+bool is_degenerate_volume(const Lattice& lat, Real vol) {
+  const Real scale = norm3(lat.a1) * norm3(lat.a2) * norm3(lat.a3);
+  return !(std::fabs(vol) > std::numeric_limits<Real>::epsilon() * scale);
+}
+
+}  // namespace
+
 Real Lattice::volume() const {
   Real cross[3] = {
     a2[1] * a3[2] - a2[2] * a3[1],
@@ -33,7 +49,7 @@ std::optional<std::string> Lattice::validate() const {
   if (!std::isfinite(vol)) {
     return "Lattice volume is non-finite, indicating invalid basis vectors.";
   }
-  if (std::fabs(vol) < std::numeric_limits<Real>::epsilon()) {
+  if (is_degenerate_volume(*this, vol)) {
     return "Lattice vectors are linearly dependent (volume is zero), forming a degenerate lattice.";
   }
 
@@ -41,10 +57,17 @@ std::optional<std::string> Lattice::validate() const {
 }
 
 void Lattice::cartesian_to_fractional(const Real cart[3], Real frac[3]) const {
+  if (cache_current()) {
+    const Real* m = cache_.inverse;
+    frac[0] = m[0] * cart[0] + m[1] * cart[1] + m[2] * cart[2];
+    frac[1] = m[3] * cart[0] + m[4] * cart[1] + m[5] * cart[2];
+    frac[2] = m[6] * cart[0] + m[7] * cart[1] + m[8] * cart[2];
+    return;
+  }
   // frac = A^{-1} * cart, where A = [a1 a2 a3] is the lattice matrix
   // Using Cramer's rule for the inverse
   Real vol = volume();
-  if (std::fabs(vol) < std::numeric_limits<Real>::epsilon()) {
+  if (is_degenerate_volume(*this, vol)) {
     frac[0] = frac[1] = frac[2] = 0.0;
     return;
   }
@@ -80,6 +103,11 @@ void Lattice::fractional_to_cartesian(const Real frac[3], Real cart[3]) const {
 }
 
 void Lattice::wrap_cartesian(Real cart[3]) const {
+  if (cache_.orthorhombic && cache_current()) {
+    for (int d = 0; d < 3; ++d)
+      cart[d] -= cache_.length[d] * std::floor(cart[d] * cache_.inv_length[d]);
+    return;
+  }
   Real frac[3];
   cartesian_to_fractional(cart, frac);
 
@@ -91,12 +119,7 @@ void Lattice::wrap_cartesian(Real cart[3]) const {
   fractional_to_cartesian(frac, cart);
 }
 
-void Lattice::min_image_displacement(const Real r1[3], const Real r2[3], Real dr[3]) const {
-  // Compute displacement in Cartesian
-  dr[0] = r2[0] - r1[0];
-  dr[1] = r2[1] - r1[1];
-  dr[2] = r2[2] - r1[2];
-
+void Lattice::min_image_general(Real dr[3]) const {
   // Convert to fractional, apply min image, convert back
   Real frac[3];
   cartesian_to_fractional(dr, frac);
@@ -106,7 +129,7 @@ void Lattice::min_image_displacement(const Real r1[3], const Real r2[3], Real dr
 
 void Lattice::reciprocal_vectors(Real b1[3], Real b2[3], Real b3[3]) const {
   Real vol = volume();
-  if (std::fabs(vol) < std::numeric_limits<Real>::epsilon()) {
+  if (is_degenerate_volume(*this, vol)) {
     b1[0] = b1[1] = b1[2] = 0.0;
     b2[0] = b2[1] = b2[2] = 0.0;
     b3[0] = b3[1] = b3[2] = 0.0;
@@ -139,4 +162,42 @@ bool Lattice::is_orthogonal() const {
   return true;
 }
 
+bool Lattice::is_orthorhombic() const {
+  if (cache_current()) return cache_.orthorhombic;
+  return a1[1] == 0.0 && a1[2] == 0.0 && a2[0] == 0.0 && a2[2] == 0.0 &&
+         a3[0] == 0.0 && a3[1] == 0.0 &&
+         a1[0] > 0.0 && a2[1] > 0.0 && a3[2] > 0.0 &&
+         std::isfinite(a1[0]) && std::isfinite(a2[1]) && std::isfinite(a3[2]);
+}
+
+void Lattice::update_cache() {
+  cache_ = Cache{};
+  const Real vol = volume();
+  if (!std::isfinite(vol) || is_degenerate_volume(*this, vol)) return;
+
+  const Real inv_vol = 1.0 / vol;
+  // Rows of A^{-1} are the reciprocal vectors without the 2π factor.
+  const Real rows[9] = {
+    a2[1] * a3[2] - a2[2] * a3[1], a2[2] * a3[0] - a2[0] * a3[2], a2[0] * a3[1] - a2[1] * a3[0],
+    a3[1] * a1[2] - a3[2] * a1[1], a3[2] * a1[0] - a3[0] * a1[2], a3[0] * a1[1] - a3[1] * a1[0],
+    a1[1] * a2[2] - a1[2] * a2[1], a1[2] * a2[0] - a1[0] * a2[2], a1[0] * a2[1] - a1[1] * a2[0]
+  };
+  for (int k = 0; k < 9; ++k) cache_.inverse[k] = rows[k] * inv_vol;
+
+  cache_.orthorhombic = is_orthorhombic();
+  if (cache_.orthorhombic) {
+    const Real len[3] = {a1[0], a2[1], a3[2]};
+    for (int d = 0; d < 3; ++d) {
+      cache_.length[d] = len[d];
+      cache_.inv_length[d] = 1.0 / len[d];
+    }
+  }
+  for (int d = 0; d < 3; ++d) {
+    cache_.basis[d] = a1[d];
+    cache_.basis[3 + d] = a2[d];
+    cache_.basis[6 + d] = a3[d];
+  }
+  cache_.valid = true;
+}
+
 }  // namespace matsimu
@@ -1,10 +1,25 @@
 #include <matsimu/core/types.hpp>
 #include <matsimu/io/config.hpp>
+#include <matsimu/io/checkpoint.hpp>
+#include <matsimu/io/run_file.hpp>
+#include <matsimu/io/sweep.hpp>
+#include <matsimu/io/trajectory_writer.hpp>
 #include <matsimu/lattice/lattice.hpp>
+#include <matsimu/parallel/communicator.hpp>
+#include <matsimu/parallel/device.hpp>
+#include <matsimu/physics/particle_builder.hpp>
+#include <matsimu/sim/distributed_heat_2d.hpp>
+#include <matsimu/sim/device_simulation.hpp>
+#include <matsimu/sim/distributed_simulation.hpp>
 #include <matsimu/sim/simulation.hpp>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <string>
 #include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <vector>
 
 #ifdef MATSIMU_USE_QT
 #include <QApplication>
@@ -20,13 +35,11 @@ const char* get_arg(int argc, char* argv[], const char* name) {
   return nullptr;
 }
 
-#ifdef MATSIMU_USE_QT
 bool has_flag(int argc, char* argv[], const char* name) {
   for (int i = 1; i < argc; ++i)
     if (std::strcmp(argv[i], name) == 0) return true;
   return false;
 }
-#endif
 
 void run_lattice_example() {
   matsimu::Lattice lat;
@@ -56,21 +69,273 @@ void run_heat_example() {
   std::cout << "Finished at t=" << sim.time() << " s, steps=" << sim.step_count() << "\n";
 }
 
+/// LJ argon crystal (10³ fcc cells) over the MPI ranks, or one rank
+/// without MPI: mpirun -np 8 matsimu --example distributed
+int run_distributed_example() {
+  std::shared_ptr<matsimu::Communicator> comm = matsimu::make_world_communicator();
+  if (!comm) comm = std::make_shared<matsimu::SelfCommunicator>();
+  const bool root = comm->rank() == 0;
+  const int cells = 10;
+  const matsimu::Real a = 0.526e-9;
+  matsimu::Lattice cell;
+  cell.a1[0] = cell.a2[1] = cell.a3[2] = a;
+  matsimu::CrystalSpec fcc;
+  for (auto& r : fcc.repeats) r = cells;
+  fcc.mass = 6.63e-26;
+
+  matsimu::SimulationParams params;
+  params.dt = 4e-15;
+  params.max_steps = 500;
+  params.cutoff = 0.85e-9;
+  params.energy_interval = 100;
+  auto lj = std::make_shared<matsimu::LennardJones>(1.654e-21, 3.405e-10, params.cutoff);
+  matsimu::DistributedSimulation sim(params, lj, comm);
+  sim.set_lattice(matsimu::supercell(cell, fcc));
+  sim.scatter_crystal(cell, fcc);
+  if (!sim.is_valid()) {
+    if (root) std::cerr << "Error: " << sim.error_message() << "\n";
+    return 1;
+  }
+  matsimu::assign_maxwell_velocities(sim.system(), 60.0, 7u);
+  sim.initialize();
+  const auto& grid = sim.domain().grid();
+  if (root)
+    std::cout << "Distributed MD: " << sim.global_count() << " atoms, " << comm->size()
+              << " ranks (" << grid[0] << "x" << grid[1] << "x" << grid[2] << ")\n";
+  while (sim.step()) {
+    if (sim.step_count() % params.energy_interval != 0) continue;
+    const matsimu::Real e = sim.total_energy();
+    if (root)
+      std::cout << "step " << sim.step_count() << ": T=" << sim.temperature()
+                << " K, E=" << e << " J\n";
+  }
+  if (!sim.is_valid()) {
+    if (root) std::cerr << "Error: " << sim.error_message() << "\n";
+    return 1;
+  }
+  return 0;
+}
+
+/// 2048² copper plate split into tiles over the MPI ranks (or one rank):
+/// mpirun -np 4 matsimu --example distributed-heat
+int run_distributed_heat_example() {
+  std::shared_ptr<matsimu::Communicator> comm = matsimu::make_world_communicator();
+  if (!comm) comm = std::make_shared<matsimu::SelfCommunicator>();
+  const bool root = comm->rank() == 0;
+  matsimu::HeatDiffusion2DParams params;
+  params.nx = params.ny = 2048;
+  params.dx = 5e-5;
+  params.dt = 0.9 * params.stability_limit();
+  params.max_steps = 200;
+  params.precision = matsimu::Precision::Double;
+  matsimu::DistributedHeat2DModel model(params, comm);
+  if (!model.is_valid()) {
+    if (root) std::cerr << "Error: " << model.error_message() << "\n";
+    return 1;
+  }
+  const auto& grid = model.grid();
+  if (root)
+    std::cout << "Distributed heat: " << params.nx << "x" << params.ny << " cells, "
+              << comm->size() << " ranks (" << grid[0] << "x" << grid[1] << " tiles)\n";
+  while (model.step()) {}
+  std::vector<matsimu::Real> field;
+  model.gather(field);
+  if (root)
+    std::cout << "t=" << model.time() << " s, steps=" << model.step_count() << ", T_center="
+              << field[(params.ny / 2) * params.nx + params.nx / 2] << " K\n";
+  return 0;
+}
+
+/// LJ argon crystal (8³ fcc cells) with the particles resident on the
+/// offload device (build with MATSIMU_USE_OFFLOAD=1): matsimu --example device
+int run_device_example() {
+  const matsimu::Real a = 0.526e-9;
+  matsimu::Lattice cell;
+  cell.a1[0] = cell.a2[1] = cell.a3[2] = a;
+  matsimu::CrystalSpec fcc;
+  for (auto& r : fcc.repeats) r = 8;
+  fcc.mass = 6.63e-26;
+
+  matsimu::SimulationParams params;
+  params.dt = 4e-15;
+  params.max_steps = 500;
+  params.cutoff = 0.85e-9;
+  params.energy_interval = 100;
+  params.backend = matsimu::ComputeBackend::Device;
+  auto lj = std::make_shared<matsimu::LennardJones>(1.654e-21, 3.405e-10, params.cutoff);
+  matsimu::Simulation sim(params, lj);
+  matsimu::ParticleSystem& crystal = sim.system();
+  const matsimu::Lattice box = matsimu::fill_crystal(crystal, cell, fcc);
+  matsimu::assign_maxwell_velocities(crystal, 60.0, 7u);
+  sim.set_lattice(box);
+  if (!sim.is_valid()) {
+    std::cerr << "Error: " << sim.error_message() << "\n";
+    return 1;
+  }
+  sim.initialize();
+  std::cout << "Device MD: " << crystal.size() << " atoms on "
+            << matsimu::device_description() << "\n";
+  while (sim.step()) {
+    if (sim.step_count() % params.energy_interval != 0) continue;
+    std::cout << "step " << sim.step_count() << ": T=" << sim.temperature()
+              << " K, E=" << sim.total_energy() << " J\n";
+  }
+  if (!sim.is_valid()) {
+    std::cerr << "Error: " << sim.error_message() << "\n";
+    return 1;
+  }
+  const matsimu::DeviceSimulation& device = *sim.device_simulation();
+  std::cout << device.neighbor_rebuilds() << " neighbor builds, " << device.snapshots()
+            << " host snapshots\n";
+  return 0;
+}
+
+/// Headless parameter sweep: run every replica of the batch file and write
+/// one CSV summary row each to --batch-output, the file's output key, or stdout.
+int run_batch(const char* batch_path, const char* output_path) {
+  matsimu::SweepResult sweep = matsimu::load_sweep(batch_path);
+  if (!sweep.ok) {
+    std::cerr << "Batch error: " << sweep.error << "\n";
+    return 1;
+  }
+  const matsimu::SweepPlan& plan = sweep.plan;
+  const std::vector<matsimu::ReplicaSpec> specs = matsimu::expand_sweep(plan);
+  std::cerr << "Running " << specs.size() << " replicas on " << plan.options.threads
+            << " threads (memory limit " << plan.options.max_bytes << " bytes)\n";
+  const std::vector<matsimu::ReplicaResult> results = matsimu::run_ensemble(specs, plan.options);
+
+  const std::string out_path = output_path ? output_path : plan.output;
+  std::ofstream file;
+  if (!out_path.empty()) {
+    file.open(out_path);
+    if (!file.is_open()) {
+      std::cerr << "Batch error: cannot open " << out_path << "\n";
+      return 1;
+    }
+  }
+  matsimu::write_ensemble_csv(out_path.empty() ? std::cout : file, plan, specs, results);
+  std::size_t failed = 0;
+  for (const matsimu::ReplicaResult& r : results)
+    if (!r.ok) ++failed;
+  if (failed > 0) std::cerr << failed << " of " << results.size() << " replicas failed\n";
+  return failed > 0 ? 1 : 0;
+}
+
+/// Headless multi-run file: every run in order, one CSV row each to
+/// --batch-output, the file's output key, or stdout.
+int run_runs(const char* runs_path, const char* output_path) {
+  matsimu::RunPlanResult loaded = matsimu::load_run_file(runs_path);
+  if (!loaded.ok) {
+    std::cerr << "Run file error: " << loaded.error << "\n";
+    return 1;
+  }
+  const matsimu::RunPlan& plan = loaded.plan;
+  std::cerr << "Running " << plan.runs.size() << " runs (MD on " << plan.options.threads
+            << " threads)\n";
+  const std::vector<matsimu::ReplicaResult> results = matsimu::run_plan(plan);
+
+  const std::string out_path = output_path ? output_path : plan.output;
+  std::ofstream file;
+  if (!out_path.empty()) {
+    file.open(out_path);
+    if (!file.is_open()) {
+      std::cerr << "Run file error: cannot open " << out_path << "\n";
+      return 1;
+    }
+  }
+  matsimu::write_run_csv(out_path.empty() ? std::cout : file, plan, results);
+  std::size_t failed = 0;
+  for (const matsimu::ReplicaResult& r : results)
+    if (!r.ok) ++failed;
+  if (failed > 0) std::cerr << failed << " of " << results.size() << " runs failed\n";
+  return failed > 0 ? 1 : 0;
+}
+
 #ifndef MATSIMU_USE_QT
-void run_default_cli(const matsimu::SimulationParams& params) {
+/// Checkpointing for the headless run: restore from restart_path (if set),
+/// write checkpoint_path every `every` steps (0 = at the end only).
+struct CheckpointOptions {
+  const char* restart_path{nullptr};
+  const char* checkpoint_path{nullptr};
+  std::size_t every{0};
+};
+
+bool write_checkpoint(const matsimu::Simulation& sim, const char* path) {
+  const matsimu::CheckpointResult r = matsimu::save_checkpoint(sim, path);
+  if (!r.ok) std::cerr << "Checkpoint error: " << r.error << "\n";
+  return r.ok;
+}
+
+/// --profile summary: time per step phase, neighbor rebuilds, particle memory.
+void print_profile(const matsimu::StepStats& s) {
+  const double total = static_cast<double>(s.total_ns());
+  const auto flags = std::cout.flags();
+  const auto precision = std::cout.precision();
+  std::cout << "Profile (" << s.steps << " steps):\n" << std::fixed;
+  if (!matsimu::kProfileCompiled)
+    std::cout << "  phase timers compiled out (MATSIMU_NO_PROFILE)\n";
+  for (std::size_t k = 0; k < matsimu::kStepPhaseCount && total > 0; ++k) {
+    const double ns = static_cast<double>(s.phase_ns[k]);
+    std::cout << "  " << std::left << std::setw(13)
+              << matsimu::step_phase_name(static_cast<matsimu::StepPhase>(k)) << std::right
+              << std::setprecision(3) << std::setw(11) << ns * 1e-6 << " ms "
+              << std::setprecision(1) << std::setw(6) << 100.0 * ns / total << "% "
+              << std::setw(10) << (s.steps ? ns / static_cast<double>(s.steps) : 0.0) << " ns/step\n";
+  }
+  std::cout << std::setprecision(0) << "  neighbor rebuilds " << s.neighbor_rebuilds << " (avg "
+            << s.average_pairs_per_rebuild() << " pairs), skin " << std::setprecision(3)
+            << s.neighbor_skin * 1e9 << " nm";
+  if (s.skin_adjustments > 0) std::cout << " (auto-tuned, " << s.skin_adjustments << " changes)";
+  if (s.particle_sorts > 0) std::cout << ", " << s.particle_sorts << " spatial sorts";
+  std::cout << std::setprecision(0) << "\n"
+            << "  particle memory " << s.bytes_in_use << " bytes in use, peak " << s.peak_bytes
+            << " of " << s.max_bytes << "\n";
+  std::cout.flags(flags);
+  std::cout.precision(precision);
+}
+
+int run_default_cli(const matsimu::SimulationParams& params, const CheckpointOptions& ckpt,
+                    const char* trajectory_path, const matsimu::TrajectoryOptions& traj_opts) {
   matsimu::Simulation sim(params);
   if (!sim.is_valid()) {
     std::cerr << "Error: " << sim.error_message() << "\n";
-    return;
+    return 1;
+  }
+  std::unique_ptr<matsimu::TrajectoryWriter> traj;
+  if (trajectory_path) {
+    traj = std::make_unique<matsimu::TrajectoryWriter>(trajectory_path, traj_opts);
+    if (!traj->is_open()) {
+      std::cerr << "Trajectory error: " << traj->error_message() << "\n";
+      return 1;
+    }
+  }
+  if (ckpt.restart_path) {
+    const matsimu::CheckpointResult r = matsimu::load_checkpoint(sim, ckpt.restart_path);
+    if (!r.ok) {
+      std::cerr << "Restart error: " << r.error << "\n";
+      return 1;
+    }
+    std::cout << "Restarted from " << ckpt.restart_path << " at step " << sim.step_count() << "\n";
   }
   std::cout << "Running simulation: dt=" << params.dt << " s, end_time=" << params.end_time
             << " s, max_steps=" << params.max_steps << "\n";
-  std::size_t steps = 0;
-  while (sim.step()) ++steps;
+  while (sim.step()) {
+    if (traj) traj->on_step(sim);
+    if (ckpt.checkpoint_path && ckpt.every > 0 && sim.step_count() % ckpt.every == 0
+        && !write_checkpoint(sim, ckpt.checkpoint_path))
+      return 1;
+  }
+  if (ckpt.checkpoint_path && !write_checkpoint(sim, ckpt.checkpoint_path)) return 1;
+  if (traj && !traj->close()) {
+    std::cerr << "Trajectory error: " << traj->error_message() << "\n";
+    return 1;
+  }
   std::cout << "Done. t=" << sim.time() << " s, steps=" << sim.step_count();
   if (!sim.error_message().empty())
     std::cout << ", error: " << sim.error_message();
   std::cout << "\n";
+  if (params.profile) print_profile(sim.stats());
+  return 0;
 }
 #endif
 
@@ -78,6 +343,15 @@ void run_default_cli(const matsimu::SimulationParams& params) {
 
 int main(int argc, char* argv[]) {
   const char* ex = get_arg(argc, argv, "--example");
+  if (ex && std::string(ex) == "distributed") {
+    matsimu::MpiSession mpi(argc, argv);
+    return run_distributed_example();
+  }
+  if (ex && std::string(ex) == "distributed-heat") {
+    matsimu::MpiSession mpi(argc, argv);
+    return run_distributed_heat_example();
+  }
+  if (ex && std::string(ex) == "device") return run_device_example();
   if (ex && std::string(ex) == "lattice") {
     run_lattice_example();
     return 0;
@@ -86,6 +360,10 @@ int main(int argc, char* argv[]) {
     run_heat_example();
     return 0;
   }
+  if (const char* batch = get_arg(argc, argv, "--batch"))
+    return run_batch(batch, get_arg(argc, argv, "--batch-output"));
+  if (const char* runs = get_arg(argc, argv, "--runs"))
+    return run_runs(runs, get_arg(argc, argv, "--batch-output"));
 
 #ifdef MATSIMU_USE_QT
   QApplication app(argc, argv);
@@ -110,7 +388,28 @@ int main(int argc, char* argv[]) {
     params.end_time = 2.0 * params.dt;
     params.max_steps = 1000;
   }
-  run_default_cli(params);
-  return 0;
+  if (has_flag(argc, argv, "--profile")) params.profile = true;
+  CheckpointOptions ckpt;
+  ckpt.restart_path = get_arg(argc, argv, "--restart");
+  ckpt.checkpoint_path = get_arg(argc, argv, "--checkpoint");
+  if (const char* every = get_arg(argc, argv, "--checkpoint-every"))
+    ckpt.every = static_cast<std::size_t>(std::strtoull(every, nullptr, 10));
+  matsimu::TrajectoryOptions traj_opts;
+  const char* trajectory_path = get_arg(argc, argv, "--trajectory");
+  if (const char* every = get_arg(argc, argv, "--trajectory-every"))
+    traj_opts.stride = static_cast<std::size_t>(std::strtoull(every, nullptr, 10));
+  if (const char* fmt = get_arg(argc, argv, "--trajectory-format")) {
+    if (std::string(fmt) == "xyz") {
+      traj_opts.format = matsimu::TrajectoryFormat::XYZ;
+    } else if (std::string(fmt) == "binary") {
+      traj_opts.format = matsimu::TrajectoryFormat::Binary;
+    } else {
+      std::cerr << "Trajectory error: invalid --trajectory-format value '" << fmt
+                << "' (expected xyz|binary)\n";
+      return 1;
+    }
+  }
+  traj_opts.compress = has_flag(argc, argv, "--trajectory-gzip");
+  return run_default_cli(params, ckpt, trajectory_path, traj_opts);
 #endif
 }
@@ -0,0 +1,208 @@
+#include <matsimu/parallel/communicator.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace matsimu {
+
+void SelfCommunicator::sendrecv(int, const std::vector<Real>& send, int,
+                                std::vector<Real>& recv) {
+    recv = send;
+}
+
+void SelfCommunicator::sendrecv(int, const std::vector<std::uint32_t>& send, int,
+                                std::vector<std::uint32_t>& recv) {
+    recv = send;
+}
+
+void SelfCommunicator::gather(const std::vector<Real>& send, std::vector<Real>& recv, int) {
+    recv = send;
+}
+
+void SelfCommunicator::gather(const std::vector<std::uint32_t>& send,
+                              std::vector<std::uint32_t>& recv, int) {
+    recv = send;
+}
+
+void SelfCommunicator::isend(int, const std::vector<Real>& data) {
+    sent_.push_back(data);
+}
+
+void SelfCommunicator::irecv(int, std::vector<Real>& data) {
+    pending_.push_back(&data);
+}
+
+void SelfCommunicator::wait_all() {
+    for (std::vector<Real>* target : pending_) {
+        if (sent_.empty()) break;
+        std::vector<Real>& msg = sent_.front();
+        std::copy_n(msg.begin(), std::min(msg.size(), target->size()), target->begin());
+        sent_.pop_front();
+    }
+    pending_.clear();
+}
+
+namespace {
+
+/// Mailboxes and reduction buffers of one payload type.
+template <typename T>
+struct Channel {
+    explicit Channel(int n)
+        : mailboxes(static_cast<std::size_t>(n) * static_cast<std::size_t>(n)),
+          contributions(static_cast<std::size_t>(n)) {}
+
+    std::vector<std::deque<std::vector<T>>> mailboxes;  // [src * size + dest], FIFO
+    std::vector<std::vector<T>> contributions;           // allreduce_sum, per rank
+    std::vector<T> result;
+};
+
+}  // namespace
+
+/// Shared state of one LocalCommunicator group.
+struct LocalCommunicator::Group {
+    explicit Group(int n) : size(n), reals(n), ids(n), counts(n) {}
+
+    int size;
+    std::mutex mutex;
+    std::condition_variable cv;
+    Channel<Real> reals;
+    Channel<std::uint32_t> ids;
+    Channel<std::uint64_t> counts;
+
+    // allreduce_sum: every rank deposits its buffer; the last one sums them
+    // in rank order into result and starts the next generation.
+    int arrived{0};
+    std::uint64_t generation{0};
+
+    template <typename T>
+    Channel<T>& channel();
+};
+
+template <>
+Channel<Real>& LocalCommunicator::Group::channel<Real>() { return reals; }
+template <>
+Channel<std::uint32_t>& LocalCommunicator::Group::channel<std::uint32_t>() { return ids; }
+template <>
+Channel<std::uint64_t>& LocalCommunicator::Group::channel<std::uint64_t>() { return counts; }
+
+std::vector<std::shared_ptr<Communicator>> LocalCommunicator::create_group(int ranks) {
+    if (ranks < 1) ranks = 1;
+    auto group = std::make_shared<Group>(ranks);
+    std::vector<std::shared_ptr<Communicator>> members;
+    members.reserve(static_cast<std::size_t>(ranks));
+    for (int r = 0; r < ranks; ++r)
+        members.emplace_back(new LocalCommunicator(group, r));
+    return members;
+}
+
+int LocalCommunicator::size() const { return group_->size; }
+
+template <typename T>
+void LocalCommunicator::reduce(T* data, std::size_t n) {
+    Group& g = *group_;
+    Channel<T>& ch = g.channel<T>();
+    std::unique_lock<std::mutex> lock(g.mutex);
+    ch.contributions[static_cast<std::size_t>(rank_)].assign(data, data + n);
+    const std::uint64_t generation = g.generation;
+    if (++g.arrived == g.size) {
+        ch.result.assign(n, T(0));
+        for (const std::vector<T>& c : ch.contributions)
+            for (std::size_t k = 0; k < n; ++k) ch.result[k] += c[k];
+        g.arrived = 0;
+        ++g.generation;
+        g.cv.notify_all();
+    } else {
+        g.cv.wait(lock, [&] { return g.generation != generation; });
+    }
+    // result stays put until every rank has left: the next reduction needs
+    // this rank's contribution before it can complete.
+    std::copy(ch.result.begin(), ch.result.begin() + static_cast<std::ptrdiff_t>(n), data);
+}
+
+void LocalCommunicator::allreduce_sum(Real* data, std::size_t n) {
+    reduce(data, n);
+}
+
+void LocalCommunicator::allreduce_sum(std::uint64_t* data, std::size_t n) {
+    reduce(data, n);
+}
+
+template <typename T>
+void LocalCommunicator::post(int dest, const std::vector<T>& data) {
+    Group& g = *group_;
+    {
+        std::lock_guard<std::mutex> lock(g.mutex);
+        g.channel<T>().mailboxes[static_cast<std::size_t>(rank_ * g.size + dest)].push_back(data);
+    }
+    g.cv.notify_all();
+}
+
+template <typename T>
+void LocalCommunicator::receive(int src, std::vector<T>& data) {
+    Group& g = *group_;
+    std::unique_lock<std::mutex> lock(g.mutex);
+    auto& box = g.channel<T>().mailboxes[static_cast<std::size_t>(src * g.size + rank_)];
+    g.cv.wait(lock, [&] { return !box.empty(); });
+    data = std::move(box.front());
+    box.pop_front();
+}
+
+void LocalCommunicator::sendrecv(int dest, const std::vector<Real>& send, int src,
+                                 std::vector<Real>& recv) {
+    post(dest, send);
+    receive(src, recv);
+}
+
+void LocalCommunicator::sendrecv(int dest, const std::vector<std::uint32_t>& send, int src,
+                                 std::vector<std::uint32_t>& recv) {
+    post(dest, send);
+    receive(src, recv);
+}
+
+void LocalCommunicator::isend(int dest, const std::vector<Real>& data) {
+    post(dest, data);
+}
+
+void LocalCommunicator::irecv(int src, std::vector<Real>& data) {
+    pending_.emplace_back(src, &data);
+}
+
+void LocalCommunicator::wait_all() {
+    std::vector<Real> msg;
+    for (const auto& [src, target] : pending_) {
+        receive(src, msg);
+        std::copy_n(msg.begin(), std::min(msg.size(), target->size()), target->begin());
+    }
+    pending_.clear();
+}
+
+template <typename T>
+void LocalCommunicator::gather_into(const std::vector<T>& send, std::vector<T>& recv, int root) {
+    if (rank_ != root) {
+        post(root, send);
+        return;
+    }
+    recv.clear();
+    std::vector<T> part;
+    for (int r = 0; r < group_->size; ++r) {
+        if (r == rank_) {
+            recv.insert(recv.end(), send.begin(), send.end());
+            continue;
+        }
+        receive(r, part);
+        recv.insert(recv.end(), part.begin(), part.end());
+    }
+}
+
+void LocalCommunicator::gather(const std::vector<Real>& send, std::vector<Real>& recv, int root) {
+    gather_into(send, recv, root);
+}
+
+void LocalCommunicator::gather(const std::vector<std::uint32_t>& send,
+                               std::vector<std::uint32_t>& recv, int root) {
+    gather_into(send, recv, root);
+}
+
+}  // namespace matsimu
@@ -0,0 +1,36 @@
+#include <matsimu/parallel/device.hpp>
+
+#ifdef MATSIMU_USE_OFFLOAD
+#include <omp.h>
+#endif
+
+namespace matsimu {
+
+const char* compute_backend_name(ComputeBackend backend) {
+    return backend == ComputeBackend::Device ? "device" : "host";
+}
+
+bool offload_enabled() {
+#ifdef MATSIMU_USE_OFFLOAD
+    return true;
+#else
+    return false;
+#endif
+}
+
+int device_count() {
+#ifdef MATSIMU_USE_OFFLOAD
+    return omp_get_num_devices();
+#else
+    return 0;
+#endif
+}
+
+std::string device_description() {
+    if (!offload_enabled()) return "host (offload not built)";
+    const int n = device_count();
+    if (n == 0) return "host threads (OpenMP target, no device)";
+    return "OpenMP target, " + std::to_string(n) + (n == 1 ? " device" : " devices");
+}
+
+}  // namespace matsimu
@@ -0,0 +1,175 @@
+#include <matsimu/parallel/communicator.hpp>
+
+#ifdef MATSIMU_USE_MPI
+// C API only; the deprecated C++ bindings do not build warning-free.
+#define OMPI_SKIP_MPICXX 1
+#define MPICH_SKIP_MPICXX 1
+#include <mpi.h>
+#endif
+
+namespace matsimu {
+
+#ifdef MATSIMU_USE_MPI
+
+namespace {
+
+/// MPI datatype of a payload type (Real is double, or float in
+/// single-precision builds; ids and counts are unsigned integers).
+template <typename T>
+struct MpiType;
+template <>
+struct MpiType<double> {
+    static MPI_Datatype get() { return MPI_DOUBLE; }
+};
+template <>
+struct MpiType<float> {
+    static MPI_Datatype get() { return MPI_FLOAT; }
+};
+template <>
+struct MpiType<std::uint32_t> {
+    static MPI_Datatype get() { return MPI_UINT32_T; }
+};
+template <>
+struct MpiType<std::uint64_t> {
+    static MPI_Datatype get() { return MPI_UINT64_T; }
+};
+
+inline MPI_Datatype mpi_real() { return MpiType<Real>::get(); }
+
+constexpr int kExchangeTag = 7301;
+constexpr int kHaloTag = 7302;
+
+class MpiCommunicator : public Communicator {
+public:
+    explicit MpiCommunicator(MPI_Comm comm) : comm_(comm) {
+        MPI_Comm_rank(comm_, &rank_);
+        MPI_Comm_size(comm_, &size_);
+    }
+
+    int rank() const override { return rank_; }
+    int size() const override { return size_; }
+
+    void allreduce_sum(Real* data, std::size_t n) override {
+        // Gather-then-sum in rank order on root keeps the result independent
+        // of the MPI library's reduction tree.
+        std::vector<Real> all;
+        gather(std::vector<Real>(data, data + n), all, 0);
+        if (rank_ == 0) {
+            for (std::size_t k = 0; k < n; ++k) data[k] = 0.0;
+            for (int r = 0; r < size_; ++r)
+                for (std::size_t k = 0; k < n; ++k) data[k] += all[static_cast<std::size_t>(r) * n + k];
+        }
+        MPI_Bcast(data, static_cast<int>(n), mpi_real(), 0, comm_);
+    }
+
+    void allreduce_sum(std::uint64_t* data, std::size_t n) override {
+        // Integer sums are exact in any order.
+        MPI_Allreduce(MPI_IN_PLACE, data, static_cast<int>(n), MpiType<std::uint64_t>::get(),
+                      MPI_SUM, comm_);
+    }
+
+    void sendrecv(int dest, const std::vector<Real>& send, int src,
+                  std::vector<Real>& recv) override {
+        exchange(dest, send, src, recv);
+    }
+
+    void sendrecv(int dest, const std::vector<std::uint32_t>& send, int src,
+                  std::vector<std::uint32_t>& recv) override {
+        exchange(dest, send, src, recv);
+    }
+
+    void gather(const std::vector<Real>& send, std::vector<Real>& recv, int root) override {
+        gather_into(send, recv, root);
+    }
+
+    void gather(const std::vector<std::uint32_t>& send, std::vector<std::uint32_t>& recv,
+                int root) override {
+        gather_into(send, recv, root);
+    }
+
+    void isend(int dest, const std::vector<Real>& data) override {
+        requests_.emplace_back();
+        MPI_Isend(data.data(), static_cast<int>(data.size()), mpi_real(), dest, kHaloTag, comm_,
+                  &requests_.back());
+    }
+
+    void irecv(int src, std::vector<Real>& data) override {
+        requests_.emplace_back();
+        MPI_Irecv(data.data(), static_cast<int>(data.size()), mpi_real(), src, kHaloTag, comm_,
+                  &requests_.back());
+    }
+
+    void wait_all() override {
+        MPI_Waitall(static_cast<int>(requests_.size()), requests_.data(), MPI_STATUSES_IGNORE);
+        requests_.clear();
+    }
+
+private:
+    MPI_Comm comm_;
+    int rank_{0};
+    int size_{1};
+    std::vector<MPI_Request> requests_;  // posted isend / irecv
+
+    template <typename T>
+    void exchange(int dest, const std::vector<T>& send, int src, std::vector<T>& recv) {
+        int send_count = static_cast<int>(send.size());
+        int recv_count = 0;
+        MPI_Sendrecv(&send_count, 1, MPI_INT, dest, kExchangeTag, &recv_count, 1, MPI_INT, src,
+                     kExchangeTag, comm_, MPI_STATUS_IGNORE);
+        recv.resize(static_cast<std::size_t>(recv_count));
+        MPI_Sendrecv(send.data(), send_count, MpiType<T>::get(), dest, kExchangeTag, recv.data(),
+                     recv_count, MpiType<T>::get(), src, kExchangeTag, comm_, MPI_STATUS_IGNORE);
+    }
+
+    template <typename T>
+    void gather_into(const std::vector<T>& send, std::vector<T>& recv, int root) {
+        int count = static_cast<int>(send.size());
+        std::vector<int> counts(rank_ == root ? static_cast<std::size_t>(size_) : 0);
+        MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, root, comm_);
+        std::vector<int> displs(counts.size());
+        if (rank_ == root) {
+            int total = 0;
+            for (std::size_t r = 0; r < counts.size(); ++r) {
+                displs[r] = total;
+                total += counts[r];
+            }
+            recv.resize(static_cast<std::size_t>(total));
+        }
+        MPI_Gatherv(send.data(), count, MpiType<T>::get(), recv.data(), counts.data(),
+                    displs.data(), MpiType<T>::get(), root, comm_);
+    }
+};
+
+}  // namespace
+
+MpiSession::MpiSession(int& argc, char**& argv) {
+    int initialized = 0;
+    MPI_Initialized(&initialized);
+    if (!initialized) {
+        MPI_Init(&argc, &argv);
+        owns_ = true;
+    }
+}
+
+MpiSession::~MpiSession() {
+    if (owns_) MPI_Finalize();
+}
+
+std::shared_ptr<Communicator> make_world_communicator() {
+    int initialized = 0;
+    MPI_Initialized(&initialized);
+    if (!initialized) return nullptr;
+    return std::make_shared<MpiCommunicator>(MPI_COMM_WORLD);
+}
+
+#else
+
+MpiSession::MpiSession(int&, char**&) {}
+
+MpiSession::~MpiSession() = default;
+
+std::shared_ptr<Communicator> make_world_communicator() { return nullptr; }
+
+#endif
+
+}  // namespace matsimu
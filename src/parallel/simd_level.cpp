@@ -0,0 +1,32 @@
+#include <matsimu/parallel/simd_level.hpp>
+
+namespace matsimu {
+
+namespace {
+
+SimdLevel detect_uncached() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::AVX2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+}  // namespace
+
+SimdLevel detect_simd_level() {
+    static const SimdLevel level = detect_uncached();
+    return level;
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+        case SimdLevel::Scalar: break;
+    }
+    return "scalar";
+}
+
+}  // namespace matsimu
@@ -0,0 +1,73 @@
+#include <matsimu/parallel/thread_pool.hpp>
+
+namespace matsimu {
+
+ThreadPool::ThreadPool(std::size_t num_threads) {
+    const std::size_t extra = num_threads > 1 ? num_threads - 1 : 0;
+    workers_.reserve(extra);
+    for (std::size_t t = 0; t < extra; ++t) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this, t + 1);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& w : workers_) w.join();
+}
+
+void ThreadPool::run(const std::function<void(std::size_t)>& task) {
+    if (workers_.empty()) {
+        task(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        pending_ = workers_.size();
+        error_ = nullptr;
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    std::exception_ptr local_error;
+    try {
+        task(0);
+    } catch (...) {
+        local_error = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return pending_ == 0; });
+    task_ = nullptr;
+    if (local_error) std::rethrow_exception(local_error);
+    if (error_) std::rethrow_exception(error_);
+}
+
+void ThreadPool::worker_loop(std::size_t tid) {
+    std::size_t seen = 0;
+    for (;;) {
+        const std::function<void(std::size_t)>* task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+            task = task_;
+        }
+        std::exception_ptr err;
+        try {
+            (*task)(tid);
+        } catch (...) {
+            err = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (err && !error_) error_ = err;
+        if (--pending_ == 0) done_cv_.notify_one();
+    }
+}
+
+}  // namespace matsimu
@@ -0,0 +1,349 @@
+#include <matsimu/physics/device_force_field.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace matsimu {
+
+namespace {
+
+constexpr Real kPi = 3.14159265358979323846;
+constexpr std::size_t kStride = TabulatedPotential::kSegmentStride;
+
+MATSIMU_OFFLOAD(declare target)
+
+/// Minimum image of one displacement component (orthorhombic box)
+inline Real min_image(Real d, Real length, Real inv_length) {
+    return d - length * std::nearbyint(d * inv_length);
+}
+
+/// LennardJones::energy_and_force for 1e-30 < r2 < cutoff²
+inline void lj_pair(Real r2, Real epsilon, Real sigma_sq, Real shift, Real& e, Real& f_div_r) {
+    const Real r2_inv = sigma_sq / r2;
+    const Real r6_inv = r2_inv * r2_inv * r2_inv;
+    const Real r12_inv = r6_inv * r6_inv;
+    e = 4.0 * epsilon * (r12_inv - r6_inv) - shift;
+    f_div_r = 24.0 * epsilon * (2.0 * r12_inv - r6_inv) / r2;
+}
+
+/// TabulatedPotential::energy_and_force for r2 < cutoff²
+inline void table_pair(Real r2, const Real* table, Real s_min, Real inv_h, std::size_t last,
+                       Real& e, Real& f_div_r) {
+    const Real x = (r2 - s_min) * inv_h;
+    std::size_t k = 0;
+    if (x > 0.0) {
+        k = static_cast<std::size_t>(x);
+        if (k > last) k = last;
+    }
+    const Real t = x - static_cast<Real>(k);
+    const Real* c = table + k * kStride;
+    e = c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+    f_div_r = c[4] + t * (c[5] + t * c[6]);
+}
+
+/// Cell of coordinate x along one axis of m cells (any x: wrapped first)
+inline std::size_t cell_coord(Real x, Real inv_length, std::size_t m) {
+    const Real s = x * inv_length;
+    const std::size_t c = static_cast<std::size_t>((s - std::floor(s)) * static_cast<Real>(m));
+    return c < m ? c : m - 1;
+}
+
+/// a-th of the distinct cells around c along an axis of m cells (a < min(m, 3))
+inline std::size_t cell_around(std::size_t c, std::size_t a, std::size_t m) {
+    return m >= 3 ? (c + a + m - 1) % m : a;
+}
+
+MATSIMU_OFFLOAD(end declare target)
+
+}  // namespace
+
+DeviceForceField::DeviceForceField(std::shared_ptr<Potential> potential, Real skin)
+    : potential_(std::move(potential)), skin_(skin) {
+    if (!potential_ || !supports(*potential_))
+        throw std::invalid_argument(
+            "DeviceForceField needs a LennardJones or TabulatedPotential (tabulate other potentials)");
+    cutoff_sq_ = potential_->cutoff_squared();
+    if (const auto* lj = dynamic_cast<const LennardJones*>(potential_.get())) {
+        epsilon_ = lj->epsilon();
+        sigma_sq_ = lj->sigma() * lj->sigma();
+        shift_ = lj->energy_shift();
+        table_.assign(kStride, 0.0);  // unused, keeps the kernels' map valid
+    } else {
+        const auto& tab = static_cast<const TabulatedPotential&>(*potential_);
+        tabulated_ = true;
+        table_.assign(tab.segment_data(), tab.segment_data() + tab.segments() * kStride);
+        s_min_ = tab.s_min();
+        inv_h_ = tab.inv_h();
+        last_segment_ = tab.segments() - 1;
+    }
+    table_device_.map(table_.data(), table_.size());
+}
+
+bool DeviceForceField::supports(const Potential& potential) {
+    return dynamic_cast<const LennardJones*>(&potential) != nullptr ||
+           dynamic_cast<const TabulatedPotential*>(&potential) != nullptr;
+}
+
+void DeviceForceField::set_box(const Lattice& box) {
+    const Real lengths[3] = {box.a1[0], box.a2[1], box.a3[2]};
+    for (int d = 0; d < 3; ++d) {
+        length_[d] = lengths[d];
+        inv_length_[d] = 1.0 / lengths[d];
+    }
+    stale_ = true;
+}
+
+void DeviceForceField::allocate(std::size_t rows, std::size_t capacity) {
+    neighbors_device_.release();
+    counts_device_.release();
+    for (auto& r : reference_device_) r.release();
+    neighbors_.assign(rows * capacity, 0);
+    counts_.assign(rows, 0);
+    for (auto& r : reference_) r.assign(rows, 0.0);
+    neighbors_device_.map(neighbors_.data(), neighbors_.size());
+    counts_device_.map(counts_.data(), counts_.size());
+    for (int d = 0; d < 3; ++d) reference_device_[d].map(reference_[d].data(), rows);
+    rows_ = rows;
+    capacity_ = capacity;
+}
+
+void DeviceForceField::allocate_cells(std::size_t n, std::size_t cells) {
+    cell_of_device_.release();
+    cell_start_device_.release();
+    cell_fill_device_.release();
+    cell_members_device_.release();
+    cell_of_.assign(n, 0);
+    cell_start_.assign(cells + 1, 0);
+    cell_fill_.assign(cells, 0);
+    cell_members_.assign(n, 0);
+    cell_of_device_.map(cell_of_.data(), n);
+    cell_start_device_.map(cell_start_.data(), cells + 1);
+    cell_fill_device_.map(cell_fill_.data(), cells);
+    cell_members_device_.map(cell_members_.data(), n);
+}
+
+void DeviceForceField::bin(const DeviceParticleArrays& p) {
+    const std::size_t n = p.n;
+    const Real list_cut = std::sqrt(cutoff_sq_) + skin_;
+    std::size_t m[3];
+    for (int d = 0; d < 3; ++d)
+        m[d] = std::max<std::size_t>(1, static_cast<std::size_t>(length_[d] / list_cut));
+    // Dilute systems: no more cells than particles (wider cells stay valid).
+    while (m[0] * m[1] * m[2] > std::max<std::size_t>(n, 27))
+        for (auto& md : m) md = std::max<std::size_t>(1, md / 2);
+    const std::size_t cells = m[0] * m[1] * m[2];
+    if (cell_of_.size() != n || cell_fill_.size() != cells) allocate_cells(n, cells);
+    for (int d = 0; d < 3; ++d) cells_[d] = m[d];
+
+    const Real* x = p.pos[0];
+    const Real* y = p.pos[1];
+    const Real* z = p.pos[2];
+    std::uint32_t* cell_of = cell_of_.data();
+    std::uint32_t* start = cell_start_.data();
+    std::uint32_t* fill = cell_fill_.data();
+    std::uint32_t* members = cell_members_.data();
+    const std::size_t mx = m[0], my = m[1], mz = m[2];
+    const Real ilx = inv_length_[0], ily = inv_length_[1], ilz = inv_length_[2];
+    MATSIMU_OFFLOAD(target teams distribute parallel for map(alloc: fill[0:cells]))
+    for (std::size_t c = 0; c < cells; ++c) fill[c] = 0;
+    MATSIMU_OFFLOAD(target teams distribute parallel for \
+                    map(alloc: x[0:n], y[0:n], z[0:n], cell_of[0:n], fill[0:cells]))
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t c = (cell_coord(x[i], ilx, mx) * my + cell_coord(y[i], ily, my)) * mz
+                              + cell_coord(z[i], ilz, mz);
+        cell_of[i] = static_cast<std::uint32_t>(c);
+        MATSIMU_OFFLOAD(atomic update)
+        fill[c] += 1;
+    }
+    // Counts -> offsets, one device thread; fill becomes each cell's cursor.
+    MATSIMU_OFFLOAD(target map(alloc: start[0:cells + 1], fill[0:cells]))
+    {
+        start[0] = 0;
+        for (std::size_t c = 0; c < cells; ++c) {
+            start[c + 1] = start[c] + fill[c];
+            fill[c] = start[c];
+        }
+    }
+    MATSIMU_OFFLOAD(target teams distribute parallel for \
+                    map(alloc: cell_of[0:n], fill[0:cells], members[0:n]))
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint32_t slot;
+        std::uint32_t* cursor = fill + cell_of[i];
+        MATSIMU_OFFLOAD(atomic capture)
+        slot = (*cursor)++;
+        members[slot] = static_cast<std::uint32_t>(i);
+    }
+    // Members by index, so list rows do not depend on the order threads ran.
+    MATSIMU_OFFLOAD(target teams distribute parallel for \
+                    map(alloc: start[0:cells + 1], members[0:n]))
+    for (std::size_t c = 0; c < cells; ++c) {
+        for (std::uint32_t k = start[c] + 1; k < start[c + 1]; ++k) {
+            const std::uint32_t v = members[k];
+            std::uint32_t at = k;
+            for (; at > start[c] && members[at - 1] > v; --at) members[at] = members[at - 1];
+            members[at] = v;
+        }
+    }
+}
+
+bool DeviceForceField::needs_rebuild(const DeviceParticleArrays& p) const {
+    if (stale_ || rows_ != p.n) return true;
+    const std::size_t n = p.n;
+    const Real* x = p.pos[0];
+    const Real* y = p.pos[1];
+    const Real* z = p.pos[2];
+    const Real* rx = reference_[0].data();
+    const Real* ry = reference_[1].data();
+    const Real* rz = reference_[2].data();
+    const Real lx = length_[0], ly = length_[1], lz = length_[2];
+    const Real ilx = inv_length_[0], ily = inv_length_[1], ilz = inv_length_[2];
+    Real worst = 0.0;
+    MATSIMU_OFFLOAD(target teams distribute parallel for reduction(max: worst) \
+                    map(alloc: x[0:n], y[0:n], z[0:n], rx[0:n], ry[0:n], rz[0:n]))
+    for (std::size_t i = 0; i < n; ++i) {
+        const Real dx = min_image(x[i] - rx[i], lx, ilx);
+        const Real dy = min_image(y[i] - ry[i], ly, ily);
+        const Real dz = min_image(z[i] - rz[i], lz, ilz);
+        const Real d2 = dx * dx + dy * dy + dz * dz;
+        worst = d2 > worst ? d2 : worst;
+    }
+    const Real half_skin = 0.5 * skin_;
+    return worst > half_skin * half_skin;
+}
+
+void DeviceForceField::rebuild(const DeviceParticleArrays& p) {
+    const std::size_t n = p.n;
+    const Real list_cut = std::sqrt(cutoff_sq_) + skin_;
+    if (rows_ != n || capacity_ == 0) {
+        // Expected neighbors at the mean density, with headroom.
+        const Real volume = length_[0] * length_[1] * length_[2];
+        const Real expected = 4.0 / 3.0 * kPi * list_cut * list_cut * list_cut *
+                              static_cast<Real>(n) / volume;
+        const Real slots = std::isfinite(expected) ? std::min(1.3 * expected, static_cast<Real>(n)) : 0.0;
+        allocate(n, static_cast<std::size_t>(slots) + 16);
+    }
+    bin(p);
+    const Real* x = p.pos[0];
+    const Real* y = p.pos[1];
+    const Real* z = p.pos[2];
+    const std::uint32_t* cell_of = cell_of_.data();
+    const std::uint32_t* start = cell_start_.data();
+    const std::uint32_t* members = cell_members_.data();
+    const std::size_t mx = cells_[0], my = cells_[1], mz = cells_[2];
+    const std::size_t cells = mx * my * mz;
+    const std::size_t sx = std::min<std::size_t>(mx, 3), sy = std::min<std::size_t>(my, 3),
+                      sz = std::min<std::size_t>(mz, 3);
+    const Real lx = length_[0], ly = length_[1], lz = length_[2];
+    const Real ilx = inv_length_[0], ily = inv_length_[1], ilz = inv_length_[2];
+    const Real list_cut_sq = list_cut * list_cut;
+    for (;;) {
+        std::uint32_t* nb = neighbors_.data();
+        std::uint32_t* cnt = counts_.data();
+        Real* rx = reference_[0].data();
+        Real* ry = reference_[1].data();
+        Real* rz = reference_[2].data();
+        const std::size_t cap = capacity_;
+        const std::size_t slots = n * cap;
+        std::size_t longest = 0;
+        MATSIMU_OFFLOAD(target teams distribute parallel for reduction(max: longest) \
+                        map(alloc: x[0:n], y[0:n], z[0:n], nb[0:slots], cnt[0:n], \
+                            rx[0:n], ry[0:n], rz[0:n], cell_of[0:n], start[0:cells + 1], \
+                            members[0:n]))
+        for (std::size_t i = 0; i < n; ++i) {
+            const Real xi = x[i], yi = y[i], zi = z[i];
+            const std::size_t home = cell_of[i];
+            const std::size_t cx = home / (my * mz), cy = home / mz % my, cz = home % mz;
+            std::size_t c = 0;
+            for (std::size_t a = 0; a < sx; ++a)
+                for (std::size_t b = 0; b < sy; ++b)
+                    for (std::size_t e = 0; e < sz; ++e) {
+                        const std::size_t cell = (cell_around(cx, a, mx) * my + cell_around(cy, b, my)) * mz
+                                                 + cell_around(cz, e, mz);
+                        for (std::uint32_t k = start[cell]; k < start[cell + 1]; ++k) {
+                            const std::size_t j = members[k];
+                            if (j == i) continue;
+                            const Real dx = min_image(xi - x[j], lx, ilx);
+                            const Real dy = min_image(yi - y[j], ly, ily);
+                            const Real dz = min_image(zi - z[j], lz, ilz);
+                            if (dx * dx + dy * dy + dz * dz < list_cut_sq) {
+                                if (c < cap) nb[i * cap + c] = static_cast<std::uint32_t>(j);
+                                ++c;
+                            }
+                        }
+                    }
+            cnt[i] = static_cast<std::uint32_t>(c < cap ? c : cap);
+            longest = c > longest ? c : longest;
+            rx[i] = xi;
+            ry[i] = yi;
+            rz[i] = zi;
+        }
+        (void)slots;
+        (void)cells;
+        if (longest <= cap) break;
+        allocate(n, longest + longest / 4 + 8);  // rows overflowed: widen and redo
+    }
+    stale_ = false;
+    ++rebuilds_;
+}
+
+Real DeviceForceField::compute_forces(const DeviceParticleArrays& p, bool with_energy) {
+    if (p.n == 0) return 0.0;
+    if (needs_rebuild(p)) rebuild(p);
+
+    const std::size_t n = p.n;
+    const Real* x = p.pos[0];
+    const Real* y = p.pos[1];
+    const Real* z = p.pos[2];
+    Real* fx = p.force[0];
+    Real* fy = p.force[1];
+    Real* fz = p.force[2];
+    const std::uint32_t* nb = neighbors_.data();
+    const std::uint32_t* cnt = counts_.data();
+    const Real* table = table_.data();
+    const std::size_t cap = capacity_;
+    const std::size_t slots = n * cap;
+    const std::size_t table_size = table_.size();
+    const bool tabulated = tabulated_;
+    const Real rc2 = cutoff_sq_;
+    const Real epsilon = epsilon_, sigma_sq = sigma_sq_, shift = shift_;
+    const Real s_min = s_min_, inv_h = inv_h_;
+    const std::size_t last = last_segment_;
+    const Real lx = length_[0], ly = length_[1], lz = length_[2];
+    const Real ilx = inv_length_[0], ily = inv_length_[1], ilz = inv_length_[2];
+    Real epot = 0.0;
+    MATSIMU_OFFLOAD(target teams distribute parallel for reduction(+: epot) \
+                    map(alloc: x[0:n], y[0:n], z[0:n], fx[0:n], fy[0:n], fz[0:n], \
+                        nb[0:slots], cnt[0:n], table[0:table_size]))
+    for (std::size_t i = 0; i < n; ++i) {
+        const Real xi = x[i], yi = y[i], zi = z[i];
+        Real fxi = 0.0, fyi = 0.0, fzi = 0.0, ei = 0.0;
+        const std::uint32_t* row = nb + i * cap;
+        for (std::uint32_t k = 0; k < cnt[i]; ++k) {
+            const std::size_t j = row[k];
+            const Real dx = min_image(xi - x[j], lx, ilx);
+            const Real dy = min_image(yi - y[j], ly, ily);
+            const Real dz = min_image(zi - z[j], lz, ilz);
+            const Real r2 = dx * dx + dy * dy + dz * dz;
+            if (!(r2 < rc2)) continue;
+            Real e = 0.0, f_div_r = 0.0;
+            if (tabulated)
+                table_pair(r2, table, s_min, inv_h, last, e, f_div_r);
+            else if (r2 > 1e-30)
+                lj_pair(r2, epsilon, sigma_sq, shift, e, f_div_r);
+            fxi += f_div_r * dx;
+            fyi += f_div_r * dy;
+            fzi += f_div_r * dz;
+            ei += e;
+        }
+        fx[i] = fxi;
+        fy[i] = fyi;
+        fz[i] = fzi;
+        epot += ei;
+    }
+    (void)slots;
+    (void)table_size;
+    // Every pair was visited from both sides.
+    return with_energy ? 0.5 * epot : 0.0;
+}
+
+}  // namespace matsimu
@@ -0,0 +1,45 @@
+#include <matsimu/physics/force_buffers.hpp>
+#include <algorithm>
+
+namespace matsimu {
+
+void ThreadForceBuffers::prepare(std::size_t threads, std::size_t n) {
+    threads_ = threads;
+    n_ = n;
+    buffers_.resize(threads > 1 ? (threads - 1) * 3 * n : 0);
+    energy_.assign(threads, 0.0);
+}
+
+void ThreadForceBuffers::begin_thread(std::size_t tid, ParticleSystem& system, Real* f[3]) {
+    if (tid == 0) {
+        for (int d = 0; d < 3; ++d) f[d] = system.force(d);
+        return;
+    }
+    Real* base = buffers_.data() + (tid - 1) * 3 * n_;
+    std::fill(base, base + 3 * n_, 0.0);
+    for (int d = 0; d < 3; ++d) f[d] = base + static_cast<std::size_t>(d) * n_;
+}
+
+Real ThreadForceBuffers::reduce(ParticleSystem& system, ThreadPool& pool) {
+    const std::size_t n = n_;
+    const std::size_t threads = threads_;
+    if (threads > 1) {
+        pool.run([&](std::size_t tid) {
+            const auto linear = [](std::size_t i) { return i; };
+            const std::size_t begin = balanced_split(n, tid, pool.size(), linear);
+            const std::size_t end = balanced_split(n, tid + 1, pool.size(), linear);
+            for (int d = 0; d < 3; ++d) {
+                Real* f = system.force(d);
+                for (std::size_t t = 1; t < threads; ++t) {
+                    const Real* b = buffers_.data() + ((t - 1) * 3 + static_cast<std::size_t>(d)) * n;
+                    for (std::size_t i = begin; i < end; ++i) f[i] += b[i];
+                }
+            }
+        });
+    }
+    Real epot = 0.0;
+    for (Real e : energy_) epot += e;
+    return epot;
+}
+
+}  // namespace matsimu
@@ -1,36 +1,95 @@
 #include <matsimu/physics/integrator.hpp>
+#include <algorithm>
 
 namespace matsimu {
 
-void VelocityVerlet::step1(ParticleSystem& system) const {
-    for (auto& p : system.particles()) {
-        // v(t+dt/2) = v(t) + 0.5*dt*a(t)
-        Real ax = p.force[0] / p.mass;
-        Real ay = p.force[1] / p.mass;
-        Real az = p.force[2] / p.mass;
-        
-        p.vel[0] += half_dt_ * ax;
-        p.vel[1] += half_dt_ * ay;
-        p.vel[2] += half_dt_ * az;
-        
-        // r(t+dt) = r(t) + dt*v(t+dt/2)
-        p.pos[0] += dt_ * p.vel[0];
-        p.pos[1] += dt_ * p.vel[1];
-        p.pos[2] += dt_ * p.vel[2];
+namespace {
+
+// Finiteness probes are fused into the update loops: (x - x) is 0 for finite
+// x and NaN otherwise, so one running sum flags any non-finite value without
+// a branch or an extra pass over memory.
+
+template <bool Check>
+bool kick_drift(ParticleSystem& system, Real dt, Real half_dt) {
+    const std::size_t n = system.size();
+    const Real* inv_m = system.inverse_masses();
+    Real probe = 0.0;
+    for (int d = 0; d < 3; ++d) {
+        Real* x = system.pos(d);
+        Real* v = system.vel(d);
+        const Real* f = system.force(d);
+        for (std::size_t i = 0; i < n; ++i) {
+            // v(t+dt/2) = v(t) + 0.5*dt*a(t)
+            v[i] += half_dt * (f[i] * inv_m[i]);
+            // r(t+dt) = r(t) + dt*v(t+dt/2)
+            x[i] += dt * v[i];
+            if (Check) probe += x[i] - x[i];
+        }
     }
+    return !Check || probe == 0.0;
 }
 
-void VelocityVerlet::step2(ParticleSystem& system) const {
-    for (auto& p : system.particles()) {
-        // v(t+dt) = v(t+dt/2) + 0.5*dt*a(t+dt)
-        Real ax = p.force[0] / p.mass;
-        Real ay = p.force[1] / p.mass;
-        Real az = p.force[2] / p.mass;
-        
-        p.vel[0] += half_dt_ * ax;
-        p.vel[1] += half_dt_ * ay;
-        p.vel[2] += half_dt_ * az;
+// Slots per block of the second kick; the moment sums re-read the block from L1.
+constexpr std::size_t kKickBlock = 1024;
+
+// v += half_dt * f / m. Moments: also sum and cache the kinetic moments of
+// the new velocities (the last kick of a step). profile: bin the new
+// velocities per slab in the same blocks (sampled steps only).
+template <bool Check, bool Moments = true>
+bool kick(ParticleSystem& system, const Real* const force[3], Real half_dt,
+          KineticProfile* profile = nullptr) {
+    const std::size_t n = system.size();
+    const Real* inv_m = system.inverse_masses();
+    const Real* m = system.masses();
+    Real probe = 0.0;
+    Real min_inv_m = 1.0;
+    VelocityMomentSums sums;
+    for (int d = 0; d < 3; ++d) {
+        Real* v = system.vel(d);
+        const Real* f = force[d];
+        for (std::size_t b = 0; b < n; b += kKickBlock) {
+            const std::size_t e = std::min(n, b + kKickBlock);
+            for (std::size_t i = b; i < e; ++i) {
+                // v(t+dt) = v(t+dt/2) + 0.5*dt*a(t+dt)
+                v[i] += half_dt * (f[i] * inv_m[i]);
+                if (Check) probe += (v[i] - v[i]) + (f[i] - f[i]);
+                // Mass must be finite and positive: 1/m finite and > 0.
+                if (Check && d == 0) {
+                    probe += inv_m[i] - inv_m[i];
+                    min_inv_m = std::min(min_inv_m, inv_m[i]);
+                }
+            }
+            if (Moments) sums.add(d, m, v, b, e);
+            if (profile) profile->add(system, d, v, b, e);
+        }
     }
+    // End-of-step velocities: thermostat and energy readouts reuse these.
+    if (Moments) system.cache_kinetic_moments(sums.finish(n));
+    return !Check || (probe == 0.0 && min_inv_m > 0.0);
+}
+
+template <bool Check, bool Moments = true>
+bool kick(ParticleSystem& system, Real half_dt, KineticProfile* profile = nullptr) {
+    const Real* force[3] = {system.force(0), system.force(1), system.force(2)};
+    return kick<Check, Moments>(system, force, half_dt, profile);
+}
+
+}  // namespace
+
+void VelocityVerlet::step1(ParticleSystem& system) const {
+    kick_drift<false>(system, dt_, half_dt_);
+}
+
+void VelocityVerlet::step2(ParticleSystem& system, KineticProfile* profile) const {
+    kick<false>(system, half_dt_, profile);
+}
+
+bool VelocityVerlet::step1_checked(ParticleSystem& system) const {
+    return kick_drift<true>(system, dt_, half_dt_);
+}
+
+bool VelocityVerlet::step2_checked(ParticleSystem& system, KineticProfile* profile) const {
+    return kick<true>(system, half_dt_, profile);
 }
 
 void VelocityVerlet::integrate(ParticleSystem& system,
@@ -46,21 +105,61 @@ void VelocityVerlet::integrate(ParticleSystem& system,
     step2(system);
 }
 
+RespaIntegrator::RespaIntegrator(Real dt, std::size_t inner_steps, Real split, Real switch_width)
+    : VelocityVerlet(dt), inner_steps_(std::max<std::size_t>(1, inner_steps)),
+      split_(split), switch_width_(switch_width) {}
+
+void RespaIntegrator::prime(ParticleSystem& system, const ForcePass& inner, const ForcePass& outer) {
+    const std::size_t n = system.size();
+    outer(system);
+    outer_.resize(3 * n);
+    for (int d = 0; d < 3; ++d)
+        std::copy(system.force(d), system.force(d) + n, outer_.begin() + d * n);
+    inner(system);
+}
+
+bool RespaIntegrator::step(ParticleSystem& system, const ForcePass& inner, const ForcePass& outer,
+                           bool check, KineticProfile* profile) {
+    if (!primed(system)) prime(system, inner, outer);
+    const std::size_t n = system.size();
+    const Real half_dt = 0.5 * dt();
+    const Real dt_in = inner_dt();
+    const Real half_dt_in = 0.5 * dt_in;
+    const Real* f_outer[3] = {outer_.data(), outer_.data() + n, outer_.data() + 2 * n};
+
+    bool ok = check ? kick<true, false>(system, f_outer, half_dt)
+                    : kick<false, false>(system, f_outer, half_dt);
+    for (std::size_t s = 0; s < inner_steps_; ++s) {
+        ok = (check ? kick_drift<true>(system, dt_in, half_dt_in)
+                    : kick_drift<false>(system, dt_in, half_dt_in)) && ok;
+        inner(system);
+        ok = (check ? kick<true, false>(system, half_dt_in)
+                    : kick<false, false>(system, half_dt_in)) && ok;
+    }
+
+    // Park the inner forces in outer_ while the outer pass overwrites
+    // system.force(), then swap: the next step starts from the same layout.
+    for (int d = 0; d < 3; ++d)
+        std::copy(system.force(d), system.force(d) + n, outer_.begin() + d * n);
+    outer(system);
+    ok = (check ? kick<true>(system, half_dt, profile) : kick<false>(system, half_dt, profile)) && ok;
+    for (int d = 0; d < 3; ++d)
+        std::swap_ranges(system.force(d), system.force(d) + n, outer_.begin() + d * n);
+    return ok;
+}
+
 void EulerIntegrator::step(ParticleSystem& system) const {
-    for (auto& p : system.particles()) {
-        // Update velocity
-        Real ax = p.force[0] / p.mass;
-        Real ay = p.force[1] / p.mass;
-        Real az = p.force[2] / p.mass;
-        
-        p.vel[0] += dt_ * ax;
-        p.vel[1] += dt_ * ay;
-        p.vel[2] += dt_ * az;
-        
-        // Update position
-        p.pos[0] += dt_ * p.vel[0];
-        p.pos[1] += dt_ * p.vel[1];
-        p.pos[2] += dt_ * p.vel[2];
+    const std::size_t n = system.size();
+    const Real* inv_m = system.inverse_masses();
+    for (int d = 0; d < 3; ++d) {
+        Real* x = system.pos(d);
+        Real* v = system.vel(d);
+        const Real* f = system.force(d);
+        for (std::size_t i = 0; i < n; ++i) {
+            // Update velocity, then position
+            v[i] += dt_ * (f[i] * inv_m[i]);
+            x[i] += dt_ * v[i];
+        }
     }
 }
 
@@ -76,11 +175,15 @@ Real TimeStepValidation::estimate_characteristic_time(const ParticleSystem& syst
     Real min_mass = std::numeric_limits<Real>::max();
     Real max_vel = 0.0;
     
-    for (const auto& p : system.particles()) {
-        if (p.mass > 0.0 && p.mass < min_mass) {
-            min_mass = p.mass;
+    const Real* m = system.masses();
+    const Real* vx = system.vel(0);
+    const Real* vy = system.vel(1);
+    const Real* vz = system.vel(2);
+    for (std::size_t i = 0; i < system.size(); ++i) {
+        if (m[i] > 0.0 && m[i] < min_mass) {
+            min_mass = m[i];
         }
-        Real v2 = p.vel[0]*p.vel[0] + p.vel[1]*p.vel[1] + p.vel[2]*p.vel[2];
+        Real v2 = vx[i]*vx[i] + vy[i]*vy[i] + vz[i]*vz[i];
         Real v = std::sqrt(v2);
         if (v > max_vel) {
             max_vel = v;
@@ -1,11 +1,40 @@
 #include <matsimu/physics/neighbor_list.hpp>
+#include <matsimu/physics/pair_kernel.hpp>
+#include <matsimu/physics/simd_lj.hpp>
+#include <matsimu/physics/spatial_sort.hpp>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
 
 namespace matsimu {
 
-NeighborList::NeighborList(Real cutoff, Real skin)
-    : cutoff_(cutoff), skin_(skin), num_pairs_(0) {
+namespace {
+
+// Upper bound on grid cells relative to particle count; keeps memory O(N)
+// when the cutoff is tiny compared to the box.
+constexpr std::size_t kMaxCellsPerParticle = 2;
+
+// Largest 32-bit-safe grid dimension per axis.
+constexpr std::size_t kMaxCellsPerAxis = 1024;
+
+void shrink_grid_to(std::size_t dims[3], std::size_t max_cells, std::size_t min_dim) {
+    std::size_t total = dims[0] * dims[1] * dims[2];
+    if (total <= max_cells) return;
+    // Uniform shrink; wider cells stay valid (width >= cutoff + skin).
+    const Real factor = std::cbrt(static_cast<Real>(total) / static_cast<Real>(max_cells));
+    for (int d = 0; d < 3; ++d) {
+        std::size_t shrunk = static_cast<std::size_t>(static_cast<Real>(dims[d]) / factor);
+        dims[d] = std::max(min_dim, shrunk);
+    }
+}
+
+}  // namespace
+
+NeighborList::NeighborList(Real cutoff, Real skin, NeighborBuild mode)
+    : cutoff_(cutoff), skin_(skin), build_mode_(mode), num_pairs_(0) {
     set_cutoff(cutoff, skin);
 }
 
@@ -17,50 +46,198 @@ void NeighborList::set_cutoff(Real cutoff, Real skin) {
 }
 
 std::size_t NeighborList::build(const ParticleSystem& system, const Lattice* lattice) {
+    const std::uint64_t t0 = profile_clock_ns();
     std::size_t n = system.size();
-    neighbors_.clear();
-    neighbors_.resize(n);
+    if (n > std::numeric_limits<std::uint32_t>::max())
+        throw std::length_error("NeighborList: particle count exceeds 32-bit index range");
+    offsets_.resize(n + 1);
+    offsets_[0] = 0;
+    indices_.clear();
     last_positions_.resize(n);
     num_pairs_ = 0;
     
     // Store positions
+    const Real* x = system.pos(0);
+    const Real* y = system.pos(1);
+    const Real* z = system.pos(2);
     for (std::size_t i = 0; i < n; ++i) {
-        last_positions_[i] = {system[i].pos[0], system[i].pos[1], system[i].pos[2]};
+        last_positions_[i] = {x[i], y[i], z[i]};
+    }
+    
+    if (build_mode_ == NeighborBuild::BruteForce || !build_cells(system, lattice)) {
+        build_brute_force(system, lattice);
     }
+    num_pairs_ = indices_.size();
+    ++build_count_;
+    pairs_built_ += num_pairs_;
+    build_ns_ += profile_clock_ns() - t0;
     
-    // Build list
+    return num_pairs_;
+}
+
+void NeighborList::build_brute_force(const ParticleSystem& system, const Lattice* lattice) {
+    std::size_t n = system.size();
     for (std::size_t i = 0; i < n; ++i) {
-        for (std::size_t j = i + 1; j < n; ++j) {
+        for (std::size_t j = i + 1; j < n && i < row_limit_; ++j) {
             Real dx[3];
-            Real r2 = distance_sq(system[i], system[j], lattice, dx);
-            if (r2 < cutoff_sq_) {
-                neighbors_[i].push_back(j);
-                ++num_pairs_;
+            Real r2 = distance_sq(system, i, j, lattice, dx);
+            if (within_cutoff(r2)) {
+                indices_.push_back(static_cast<std::uint32_t>(j));
             }
         }
+        offsets_[i + 1] = indices_.size();
     }
-    
-    return num_pairs_;
+}
+
+bool NeighborList::build_cells(const ParticleSystem& system, const Lattice* lattice) {
+    const std::size_t n = system.size();
+    const Real rc = cutoff_ + skin_;
+    if (n < 2 || !(rc > 0.0) || !std::isfinite(rc)) return false;
+
+    // Grid dimensions and the map from a particle to integer cell coordinates.
+    // Periodic: bin in fractional coordinates; the perpendicular width of the
+    // cell along axis d is V / |a_j × a_k|, so n_d = floor(width_d / rc).
+    // Open: bin the Cartesian bounding box.
+    std::size_t dims[3] = {1, 1, 1};
+    Real origin[3] = {0.0, 0.0, 0.0};
+    Real inv_width[3] = {0.0, 0.0, 0.0};
+    const bool periodic = (lattice != nullptr);
+
+    if (periodic) {
+        const Real vol = std::fabs(lattice->volume());
+        if (!(vol > 0.0) || !std::isfinite(vol)) return false;
+        const Real* a[3] = {lattice->a1, lattice->a2, lattice->a3};
+        for (int d = 0; d < 3; ++d) {
+            const Real* u = a[(d + 1) % 3];
+            const Real* v = a[(d + 2) % 3];
+            const Real cx = u[1] * v[2] - u[2] * v[1];
+            const Real cy = u[2] * v[0] - u[0] * v[2];
+            const Real cz = u[0] * v[1] - u[1] * v[0];
+            const Real width = vol / std::sqrt(cx * cx + cy * cy + cz * cz);
+            const Real cells = std::floor(width / rc);
+            // Fewer than 3 cells would visit the same cell twice via wrap-around.
+            if (!std::isfinite(cells) || cells < 3.0) return false;
+            dims[d] = static_cast<std::size_t>(std::min<Real>(cells, kMaxCellsPerAxis));
+        }
+        shrink_grid_to(dims, std::max<std::size_t>(27, kMaxCellsPerParticle * n), 3);
+    } else {
+        Real lo[3], hi[3];
+        for (int d = 0; d < 3; ++d) {
+            const Real* x = system.pos(d);
+            lo[d] = hi[d] = x[0];
+            for (std::size_t i = 1; i < n; ++i) {
+                lo[d] = std::min(lo[d], x[i]);
+                hi[d] = std::max(hi[d], x[i]);
+            }
+        }
+        for (int d = 0; d < 3; ++d) {
+            const Real extent = hi[d] - lo[d];
+            if (!std::isfinite(extent)) return false;
+            const Real cells = std::floor(extent / rc);
+            dims[d] = static_cast<std::size_t>(std::clamp<Real>(cells, 1.0, kMaxCellsPerAxis));
+            origin[d] = lo[d];
+        }
+        shrink_grid_to(dims, std::max<std::size_t>(27, kMaxCellsPerParticle * n), 1);
+        for (int d = 0; d < 3; ++d) {
+            const Real extent = hi[d] - lo[d];
+            inv_width[d] = (extent > 0.0) ? static_cast<Real>(dims[d]) / extent : 0.0;
+        }
+    }
+
+    const std::size_t ncells = dims[0] * dims[1] * dims[2];
+    auto cell_coord = [&](std::size_t i, std::size_t c[3]) {
+        const Real r[3] = {system.pos(0)[i], system.pos(1)[i], system.pos(2)[i]};
+        Real s[3];
+        if (periodic) {
+            lattice->cartesian_to_fractional(r, s);
+            for (int d = 0; d < 3; ++d) s[d] = (s[d] - std::floor(s[d])) * static_cast<Real>(dims[d]);
+        } else {
+            for (int d = 0; d < 3; ++d) s[d] = (r[d] - origin[d]) * inv_width[d];
+        }
+        for (int d = 0; d < 3; ++d) {
+            if (!std::isfinite(s[d]) || s[d] < 0.0) s[d] = 0.0;
+            c[d] = std::min(dims[d] - 1, static_cast<std::size_t>(s[d]));
+        }
+    };
+
+    // Counting sort of particles into cells.
+    cell_of_.resize(n);
+    cell_start_.assign(ncells + 1, 0);
+    cell_members_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::size_t c[3];
+        cell_coord(i, c);
+        cell_of_[i] = (c[2] * dims[1] + c[1]) * dims[0] + c[0];
+        ++cell_start_[cell_of_[i] + 1];
+    }
+    for (std::size_t c = 0; c < ncells; ++c) cell_start_[c + 1] += cell_start_[c];
+    {
+        scratch_.set_budget(system.budget());
+        scratch_.reserve(ncells * sizeof(std::size_t) + 64);
+        ArenaScope scope(scratch_);
+        ArenaVector<std::size_t> fill(cell_start_.begin(), cell_start_.end() - 1,
+                                      arena_allocator<std::size_t>(&scratch_));
+        for (std::size_t i = 0; i < n; ++i) cell_members_[fill[cell_of_[i]]++] = i;
+    }
+
+    // Scan the 27-cell neighborhood; keep j > i so each pair is stored once,
+    // exactly as the brute-force build does.
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i >= row_limit_) {
+            offsets_[i + 1] = indices_.size();
+            continue;
+        }
+        const std::size_t ci = cell_of_[i];
+        const long c0 = static_cast<long>(ci % dims[0]);
+        const long c1 = static_cast<long>((ci / dims[0]) % dims[1]);
+        const long c2 = static_cast<long>(ci / (dims[0] * dims[1]));
+        const std::size_t row_begin = indices_.size();
+        for (long o2 = -1; o2 <= 1; ++o2) {
+            long k2 = c2 + o2;
+            if (periodic) k2 = (k2 + static_cast<long>(dims[2])) % static_cast<long>(dims[2]);
+            else if (k2 < 0 || k2 >= static_cast<long>(dims[2])) continue;
+            for (long o1 = -1; o1 <= 1; ++o1) {
+                long k1 = c1 + o1;
+                if (periodic) k1 = (k1 + static_cast<long>(dims[1])) % static_cast<long>(dims[1]);
+                else if (k1 < 0 || k1 >= static_cast<long>(dims[1])) continue;
+                for (long o0 = -1; o0 <= 1; ++o0) {
+                    long k0 = c0 + o0;
+                    if (periodic) k0 = (k0 + static_cast<long>(dims[0])) % static_cast<long>(dims[0]);
+                    else if (k0 < 0 || k0 >= static_cast<long>(dims[0])) continue;
+                    const std::size_t cell = (static_cast<std::size_t>(k2) * dims[1]
+                                              + static_cast<std::size_t>(k1)) * dims[0]
+                                             + static_cast<std::size_t>(k0);
+                    for (std::size_t m = cell_start_[cell]; m < cell_start_[cell + 1]; ++m) {
+                        const std::size_t j = cell_members_[m];
+                        if (j <= i) continue;
+                        Real dx[3];
+                        Real r2 = distance_sq(system, i, j, lattice, dx);
+                        if (within_cutoff(r2)) indices_.push_back(static_cast<std::uint32_t>(j));
+                    }
+                }
+            }
+        }
+        // Ascending order keeps force summation order identical to BruteForce.
+        std::sort(indices_.begin() + static_cast<std::ptrdiff_t>(row_begin), indices_.end());
+        offsets_[i + 1] = indices_.size();
+    }
+    return true;
 }
 
 bool NeighborList::needs_rebuild(const ParticleSystem& system, const Lattice* lattice) const {
     if (system.size() != last_positions_.size()) return true;
     
+    const Real* x = system.pos(0);
+    const Real* y = system.pos(1);
+    const Real* z = system.pos(2);
     for (std::size_t i = 0; i < system.size(); ++i) {
+        const Real r[3] = {x[i], y[i], z[i]};
         Real dx[3];
-        dx[0] = system[i].pos[0] - last_positions_[i][0];
-        dx[1] = system[i].pos[1] - last_positions_[i][1];
-        dx[2] = system[i].pos[2] - last_positions_[i][2];
-        
         if (lattice) {
             // Check drift using min-image to ignore periodic wraps
-            Real frac[3];
-            lattice->cartesian_to_fractional(dx, frac);
-            // We want the displacement from the origin in fractional space, wrapped to [-0.5, 0.5]
-            for (int d = 0; d < 3; ++d) {
-                frac[d] = frac[d] - std::round(frac[d]);
-            }
-            lattice->fractional_to_cartesian(frac, dx);
+            lattice->min_image_displacement(last_positions_[i].data(), r, dx);
+        } else {
+            for (int d = 0; d < 3; ++d) dx[d] = r[d] - last_positions_[i][d];
         }
         
         Real dr2 = dx[0]*dx[0] + dx[1]*dx[1] + dx[2]*dx[2];
@@ -72,7 +249,8 @@ bool NeighborList::needs_rebuild(const ParticleSystem& system, const Lattice* la
 
 
 void NeighborList::clear() {
-    neighbors_.clear();
+    offsets_.clear();
+    indices_.clear();
     last_positions_.clear();
     num_pairs_ = 0;
 }
@@ -91,21 +269,85 @@ Real NeighborList::distance_sq(const Particle& p1, const Particle& p2,
     return dx[0]*dx[0] + dx[1]*dx[1] + dx[2]*dx[2];
 }
 
+Real NeighborList::distance_sq(const ParticleSystem& system, std::size_t i, std::size_t j,
+                                const Lattice* lattice, Real dx[3]) {
+    const Real r1[3] = {system.pos(0)[i], system.pos(1)[i], system.pos(2)[i]};
+    const Real r2[3] = {system.pos(0)[j], system.pos(1)[j], system.pos(2)[j]};
+    dx[0] = r2[0] - r1[0];
+    dx[1] = r2[1] - r1[1];
+    dx[2] = r2[2] - r1[2];
+    
+    if (lattice) {
+        lattice->min_image_displacement(r1, r2, dx);
+    }
+    
+    return dx[0]*dx[0] + dx[1]*dx[1] + dx[2]*dx[2];
+}
+
 // NeighborForceField implementation
 NeighborForceField::NeighborForceField(std::shared_ptr<Potential> potential,
-                                       Real cutoff, Real skin)
-    : potential_(std::move(potential)), nlist_(cutoff, skin) {}
+                                       Real cutoff, Real skin, NeighborBuild mode)
+    : potential_(std::move(potential)), nlist_(cutoff, skin, mode),
+      simd_level_(detect_simd_level()) {}
+
+void NeighborForceField::set_simd_level(SimdLevel level) {
+    simd_level_ = std::min(level, detect_simd_level());
+}
+
+void NeighborForceField::set_shell_switch(Real split, Real width) {
+    shell_switch_.split = split;
+    shell_switch_.width = std::clamp<Real>(width, 0.0, split);
+    inner_offsets_.clear();  // filtered at the old split; rebuilt with the list
+}
+
+void NeighborForceField::build_inner_list(const ParticleSystem& system, const Lattice* lattice) {
+    inner_offsets_.clear();
+    inner_indices_.clear();
+    if (shell_switch_.split <= 0.0) return;
+    // Pairs beyond split + skin now cannot come within split before the
+    // next rebuild (each particle moves at most skin/2).
+    const Real reach = shell_switch_.split + nlist_.skin();
+    const Real reach_sq = reach * reach;
+    const auto& offsets = nlist_.offsets();
+    const std::size_t rows = offsets.empty() ? 0 : offsets.size() - 1;
+    inner_offsets_.reserve(offsets.size());
+    inner_offsets_.push_back(0);
+    for (std::size_t i = 0; i < rows; ++i) {
+        for (const std::uint32_t j : nlist_.neighbors(i)) {
+            Real dx[3];
+            if (NeighborList::distance_sq(system, i, j, lattice, dx) < reach_sq)
+                inner_indices_.push_back(j);
+        }
+        inner_offsets_.push_back(inner_indices_.size());
+    }
+    inner_build_ = nlist_.build_count();
+}
 
-Real NeighborForceField::compute_forces(ParticleSystem& system, const Lattice* lattice) {
+Real NeighborForceField::compute_forces(ParticleSystem& system, const Lattice* lattice,
+                                       bool with_energy, ForceShell shell, PairSampler* sampler) {
     if (nlist_.needs_rebuild(system, lattice)) {
+        if (sort_interval_ > 0 && rebuilds_ % sort_interval_ == 0) {
+            const std::uint64_t t0 = profile_clock_ns();
+            sort_particles_morton(system, lattice, &nlist_.scratch());
+            sort_ns_ += profile_clock_ns() - t0;
+            ++sort_count_;
+        }
+        ++rebuilds_;
         nlist_.build(system, lattice);
+        build_inner_list(system, lattice);
     }
-    return compute_forces_internal(system, lattice);
+    if (shell != ForceShell::All) return compute_shell_forces(system, lattice, with_energy, shell);
+    const Real epot = compute_forces_internal(system, lattice, with_energy, sampler);
+    if (with_energy) store_energy(system, lattice, epot);
+    return epot;
 }
 
 Real NeighborForceField::compute_energy(const ParticleSystem& system, const Lattice* lattice) {
+    if (energy_cache_hit(system, lattice)) return energy_cache_.epot;
+    
     if (nlist_.needs_rebuild(system, lattice)) {
         nlist_.build(system, lattice);
+        build_inner_list(system, lattice);
     }
     
     if (!potential_) return 0.0;
@@ -117,7 +359,7 @@ Real NeighborForceField::compute_energy(const ParticleSystem& system, const Latt
         for (std::size_t j : nlist_.neighbors(i)) {
             // Calculate actual distance
             Real dx[3];
-            Real r2 = NeighborList::distance_sq(system[i], system[j], lattice, dx);
+            Real r2 = NeighborList::distance_sq(system, i, j, lattice, dx);
 
             if (r2 < potential_->cutoff_squared()) {
                 epot += potential_->energy(r2);
@@ -125,38 +367,126 @@ Real NeighborForceField::compute_energy(const ParticleSystem& system, const Latt
         }
     }
 
+    store_energy(system, lattice, epot);
     return epot;
 }
 
-Real NeighborForceField::compute_forces_internal(ParticleSystem& system, const Lattice* lattice) {
+namespace {
+
+void snapshot_basis(const Lattice* lattice, Real basis[9]) {
+    for (int d = 0; d < 3; ++d) {
+        basis[d] = lattice ? lattice->a1[d] : 0.0;
+        basis[3 + d] = lattice ? lattice->a2[d] : 0.0;
+        basis[6 + d] = lattice ? lattice->a3[d] : 0.0;
+    }
+}
+
+}  // namespace
+
+bool NeighborForceField::energy_cache_hit(const ParticleSystem& system,
+                                          const Lattice* lattice) const {
+    if (!energy_cache_.valid || energy_cache_.position_version != system.position_version()
+        || energy_cache_.lattice != lattice) {
+        return false;
+    }
+    Real basis[9];
+    snapshot_basis(lattice, basis);
+    return std::equal(basis, basis + 9, energy_cache_.basis);
+}
+
+void NeighborForceField::store_energy(const ParticleSystem& system, const Lattice* lattice,
+                                      Real epot) {
+    energy_cache_.valid = true;
+    energy_cache_.position_version = system.position_version();
+    energy_cache_.lattice = lattice;
+    snapshot_basis(lattice, energy_cache_.basis);
+    energy_cache_.epot = epot;
+}
+
+Real NeighborForceField::compute_forces_internal(ParticleSystem& system, const Lattice* lattice,
+                                                bool with_energy, PairSampler* sampler) {
     if (!potential_) return 0.0;
 
-    system.clear_forces();
-    Real epot = 0.0;
-    std::size_t n = system.size();
+    const auto& offsets = nlist_.offsets();
+    const auto pairs_before = [&offsets](std::size_t i) { return offsets[i]; };
+    const auto rows = [this](std::size_t i) { return nlist_.neighbors(i); };
 
-    for (std::size_t i = 0; i < n; ++i) {
-        for (std::size_t j : nlist_.neighbors(i)) {
-            Real dx[3];
-            Real r2 = NeighborList::distance_sq(system[i], system[j], lattice, dx);
-            
-            if (r2 < potential_->cutoff_squared()) {
-                Real e = potential_->energy(r2);
-                Real f_div_r = potential_->force_div_r(r2);
-                
-                epot += e;
-                
-                Real fx = f_div_r * dx[0];
-                Real fy = f_div_r * dx[1];
-                Real fz = f_div_r * dx[2];
-                
-                system[i].add_force(fx, fy, fz);
-                system[j].add_force(-fx, -fy, -fz);
-            }
-        }
+    if (sampler) {
+        sampler->prepare(pair_row_threads(pool_.get()));
+        return dispatch_pair_kernel(*potential_, [&](const auto& kernel) {
+            return run_pair_rows(pool_.get(), buffers_, system, pairs_before,
+                                 [&](std::size_t begin, std::size_t end, Real* const f[3],
+                                     std::size_t tid) {
+                const PairSampler::Sink sink = sampler->sink(tid);
+                return with_energy
+                    ? accumulate_pair_rows<true>(kernel, rows, system, lattice, begin, end, f, sink)
+                    : accumulate_pair_rows<false>(kernel, rows, system, lattice, begin, end, f, sink);
+            });
+        });
     }
-    
-    return epot;
+
+    SimdBox box;
+    if (simd_level_ != SimdLevel::Scalar && typeid(*potential_) == typeid(LennardJones)
+        && make_simd_box(lattice, box)) {
+        const auto& lj = static_cast<const LennardJones&>(*potential_);
+        return run_pair_rows(pool_.get(), buffers_, system, pairs_before,
+                             [&](std::size_t begin, std::size_t end, Real* const f[3]) {
+            return lj_neighbor_rows_simd(simd_level_, lj, nlist_, system, box, begin, end, f,
+                                         with_energy, precision_);
+        });
+    }
+    // Kernel chosen once per evaluation; the inner loop is free of virtual calls.
+    return dispatch_pair_kernel(*potential_, [&](const auto& kernel) {
+        return run_pair_rows(pool_.get(), buffers_, system, pairs_before,
+                             [&](std::size_t begin, std::size_t end, Real* const f[3]) {
+            return with_energy
+                ? accumulate_pair_rows<true>(kernel, rows, system, lattice, begin, end, f)
+                : accumulate_pair_rows<false>(kernel, rows, system, lattice, begin, end, f);
+        });
+    });
+}
+
+Real NeighborForceField::compute_shell_forces(ParticleSystem& system, const Lattice* lattice,
+                                             bool with_energy, ForceShell shell) {
+    if (!potential_) {
+        system.clear_forces();
+        return 0.0;
+    }
+
+    // The inner shell walks the short list when it belongs to the current build.
+    const bool short_list = shell == ForceShell::Inner && !inner_offsets_.empty()
+        && inner_build_ == nlist_.build_count();
+    const std::size_t* offsets = short_list ? inner_offsets_.data() : nlist_.offsets().data();
+    const std::uint32_t* indices = short_list ? inner_indices_.data() : nlist_.indices().data();
+    const auto pairs_before = [offsets](std::size_t i) { return offsets[i]; };
+    const auto rows = [offsets, indices](std::size_t i) {
+        return NeighborRange(indices + offsets[i], indices + offsets[i + 1]);
+    };
+
+    SimdBox box;
+    if (simd_level_ != SimdLevel::Scalar && typeid(*potential_) == typeid(LennardJones)
+        && make_simd_box(lattice, box)) {
+        const auto& lj = static_cast<const LennardJones&>(*potential_);
+        return run_pair_rows(pool_.get(), buffers_, system, pairs_before,
+                             [&](std::size_t begin, std::size_t end, Real* const f[3]) {
+            return lj_shell_rows_simd(simd_level_, lj, shell, shell_switch_, offsets, indices,
+                                      system, box, begin, end, f, with_energy);
+        });
+    }
+    const auto run = [&](const auto& shell_kernel) {
+        return run_pair_rows(pool_.get(), buffers_, system, pairs_before,
+                             [&](std::size_t begin, std::size_t end, Real* const f[3]) {
+            return with_energy
+                ? accumulate_pair_rows<true>(shell_kernel, rows, system, lattice, begin, end, f)
+                : accumulate_pair_rows<false>(shell_kernel, rows, system, lattice, begin, end, f);
+        });
+    };
+    return dispatch_pair_kernel(*potential_, [&](const auto& kernel) {
+        using Kernel = std::decay_t<decltype(kernel)>;
+        if (shell == ForceShell::Inner)
+            return run(ShellPairKernel<ForceShell::Inner, Kernel>(kernel, shell_switch_));
+        return run(ShellPairKernel<ForceShell::Outer, Kernel>(kernel, shell_switch_));
+    });
 }
 
 } // namespace matsimu
@@ -0,0 +1,197 @@
+#include <matsimu/physics/observables.hpp>
+#include <algorithm>
+#include <numeric>
+
+namespace matsimu {
+
+namespace {
+
+// Boltzmann constant [J/K]
+constexpr Real kB = 1.380649e-23;
+
+constexpr Real kPi = 3.14159265358979323846;
+
+}  // namespace
+
+void PairSampler::set_rdf(std::size_t bins, Real r_max) {
+    bins_ = r_max > 0.0 ? bins : 0;
+    r_max_ = r_max;
+    histogram_ = histogram_ && bins_ > 0;
+}
+
+void PairSampler::prepare(std::size_t threads) {
+    threads_ = threads;
+    virial_.assign(threads, 0.0);
+    counts_.assign(histogram_ ? threads * bins_ : 0, 0);
+}
+
+PairSampler::Sink PairSampler::sink(std::size_t tid) {
+    if (!histogram_) return Sink(&virial_[tid], nullptr, 1, 0.0, 0.0);
+    return Sink(&virial_[tid], counts_.data() + tid * bins_, bins_, r_max_ * r_max_,
+                static_cast<Real>(bins_) / r_max_);
+}
+
+Real PairSampler::virial() const {
+    Real w = 0.0;
+    for (Real v : virial_) w += v;
+    return w;
+}
+
+void PairSampler::add_counts(std::vector<std::uint64_t>& hist) const {
+    if (!histogram_) return;
+    hist.resize(bins_, 0);
+    for (std::size_t t = 0; t < threads_; ++t)
+        for (std::size_t k = 0; k < bins_; ++k) hist[k] += counts_[t * bins_ + k];
+}
+
+void KineticProfile::configure(std::size_t bins, int axis) {
+    axis_ = axis;
+    mv2_.assign(bins, 0.0);
+    counts_.assign(bins, 0);
+}
+
+void KineticProfile::begin(const Lattice& box, std::size_t n) {
+    // Fractional coordinate along a_d: (a_j × a_k) · r / V.
+    const Real* a[3] = {box.a1, box.a2, box.a3};
+    const Real* u = a[(axis_ + 1) % 3];
+    const Real* v = a[(axis_ + 2) % 3];
+    const Real inv_vol = 1.0 / box.volume();
+    inverse_row_[0] = (u[1] * v[2] - u[2] * v[1]) * inv_vol;
+    inverse_row_[1] = (u[2] * v[0] - u[0] * v[2]) * inv_vol;
+    inverse_row_[2] = (u[0] * v[1] - u[1] * v[0]) * inv_vol;
+    bin_.resize(n);
+    std::fill(mv2_.begin(), mv2_.end(), 0.0);
+    std::fill(counts_.begin(), counts_.end(), 0);
+}
+
+void KineticProfile::add(const ParticleSystem& system, int d, const Real* v,
+                         std::size_t begin, std::size_t end) {
+    const Real* m = system.masses();
+    const std::size_t bins = mv2_.size();
+    if (d == 0) {
+        const Real* x = system.pos(0);
+        const Real* y = system.pos(1);
+        const Real* z = system.pos(2);
+        const Real scale = static_cast<Real>(bins);
+        for (std::size_t i = begin; i < end; ++i) {
+            const Real s = inverse_row_[0] * x[i] + inverse_row_[1] * y[i] + inverse_row_[2] * z[i];
+            const Real t = (s - std::floor(s)) * scale;
+            const auto k = t > 0.0 ? std::min(bins - 1, static_cast<std::size_t>(t)) : 0;
+            bin_[i] = static_cast<std::uint32_t>(k);
+            ++counts_[k];
+        }
+    }
+    for (std::size_t i = begin; i < end; ++i) mv2_[bin_[i]] += m[i] * v[i] * v[i];
+}
+
+std::optional<std::string> ObservableParams::validate() const {
+    if (rdf_stride > 0 && rdf_bins == 0)
+        return "RDF needs at least one bin.";
+    if (!std::isfinite(rdf_max) || rdf_max < 0.0)
+        return "RDF range must be finite and non-negative.";
+    if (temperature_profile_stride > 0 && temperature_profile_bins == 0)
+        return "Temperature profile needs at least one bin.";
+    if (temperature_profile_axis < 0 || temperature_profile_axis > 2)
+        return "Temperature profile axis must be 0, 1 or 2.";
+    return std::nullopt;
+}
+
+void Observables::configure(const ObservableParams& params, Real cutoff) {
+    params_ = params;
+    const Real r_max = params.rdf_max > 0.0 && params.rdf_max < cutoff ? params.rdf_max : cutoff;
+    sampler_.set_rdf(params.rdf_stride > 0 ? params.rdf_bins : 0, r_max);
+    profile_.configure(params.temperature_profile_stride > 0 ? params.temperature_profile_bins : 0,
+                       params.temperature_profile_axis);
+    reset();
+}
+
+void Observables::reset() {
+    rdf_counts_.assign(sampler_.rdf_bins(), 0);
+    rdf_norm_ = 0.0;
+    rdf_samples_ = 0;
+    pressure_sum_ = 0.0;
+    last_pressure_ = 0.0;
+    last_virial_ = 0.0;
+    pressure_samples_ = 0;
+    profile_mv2_.assign(profile_.bins(), 0.0);
+    profile_counts_.assign(profile_.bins(), 0);
+    profile_samples_ = 0;
+    pair_armed_ = false;
+    profile_armed_ = false;
+}
+
+PairSampler* Observables::pair_sampler(std::size_t step) {
+    const bool rdf = rdf_due(step);
+    pair_armed_ = rdf || pressure_due(step);
+    if (!pair_armed_) return nullptr;
+    sampler_.set_histogram(rdf);
+    sampler_.prepare(0);
+    return &sampler_;
+}
+
+KineticProfile* Observables::kinetic_profile(std::size_t step, const Lattice* box, std::size_t n) {
+    profile_armed_ = temperature_profile_due(step) && box && box->volume() != 0.0 && profile_.bins() > 0;
+    if (!profile_armed_) return nullptr;
+    profile_.begin(*box, n);
+    return &profile_;
+}
+
+void Observables::finish_step(std::size_t step, const ParticleSystem& system, const Lattice* box,
+                              Real kinetic_energy) {
+    const Real volume = box ? std::fabs(box->volume()) : 0.0;
+    if (pair_armed_ && sampler_.threads() > 0 && volume > 0.0) {
+        if (rdf_due(step) && sampler_.histogram()) {
+            sampler_.add_counts(rdf_counts_);
+            const Real n = static_cast<Real>(system.size());
+            rdf_norm_ += n * n / (2.0 * volume);
+            ++rdf_samples_;
+        }
+        if (pressure_due(step)) {
+            last_virial_ = sampler_.virial();
+            last_pressure_ = (2.0 * kinetic_energy + last_virial_) / (3.0 * volume);
+            pressure_sum_ += last_pressure_;
+            ++pressure_samples_;
+        }
+    }
+    if (profile_armed_) {
+        const std::uint64_t swept = std::accumulate(profile_.counts().begin(), profile_.counts().end(),
+                                                    std::uint64_t{0});
+        if (swept == system.size() && swept > 0) {
+            for (std::size_t k = 0; k < profile_mv2_.size(); ++k) {
+                profile_mv2_[k] += profile_.mv2()[k];
+                profile_counts_[k] += profile_.counts()[k];
+            }
+            ++profile_samples_;
+        }
+    }
+    pair_armed_ = false;
+    profile_armed_ = false;
+}
+
+Real Observables::rdf_bin_width() const {
+    return sampler_.rdf_bins() ? sampler_.rdf_max() / static_cast<Real>(sampler_.rdf_bins()) : 0.0;
+}
+
+std::vector<Real> Observables::rdf() const {
+    std::vector<Real> g(rdf_counts_.size(), 0.0);
+    if (rdf_norm_ <= 0.0) return g;
+    // Ideal-gas pairs in shell k: (N² / 2V) · 4π/3 (r_{k+1}³ - r_k³).
+    const Real w = rdf_bin_width();
+    for (std::size_t k = 0; k < g.size(); ++k) {
+        const Real r0 = w * static_cast<Real>(k);
+        const Real r1 = r0 + w;
+        const Real shell = 4.0 / 3.0 * kPi * (r1 * r1 * r1 - r0 * r0 * r0);
+        g[k] = static_cast<Real>(rdf_counts_[k]) / (rdf_norm_ * shell);
+    }
+    return g;
+}
+
+std::vector<Real> Observables::temperature_profile() const {
+    std::vector<Real> t(profile_mv2_.size(), 0.0);
+    for (std::size_t k = 0; k < t.size(); ++k)
+        if (profile_counts_[k] > 0)
+            t[k] = profile_mv2_[k] / (3.0 * kB * static_cast<Real>(profile_counts_[k]));
+    return t;
+}
+
+}  // namespace matsimu
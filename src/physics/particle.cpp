@@ -1,47 +1,244 @@
 #include <matsimu/physics/particle.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
 #include <algorithm>
 #include <numeric>
+#include <atomic>
 
 namespace matsimu {
 
 // Boltzmann constant [J/K]
 constexpr Real kB = 1.380649e-23;
 
+ParticleSystem::ParticleSystem(std::size_t n, std::size_t max_bytes)
+    : ParticleSystem(n, RealAllocator(max_bytes)) {}
+
+ParticleSystem::ParticleSystem(std::size_t n, std::size_t max_bytes,
+                               std::shared_ptr<const MemoryPlacement> placement)
+    : ParticleSystem(n, RealAllocator(max_bytes, placement_allocator<Real>(std::move(placement)))) {}
+
+ParticleSystem::ParticleSystem(std::size_t n, const RealAllocator& alloc)
+    : pos_{RealArray(n, 0.0, alloc), RealArray(n, 0.0, alloc), RealArray(n, 0.0, alloc)},
+      vel_{RealArray(n, 0.0, alloc), RealArray(n, 0.0, alloc), RealArray(n, 0.0, alloc)},
+      force_{RealArray(n, 0.0, alloc), RealArray(n, 0.0, alloc), RealArray(n, 0.0, alloc)},
+      mass_(n, Particle().mass, alloc),
+      inv_mass_(n, 1.0 / Particle().mass, alloc),
+      ids_(IndexArray::allocator_type(alloc)),
+      pos_version_(next_position_version()),
+      vel_version_(next_position_version()) {}
+
+std::uint64_t ParticleSystem::next_position_version() {
+    static std::atomic<std::uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+void ParticleSystem::add_particle(const Particle& p) {
+    touch_positions();
+    touch_velocities();
+    for (int d = 0; d < 3; ++d) {
+        pos_[d].push_back(p.pos[d]);
+        vel_[d].push_back(p.vel[d]);
+        force_[d].push_back(p.force[d]);
+    }
+    mass_.push_back(p.mass);
+    inv_mass_.push_back(1.0 / p.mass);
+    if (!ids_.empty()) ids_.push_back(static_cast<std::uint32_t>(ids_.size()));
+}
+
+void ParticleSystem::append_state(std::size_t n, const Real* const pos[3], const Real* const vel[3]) {
+    touch_positions();
+    touch_velocities();
+    const std::size_t first = size();
+    for (int d = 0; d < 3; ++d) {
+        pos_[d].insert(pos_[d].end(), pos[d], pos[d] + n);
+        if (vel)
+            vel_[d].insert(vel_[d].end(), vel[d], vel[d] + n);
+        else
+            vel_[d].resize(first + n, 0.0);
+        force_[d].resize(first + n, 0.0);
+    }
+    if (!ids_.empty())
+        for (std::size_t i = first; i < first + n; ++i) ids_.push_back(static_cast<std::uint32_t>(i));
+}
+
+void ParticleSystem::append(std::size_t n, const Real* const pos[3], const Real* const vel[3],
+                            const Real* mass) {
+    const std::size_t first = size();
+    append_state(n, pos, vel);
+    mass_.insert(mass_.end(), mass, mass + n);
+    inv_mass_.resize(first + n);
+    for (std::size_t i = first; i < first + n; ++i) inv_mass_[i] = 1.0 / mass_[i];
+}
+
+void ParticleSystem::append(std::size_t n, const Real* const pos[3], const Real* const vel[3],
+                            Real mass) {
+    append_state(n, pos, vel);
+    mass_.resize(mass_.size() + n, mass);
+    inv_mass_.resize(inv_mass_.size() + n, 1.0 / mass);
+}
+
+void ParticleSystem::reserve(std::size_t n) {
+    for (int d = 0; d < 3; ++d) {
+        pos_[d].reserve(n);
+        vel_[d].reserve(n);
+        force_[d].reserve(n);
+    }
+    mass_.reserve(n);
+    inv_mass_.reserve(n);
+}
+
+void ParticleSystem::clear() {
+    touch_positions();
+    touch_velocities();
+    for (int d = 0; d < 3; ++d) {
+        pos_[d].clear();
+        vel_[d].clear();
+        force_[d].clear();
+    }
+    mass_.clear();
+    inv_mass_.clear();
+    ids_.clear();
+}
+
+void ParticleSystem::resize(std::size_t n) {
+    touch_positions();
+    touch_velocities();
+    for (int d = 0; d < 3; ++d) {
+        pos_[d].resize(n, 0.0);
+        vel_[d].resize(n, 0.0);
+        force_[d].resize(n, 0.0);
+    }
+    mass_.resize(n, Particle().mass);
+    inv_mass_.resize(n, 1.0 / Particle().mass);
+    ids_.clear();
+}
+
+void ParticleSystem::reorder(const std::uint32_t* order, Arena* arena) {
+    touch_positions();
+    touch_velocities();
+    const std::size_t n = size();
+    ArenaVector<Real> scratch(n, arena_allocator<Real>(arena));
+    auto permute = [&](RealArray& a) {
+        for (std::size_t i = 0; i < n; ++i) scratch[i] = a[order[i]];
+        std::copy(scratch.begin(), scratch.end(), a.begin());
+    };
+    for (int d = 0; d < 3; ++d) {
+        permute(pos_[d]);
+        permute(vel_[d]);
+        permute(force_[d]);
+    }
+    permute(mass_);
+    permute(inv_mass_);
+
+    if (ids_.empty()) {
+        ids_.assign(order, order + n);
+    } else {
+        ArenaVector<std::uint32_t> ids(n, arena_allocator<std::uint32_t>(arena));
+        for (std::size_t i = 0; i < n; ++i) ids[i] = ids_[order[i]];
+        std::copy(ids.begin(), ids.end(), ids_.begin());
+    }
+}
+
+void ParticleSystem::set_ids(const std::uint32_t* ids) {
+    ids_.assign(ids, ids + size());
+}
+
+void ParticleSystem::slots_by_id(std::vector<std::uint32_t>& slots) const {
+    const std::size_t n = size();
+    slots.resize(n);
+    for (std::size_t i = 0; i < n; ++i) slots[id(i)] = static_cast<std::uint32_t>(i);
+}
+
+void ParticleSystem::set_mass(std::size_t i, Real m) {
+    touch_velocities();
+    mass_[i] = m;
+    inv_mass_[i] = 1.0 / m;
+}
+
+void ParticleSystem::set_masses(const Real* m) {
+    touch_velocities();
+    const std::size_t n = size();
+    std::copy(m, m + n, mass_.begin());
+    for (std::size_t i = 0; i < n; ++i) inv_mass_[i] = 1.0 / mass_[i];
+}
+
 void ParticleSystem::clear_forces() {
-    for (auto& p : particles_) {
-        p.clear_force();
+    for (int d = 0; d < 3; ++d) {
+        std::fill(force_[d].begin(), force_[d].end(), 0.0);
     }
 }
 
-Real ParticleSystem::kinetic_energy() const {
-    Real ekin = 0.0;
-    for (const auto& p : particles_) {
-        Real v2 = p.vel[0] * p.vel[0] + p.vel[1] * p.vel[1] + p.vel[2] * p.vel[2];
-        ekin += 0.5 * p.mass * v2;
+void VelocityMomentSums::merge(const VelocityMomentSums& o) {
+    for (int k = 0; k < 4; ++k) {
+        for (int d = 0; d < 3; ++d) {
+            mv[d][k] += o.mv[d][k];
+            mv2[d][k] += o.mv2[d][k];
+        }
+        mass[k] += o.mass[k];
     }
-    return ekin;
 }
 
-Real ParticleSystem::temperature() const {
-    std::size_t n = particles_.size();
-    if (n <= 1) return 0.0;
-    
-    Real ekin = kinetic_energy();
-    // T = 2*E_kin / (dof * k_B)
+KineticMoments VelocityMomentSums::finish(std::size_t n) const {
+    auto lanes = [](const Real* l) { return (l[0] + l[1]) + (l[2] + l[3]); };
+    KineticMoments out;
+    Real twice_ekin = 0.0;
+    for (int d = 0; d < 3; ++d) {
+        out.momentum[d] = lanes(mv[d]);
+        twice_ekin += lanes(mv2[d]);
+    }
+    out.kinetic_energy = 0.5 * twice_ekin;
+    out.total_mass = lanes(mass);
     // For N particles with fixed COM, dof = 3*N - 3
-    Real dof = 3.0 * static_cast<Real>(n) - 3.0;
-    return (2.0 * ekin) / (dof * kB);
+    if (n > 1) out.temperature = twice_ekin / ((3.0 * static_cast<Real>(n) - 3.0) * kB);
+    return out;
+}
+
+namespace {
+
+/// Below this many particles a pool is not worth waking for the reduction.
+constexpr std::size_t kParallelMomentsMin = 16384;
+
+}  // namespace
+
+const KineticMoments& ParticleSystem::kinetic_moments(ThreadPool* pool) const {
+    if (moments_version_ == vel_version_) return moments_;
+    const std::size_t n = size();
+    const Real* m = mass_.data();
+    VelocityMomentSums sums;
+    if (pool && pool->size() > 1 && n >= kParallelMomentsMin) {
+        const std::size_t parts = pool->size();
+        std::vector<VelocityMomentSums> partial(parts);
+        pool->run([&](std::size_t tid) {
+            // Chunk starts are multiples of 4 so every slot keeps its lane.
+            const std::size_t begin = (n * tid / parts) & ~std::size_t(3);
+            const std::size_t end = tid + 1 == parts ? n : (n * (tid + 1) / parts) & ~std::size_t(3);
+            for (int d = 0; d < 3; ++d) partial[tid].add(d, m, vel_[d].data(), begin, end);
+        });
+        for (const VelocityMomentSums& p : partial) sums.merge(p);
+    } else {
+        for (int d = 0; d < 3; ++d) sums.add(d, m, vel_[d].data(), 0, n);
+    }
+    cache_kinetic_moments(sums.finish(n));
+    return moments_;
+}
+
+void ParticleSystem::cache_kinetic_moments(const KineticMoments& m) const {
+    moments_ = m;
+    moments_version_ = vel_version_;
 }
 
 void ParticleSystem::center_of_mass(Real com[3]) const {
     com[0] = com[1] = com[2] = 0.0;
     Real total_mass = 0.0;
-    
-    for (const auto& p : particles_) {
-        com[0] += p.mass * p.pos[0];
-        com[1] += p.mass * p.pos[1];
-        com[2] += p.mass * p.pos[2];
-        total_mass += p.mass;
+    const std::size_t n = size();
+    const Real* m = mass_.data();
+    const Real* x = pos_[0].data();
+    const Real* y = pos_[1].data();
+    const Real* z = pos_[2].data();
+    for (std::size_t i = 0; i < n; ++i) {
+        com[0] += m[i] * x[i];
+        com[1] += m[i] * y[i];
+        com[2] += m[i] * z[i];
+        total_mass += m[i];
     }
     
     if (total_mass > 0.0) {
@@ -52,34 +249,55 @@ void ParticleSystem::center_of_mass(Real com[3]) const {
 }
 
 void ParticleSystem::zero_com_velocity() {
-    Real com_vel[3] = {0.0, 0.0, 0.0};
-    Real total_mass = 0.0;
-    
-    for (const auto& p : particles_) {
-        com_vel[0] += p.mass * p.vel[0];
-        com_vel[1] += p.mass * p.vel[1];
-        com_vel[2] += p.mass * p.vel[2];
-        total_mass += p.mass;
-    }
-    
-    if (total_mass > 0.0) {
-        com_vel[0] /= total_mass;
-        com_vel[1] /= total_mass;
-        com_vel[2] /= total_mass;
+    KineticMoments km = kinetic_moments();
+    if (!(km.total_mass > 0.0)) return;
+    const std::size_t n = size();
+    Real p2 = 0.0;
+    for (int d = 0; d < 3; ++d) {
+        const Real com_vel = km.momentum[d] / km.total_mass;
+        Real* v = vel_[d].data();
+        for (std::size_t i = 0; i < n; ++i) v[i] -= com_vel;
+        p2 += km.momentum[d] * km.momentum[d];
+        km.momentum[d] = 0.0;
     }
-    
-    for (auto& p : particles_) {
-        p.vel[0] -= com_vel[0];
-        p.vel[1] -= com_vel[1];
-        p.vel[2] -= com_vel[2];
+    touch_velocities();
+    // E_kin loses the COM part |P|²/2M; T rescales with it.
+    const Real ekin = std::max<Real>(0.0, km.kinetic_energy - 0.5 * p2 / km.total_mass);
+    if (km.kinetic_energy > 0.0) km.temperature *= ekin / km.kinetic_energy;
+    km.kinetic_energy = ekin;
+    cache_kinetic_moments(km);
+}
+
+void ParticleSystem::scale_velocities(Real lambda) {
+    const bool cached = moments_version_ == vel_version_;
+    const std::size_t n = size();
+    for (int d = 0; d < 3; ++d) {
+        Real* v = vel_[d].data();
+        for (std::size_t i = 0; i < n; ++i) v[i] *= lambda;
     }
+    touch_velocities();
+    if (!cached) return;
+    KineticMoments km = moments_;
+    for (int d = 0; d < 3; ++d) km.momentum[d] *= lambda;
+    km.kinetic_energy *= lambda * lambda;
+    km.temperature *= lambda * lambda;
+    cache_kinetic_moments(km);
 }
 
 void ParticleSystem::apply_pbc(const Lattice& lattice) {
     // Use the lattice's wrap_cartesian method for proper PBC handling
     // This works for both orthogonal and non-orthogonal lattices
-    for (auto& p : particles_) {
-        lattice.wrap_cartesian(p.pos);
+    touch_positions();
+    const std::size_t n = size();
+    Real* x = pos_[0].data();
+    Real* y = pos_[1].data();
+    Real* z = pos_[2].data();
+    for (std::size_t i = 0; i < n; ++i) {
+        Real r[3] = {x[i], y[i], z[i]};
+        lattice.wrap_cartesian(r);
+        x[i] = r[0];
+        y[i] = r[1];
+        z[i] = r[2];
     }
 }
 
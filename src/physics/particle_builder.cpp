@@ -0,0 +1,162 @@
+#include <matsimu/physics/particle_builder.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace matsimu {
+
+namespace {
+
+constexpr Real kSimpleCubicSites[1][3] = {{0.0, 0.0, 0.0}};
+constexpr Real kBccSites[2][3] = {{0.0, 0.0, 0.0}, {0.5, 0.5, 0.5}};
+constexpr Real kFccSites[4][3] = {{0.0, 0.0, 0.0}, {0.5, 0.5, 0.0},
+                                  {0.5, 0.0, 0.5}, {0.0, 0.5, 0.5}};
+
+const Real (*sites_of(CrystalBasis basis))[3] {
+    switch (basis) {
+    case CrystalBasis::SimpleCubic: return kSimpleCubicSites;
+    case CrystalBasis::BCC: return kBccSites;
+    case CrystalBasis::FCC: break;
+    }
+    return kFccSites;
+}
+
+// Cap on placement cells (4 bytes each); wider cells stay valid.
+constexpr std::size_t kMaxPlacementCells = std::size_t{1} << 21;
+
+}  // namespace
+
+std::size_t crystal_sites(CrystalBasis basis) {
+    switch (basis) {
+    case CrystalBasis::SimpleCubic: return 1;
+    case CrystalBasis::BCC: return 2;
+    case CrystalBasis::FCC: break;
+    }
+    return 4;
+}
+
+void crystal_site(const Lattice& cell, const CrystalSpec& spec, const std::size_t n[3],
+                  std::size_t b, Real pos[3]) {
+    const Real* site = sites_of(spec.basis)[b];
+    const Real f[3] = {static_cast<Real>(n[0]) + (site[0] + spec.offset[0]),
+                       static_cast<Real>(n[1]) + (site[1] + spec.offset[1]),
+                       static_cast<Real>(n[2]) + (site[2] + spec.offset[2])};
+    for (int d = 0; d < 3; ++d)
+        pos[d] = f[0] * cell.a1[d] + f[1] * cell.a2[d] + f[2] * cell.a3[d];
+}
+
+Lattice supercell(const Lattice& cell, const CrystalSpec& spec) {
+    Lattice super = cell;
+    Real* s[3] = {super.a1, super.a2, super.a3};
+    for (int k3 = 0; k3 < 3; ++k3)
+        for (int d = 0; d < 3; ++d) s[k3][d] *= static_cast<Real>(spec.repeats[k3]);
+    super.update_cache();
+    return super;
+}
+
+Lattice fill_crystal(ParticleSystem& ps, const Lattice& cell, const CrystalSpec& spec) {
+    const std::size_t nb = crystal_sites(spec.basis);
+    const std::size_t* rep = spec.repeats;
+    const std::size_t count = rep[0] * rep[1] * rep[2] * nb;
+
+    std::vector<Real> xyz[3];
+    for (auto& v : xyz) v.resize(count);
+    std::size_t k = 0;
+    std::size_t n[3];
+    for (n[0] = 0; n[0] < rep[0]; ++n[0]) {
+        for (n[1] = 0; n[1] < rep[1]; ++n[1]) {
+            for (n[2] = 0; n[2] < rep[2]; ++n[2]) {
+                for (std::size_t b = 0; b < nb; ++b, ++k) {
+                    Real r[3];
+                    crystal_site(cell, spec, n, b, r);
+                    for (int d = 0; d < 3; ++d) xyz[d][k] = r[d];
+                }
+            }
+        }
+    }
+    const Real* pos[3] = {xyz[0].data(), xyz[1].data(), xyz[2].data()};
+    ps.append(count, pos, nullptr, spec.mass);
+    return supercell(cell, spec);
+}
+
+PlacementGrid::PlacementGrid(const Lattice& box, Real min_distance)
+    : box_(box), min_dist2_(min_distance * min_distance) {
+    box_.update_cache();
+    // Perpendicular width of the box along axis d is V / |a_j × a_k|.
+    const Real vol = std::fabs(box_.volume());
+    const Real* a[3] = {box_.a1, box_.a2, box_.a3};
+    for (int d = 0; d < 3; ++d) {
+        const Real* u = a[(d + 1) % 3];
+        const Real* v = a[(d + 2) % 3];
+        const Real cx = u[1] * v[2] - u[2] * v[1];
+        const Real cy = u[2] * v[0] - u[0] * v[2];
+        const Real cz = u[0] * v[1] - u[1] * v[0];
+        const Real cells = std::floor(vol / std::sqrt(cx * cx + cy * cy + cz * cz) / min_distance);
+        if (std::isfinite(cells) && cells > 1.0)
+            dims_[d] = static_cast<std::size_t>(std::min<Real>(cells, kMaxPlacementCells));
+    }
+    while (dims_[0] * dims_[1] * dims_[2] > kMaxPlacementCells) {
+        for (auto& n : dims_) n = std::max<std::size_t>(1, n / 2);
+    }
+    head_.assign(dims_[0] * dims_[1] * dims_[2], -1);
+}
+
+std::size_t PlacementGrid::cell_of(const Real pos[3], std::size_t c[3]) const {
+    Real s[3];
+    box_.cartesian_to_fractional(pos, s);
+    for (int d = 0; d < 3; ++d) {
+        Real t = (s[d] - std::floor(s[d])) * static_cast<Real>(dims_[d]);
+        if (!std::isfinite(t) || t < 0.0) t = 0.0;
+        c[d] = std::min(dims_[d] - 1, static_cast<std::size_t>(t));
+    }
+    return (c[2] * dims_[1] + c[1]) * dims_[0] + c[0];
+}
+
+bool PlacementGrid::fits(const Real pos[3]) const {
+    std::size_t c[3];
+    cell_of(pos, c);
+    // Cells to visit per axis: the three around c, or every cell when the
+    // axis has fewer than three (wrap-around would repeat them).
+    std::size_t span[3][3];
+    std::size_t count[3];
+    for (int d = 0; d < 3; ++d) {
+        const std::size_t n = dims_[d];
+        if (n < 3) {
+            count[d] = n;
+            for (std::size_t k = 0; k < n; ++k) span[d][k] = k;
+        } else {
+            count[d] = 3;
+            span[d][0] = (c[d] + n - 1) % n;
+            span[d][1] = c[d];
+            span[d][2] = (c[d] + 1) % n;
+        }
+    }
+    for (std::size_t iz = 0; iz < count[2]; ++iz) {
+        for (std::size_t iy = 0; iy < count[1]; ++iy) {
+            for (std::size_t ix = 0; ix < count[0]; ++ix) {
+                const std::size_t cell = (span[2][iz] * dims_[1] + span[1][iy]) * dims_[0] + span[0][ix];
+                for (std::int32_t j = head_[cell]; j >= 0; j = next_[static_cast<std::size_t>(j)]) {
+                    Real dr[3];
+                    box_.min_image_displacement(points_[static_cast<std::size_t>(j)].r, pos, dr);
+                    if (dr[0] * dr[0] + dr[1] * dr[1] + dr[2] * dr[2] < min_dist2_) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void PlacementGrid::insert(const Real pos[3]) {
+    std::size_t c[3];
+    const std::size_t cell = cell_of(pos, c);
+    next_.push_back(head_[cell]);
+    head_[cell] = static_cast<std::int32_t>(points_.size());
+    points_.push_back({{pos[0], pos[1], pos[2]}});
+}
+
+bool PlacementGrid::try_insert(const Real pos[3]) {
+    if (!fits(pos)) return false;
+    insert(pos);
+    return true;
+}
+
+}  // namespace matsimu
@@ -1,6 +1,8 @@
 #include <matsimu/physics/potential.hpp>
+#include <matsimu/physics/pair_kernel.hpp>
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace matsimu {
 
@@ -67,37 +69,106 @@ Real HarmonicPotential::force_div_r(Real r2) const {
     return -k_ * dr / r;
 }
 
+// Tabulated potential implementation
+namespace {
+
+std::vector<Real> sample_nodes(const Potential& source, Real r_min, std::size_t points,
+                               bool want_energy) {
+    const Real s_min = r_min * r_min;
+    const Real s_max = source.cutoff_squared();
+    const Real h = points > 1 ? (s_max - s_min) / static_cast<Real>(points - 1) : 0.0;
+    std::vector<Real> out(points);
+    for (std::size_t k = 0; k < points; ++k) {
+        // Last node: the limit from inside the cutoff (sources return 0 at it).
+        const Real s = k + 1 == points ? std::nextafter(s_max, s_min) : s_min + static_cast<Real>(k) * h;
+        out[k] = want_energy ? source.energy(s) : source.force_div_r(s);
+    }
+    return out;
+}
+
+}  // namespace
+
+TabulatedPotential::TabulatedPotential(const Potential& source, Real r_min, std::size_t points)
+    : TabulatedPotential(r_min, source.cutoff(), sample_nodes(source, r_min, points, true),
+                         sample_nodes(source, r_min, points, false)) {}
+
+TabulatedPotential::TabulatedPotential(Real r_min, Real cutoff, const std::vector<Real>& energy,
+                                       const std::vector<Real>& force_div_r)
+    : s_min_(r_min * r_min), inv_h_(0.0), cutoff_sq_(cutoff * cutoff), last_(0) {
+    if (energy.size() < 2 || energy.size() != force_div_r.size())
+        throw std::invalid_argument("TabulatedPotential: need >= 2 nodes with energy and force");
+    if (!(r_min > 0.0) || !(r_min < cutoff) || !std::isfinite(cutoff))
+        throw std::invalid_argument("TabulatedPotential: need 0 < r_min < cutoff");
+    build(energy, force_div_r);
+}
+
+void TabulatedPotential::build(const std::vector<Real>& energy, const std::vector<Real>& force_div_r) {
+    const std::size_t n = energy.size();
+    const Real h = (cutoff_sq_ - s_min_) / static_cast<Real>(n - 1);
+    inv_h_ = 1.0 / h;
+    table_.resize(n - 1);
+    last_ = n - 2;
+    for (std::size_t k = 0; k + 1 < n; ++k) {
+        // Hermite data in t = (s - s_k)/h: values and dU/dt = h·dU/ds = -h·(F/r)/2.
+        const Real u0 = energy[k];
+        const Real u1 = energy[k + 1];
+        const Real d0 = -0.5 * h * force_div_r[k];
+        const Real d1 = -0.5 * h * force_div_r[k + 1];
+        Segment& c = table_[k];
+        c[0] = u0;
+        c[1] = d0;
+        c[2] = 3.0 * (u1 - u0) - 2.0 * d0 - d1;
+        c[3] = 2.0 * (u0 - u1) + d0 + d1;
+        // F/r = -2·dU/ds = -(2/h)·dU/dt
+        c[4] = -2.0 * inv_h_ * c[1];
+        c[5] = -4.0 * inv_h_ * c[2];
+        c[6] = -6.0 * inv_h_ * c[3];
+        c[7] = 0.0;
+    }
+}
+
+Real TabulatedPotential::energy(Real r2) const {
+    Real e, f;
+    energy_and_force(r2, e, f);
+    return e;
+}
+
+Real TabulatedPotential::force_div_r(Real r2) const {
+    Real e, f;
+    energy_and_force(r2, e, f);
+    return f;
+}
+
 // ForceField implementation
-Real ForceField::compute_forces(ParticleSystem& system, const Lattice* lattice) const {
+Real ForceField::compute_forces(ParticleSystem& system, const Lattice* lattice,
+                               bool with_energy, PairSampler* sampler) const {
     if (!potential_) return 0.0;
     
-    system.clear_forces();
-    Real epot = 0.0;
-    std::size_t n = system.size();
-    
-    for (std::size_t i = 0; i < n; ++i) {
-        for (std::size_t j = i + 1; j < n; ++j) {
-            Real dx[3];
-            Real r2 = distance_squared(system[i], system[j], lattice, dx);
-            
-            if (r2 < potential_->cutoff_squared()) {
-                Real e = potential_->energy(r2);
-                Real f_div_r = potential_->force_div_r(r2);
-                
-                epot += e;
-                
-                // F_ij = f_div_r * r_vec
-                Real fx = f_div_r * dx[0];
-                Real fy = f_div_r * dx[1];
-                Real fz = f_div_r * dx[2];
-                
-                system[i].add_force(fx, fy, fz);
-                system[j].add_force(-fx, -fy, -fz);
-            }
-        }
+    const std::size_t n = system.size();
+    // Row i has n-1-i pairs; the threaded split balances by triangular cost.
+    const auto pairs_before = [n](std::size_t i) { return i * (n - 1) - i * (i - 1) / 2; };
+    const AllPairsRows rows(n);
+    if (sampler) {
+        sampler->prepare(pair_row_threads(pool_.get()));
+        return dispatch_pair_kernel(*potential_, [&](const auto& kernel) {
+            return run_pair_rows(pool_.get(), buffers_, system, pairs_before,
+                                 [&](std::size_t begin, std::size_t end, Real* const f[3],
+                                     std::size_t tid) {
+                const PairSampler::Sink sink = sampler->sink(tid);
+                return with_energy
+                    ? accumulate_pair_rows<true>(kernel, rows, system, lattice, begin, end, f, sink)
+                    : accumulate_pair_rows<false>(kernel, rows, system, lattice, begin, end, f, sink);
+            });
+        });
     }
-    
-    return epot;
+    return dispatch_pair_kernel(*potential_, [&](const auto& kernel) {
+        return run_pair_rows(pool_.get(), buffers_, system, pairs_before,
+                             [&](std::size_t begin, std::size_t end, Real* const f[3]) {
+            return with_energy
+                ? accumulate_pair_rows<true>(kernel, rows, system, lattice, begin, end, f)
+                : accumulate_pair_rows<false>(kernel, rows, system, lattice, begin, end, f);
+        });
+    });
 }
 
 Real ForceField::compute_energy(const ParticleSystem& system, const Lattice* lattice) const {
@@ -109,7 +180,7 @@ Real ForceField::compute_energy(const ParticleSystem& system, const Lattice* lat
     
     for (std::size_t i = 0; i < n; ++i) {
         for (std::size_t j = i + 1; j < n; ++j) {
-            Real r2 = distance_squared(system[i], system[j], lattice, dx);
+            Real r2 = distance_squared(system, i, j, lattice, dx);
             if (r2 < potential_->cutoff_squared()) {
                 epot += potential_->energy(r2);
             }
@@ -119,16 +190,18 @@ Real ForceField::compute_energy(const ParticleSystem& system, const Lattice* lat
     return epot;
 }
 
-Real ForceField::distance_squared(const Particle& p1, const Particle& p2,
+Real ForceField::distance_squared(const ParticleSystem& system, std::size_t i, std::size_t j,
                                     const Lattice* lattice, Real dx[3]) {
-    dx[0] = p2.pos[0] - p1.pos[0];
-    dx[1] = p2.pos[1] - p1.pos[1];
-    dx[2] = p2.pos[2] - p1.pos[2];
+    const Real r1[3] = {system.pos(0)[i], system.pos(1)[i], system.pos(2)[i]};
+    const Real r2[3] = {system.pos(0)[j], system.pos(1)[j], system.pos(2)[j]};
+    dx[0] = r2[0] - r1[0];
+    dx[1] = r2[1] - r1[1];
+    dx[2] = r2[2] - r1[2];
     
     if (lattice) {
         // Use the lattice's min_image_displacement for proper PBC handling
         // This works for both orthogonal and non-orthogonal lattices
-        lattice->min_image_displacement(p1.pos, p2.pos, dx);
+        lattice->min_image_displacement(r1, r2, dx);
     }
     
     return dx[0]*dx[0] + dx[1]*dx[1] + dx[2]*dx[2];
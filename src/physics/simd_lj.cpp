@@ -0,0 +1,604 @@
+#include <matsimu/physics/simd_lj.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATSIMU_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace matsimu {
+
+namespace {
+
+struct LJConstants {
+    Real cutoff_sq;
+    Real sigma_sq;
+    Real eps4;
+    Real eps24;
+    Real shift;
+    Real eps24_over_sigma_sq;  // float kernels: F/r = (24ε/σ²)·(2s¹² − s⁶)·σ²/r²
+    // ShellSwitch of the shell kernels (ShellPairKernel, pair_kernel.hpp)
+    Real on_sq{0};
+    Real off_sq{0};
+    Real r_on{0};
+    Real inv_width{0};
+};
+
+LJConstants lj_constants(const LennardJones& lj) {
+    const Real sigma_sq = lj.sigma() * lj.sigma();
+    return {lj.cutoff_squared(), sigma_sq, 4.0 * lj.epsilon(),
+            24.0 * lj.epsilon(), lj.energy_shift(), 24.0 * lj.epsilon() / sigma_sq};
+}
+
+/// c restricted to one shell of sw; the inner shell's cutoff is the split.
+LJConstants shell_constants(LJConstants c, ForceShell shell, const ShellSwitch& sw) {
+    c.r_on = sw.split - sw.width;
+    c.inv_width = sw.width > 0.0 ? 1.0 / sw.width : 0.0;
+    c.on_sq = c.r_on * c.r_on;
+    c.off_sq = sw.split * sw.split;
+    if (shell == ForceShell::Inner) c.cutoff_sq = std::min(c.cutoff_sq, c.off_sq);
+    return c;
+}
+
+struct RowArgs {
+    const std::uint32_t* idx;
+    const std::size_t* offsets;
+    const Real* x;
+    const Real* y;
+    const Real* z;
+    Real* fx;
+    Real* fy;
+    Real* fz;
+    std::size_t begin;
+    std::size_t end;
+};
+
+// Scalar remainder of a row, using the same rint-based minimum image as the
+// vector lanes. Returns the row's energy; adds the i-side force to fi.
+inline Real row_tail(const LJConstants& c, const SimdBox& box, const RowArgs& a,
+                     std::size_t i, std::size_t k, std::size_t kend, Real fi[3]) {
+    Real epot = 0.0;
+    for (; k < kend; ++k) {
+        const std::size_t j = a.idx[k];
+        Real dx = a.x[i] - a.x[j];
+        Real dy = a.y[i] - a.y[j];
+        Real dz = a.z[i] - a.z[j];
+        if (box.periodic) {
+            dx -= box.length[0] * std::nearbyint(dx * box.inv_length[0]);
+            dy -= box.length[1] * std::nearbyint(dy * box.inv_length[1]);
+            dz -= box.length[2] * std::nearbyint(dz * box.inv_length[2]);
+        }
+        const Real r2 = dx * dx + dy * dy + dz * dz;
+        if (!(r2 < c.cutoff_sq) || !(r2 > 1e-30)) continue;
+        const Real r2_inv = c.sigma_sq / r2;
+        const Real r6_inv = r2_inv * r2_inv * r2_inv;
+        const Real r12_inv = r6_inv * r6_inv;
+        epot += c.eps4 * (r12_inv - r6_inv) - c.shift;
+        const Real f_div_r = c.eps24 * (2.0 * r12_inv - r6_inv) / r2;
+        fi[0] += f_div_r * dx; fi[1] += f_div_r * dy; fi[2] += f_div_r * dz;
+        a.fx[j] -= f_div_r * dx; a.fy[j] -= f_div_r * dy; a.fz[j] -= f_div_r * dz;
+    }
+    return epot;
+}
+
+#ifdef MATSIMU_X86_SIMD
+
+__attribute__((target("avx2,fma")))
+inline double hsum256(__m256d v) {
+    __m128d lo = _mm256_castpd256_pd128(v);
+    __m128d hi = _mm256_extractf128_pd(v, 1);
+    lo = _mm_add_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+}
+
+// Shell rows (the short inner list) and the mixed-precision kernels end in
+// one padded vector instead of a scalar tail: missing lanes point at i
+// itself, so r² = 0 and the tiny-distance mask drops them.
+/// Neighbor indices k .. k+width of row i; the short last chunk is copied to pad.
+inline const std::uint32_t* pad_row_tail(const RowArgs& a, std::size_t i, std::size_t k,
+                                         std::size_t kend, std::uint32_t* pad, std::size_t width) {
+    if (k + width <= kend) return a.idx + k;
+    for (std::size_t l = 0; l < width; ++l)
+        pad[l] = k + l < kend ? a.idx[k + l] : static_cast<std::uint32_t>(i);
+    return pad;
+}
+
+/// One shell of the 4 lanes of e and F/r, with the values of ShellPairKernel.
+template <ForceShell Shell>
+__attribute__((target("avx2,fma")))
+inline void apply_shell_avx2(const LJConstants& c, __m256d r2, __m256d& e, __m256d& fr) {
+    const __m256d below = _mm256_cmp_pd(r2, _mm256_set1_pd(c.on_sq), _CMP_LT_OQ);
+    const __m256d outside = _mm256_cmp_pd(r2, _mm256_set1_pd(c.off_sq), _CMP_GE_OQ);
+    if (_mm256_movemask_pd(_mm256_or_pd(below, outside)) == 0xF) {
+        // No lane in the switching zone: each pair is all inner or all outer.
+        const __m256d keep = Shell == ForceShell::Inner ? below : outside;
+        e = _mm256_and_pd(e, keep);
+        fr = _mm256_and_pd(fr, keep);
+        return;
+    }
+    // x is clamped to [0, 1], so S = 1 and S' = 0 below the zone; S = 0 from the split on.
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d r = _mm256_sqrt_pd(r2);
+    const __m256d x = _mm256_min_pd(one, _mm256_max_pd(_mm256_setzero_pd(),
+        _mm256_mul_pd(_mm256_sub_pd(r, _mm256_set1_pd(c.r_on)), _mm256_set1_pd(c.inv_width))));
+    const __m256d s = _mm256_andnot_pd(outside, _mm256_sub_pd(one, _mm256_mul_pd(_mm256_mul_pd(x, x),
+        _mm256_sub_pd(_mm256_set1_pd(3.0), _mm256_add_pd(x, x)))));
+    const __m256d ds_dr = _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(-6.0), x),
+                                                      _mm256_sub_pd(one, x)),
+                                        _mm256_set1_pd(c.inv_width));
+    const __m256d e_in = _mm256_mul_pd(s, e);
+    const __m256d f_in = _mm256_sub_pd(_mm256_mul_pd(s, fr), _mm256_div_pd(_mm256_mul_pd(ds_dr, e), r));
+    if (Shell == ForceShell::Inner) {
+        e = e_in;
+        fr = f_in;
+    } else {
+        e = _mm256_sub_pd(e, e_in);
+        fr = _mm256_sub_pd(fr, f_in);
+    }
+}
+
+template <bool WithEnergy, ForceShell Shell = ForceShell::All>
+__attribute__((target("avx2,fma")))
+Real rows_avx2(const LJConstants& c, const SimdBox& box, const RowArgs& a) {
+    const __m256d rc2 = _mm256_set1_pd(c.cutoff_sq);
+    const __m256d tiny = _mm256_set1_pd(1e-30);
+    const __m256d sig2 = _mm256_set1_pd(c.sigma_sq);
+    const __m256d eps4 = _mm256_set1_pd(c.eps4);
+    const __m256d eps24 = _mm256_set1_pd(c.eps24);
+    const __m256d shift = _mm256_set1_pd(c.shift);
+    const __m256d two = _mm256_set1_pd(2.0);
+    const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    const __m256d len[3] = {_mm256_set1_pd(box.length[0]), _mm256_set1_pd(box.length[1]),
+                            _mm256_set1_pd(box.length[2])};
+    const __m256d inv_len[3] = {_mm256_set1_pd(box.inv_length[0]), _mm256_set1_pd(box.inv_length[1]),
+                                _mm256_set1_pd(box.inv_length[2])};
+    const Real* pos[3] = {a.x, a.y, a.z};
+
+    __m256d epot_v = _mm256_setzero_pd();
+    Real epot = 0.0;
+    alignas(32) double tmp[3][4];
+    alignas(16) std::uint32_t pad[4];
+
+    for (std::size_t i = a.begin; i < a.end; ++i) {
+        const __m256d ri[3] = {_mm256_set1_pd(a.x[i]), _mm256_set1_pd(a.y[i]),
+                               _mm256_set1_pd(a.z[i])};
+        __m256d fi_v[3] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+        std::size_t k = a.offsets[i];
+        const std::size_t kend = a.offsets[i + 1];
+        for (; Shell == ForceShell::All ? k + 4 <= kend : k < kend; k += 4) {
+            const std::uint32_t* idx = pad_row_tail(a, i, k, kend, pad, 4);
+            const __m128i vj = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx));
+            __m256d d[3];
+            for (int ax = 0; ax < 3; ++ax) {
+                d[ax] = _mm256_sub_pd(ri[ax], _mm256_mask_i32gather_pd(_mm256_setzero_pd(), pos[ax], vj, all_lanes, 8));
+                if (box.periodic) {
+                    const __m256d img = _mm256_round_pd(_mm256_mul_pd(d[ax], inv_len[ax]),
+                                                        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+                    d[ax] = _mm256_sub_pd(d[ax], _mm256_mul_pd(len[ax], img));
+                }
+            }
+            const __m256d r2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(d[0], d[0]),
+                                                           _mm256_mul_pd(d[1], d[1])),
+                                             _mm256_mul_pd(d[2], d[2]));
+            const __m256d mask = _mm256_and_pd(_mm256_cmp_pd(r2, rc2, _CMP_LT_OQ),
+                                               _mm256_cmp_pd(r2, tiny, _CMP_GT_OQ));
+            if (_mm256_movemask_pd(mask) == 0) continue;
+            const __m256d r2_inv = _mm256_div_pd(sig2, r2);
+            const __m256d r6_inv = _mm256_mul_pd(_mm256_mul_pd(r2_inv, r2_inv), r2_inv);
+            const __m256d r12_inv = _mm256_mul_pd(r6_inv, r6_inv);
+            __m256d e = _mm256_sub_pd(_mm256_mul_pd(eps4, _mm256_sub_pd(r12_inv, r6_inv)), shift);
+            __m256d fr = _mm256_div_pd(
+                _mm256_mul_pd(eps24, _mm256_sub_pd(_mm256_mul_pd(two, r12_inv), r6_inv)), r2);
+            if (Shell != ForceShell::All) apply_shell_avx2<Shell>(c, r2, e, fr);
+            if (WithEnergy) epot_v = _mm256_add_pd(epot_v, _mm256_and_pd(e, mask));
+            const __m256d f_div_r = _mm256_and_pd(fr, mask);
+            for (int ax = 0; ax < 3; ++ax) {
+                const __m256d fv = _mm256_mul_pd(f_div_r, d[ax]);
+                fi_v[ax] = _mm256_add_pd(fi_v[ax], fv);
+                _mm256_store_pd(tmp[ax], fv);
+            }
+            // No AVX2 scatter; j values within a row are distinct.
+            for (int l = 0; l < 4; ++l) {
+                const std::size_t j = idx[l];
+                a.fx[j] -= tmp[0][l];
+                a.fy[j] -= tmp[1][l];
+                a.fz[j] -= tmp[2][l];
+            }
+        }
+        Real fi[3] = {hsum256(fi_v[0]), hsum256(fi_v[1]), hsum256(fi_v[2])};
+        if (Shell == ForceShell::All) {
+            const Real e_tail = row_tail(c, box, a, i, k, kend, fi);
+            if (WithEnergy) epot += e_tail;
+        }
+        a.fx[i] += fi[0];
+        a.fy[i] += fi[1];
+        a.fz[i] += fi[2];
+    }
+    return WithEnergy ? epot + hsum256(epot_v) : 0.0;
+}
+
+__attribute__((target("avx512f")))
+inline double hsum512(__m512d v) {
+    // Masked extracts: the plain forms trip -Wmaybe-uninitialized in GCC 12.
+    const __m256d lo = _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, v, 0);
+    const __m256d hi = _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, v, 1);
+    const __m256d s4 = _mm256_add_pd(lo, hi);
+    __m128d s2 = _mm_add_pd(_mm256_castpd256_pd128(s4), _mm256_extractf128_pd(s4, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s2, _mm_unpackhi_pd(s2, s2)));
+}
+
+/// One shell of the 8 lanes of e and F/r, with the values of ShellPairKernel.
+template <ForceShell Shell>
+__attribute__((target("avx512f")))
+inline void apply_shell_avx512(const LJConstants& c, __m512d r2, __m512d& e, __m512d& fr) {
+    const __mmask8 below = _mm512_cmp_pd_mask(r2, _mm512_set1_pd(c.on_sq), _CMP_LT_OQ);
+    const __mmask8 inside = _mm512_cmp_pd_mask(r2, _mm512_set1_pd(c.off_sq), _CMP_LT_OQ);
+    if ((inside & static_cast<__mmask8>(~below)) == 0) {
+        // No lane in the switching zone: each pair is all inner or all outer.
+        const __mmask8 keep = Shell == ForceShell::Inner ? below : static_cast<__mmask8>(~inside);
+        e = _mm512_maskz_mov_pd(keep, e);
+        fr = _mm512_maskz_mov_pd(keep, fr);
+        return;
+    }
+    // x is clamped to [0, 1], so S = 1 and S' = 0 below the zone; S = 0 from the split on.
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d r = _mm512_mask_sqrt_pd(zero, 0xFF, r2);
+    // Clamped with blends: GCC 12 flags the undefined pass-through of _mm512_max_pd.
+    __m512d x = _mm512_mul_pd(_mm512_sub_pd(r, _mm512_set1_pd(c.r_on)), _mm512_set1_pd(c.inv_width));
+    x = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x, zero, _CMP_LT_OQ), x, zero);
+    x = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(x, one, _CMP_GT_OQ), x, one);
+    const __m512d s = _mm512_maskz_mov_pd(inside, _mm512_sub_pd(one, _mm512_mul_pd(_mm512_mul_pd(x, x),
+        _mm512_sub_pd(_mm512_set1_pd(3.0), _mm512_add_pd(x, x)))));
+    const __m512d ds_dr = _mm512_mul_pd(_mm512_mul_pd(_mm512_mul_pd(_mm512_set1_pd(-6.0), x),
+                                                      _mm512_sub_pd(one, x)),
+                                        _mm512_set1_pd(c.inv_width));
+    const __m512d e_in = _mm512_mul_pd(s, e);
+    const __m512d f_in = _mm512_sub_pd(_mm512_mul_pd(s, fr), _mm512_div_pd(_mm512_mul_pd(ds_dr, e), r));
+    if (Shell == ForceShell::Inner) {
+        e = e_in;
+        fr = f_in;
+    } else {
+        e = _mm512_sub_pd(e, e_in);
+        fr = _mm512_sub_pd(fr, f_in);
+    }
+}
+
+template <bool WithEnergy, ForceShell Shell = ForceShell::All>
+__attribute__((target("avx512f")))
+Real rows_avx512(const LJConstants& c, const SimdBox& box, const RowArgs& a) {
+    const __m512d rc2 = _mm512_set1_pd(c.cutoff_sq);
+    const __m512d tiny = _mm512_set1_pd(1e-30);
+    const __m512d sig2 = _mm512_set1_pd(c.sigma_sq);
+    const __m512d eps4 = _mm512_set1_pd(c.eps4);
+    const __m512d eps24 = _mm512_set1_pd(c.eps24);
+    const __m512d shift = _mm512_set1_pd(c.shift);
+    const __m512d two = _mm512_set1_pd(2.0);
+    // Explicit sources for masked forms: the unmasked intrinsics start from
+    // _mm512_undefined_pd(), which trips -Wmaybe-uninitialized in GCC 12.
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d len[3] = {_mm512_set1_pd(box.length[0]), _mm512_set1_pd(box.length[1]),
+                            _mm512_set1_pd(box.length[2])};
+    const __m512d inv_len[3] = {_mm512_set1_pd(box.inv_length[0]), _mm512_set1_pd(box.inv_length[1]),
+                                _mm512_set1_pd(box.inv_length[2])};
+    const Real* pos[3] = {a.x, a.y, a.z};
+    Real* force[3] = {a.fx, a.fy, a.fz};
+
+    __m512d epot_v = _mm512_setzero_pd();
+    Real epot = 0.0;
+    alignas(32) std::uint32_t pad[8];
+
+    for (std::size_t i = a.begin; i < a.end; ++i) {
+        const __m512d ri[3] = {_mm512_set1_pd(a.x[i]), _mm512_set1_pd(a.y[i]),
+                               _mm512_set1_pd(a.z[i])};
+        __m512d fi_v[3] = {_mm512_setzero_pd(), _mm512_setzero_pd(), _mm512_setzero_pd()};
+        std::size_t k = a.offsets[i];
+        const std::size_t kend = a.offsets[i + 1];
+        for (; Shell == ForceShell::All ? k + 8 <= kend : k < kend; k += 8) {
+            const std::uint32_t* idx = pad_row_tail(a, i, k, kend, pad, 8);
+            const __m256i vj = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx));
+            __m512d d[3];
+            for (int ax = 0; ax < 3; ++ax) {
+                d[ax] = _mm512_sub_pd(ri[ax], _mm512_mask_i32gather_pd(zero, 0xFF, vj, pos[ax], 8));
+                if (box.periodic) {
+                    const __m512d img = _mm512_mask_roundscale_pd(zero, 0xFF, _mm512_mul_pd(d[ax], inv_len[ax]),
+                                                                  _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+                    d[ax] = _mm512_sub_pd(d[ax], _mm512_mul_pd(len[ax], img));
+                }
+            }
+            const __m512d r2 = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(d[0], d[0]),
+                                                           _mm512_mul_pd(d[1], d[1])),
+                                             _mm512_mul_pd(d[2], d[2]));
+            const __mmask8 mask = _mm512_cmp_pd_mask(r2, rc2, _CMP_LT_OQ)
+                                  & _mm512_cmp_pd_mask(r2, tiny, _CMP_GT_OQ);
+            if (mask == 0) continue;
+            const __m512d r2_inv = _mm512_div_pd(sig2, r2);
+            const __m512d r6_inv = _mm512_mul_pd(_mm512_mul_pd(r2_inv, r2_inv), r2_inv);
+            const __m512d r12_inv = _mm512_mul_pd(r6_inv, r6_inv);
+            __m512d e = _mm512_sub_pd(_mm512_mul_pd(eps4, _mm512_sub_pd(r12_inv, r6_inv)), shift);
+            __m512d fr = _mm512_div_pd(
+                _mm512_mul_pd(eps24, _mm512_sub_pd(_mm512_mul_pd(two, r12_inv), r6_inv)), r2);
+            if (Shell != ForceShell::All) apply_shell_avx512<Shell>(c, r2, e, fr);
+            if (WithEnergy) epot_v = _mm512_mask_add_pd(epot_v, mask, epot_v, e);
+            const __m512d f_div_r = _mm512_maskz_mov_pd(mask, fr);
+            for (int ax = 0; ax < 3; ++ax) {
+                const __m512d fv = _mm512_mul_pd(f_div_r, d[ax]);
+                fi_v[ax] = _mm512_add_pd(fi_v[ax], fv);
+                // j values within a row are distinct, so gather/scatter is race-free.
+                const __m512d fj = _mm512_mask_i32gather_pd(zero, mask, vj, force[ax], 8);
+                _mm512_mask_i32scatter_pd(force[ax], mask, vj, _mm512_sub_pd(fj, fv), 8);
+            }
+        }
+        Real fi[3] = {hsum512(fi_v[0]), hsum512(fi_v[1]), hsum512(fi_v[2])};
+        if (Shell == ForceShell::All) {
+            const Real e_tail = row_tail(c, box, a, i, k, kend, fi);
+            if (WithEnergy) epot += e_tail;
+        }
+        a.fx[i] += fi[0];
+        a.fy[i] += fi[1];
+        a.fz[i] += fi[2];
+    }
+    return WithEnergy ? epot + hsum512(epot_v) : 0.0;
+}
+
+// Mixed precision (Precision::Single): displacements, the minimum image and
+// all sums stay in double; r² is rounded to float and the LJ terms
+// (one division per pair instead of two) run on twice as many lanes.
+// Rows end in one padded vector instead of a scalar tail (pad_row_tail).
+
+template <bool WithEnergy>
+__attribute__((target("avx2,fma")))
+Real rows_avx2_f32(const LJConstants& c, const SimdBox& box, const RowArgs& a) {
+    const __m256 rc2 = _mm256_set1_ps(static_cast<float>(c.cutoff_sq));
+    const __m256 tiny = _mm256_set1_ps(1e-30f);
+    const __m256 sig2 = _mm256_set1_ps(static_cast<float>(c.sigma_sq));
+    const __m256 eps4 = _mm256_set1_ps(static_cast<float>(c.eps4));
+    const __m256 eps24s = _mm256_set1_ps(static_cast<float>(c.eps24_over_sigma_sq));
+    const __m256 shift = _mm256_set1_ps(static_cast<float>(c.shift));
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    const __m256d len[3] = {_mm256_set1_pd(box.length[0]), _mm256_set1_pd(box.length[1]),
+                            _mm256_set1_pd(box.length[2])};
+    const __m256d inv_len[3] = {_mm256_set1_pd(box.inv_length[0]), _mm256_set1_pd(box.inv_length[1]),
+                                _mm256_set1_pd(box.inv_length[2])};
+    const Real* pos[3] = {a.x, a.y, a.z};
+
+    __m256d epot_v = _mm256_setzero_pd();  // Accum lanes
+    alignas(32) double tmp[3][8];
+    alignas(32) std::uint32_t pad[8];
+
+    for (std::size_t i = a.begin; i < a.end; ++i) {
+        const __m256d ri[3] = {_mm256_set1_pd(a.x[i]), _mm256_set1_pd(a.y[i]),
+                               _mm256_set1_pd(a.z[i])};
+        __m256d fi_v[3] = {_mm256_setzero_pd(), _mm256_setzero_pd(), _mm256_setzero_pd()};
+        std::size_t k = a.offsets[i];
+        const std::size_t kend = a.offsets[i + 1];
+        for (; k < kend; k += 8) {
+            const std::uint32_t* idx = pad_row_tail(a, i, k, kend, pad, 8);
+            const __m128i vj[2] = {_mm_loadu_si128(reinterpret_cast<const __m128i*>(idx)),
+                                   _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + 4))};
+            __m256d d[2][3];
+            __m128 r2_half[2];
+            for (int h = 0; h < 2; ++h) {
+                for (int ax = 0; ax < 3; ++ax) {
+                    d[h][ax] = _mm256_sub_pd(ri[ax], _mm256_mask_i32gather_pd(_mm256_setzero_pd(), pos[ax], vj[h], all_lanes, 8));
+                    if (box.periodic) {
+                        const __m256d img = _mm256_round_pd(_mm256_mul_pd(d[h][ax], inv_len[ax]),
+                                                            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+                        d[h][ax] = _mm256_sub_pd(d[h][ax], _mm256_mul_pd(len[ax], img));
+                    }
+                }
+                const __m256d r2d = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(d[h][0], d[h][0]),
+                                                                _mm256_mul_pd(d[h][1], d[h][1])),
+                                                  _mm256_mul_pd(d[h][2], d[h][2]));
+                r2_half[h] = _mm256_cvtpd_ps(r2d);
+            }
+            const __m256 r2 = _mm256_set_m128(r2_half[1], r2_half[0]);
+            const __m256 mask = _mm256_and_ps(_mm256_cmp_ps(r2, rc2, _CMP_LT_OQ),
+                                              _mm256_cmp_ps(r2, tiny, _CMP_GT_OQ));
+            if (_mm256_movemask_ps(mask) == 0) continue;
+            const __m256 s2 = _mm256_div_ps(sig2, r2);
+            const __m256 s6 = _mm256_mul_ps(_mm256_mul_ps(s2, s2), s2);
+            const __m256 s12 = _mm256_mul_ps(s6, s6);
+            const __m256 fr = _mm256_and_ps(
+                _mm256_mul_ps(_mm256_mul_ps(eps24s, _mm256_sub_ps(_mm256_mul_ps(two, s12), s6)), s2), mask);
+            const __m256d f_div_r[2] = {_mm256_cvtps_pd(_mm256_castps256_ps128(fr)),
+                                        _mm256_cvtps_pd(_mm256_extractf128_ps(fr, 1))};
+            if (WithEnergy) {
+                const __m256 e = _mm256_and_ps(
+                    _mm256_sub_ps(_mm256_mul_ps(eps4, _mm256_sub_ps(s12, s6)), shift), mask);
+                epot_v = _mm256_add_pd(epot_v, _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(e)),
+                                                             _mm256_cvtps_pd(_mm256_extractf128_ps(e, 1))));
+            }
+            for (int h = 0; h < 2; ++h) {
+                for (int ax = 0; ax < 3; ++ax) {
+                    const __m256d fv = _mm256_mul_pd(f_div_r[h], d[h][ax]);
+                    fi_v[ax] = _mm256_add_pd(fi_v[ax], fv);
+                    _mm256_store_pd(tmp[ax] + 4 * h, fv);
+                }
+            }
+            for (int l = 0; l < 8; ++l) {
+                const std::size_t j = idx[l];
+                a.fx[j] -= tmp[0][l];
+                a.fy[j] -= tmp[1][l];
+                a.fz[j] -= tmp[2][l];
+            }
+        }
+        a.fx[i] += hsum256(fi_v[0]);
+        a.fy[i] += hsum256(fi_v[1]);
+        a.fz[i] += hsum256(fi_v[2]);
+    }
+    return WithEnergy ? static_cast<Real>(hsum256(epot_v)) : 0.0;
+}
+
+// Half h of a 16-lane float vector as 8 doubles (masked forms, see hsum512).
+__attribute__((target("avx512f")))
+inline __m512d widen512(__m512 v, int h) {
+    const __m256d half = h == 0
+        ? _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, _mm512_castps_pd(v), 0)
+        : _mm512_mask_extractf64x4_pd(_mm256_setzero_pd(), 0xF, _mm512_castps_pd(v), 1);
+    return _mm512_maskz_cvtps_pd(0xFF, _mm256_castpd_ps(half));
+}
+
+template <bool WithEnergy>
+__attribute__((target("avx512f")))
+Real rows_avx512_f32(const LJConstants& c, const SimdBox& box, const RowArgs& a) {
+    const __m512 rc2 = _mm512_set1_ps(static_cast<float>(c.cutoff_sq));
+    const __m512 tiny = _mm512_set1_ps(1e-30f);
+    const __m512 sig2 = _mm512_set1_ps(static_cast<float>(c.sigma_sq));
+    const __m512 eps4 = _mm512_set1_ps(static_cast<float>(c.eps4));
+    const __m512 eps24s = _mm512_set1_ps(static_cast<float>(c.eps24_over_sigma_sq));
+    const __m512 shift = _mm512_set1_ps(static_cast<float>(c.shift));
+    const __m512 two = _mm512_set1_ps(2.0f);
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d len[3] = {_mm512_set1_pd(box.length[0]), _mm512_set1_pd(box.length[1]),
+                            _mm512_set1_pd(box.length[2])};
+    const __m512d inv_len[3] = {_mm512_set1_pd(box.inv_length[0]), _mm512_set1_pd(box.inv_length[1]),
+                                _mm512_set1_pd(box.inv_length[2])};
+    const Real* pos[3] = {a.x, a.y, a.z};
+    Real* force[3] = {a.fx, a.fy, a.fz};
+
+    __m512d epot_v = _mm512_setzero_pd();  // Accum lanes
+    alignas(64) std::uint32_t pad[16];
+
+    for (std::size_t i = a.begin; i < a.end; ++i) {
+        const __m512d ri[3] = {_mm512_set1_pd(a.x[i]), _mm512_set1_pd(a.y[i]),
+                               _mm512_set1_pd(a.z[i])};
+        __m512d fi_v[3] = {_mm512_setzero_pd(), _mm512_setzero_pd(), _mm512_setzero_pd()};
+        std::size_t k = a.offsets[i];
+        const std::size_t kend = a.offsets[i + 1];
+        for (; k < kend; k += 16) {
+            const std::uint32_t* idx = pad_row_tail(a, i, k, kend, pad, 16);
+            const __m256i vj[2] = {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx)),
+                                   _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + 8))};
+            __m512d d[2][3];
+            __m256 r2_half[2];
+            for (int h = 0; h < 2; ++h) {
+                for (int ax = 0; ax < 3; ++ax) {
+                    d[h][ax] = _mm512_sub_pd(ri[ax], _mm512_mask_i32gather_pd(zero, 0xFF, vj[h], pos[ax], 8));
+                    if (box.periodic) {
+                        const __m512d img = _mm512_mask_roundscale_pd(zero, 0xFF, _mm512_mul_pd(d[h][ax], inv_len[ax]),
+                                                                      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+                        d[h][ax] = _mm512_sub_pd(d[h][ax], _mm512_mul_pd(len[ax], img));
+                    }
+                }
+                const __m512d r2d = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(d[h][0], d[h][0]),
+                                                                _mm512_mul_pd(d[h][1], d[h][1])),
+                                                  _mm512_mul_pd(d[h][2], d[h][2]));
+                r2_half[h] = _mm512_maskz_cvtpd_ps(0xFF, r2d);
+            }
+            const __m512d r2_lo = _mm512_mask_insertf64x4(zero, 0xFF, zero, _mm256_castps_pd(r2_half[0]), 0);
+            const __m512 r2 = _mm512_castpd_ps(
+                _mm512_mask_insertf64x4(zero, 0xFF, r2_lo, _mm256_castps_pd(r2_half[1]), 1));
+            const __mmask16 mask = _mm512_cmp_ps_mask(r2, rc2, _CMP_LT_OQ)
+                                   & _mm512_cmp_ps_mask(r2, tiny, _CMP_GT_OQ);
+            if (mask == 0) continue;
+            const __m512 s2 = _mm512_div_ps(sig2, r2);
+            const __m512 s6 = _mm512_mul_ps(_mm512_mul_ps(s2, s2), s2);
+            const __m512 s12 = _mm512_mul_ps(s6, s6);
+            const __m512 fr = _mm512_maskz_mov_ps(
+                mask, _mm512_mul_ps(_mm512_mul_ps(eps24s, _mm512_sub_ps(_mm512_mul_ps(two, s12), s6)), s2));
+            if (WithEnergy) {
+                const __m512 e = _mm512_maskz_mov_ps(
+                    mask, _mm512_sub_ps(_mm512_mul_ps(eps4, _mm512_sub_ps(s12, s6)), shift));
+                epot_v = _mm512_add_pd(epot_v, _mm512_add_pd(widen512(e, 0), widen512(e, 1)));
+            }
+            for (int h = 0; h < 2; ++h) {
+                const __mmask8 m = static_cast<__mmask8>(mask >> (8 * h));
+                if (m == 0) continue;
+                const __m512d f_div_r = widen512(fr, h);
+                for (int ax = 0; ax < 3; ++ax) {
+                    const __m512d fv = _mm512_mul_pd(f_div_r, d[h][ax]);
+                    fi_v[ax] = _mm512_add_pd(fi_v[ax], fv);
+                    const __m512d fj = _mm512_mask_i32gather_pd(zero, m, vj[h], force[ax], 8);
+                    _mm512_mask_i32scatter_pd(force[ax], m, vj[h], _mm512_sub_pd(fj, fv), 8);
+                }
+            }
+        }
+        a.fx[i] += hsum512(fi_v[0]);
+        a.fy[i] += hsum512(fi_v[1]);
+        a.fz[i] += hsum512(fi_v[2]);
+    }
+    return WithEnergy ? static_cast<Real>(hsum512(epot_v)) : 0.0;
+}
+
+#endif  // MATSIMU_X86_SIMD
+
+}  // namespace
+
+bool make_simd_box(const Lattice* lattice, SimdBox& box) {
+    box = SimdBox{};
+    if (!lattice) return true;
+    // The per-axis image is only valid for a diagonal basis.
+    if (!lattice->is_orthorhombic()) return false;
+    const Real len[3] = {lattice->a1[0], lattice->a2[1], lattice->a3[2]};
+    for (int d = 0; d < 3; ++d) {
+        box.length[d] = len[d];
+        box.inv_length[d] = 1.0 / len[d];
+    }
+    box.periodic = true;
+    return true;
+}
+
+Real lj_neighbor_rows_simd(SimdLevel level, const LennardJones& lj, const NeighborList& nlist,
+                           const ParticleSystem& system, const SimdBox& box,
+                           std::size_t begin, std::size_t end, Real* const f[3],
+                           bool with_energy, Precision precision) {
+    if (system.size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+        throw std::length_error("lj_neighbor_rows_simd: particle count exceeds gather index range");
+    const LJConstants c = lj_constants(lj);
+    const RowArgs a{nlist.indices().data(), nlist.offsets().data(),
+                    system.pos(0), system.pos(1), system.pos(2),
+                    f[0], f[1], f[2], begin, end};
+#ifdef MATSIMU_X86_SIMD
+    if (precision == Precision::Single) {
+        if (level == SimdLevel::AVX512)
+            return with_energy ? rows_avx512_f32<true>(c, box, a) : rows_avx512_f32<false>(c, box, a);
+        if (level == SimdLevel::AVX2)
+            return with_energy ? rows_avx2_f32<true>(c, box, a) : rows_avx2_f32<false>(c, box, a);
+    }
+    if (level == SimdLevel::AVX512)
+        return with_energy ? rows_avx512<true>(c, box, a) : rows_avx512<false>(c, box, a);
+    if (level == SimdLevel::AVX2)
+        return with_energy ? rows_avx2<true>(c, box, a) : rows_avx2<false>(c, box, a);
+#endif
+    (void)level;
+    (void)precision;
+    throw std::invalid_argument("lj_neighbor_rows_simd: SIMD level not available");
+}
+
+Real lj_shell_rows_simd(SimdLevel level, const LennardJones& lj, ForceShell shell,
+                        const ShellSwitch& sw, const std::size_t* offsets,
+                        const std::uint32_t* indices, const ParticleSystem& system,
+                        const SimdBox& box, std::size_t begin, std::size_t end, Real* const f[3],
+                        bool with_energy) {
+    if (system.size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+        throw std::length_error("lj_shell_rows_simd: particle count exceeds gather index range");
+    if (shell == ForceShell::All)
+        throw std::invalid_argument("lj_shell_rows_simd: use lj_neighbor_rows_simd for ForceShell::All");
+    const LJConstants c = shell_constants(lj_constants(lj), shell, sw);
+    const RowArgs a{indices, offsets, system.pos(0), system.pos(1), system.pos(2),
+                    f[0], f[1], f[2], begin, end};
+#ifdef MATSIMU_X86_SIMD
+    constexpr ForceShell In = ForceShell::Inner, Out = ForceShell::Outer;
+    const bool inner = shell == In;
+    if (level == SimdLevel::AVX512) {
+        if (with_energy)
+            return inner ? rows_avx512<true, In>(c, box, a) : rows_avx512<true, Out>(c, box, a);
+        return inner ? rows_avx512<false, In>(c, box, a) : rows_avx512<false, Out>(c, box, a);
+    }
+    if (level == SimdLevel::AVX2) {
+        if (with_energy)
+            return inner ? rows_avx2<true, In>(c, box, a) : rows_avx2<true, Out>(c, box, a);
+        return inner ? rows_avx2<false, In>(c, box, a) : rows_avx2<false, Out>(c, box, a);
+    }
+#endif
+    (void)level;
+    throw std::invalid_argument("lj_shell_rows_simd: SIMD level not available");
+}
+
+}  // namespace matsimu
@@ -0,0 +1,94 @@
+#include <matsimu/physics/spatial_sort.hpp>
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+namespace matsimu {
+
+namespace {
+
+// Spread the low 10 bits of v to every third bit.
+std::uint32_t spread_bits(std::uint32_t v) {
+    v &= 0x3FFu;
+    v = (v | (v << 16)) & 0x030000FFu;
+    v = (v | (v << 8)) & 0x0300F00Fu;
+    v = (v | (v << 4)) & 0x030C30C3u;
+    v = (v | (v << 2)) & 0x09249249u;
+    return v;
+}
+
+std::uint32_t to_cell(Real t) {
+    const Real c = std::floor(t * static_cast<Real>(kMortonCells));
+    if (!(c > 0)) return 0;  // also NaN
+    return c >= static_cast<Real>(kMortonCells) ? kMortonCells - 1 : static_cast<std::uint32_t>(c);
+}
+
+}  // namespace
+
+std::uint32_t morton_key(std::uint32_t x, std::uint32_t y, std::uint32_t z) {
+    return spread_bits(x) | (spread_bits(y) << 1) | (spread_bits(z) << 2);
+}
+
+namespace {
+
+template <typename OrderVector>
+void fill_morton_order(const ParticleSystem& system, const Lattice* lattice, Arena* scratch,
+                       OrderVector& order) {
+    const std::size_t n = system.size();
+    const Real* x = system.pos(0);
+    const Real* y = system.pos(1);
+    const Real* z = system.pos(2);
+
+    Real lo[3] = {0, 0, 0}, inv_extent[3] = {1, 1, 1};
+    if (!lattice && n > 0) {
+        Real hi[3];
+        for (int d = 0; d < 3; ++d) {
+            const Real* a = system.pos(d);
+            const auto [mn, mx] = std::minmax_element(a, a + n);
+            lo[d] = *mn;
+            hi[d] = *mx;
+            inv_extent[d] = hi[d] > lo[d] ? 1.0 / (hi[d] - lo[d]) : 0.0;
+        }
+    }
+
+    ArenaVector<std::uint64_t> keyed(n, arena_allocator<std::uint64_t>(scratch));  // key << 32 | slot: stable for equal keys
+    for (std::size_t i = 0; i < n; ++i) {
+        Real f[3];
+        if (lattice) {
+            const Real r[3] = {x[i], y[i], z[i]};
+            lattice->cartesian_to_fractional(r, f);
+            for (int d = 0; d < 3; ++d) f[d] -= std::floor(f[d]);
+        } else {
+            f[0] = (x[i] - lo[0]) * inv_extent[0];
+            f[1] = (y[i] - lo[1]) * inv_extent[1];
+            f[2] = (z[i] - lo[2]) * inv_extent[2];
+        }
+        const std::uint64_t key = morton_key(to_cell(f[0]), to_cell(f[1]), to_cell(f[2]));
+        keyed[i] = (key << 32) | static_cast<std::uint64_t>(i);
+    }
+    std::sort(keyed.begin(), keyed.end());
+    order.resize(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = static_cast<std::uint32_t>(keyed[i] & 0xFFFFFFFFu);
+}
+
+}  // namespace
+
+void morton_order(const ParticleSystem& system, const Lattice* lattice,
+                  std::vector<std::uint32_t>& order) {
+    fill_morton_order(system, lattice, nullptr, order);
+}
+
+void sort_particles_morton(ParticleSystem& system, const Lattice* lattice, Arena* scratch) {
+    const std::size_t n = system.size();
+    if (scratch) scratch->set_budget(system.budget());
+    if (scratch) scratch->reserve(n * (sizeof(std::uint32_t) + sizeof(std::uint64_t)
+                                       + ParticleSystem::kReorderScratchPerParticle) + 256);
+    std::optional<ArenaScope> scope;
+    if (scratch) scope.emplace(*scratch);
+    ArenaVector<std::uint32_t> order{arena_allocator<std::uint32_t>(scratch)};
+    order.reserve(n);
+    fill_morton_order(system, lattice, scratch, order);
+    system.reorder(order.data(), scratch);
+}
+
+}  // namespace matsimu
@@ -1,5 +1,9 @@
 #include <matsimu/physics/thermostat.hpp>
+#include <matsimu/physics/counter_rng.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
+#include <algorithm>
 #include <random>
+#include <sstream>
 #include <cmath>
 
 namespace matsimu {
@@ -7,26 +11,51 @@ namespace matsimu {
 // Boltzmann constant [J/K]
 constexpr Real kB = 1.380649e-23;
 
+namespace {
+
+/// Below this many particles per-particle loops stay on the calling thread.
+constexpr std::size_t kParallelParticlesMin = 4096;
+
+/// body(begin, end) over [0, n), split in static chunks over pool when worth it.
+template <typename Body>
+void for_particle_chunks(ThreadPool* pool, std::size_t n, const Body& body) {
+    if (!pool || pool->size() < 2 || n < kParallelParticlesMin) {
+        body(std::size_t(0), n);
+        return;
+    }
+    const std::size_t parts = pool->size();
+    pool->run([&](std::size_t tid) { body(n * tid / parts, n * (tid + 1) / parts); });
+}
+
+}  // namespace
+
 // VelocityRescaleThermostat implementation
 VelocityRescaleThermostat::VelocityRescaleThermostat(Real target_T, Real tau)
     : target_T_(target_T), tau_(tau) {}
 
 void VelocityRescaleThermostat::apply(ParticleSystem& system, Real dt) {
-    Real current_T = system.temperature();
-    if (current_T <= 0.0 || target_T_ <= 0.0) return;
+    rescale(system, dt, system.temperature());
+}
+
+void VelocityRescaleThermostat::apply_distributed(ParticleSystem& system, Real dt,
+                                                  Real global_temperature) {
+    rescale(system, dt, global_temperature);
+}
+
+std::optional<Real> VelocityRescaleThermostat::uniform_scale(Real dt, Real current_T) const {
+    if (current_T <= 0.0 || target_T_ <= 0.0) return 1.0;
     
     // Berendsen scaling factor
     // lambda^2 = 1 + (dt/tau) * (T_target/T_current - 1)
     Real lambda_sq = 1.0 + (dt / tau_) * (target_T_ / current_T - 1.0);
-    if (lambda_sq <= 0.0) return;
+    if (lambda_sq <= 0.0) return 1.0;
     
-    Real lambda = std::sqrt(lambda_sq);
-    
-    for (auto& p : system.particles()) {
-        p.vel[0] *= lambda;
-        p.vel[1] *= lambda;
-        p.vel[2] *= lambda;
-    }
+    return std::sqrt(lambda_sq);
+}
+
+void VelocityRescaleThermostat::rescale(ParticleSystem& system, Real dt, Real current_T) const {
+    const Real lambda = *uniform_scale(dt, current_T);
+    if (lambda != 1.0) system.scale_velocities(lambda);
 }
 
 // AndersenThermostat implementation
@@ -38,12 +67,13 @@ public:
     std::normal_distribution<Real> dist_{0.0, 1.0};
 };
 
-AndersenThermostat::AndersenThermostat(Real target_T, Real nu, unsigned seed)
-    : target_T_(target_T), nu_(nu) {
+AndersenThermostat::AndersenThermostat(Real target_T, Real nu, unsigned seed, ThermostatRng rng)
+    : target_T_(target_T), nu_(nu), rng_(rng) {
     if (seed == 0) {
         std::random_device rd;
         seed = rd();
     }
+    seed_ = seed;
     impl_ = std::make_unique<Impl>(seed);
 }
 
@@ -52,17 +82,41 @@ AndersenThermostat::~AndersenThermostat() = default;
 void AndersenThermostat::apply(ParticleSystem& system, Real dt) {
     // Collision probability per particle per timestep
     Real prob = 1.0 - std::exp(-nu_ * dt);
+    
+    if (rng_ == ThermostatRng::Counter) {
+        const CounterRng rng(seed_, CounterRng::kStreamAndersen);
+        const std::uint64_t step = calls_++;
+        const std::size_t n = system.size();
+        const Real* inv_m = system.inverse_masses();
+        Real* v[3] = {system.vel(0), system.vel(1), system.vel(2)};
+        for_particle_chunks(pool_.get(), n, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const std::uint32_t id = system.id(i);
+                if (uniform_open01(rng.block(step, id, 0)[0]) >= prob) continue;
+                const Real sigma = std::sqrt(kB * target_T_ * inv_m[i]);
+                Real g[3];
+                rng.normal3(step, id, 1, g);
+                for (int d = 0; d < 3; ++d) v[d][i] = sigma * g[d];
+            }
+        });
+        return;
+    }
     std::uniform_real_distribution<Real> uniform(0.0, 1.0);
     
     // Standard deviation of Maxwell-Boltzmann distribution
     // sigma = sqrt(kB * T / m)
-    for (auto& p : system.particles()) {
+    const std::size_t n = system.size();
+    const Real* inv_m = system.inverse_masses();
+    Real* vx = system.vel(0);
+    Real* vy = system.vel(1);
+    Real* vz = system.vel(2);
+    for (std::size_t i = 0; i < n; ++i) {
         if (uniform(impl_->gen_) < prob) {
-            Real sigma = std::sqrt(kB * target_T_ / p.mass);
+            Real sigma = std::sqrt(kB * target_T_ * inv_m[i]);
             
-            p.vel[0] = sigma * impl_->dist_(impl_->gen_);
-            p.vel[1] = sigma * impl_->dist_(impl_->gen_);
-            p.vel[2] = sigma * impl_->dist_(impl_->gen_);
+            vx[i] = sigma * impl_->dist_(impl_->gen_);
+            vy[i] = sigma * impl_->dist_(impl_->gen_);
+            vz[i] = sigma * impl_->dist_(impl_->gen_);
         }
     }
 }
@@ -76,4 +130,48 @@ void AndersenThermostat::set_target_temperature(Real T) {
     target_T_ = T;
 }
 
+std::string AndersenThermostat::save_state() const {
+    std::ostringstream os;
+    if (rng_ == ThermostatRng::Counter) {
+        os << "philox " << seed_ << ' ' << calls_;
+        return os.str();
+    }
+    os << impl_->gen_ << ' ' << impl_->dist_;
+    return os.str();
+}
+
+bool AndersenThermostat::load_state(const std::string& state) {
+    std::istringstream is(state);
+    if (rng_ == ThermostatRng::Counter) {
+        std::string tag;
+        unsigned seed = 0;
+        std::uint64_t calls = 0;
+        if (!(is >> tag >> seed >> calls) || tag != "philox") return false;
+        seed_ = seed;
+        calls_ = calls;
+        return true;
+    }
+    std::mt19937 gen;
+    std::normal_distribution<Real> dist;
+    if (!(is >> gen >> dist)) return false;
+    impl_->gen_ = gen;
+    impl_->dist_ = dist;
+    return true;
+}
+
+void assign_maxwell_velocities(ParticleSystem& system, Real T, std::uint64_t seed, ThreadPool* pool) {
+    const CounterRng rng(seed, CounterRng::kStreamVelocities);
+    const Real scale = std::sqrt(kB * std::max<Real>(T, 0.0));
+    const Real* inv_m = system.inverse_masses();
+    Real* v[3] = {system.vel(0), system.vel(1), system.vel(2)};
+    for_particle_chunks(pool, system.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            Real g[3];
+            rng.normal3(0, system.id(i), 0, g);
+            const Real sigma = scale * std::sqrt(inv_m[i]);
+            for (int d = 0; d < 3; ++d) v[d][i] = sigma * g[d];
+        }
+    });
+}
+
 } // namespace matsimu
@@ -0,0 +1,332 @@
+#include <matsimu/sim/device_simulation.hpp>
+#include <cmath>
+
+namespace matsimu {
+
+namespace {
+
+// Boltzmann constant [J/K]
+constexpr Real kB = 1.380649e-23;
+
+MATSIMU_OFFLOAD(declare target)
+
+/// Wrap one coordinate into [0, length)
+inline Real wrap(Real x, Real length, Real inv_length) {
+    return x - length * std::floor(x * inv_length);
+}
+
+MATSIMU_OFFLOAD(end declare target)
+
+}  // namespace
+
+DeviceSimulation::DeviceSimulation(const SimulationParams& params, std::shared_ptr<Potential> potential)
+    : params_(params), system_(0, params.max_bytes) {
+    if (auto validation_error = params_.validate()) {
+        error_msg_ = *validation_error;
+        return;
+    }
+    if (params_.respa_steps > 1) {
+        error_msg_ = "RESPA is not supported in device runs.";
+        return;
+    }
+    params_ok_ = true;
+    set_potential(std::move(potential));
+}
+
+void DeviceSimulation::set_potential(std::shared_ptr<Potential> potential) {
+    if (!params_ok_) return;
+    if (initialized_ && host_stale_) download();
+    initialized_ = false;
+    force_field_.reset();
+    if (!potential || !DeviceForceField::supports(*potential)) {
+        error_msg_ = "Device runs need a LennardJones or TabulatedPotential.";
+        valid_ = false;
+        return;
+    }
+    force_field_ = std::make_unique<DeviceForceField>(std::move(potential), params_.neighbor_skin);
+    configure();
+}
+
+void DeviceSimulation::set_lattice(const Lattice& lattice) {
+    if (initialized_ && host_stale_) download();
+    lattice_ = lattice;
+    lattice_.update_cache();
+    has_lattice_ = true;
+    initialized_ = false;
+    configure();
+}
+
+void DeviceSimulation::configure() {
+    if (!force_field_) return;  // error_msg_ says why
+    valid_ = false;
+    if (!has_lattice_) {
+        error_msg_ = "No lattice set";
+        return;
+    }
+    if (!lattice_.is_orthorhombic()) {
+        error_msg_ = "Device runs need an orthorhombic lattice.";
+        return;
+    }
+    const Real width = 2.0 * (force_field_->cutoff() + params_.neighbor_skin);
+    if (lattice_.a1[0] < width || lattice_.a2[1] < width || lattice_.a3[2] < width) {
+        error_msg_ = "Lattice must be at least 2 x (cutoff + skin) wide along every axis.";
+        return;
+    }
+    force_field_->set_box(lattice_);
+    error_msg_.clear();
+    valid_ = true;
+}
+
+void DeviceSimulation::restore_clock(Real time, std::size_t step_count) {
+    time_ = time;
+    step_count_ = step_count;
+    epot_valid_ = false;
+}
+
+ParticleSystem& DeviceSimulation::system() {
+    if (host_stale_) download();
+    return system_;
+}
+
+const ParticleSystem& DeviceSimulation::system() const {
+    if (host_stale_) download();
+    return system_;
+}
+
+DeviceParticleArrays DeviceSimulation::arrays() const {
+    DeviceParticleArrays p;
+    p.n = system_.size();
+    for (int d = 0; d < 3; ++d) {
+        p.pos[d] = pos_[d].host();
+        p.force[d] = force_[d].host();
+    }
+    return p;
+}
+
+void DeviceSimulation::upload() {
+    // Unmap everything first: a reallocated array may now sit where another
+    // mirror's old range is still mapped, and mapping over a present range
+    // would neither allocate nor copy.
+    release_mirrors();
+    const std::size_t n = system_.size();
+    for (int d = 0; d < 3; ++d) {
+        pos_[d].map(system_.pos(d), n);
+        vel_[d].map(system_.vel(d), n);
+        force_[d].map(system_.force(d), n);
+    }
+    inv_mass_.map(system_.inverse_masses(), n);
+    mass_.map(system_.masses(), n);
+    force_field_->invalidate();
+    epot_ = force_field_->compute_forces(arrays(), true);
+    epot_valid_ = true;
+    kick(0.0);
+    mark_synced();
+    host_stale_ = true;  // forces
+    ++uploads_;
+}
+
+void DeviceSimulation::release_mirrors() {
+    for (int d = 0; d < 3; ++d) {
+        pos_[d].release();
+        vel_[d].release();
+        force_[d].release();
+    }
+    inv_mass_.release();
+    mass_.release();
+}
+
+void DeviceSimulation::mark_synced() const {
+    synced_pos_version_ = system_.position_version();
+    synced_vel_version_ = system_.velocity_version();
+}
+
+bool DeviceSimulation::host_changed() const {
+    return system_.position_version() != synced_pos_version_
+        || system_.velocity_version() != synced_vel_version_;
+}
+
+void DeviceSimulation::download() const {
+    // Non-const accessors: bump the position and velocity versions.
+    for (int d = 0; d < 3; ++d) {
+        system_.pos(d);
+        system_.vel(d);
+        pos_[d].download();
+        vel_[d].download();
+        force_[d].download();
+    }
+    mark_synced();
+    host_stale_ = false;
+    ++snapshots_;
+}
+
+void DeviceSimulation::initialize() {
+    if (!valid_) return;
+    if (host_stale_) download();
+    system_.zero_com_velocity();
+    upload();
+    initialized_ = true;
+}
+
+void DeviceSimulation::kick_drift() {
+    const std::size_t n = system_.size();
+    Real* x = pos_[0].host();
+    Real* y = pos_[1].host();
+    Real* z = pos_[2].host();
+    Real* vx = vel_[0].host();
+    Real* vy = vel_[1].host();
+    Real* vz = vel_[2].host();
+    const Real* fx = force_[0].host();
+    const Real* fy = force_[1].host();
+    const Real* fz = force_[2].host();
+    const Real* inv_m = inv_mass_.host();
+    const Real dt = params_.dt;
+    const Real half_dt = 0.5 * dt;
+    const Real lx = lattice_.a1[0], ly = lattice_.a2[1], lz = lattice_.a3[2];
+    const Real ilx = 1.0 / lx, ily = 1.0 / ly, ilz = 1.0 / lz;
+    MATSIMU_OFFLOAD(target teams distribute parallel for \
+                    map(alloc: x[0:n], y[0:n], z[0:n], vx[0:n], vy[0:n], vz[0:n], \
+                        fx[0:n], fy[0:n], fz[0:n], inv_m[0:n]))
+    for (std::size_t i = 0; i < n; ++i) {
+        vx[i] += half_dt * (fx[i] * inv_m[i]);
+        vy[i] += half_dt * (fy[i] * inv_m[i]);
+        vz[i] += half_dt * (fz[i] * inv_m[i]);
+        x[i] = wrap(x[i] + dt * vx[i], lx, ilx);
+        y[i] = wrap(y[i] + dt * vy[i], ly, ily);
+        z[i] = wrap(z[i] + dt * vz[i], lz, ilz);
+    }
+}
+
+bool DeviceSimulation::kick(Real half_dt) {
+    const std::size_t n = system_.size();
+    const Real* x = pos_[0].host();
+    const Real* y = pos_[1].host();
+    const Real* z = pos_[2].host();
+    Real* vx = vel_[0].host();
+    Real* vy = vel_[1].host();
+    Real* vz = vel_[2].host();
+    const Real* fx = force_[0].host();
+    const Real* fy = force_[1].host();
+    const Real* fz = force_[2].host();
+    const Real* inv_m = inv_mass_.host();
+    const Real* m = mass_.host();
+    Real twice_ekin = 0.0, px = 0.0, py = 0.0, pz = 0.0, total_mass = 0.0;
+    std::size_t bad = 0;
+    MATSIMU_OFFLOAD(target teams distribute parallel for \
+                    reduction(+: twice_ekin, px, py, pz, total_mass, bad) \
+                    map(alloc: x[0:n], y[0:n], z[0:n], vx[0:n], vy[0:n], vz[0:n], \
+                        fx[0:n], fy[0:n], fz[0:n], inv_m[0:n], m[0:n]))
+    for (std::size_t i = 0; i < n; ++i) {
+        if (half_dt != 0.0) {
+            vx[i] += half_dt * (fx[i] * inv_m[i]);
+            vy[i] += half_dt * (fy[i] * inv_m[i]);
+            vz[i] += half_dt * (fz[i] * inv_m[i]);
+        }
+        twice_ekin += m[i] * (vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+        px += m[i] * vx[i];
+        py += m[i] * vy[i];
+        pz += m[i] * vz[i];
+        total_mass += m[i];
+        // Any inf or NaN makes the probe NaN.
+        const Real probe = x[i] + y[i] + z[i] + vx[i] + vy[i] + vz[i] + fx[i] + fy[i] + fz[i];
+        if (!(probe - probe == 0.0) || !(m[i] > 0.0)) ++bad;
+    }
+    kinetic_.kinetic_energy = 0.5 * twice_ekin;
+    kinetic_.momentum[0] = px;
+    kinetic_.momentum[1] = py;
+    kinetic_.momentum[2] = pz;
+    kinetic_.total_mass = total_mass;
+    kinetic_.temperature = n > 1 ? twice_ekin / ((3.0 * static_cast<Real>(n) - 3.0) * kB) : 0.0;
+    return bad == 0;
+}
+
+void DeviceSimulation::scale_velocities(Real lambda) {
+    const std::size_t n = system_.size();
+    Real* vx = vel_[0].host();
+    Real* vy = vel_[1].host();
+    Real* vz = vel_[2].host();
+    MATSIMU_OFFLOAD(target teams distribute parallel for map(alloc: vx[0:n], vy[0:n], vz[0:n]))
+    for (std::size_t i = 0; i < n; ++i) {
+        vx[i] *= lambda;
+        vy[i] *= lambda;
+        vz[i] *= lambda;
+    }
+    kinetic_.kinetic_energy *= lambda * lambda;
+    kinetic_.temperature *= lambda * lambda;
+    for (Real& p : kinetic_.momentum) p *= lambda;
+}
+
+void DeviceSimulation::apply_thermostat() {
+    if (const auto lambda = thermostat_->uniform_scale(params_.dt, kinetic_.temperature)) {
+        if (*lambda != 1.0) scale_velocities(*lambda);
+        return;
+    }
+    // Per-particle thermostat: through the host velocities.
+    for (int d = 0; d < 3; ++d) {
+        system_.vel(d);
+        vel_[d].download();
+    }
+    thermostat_->apply(system_, params_.dt);
+    for (int d = 0; d < 3; ++d) vel_[d].upload();
+    synced_vel_version_ = system_.velocity_version();
+    kick(0.0);
+}
+
+Real DeviceSimulation::potential_energy() {
+    if (!epot_valid_ && valid_ && initialized_) {
+        if (host_changed()) {
+            upload();
+        } else {
+            epot_ = force_field_->compute_forces(arrays(), true);
+            epot_valid_ = true;
+        }
+    }
+    return epot_;
+}
+
+bool DeviceSimulation::finished() const {
+    if (!valid_) return true;
+    if (step_count_ >= params_.max_steps) return true;
+    if (params_.end_time > 0.0 && time_ >= params_.end_time) return true;
+    return false;
+}
+
+bool DeviceSimulation::step() {
+    if (!valid_) {
+        if (error_msg_.empty()) error_msg_ = "Simulation not properly initialized";
+        return false;
+    }
+    if (finished()) return false;
+    if (!initialized_) initialize();
+    else if (host_changed()) upload();
+
+    const bool energy_due = params_.energy_interval > 0
+        && (step_count_ + 1) % params_.energy_interval == 0;
+    kick_drift();
+    epot_ = force_field_->compute_forces(arrays(), energy_due);
+    epot_valid_ = energy_due;
+    const bool healthy = kick(0.5 * params_.dt);
+    if (thermostat_ && healthy) apply_thermostat();
+    host_stale_ = true;
+    if (!healthy) {
+        error_msg_ = "Particle state became non-finite";
+        valid_ = false;
+        return false;
+    }
+
+    time_ += params_.dt;
+    ++step_count_;
+    if (params_.end_time > 0.0) {
+        const Real epsilon = params_.dt * 0.5;
+        if (time_ >= params_.end_time - epsilon) {
+            time_ = params_.end_time;
+            return false;
+        }
+    }
+    return true;
+}
+
+void DeviceSimulation::run() {
+    while (step()) {}
+}
+
+}  // namespace matsimu
@@ -0,0 +1,228 @@
+#include <matsimu/sim/distributed_heat_2d.hpp>
+#include <matsimu/sim/heat_stencil.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace matsimu {
+
+namespace {
+
+enum Side { West = 0, East = 1, South = 2, North = 3 };
+
+/// Values ahead of each rank's cells in gather(): i0, j0, nx, ny.
+constexpr std::size_t kTileHeader = 4;
+
+}  // namespace
+
+DistributedHeat2DModel::DistributedHeat2DModel(const HeatDiffusion2DParams& params,
+                                               std::shared_ptr<Communicator> comm,
+                                               std::size_t max_bytes)
+    : params_(params), comm_(std::move(comm)),
+      pool_(params.num_threads > 1 && !params.validate()
+                ? std::make_shared<ThreadPool>(params.num_threads) : nullptr),
+      placement_(make_memory_placement(params.huge_pages, params.first_touch, pool_)),
+      T_(HeatAllocator(max_bytes, placement_allocator<Real>(placement_))),
+      T_next_(HeatAllocator(max_bytes, placement_allocator<Real>(placement_))) {
+    if (!comm_) comm_ = std::make_shared<SelfCommunicator>();
+    if (auto err = params_.validate()) {
+        error_msg_ = *err;
+        return;
+    }
+    if (params_.scheme != HeatScheme::Explicit || params_.precision != Precision::Double) {
+        error_msg_ = "Distributed heat diffusion needs the explicit scheme in double precision.";
+        return;
+    }
+    decompose();
+    if (!error_msg_.empty()) return;
+    initialize();
+    valid_ = true;
+}
+
+void DistributedHeat2DModel::decompose() {
+    const std::size_t inner_x = params_.nx - 2;
+    const std::size_t inner_y = params_.ny - 2;
+    const int ranks = comm_->size();
+
+    // Least halo per tile (its perimeter) among grids leaving every tile a cell.
+    Real best_cost = std::numeric_limits<Real>::infinity();
+    for (int px = 1; px <= ranks; ++px) {
+        if (ranks % px != 0) continue;
+        const int py = ranks / px;
+        if (static_cast<std::size_t>(px) > inner_x || static_cast<std::size_t>(py) > inner_y)
+            continue;
+        const Real cost = static_cast<Real>(inner_x) / px + static_cast<Real>(inner_y) / py;
+        if (cost < best_cost) {
+            best_cost = cost;
+            grid_ = {px, py};
+        }
+    }
+    if (!std::isfinite(best_cost)) {
+        error_msg_ = "Grid too small for " + std::to_string(ranks)
+                     + " ranks: every tile needs at least one interior cell.";
+        return;
+    }
+
+    const int rank = comm_->rank();
+    coords_ = {rank % grid_[0], rank / grid_[0]};
+    const auto cx = static_cast<std::size_t>(coords_[0]);
+    const auto cy = static_cast<std::size_t>(coords_[1]);
+    const auto px = static_cast<std::size_t>(grid_[0]);
+    const auto py = static_cast<std::size_t>(grid_[1]);
+    tile_.i0 = 1 + inner_x * cx / px;
+    tile_.j0 = 1 + inner_y * cy / py;
+    tile_.nx = 1 + inner_x * (cx + 1) / px - tile_.i0;
+    tile_.ny = 1 + inner_y * (cy + 1) / py - tile_.j0;
+
+    neighbor_[West] = coords_[0] > 0 ? rank - 1 : -1;
+    neighbor_[East] = coords_[0] + 1 < grid_[0] ? rank + 1 : -1;
+    neighbor_[South] = coords_[1] > 0 ? rank - grid_[0] : -1;
+    neighbor_[North] = coords_[1] + 1 < grid_[1] ? rank + grid_[0] : -1;
+    for (int side = 0; side < 4; ++side) {
+        const std::size_t n = side < South ? tile_.ny : tile_.nx;
+        send_[side].assign(neighbor_[side] >= 0 ? n : 0, 0.0);
+        recv_[side].assign(neighbor_[side] >= 0 ? n : 0, 0.0);
+    }
+}
+
+void DistributedHeat2DModel::initialize() {
+    const std::size_t pitch = this->pitch();
+    T_.assign(pitch * (tile_.ny + 2), params_.T_boundary);
+
+    // Same expressions as HeatDiffusion2DModel, at global cell indices.
+    const Real sigma = params_.hot_radius_frac;
+    const Real inv_2sigma2 = 1.0 / (2.0 * sigma * sigma);
+    const Real T_delta = params_.T_hot - params_.T_boundary;
+    for (std::size_t j = 0; j < tile_.ny; ++j) {
+        const std::size_t gj = tile_.j0 + j;
+        const Real fy = (static_cast<Real>(gj) + 0.5) / static_cast<Real>(params_.ny) - 0.5;
+        Real* row = T_.data() + (j + 1) * pitch + 1;
+        for (std::size_t i = 0; i < tile_.nx; ++i) {
+            if (params_.ic == HeatIC2D::UniformHot) {
+                row[i] = params_.T_hot;
+                continue;
+            }
+            const std::size_t gi = tile_.i0 + i;
+            const Real fx = (static_cast<Real>(gi) + 0.5) / static_cast<Real>(params_.nx) - 0.5;
+            const Real r2 = fx * fx + fy * fy;
+            row[i] = params_.T_boundary + T_delta * std::exp(-r2 * inv_2sigma2);
+        }
+    }
+    // The frame of T_next_ is never written by a step; its edges stay T_boundary.
+    T_next_ = T_;
+}
+
+void DistributedHeat2DModel::post_halo() {
+    const std::size_t pitch = this->pitch();
+    const Real* T = T_.data();
+    for (int side = 0; side < 4; ++side) {
+        if (neighbor_[side] < 0) continue;
+        std::vector<Real>& out = send_[side];
+        if (side < South) {
+            const std::size_t i = side == West ? 1 : tile_.nx;
+            for (std::size_t j = 0; j < tile_.ny; ++j) out[j] = T[(j + 1) * pitch + i];
+        } else {
+            const std::size_t j = side == South ? 1 : tile_.ny;
+            std::copy_n(T + j * pitch + 1, tile_.nx, out.begin());
+        }
+        comm_->irecv(neighbor_[side], recv_[side]);
+        comm_->isend(neighbor_[side], out);
+    }
+}
+
+void DistributedHeat2DModel::unpack_halo() {
+    const std::size_t pitch = this->pitch();
+    Real* T = T_.data();
+    for (int side = 0; side < 4; ++side) {
+        if (neighbor_[side] < 0) continue;
+        const std::vector<Real>& in = recv_[side];
+        if (side < South) {
+            const std::size_t i = side == West ? 0 : tile_.nx + 1;
+            for (std::size_t j = 0; j < tile_.ny; ++j) T[(j + 1) * pitch + i] = in[j];
+        } else {
+            const std::size_t j = side == South ? 0 : tile_.ny + 1;
+            std::copy(in.begin(), in.end(), T + j * pitch + 1);
+        }
+    }
+}
+
+bool DistributedHeat2DModel::step() {
+    if (!valid_ || finished()) return false;
+
+    const Real r = params_.alpha * params_.dt / (params_.dx * params_.dx);
+    const std::size_t pitch = this->pitch();
+    const std::size_t nx = tile_.nx, ny = tile_.ny;
+    const Real* src = T_.data();
+    Real* dst = T_next_.data();
+
+    post_halo();
+    // Cells (padded coordinates) [2, nx) × [2, ny) read no ghost.
+    heat_update_rect_2d(src, dst, pitch, 2, nx, 2, ny, r, pool_.get(), simd_level_);
+    comm_->wait_all();
+    unpack_halo();
+    // Rim: first and last row in full, then the first and last column between them.
+    heat_update_rect_2d(src, dst, pitch, 1, nx + 1, 1, 2, r, nullptr, simd_level_);
+    if (ny > 1) heat_update_rect_2d(src, dst, pitch, 1, nx + 1, ny, ny + 1, r, nullptr, simd_level_);
+    heat_update_rect_2d(src, dst, pitch, 1, 2, 2, ny, r, nullptr, simd_level_);
+    if (nx > 1) heat_update_rect_2d(src, dst, pitch, nx, nx + 1, 2, ny, r, nullptr, simd_level_);
+    std::swap(T_, T_next_);
+
+    time_ += params_.dt;
+    ++step_count_;
+    if (!std::isfinite(time_)) {
+        error_msg_ = "Time became non-finite.";
+        valid_ = false;
+        return false;
+    }
+    return true;
+}
+
+bool DistributedHeat2DModel::finished() const {
+    if (!valid_) return true;
+    if (step_count_ >= params_.max_steps) return true;
+    if (params_.end_time > 0.0 && time_ >= params_.end_time) return true;
+    return false;
+}
+
+std::vector<StateBuffer> DistributedHeat2DModel::state_buffers() {
+    if (!valid_) return {};
+    return {{T_.data(), T_.size() * sizeof(Real)}};
+}
+
+void DistributedHeat2DModel::restore_clock(Real time, std::size_t step_count) {
+    time_ = time;
+    step_count_ = step_count;
+}
+
+void DistributedHeat2DModel::gather(std::vector<Real>& out, int root) {
+    const std::size_t pitch = this->pitch();
+    std::vector<Real> mine;
+    if (valid_) {
+        mine.reserve(kTileHeader + tile_.nx * tile_.ny);
+        mine.insert(mine.end(), {static_cast<Real>(tile_.i0), static_cast<Real>(tile_.j0),
+                                 static_cast<Real>(tile_.nx), static_cast<Real>(tile_.ny)});
+        for (std::size_t j = 0; j < tile_.ny; ++j) {
+            const Real* row = T_.data() + (j + 1) * pitch + 1;
+            mine.insert(mine.end(), row, row + tile_.nx);
+        }
+    }
+    std::vector<Real> all;
+    comm_->gather(mine, all, root);
+    out.clear();
+    if (comm_->rank() != root || !valid_) return;
+    const std::size_t nx = params_.nx;
+    out.assign(nx * params_.ny, params_.T_boundary);
+    for (std::size_t k = 0; k + kTileHeader <= all.size();) {
+        const Real* rec = all.data() + k;
+        const auto i0 = static_cast<std::size_t>(rec[0]);
+        const auto j0 = static_cast<std::size_t>(rec[1]);
+        const auto tnx = static_cast<std::size_t>(rec[2]);
+        const auto tny = static_cast<std::size_t>(rec[3]);
+        const Real* cells = rec + kTileHeader;
+        for (std::size_t j = 0; j < tny; ++j)
+            std::copy_n(cells + j * tnx, tnx, out.data() + (j0 + j) * nx + i0);
+        k += kTileHeader + tnx * tny;
+    }
+}
+
+}  // namespace matsimu
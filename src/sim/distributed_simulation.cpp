@@ -0,0 +1,359 @@
+#include <matsimu/sim/distributed_simulation.hpp>
+#include <matsimu/physics/pair_kernel.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace matsimu {
+
+namespace {
+
+// Boltzmann constant [J/K]
+constexpr Real kB = 1.380649e-23;
+
+/**
+ * accumulate_pair_rows for one rank: rows [begin, end) of local's owned
+ * prefix [0, n_owned), open-box displacements. Partners j >= n_owned are
+ * ghosts: their reaction force belongs to the rank (or image) that owns
+ * them and the pair energy is shared with it, so only the i side is updated
+ * and half the energy is counted.
+ */
+template <bool WithEnergy, typename Kernel>
+Real accumulate_owned_rows(const Kernel& kernel, const NeighborList& nlist,
+                           const ParticleSystem& local, std::size_t n_owned,
+                           std::size_t begin, std::size_t end, Real* const f[3]) {
+    const Real* x = local.pos(0);
+    const Real* y = local.pos(1);
+    const Real* z = local.pos(2);
+    const Real rc2 = kernel.cutoff_squared();
+    Real epot = 0.0;
+
+    for (std::size_t i = begin; i < std::min(end, n_owned); ++i) {
+        Real fxi = 0.0, fyi = 0.0, fzi = 0.0;
+        for (std::size_t j : nlist.neighbors(i)) {
+            const Real dx = x[i] - x[j];
+            const Real dy = y[i] - y[j];
+            const Real dz = z[i] - z[j];
+            const Real r2 = dx * dx + dy * dy + dz * dz;
+            if (r2 >= rc2) continue;
+            Real e, f_div_r;
+            kernel.energy_and_force(r2, e, f_div_r);
+            const Real fx = f_div_r * dx;
+            const Real fy = f_div_r * dy;
+            const Real fz = f_div_r * dz;
+            fxi += fx; fyi += fy; fzi += fz;
+            if (j < n_owned) {
+                f[0][j] -= fx; f[1][j] -= fy; f[2][j] -= fz;
+                if (WithEnergy) epot += e;
+            } else if (WithEnergy) {
+                epot += 0.5 * e;
+            }
+        }
+        f[0][i] += fxi; f[1][i] += fyi; f[2][i] += fzi;
+    }
+    return epot;
+}
+
+/// Kinetic moments of n particles from reduced sums {KE, p[3], M}.
+void unpack_kinetic(const Real* sums, std::size_t n, KineticMoments& m) {
+    m.kinetic_energy = sums[0];
+    for (int d = 0; d < 3; ++d) m.momentum[d] = sums[1 + d];
+    m.total_mass = sums[4];
+    m.temperature = n > 1 ? 2.0 * m.kinetic_energy / ((3.0 * static_cast<Real>(n) - 3.0) * kB) : 0.0;
+}
+
+}  // namespace
+
+DistributedSimulation::DistributedSimulation(const SimulationParams& params,
+                                             std::shared_ptr<Potential> potential,
+                                             std::shared_ptr<Communicator> comm)
+    : params_(params), potential_(std::move(potential)), comm_(std::move(comm)),
+      thread_pool_(params.num_threads > 1 && !params.validate()
+                       ? std::make_shared<ThreadPool>(params.num_threads) : nullptr),
+      system_(0, params.max_bytes), local_(0, params.max_bytes),
+      nlist_(params.cutoff, params.neighbor_skin, params.neighbor_build),
+      integrator_(params.dt) {
+    if (auto validation_error = params_.validate()) {
+        error_msg_ = *validation_error;
+        return;
+    }
+    if (params_.respa_steps > 1) {
+        error_msg_ = "RESPA is not supported in distributed runs.";
+        return;
+    }
+    if (!potential_) {
+        error_msg_ = "Distributed simulation needs a potential.";
+        return;
+    }
+    if (!comm_) comm_ = std::make_shared<SelfCommunicator>();
+    error_msg_ = "No lattice set";
+}
+
+void DistributedSimulation::set_lattice(const Lattice& lattice) {
+    if (!potential_ || params_.validate() || params_.respa_steps > 1) return;
+    domain_ = DomainDecomposition(lattice, params_.cutoff + params_.neighbor_skin, *comm_);
+    valid_ = domain_.is_valid();
+    error_msg_ = domain_.error_message();
+    initialized_ = false;
+}
+
+void DistributedSimulation::scatter(const ParticleSystem& global) {
+    system_.clear();
+    if (!valid_) return;
+    std::vector<std::uint32_t> ids;
+    const int rank = comm_->rank();
+    for (std::size_t i = 0; i < global.size(); ++i) {
+        const Particle p = global[i];
+        if (domain_.owner_of(p.pos) != rank) continue;
+        system_.add_particle(p);
+        ids.push_back(static_cast<std::uint32_t>(i));
+    }
+    system_.set_ids(ids.data());
+    initialized_ = false;
+}
+
+void DistributedSimulation::scatter_crystal(const Lattice& cell, const CrystalSpec& spec) {
+    system_.clear();
+    if (!valid_) return;
+    const std::size_t nb = crystal_sites(spec.basis);
+    const std::size_t* rep = spec.repeats;
+    const Lattice& box = domain_.lattice();
+    const Lattice super = supercell(cell, spec);
+    const Real* want[3] = {super.a1, super.a2, super.a3};
+    const Real* have[3] = {box.a1, box.a2, box.a3};
+    bool same_box = true;
+    for (int k = 0; k < 3; ++k) {
+        const Real norm = std::sqrt(want[k][0] * want[k][0] + want[k][1] * want[k][1]
+                                    + want[k][2] * want[k][2]);
+        for (int d = 0; d < 3; ++d)
+            same_box = same_box && std::fabs(have[k][d] - want[k][d]) <= 1e-6 * norm;
+    }
+    constexpr std::size_t kMaxSites = std::size_t{1} << 32;  // 32-bit ids
+    const bool fits = rep[0] > 0 && rep[1] > 0 && rep[2] > 0 && rep[0] <= kMaxSites / nb
+                      && rep[1] <= kMaxSites / nb / rep[0]
+                      && rep[2] <= kMaxSites / nb / rep[0] / rep[1];
+    if (!same_box || !fits) {
+        error_msg_ = !same_box ? "scatter_crystal: the crystal's supercell is not the lattice."
+                               : "scatter_crystal: crystal exceeds 2^32 sites (32-bit ids).";
+        valid_ = false;
+        return;
+    }
+
+    // Cell indices along each axis whose sites can fall in this rank's slab
+    // (widened for rounding); owner_of() then decides each site, so a rank
+    // keeps exactly the sites scatter() would give it.
+    constexpr Real kSlabMargin = 1e-5;
+    const int rank = comm_->rank();
+    std::vector<std::size_t> rows[3];
+    for (int d = 0; d < 3; ++d) {
+        const Real parts = static_cast<Real>(domain_.grid()[d]);
+        const Real lo = static_cast<Real>(domain_.coords()[d]) / parts - kSlabMargin;
+        const Real hi = static_cast<Real>(domain_.coords()[d] + 1) / parts + kSlabMargin;
+        for (std::size_t n = 0; n < rep[d]; ++n) {
+            bool near = false;
+            for (std::size_t b = 0; b < nb && !near; ++b) {
+                std::size_t at[3] = {0, 0, 0};
+                at[d] = n;
+                Real r[3], s[3];
+                crystal_site(cell, spec, at, b, r);
+                box.cartesian_to_fractional(r, s);
+                const Real t = s[d] - std::floor(s[d]);
+                near = (t >= lo && t < hi) || t >= lo + 1.0 || t < hi - 1.0;
+            }
+            if (near) rows[d].push_back(n);
+        }
+    }
+
+    std::vector<Real> xyz[3];
+    std::vector<std::uint32_t> ids;
+    std::size_t n[3];
+    for (const std::size_t n0 : rows[0]) {
+        for (const std::size_t n1 : rows[1]) {
+            for (const std::size_t n2 : rows[2]) {
+                n[0] = n0;
+                n[1] = n1;
+                n[2] = n2;
+                for (std::size_t b = 0; b < nb; ++b) {
+                    Real r[3];
+                    crystal_site(cell, spec, n, b, r);
+                    if (domain_.owner_of(r) != rank) continue;
+                    for (int d = 0; d < 3; ++d) xyz[d].push_back(r[d]);
+                    ids.push_back(static_cast<std::uint32_t>(((n0 * rep[1] + n1) * rep[2] + n2) * nb + b));
+                }
+            }
+        }
+    }
+    const Real* pos[3] = {xyz[0].data(), xyz[1].data(), xyz[2].data()};
+    system_.append(ids.size(), pos, nullptr, spec.mass);
+    system_.set_ids(ids.data());
+    initialized_ = false;
+}
+
+void DistributedSimulation::initialize() {
+    if (!valid_) return;
+    // Migration keeps the total; counted once, as an integer (exact for any Real).
+    std::uint64_t count = system_.size();
+    comm_->allreduce_sum(&count, 1);
+    global_count_ = static_cast<std::size_t>(count);
+    // Zero the centre-of-mass velocity of the whole system.
+    reduce_kinetic();
+    if (global_kinetic_.total_mass > 0.0) {
+        for (int d = 0; d < 3; ++d) {
+            const Real v_com = global_kinetic_.momentum[d] / global_kinetic_.total_mass;
+            Real* v = system_.vel(d);
+            for (std::size_t i = 0; i < system_.size(); ++i) v[i] -= v_com;
+        }
+    }
+    rebuild();
+    compute_forces(true);
+    reduce_step(true);
+    initialized_ = true;
+}
+
+void DistributedSimulation::rebuild() {
+    domain_.migrate(system_, *comm_);
+    domain_.build_ghosts(system_, local_, *comm_);
+    nlist_.set_row_limit(system_.size());
+    nlist_.build(local_, nullptr);
+    ++rebuilds_;
+}
+
+void DistributedSimulation::refresh_ghosts() {
+    domain_.update_ghosts(system_, local_, *comm_);
+    std::uint64_t votes = nlist_.needs_rebuild(local_) ? 1 : 0;
+    comm_->allreduce_sum(&votes, 1);
+    if (votes > 0) rebuild();
+}
+
+void DistributedSimulation::compute_forces(bool with_energy) {
+    const std::size_t n_owned = system_.size();
+    const std::vector<std::size_t>& offsets = nlist_.offsets();
+    local_epot_ = dispatch_pair_kernel(*potential_, [&](const auto& kernel) {
+        return run_pair_rows(
+            thread_pool_.get(), buffers_, local_,
+            [&](std::size_t i) { return offsets[i]; },
+            [&](std::size_t begin, std::size_t end, Real* const f[3]) {
+                return with_energy
+                    ? accumulate_owned_rows<true>(kernel, nlist_, local_, n_owned, begin, end, f)
+                    : accumulate_owned_rows<false>(kernel, nlist_, local_, n_owned, begin, end, f);
+            });
+    });
+    for (int d = 0; d < 3; ++d)
+        std::copy(local_.force(d), local_.force(d) + n_owned, system_.force(d));
+    local_epot_valid_ = with_energy;
+    epot_valid_ = false;
+}
+
+void DistributedSimulation::reduce_kinetic() {
+    const KineticMoments& m = system_.kinetic_moments(thread_pool_.get());
+    Real sums[5] = {m.kinetic_energy, m.momentum[0], m.momentum[1], m.momentum[2],
+                    m.total_mass};
+    comm_->allreduce_sum(sums, 5);
+    unpack_kinetic(sums, global_count_, global_kinetic_);
+}
+
+bool DistributedSimulation::reduce_step(bool healthy) {
+    const KineticMoments& m = system_.kinetic_moments(thread_pool_.get());
+    // The health flag sums to the number of failed ranks, exact in any Real
+    // below 2^24 ranks.
+    Real sums[7] = {m.kinetic_energy, m.momentum[0], m.momentum[1], m.momentum[2],
+                    m.total_mass, local_epot_valid_ ? local_epot_ : 0.0, healthy ? 0.0 : 1.0};
+    comm_->allreduce_sum(sums, 7);
+    unpack_kinetic(sums, global_count_, global_kinetic_);
+    // Every rank summed energy on the same steps.
+    global_epot_ = sums[5];
+    epot_valid_ = local_epot_valid_;
+    return sums[6] == 0.0;
+}
+
+Real DistributedSimulation::potential_energy() {
+    if (!epot_valid_ && valid_ && initialized_) {
+        compute_forces(true);
+        Real epot = local_epot_;
+        comm_->allreduce_sum(&epot, 1);
+        global_epot_ = epot;
+        epot_valid_ = true;
+    }
+    return global_epot_;
+}
+
+bool DistributedSimulation::finished() const {
+    if (!valid_) return true;
+    if (step_count_ >= params_.max_steps) return true;
+    if (params_.end_time > 0.0 && time_ >= params_.end_time) return true;
+    return false;
+}
+
+bool DistributedSimulation::step() {
+    if (!valid_) {
+        if (error_msg_.empty()) error_msg_ = "Simulation not properly initialized";
+        return false;
+    }
+    if (finished()) return false;
+    if (!initialized_) initialize();
+
+    const bool energy_due = params_.energy_interval > 0
+        && (step_count_ + 1) % params_.energy_interval == 0;
+    bool healthy = integrator_.step1_checked(system_);
+    refresh_ghosts();
+    compute_forces(energy_due);
+    healthy = integrator_.step2_checked(system_) && healthy;
+    if (thermostat_) {
+        reduce_kinetic();
+        thermostat_->apply_distributed(system_, params_.dt, global_kinetic_.temperature);
+    }
+    if (!reduce_step(healthy)) {
+        error_msg_ = "Particle state became non-finite";
+        valid_ = false;
+        return false;
+    }
+
+    time_ += params_.dt;
+    ++step_count_;
+    if (params_.end_time > 0.0) {
+        const Real epsilon = params_.dt * 0.5;
+        if (time_ >= params_.end_time - epsilon) {
+            time_ = params_.end_time;
+            return false;
+        }
+    }
+    return true;
+}
+
+void DistributedSimulation::run() {
+    while (step()) {}
+}
+
+void DistributedSimulation::gather(ParticleSystem& out, int root) {
+    constexpr std::size_t stride = 7;  // position, velocity, mass; ids go separately
+    const ParticleSystem& owned = system_;
+    std::vector<Real> mine;
+    std::vector<std::uint32_t> my_ids(owned.size());
+    mine.reserve(owned.size() * stride);
+    for (std::size_t i = 0; i < owned.size(); ++i) {
+        const Particle p = owned[i];
+        mine.insert(mine.end(), {p.pos[0], p.pos[1], p.pos[2], p.vel[0], p.vel[1], p.vel[2],
+                                 p.mass});
+        my_ids[i] = owned.id(i);
+    }
+    std::vector<Real> all;
+    std::vector<std::uint32_t> ids;
+    comm_->gather(mine, all, root);
+    comm_->gather(my_ids, ids, root);
+    out.clear();
+    if (comm_->rank() != root) return;
+    const std::size_t n = std::min(all.size() / stride, ids.size());
+    out.resize(n);
+    for (std::size_t k = 0; k < n; ++k) {
+        const Real* rec = all.data() + k * stride;
+        const std::size_t i = ids[k];
+        if (i >= n) continue;
+        for (int d = 0; d < 3; ++d) {
+            out.pos(d)[i] = rec[d];
+            out.vel(d)[i] = rec[3 + d];
+        }
+        out.set_mass(i, rec[6]);
+    }
+}
+
+}  // namespace matsimu
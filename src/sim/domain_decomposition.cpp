@@ -0,0 +1,239 @@
+#include <matsimu/sim/domain_decomposition.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace matsimu {
+
+namespace {
+
+/// Reals per migrating particle: position, velocity, mass (the id travels
+/// in a separate integer message).
+constexpr std::size_t kMigrateStride = 7;
+
+/// Perpendicular width of the cell along each lattice vector: V / |a_j × a_k|.
+void cell_widths(const Lattice& lattice, Real width[3]) {
+    const Real vol = std::fabs(lattice.volume());
+    const Real* a[3] = {lattice.a1, lattice.a2, lattice.a3};
+    for (int d = 0; d < 3; ++d) {
+        const Real* u = a[(d + 1) % 3];
+        const Real* v = a[(d + 2) % 3];
+        const Real cx = u[1] * v[2] - u[2] * v[1];
+        const Real cy = u[2] * v[0] - u[0] * v[2];
+        const Real cz = u[0] * v[1] - u[1] * v[0];
+        width[d] = vol / std::sqrt(cx * cx + cy * cy + cz * cz);
+    }
+}
+
+}  // namespace
+
+DomainDecomposition::DomainDecomposition(const Lattice& lattice, Real halo,
+                                         const Communicator& comm)
+    : lattice_(lattice), halo_(halo) {
+    lattice_.update_cache();
+    const Real vol = std::fabs(lattice_.volume());
+    if (!(vol > 0.0) || !std::isfinite(vol)) {
+        error_ = "Domain decomposition needs a periodic cell with non-zero volume.";
+        return;
+    }
+    if (!(halo > 0.0) || !std::isfinite(halo)) {
+        error_ = "Domain decomposition halo (cutoff + skin) must be positive and finite.";
+        return;
+    }
+    Real width[3];
+    cell_widths(lattice_, width);
+
+    // Least halo surface among grids whose subdomains are >= halo wide.
+    const int ranks = comm.size();
+    Real best_cost = std::numeric_limits<Real>::infinity();
+    for (int p0 = 1; p0 <= ranks; ++p0) {
+        if (ranks % p0 != 0) continue;
+        for (int p1 = 1; p1 <= ranks / p0; ++p1) {
+            if ((ranks / p0) % p1 != 0) continue;
+            const int p[3] = {p0, p1, ranks / p0 / p1};
+            Real cost = 0.0;
+            bool fits = true;
+            for (int d = 0; d < 3; ++d) {
+                fits = fits && width[d] / static_cast<Real>(p[d]) >= halo;
+                cost += static_cast<Real>(p[d]) / width[d];
+            }
+            if (fits && cost < best_cost) {
+                best_cost = cost;
+                grid_ = {p[0], p[1], p[2]};
+            }
+        }
+    }
+    if (!std::isfinite(best_cost)) {
+        error_ = "Cell too small for " + std::to_string(ranks)
+                 + " ranks: subdomains would be narrower than cutoff + skin.";
+        return;
+    }
+
+    const int rank = comm.rank();
+    coords_ = {rank % grid_[0], (rank / grid_[0]) % grid_[1], rank / (grid_[0] * grid_[1])};
+    for (int d = 0; d < 3; ++d) {
+        std::array<int, 3> c = coords_;
+        c[d] = (coords_[d] + grid_[d] - 1) % grid_[d];
+        lower_[d] = rank_at(c[0], c[1], c[2]);
+        c[d] = (coords_[d] + 1) % grid_[d];
+        upper_[d] = rank_at(c[0], c[1], c[2]);
+        halo_frac_[d] = halo / width[d];
+    }
+}
+
+int DomainDecomposition::rank_at(int c0, int c1, int c2) const {
+    return (c2 * grid_[1] + c1) * grid_[0] + c0;
+}
+
+int DomainDecomposition::grid_coord(Real s, int d) const {
+    // No wrap: owned positions sit in [0, 1) up to rounding, and a clamped
+    // edge particle must stay consistent with its Cartesian position.
+    const Real c = std::floor(s * static_cast<Real>(grid_[d]));
+    if (!(c > 0.0)) return 0;
+    return static_cast<int>(std::min<Real>(c, static_cast<Real>(grid_[d] - 1)));
+}
+
+int DomainDecomposition::owner_of(const Real pos[3]) const {
+    Real s[3];
+    lattice_.cartesian_to_fractional(pos, s);
+    int c[3];
+    for (int d = 0; d < 3; ++d) c[d] = grid_coord(s[d] - std::floor(s[d]), d);
+    return rank_at(c[0], c[1], c[2]);
+}
+
+void DomainDecomposition::migrate(ParticleSystem& owned, Communicator& comm) {
+    owned.apply_pbc(lattice_);
+    std::vector<std::uint32_t> ids, ids_to_lower, ids_to_upper, ids_in;
+    std::vector<Real> to_upper;
+    for (int d = 0; d < 3; ++d) {
+        if (grid_[d] == 1) continue;
+        const int below = (coords_[d] + grid_[d] - 1) % grid_[d];
+        const std::size_t n = owned.size();
+        ids.resize(n);
+        for (std::size_t i = 0; i < n; ++i) ids[i] = owned.id(i);
+
+        // Pack leavers, compact the rest in place.
+        send_buf_.clear();
+        to_upper.clear();
+        ids_to_lower.clear();
+        ids_to_upper.clear();
+        Real* x[3] = {owned.pos(0), owned.pos(1), owned.pos(2)};
+        Real* v[3] = {owned.vel(0), owned.vel(1), owned.vel(2)};
+        const Real* m = owned.masses();
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const Real r[3] = {x[0][i], x[1][i], x[2][i]};
+            Real s[3];
+            lattice_.cartesian_to_fractional(r, s);
+            const int c = std::isfinite(s[d]) ? grid_coord(s[d], d) : coords_[d];
+            if (c != coords_[d]) {
+                std::vector<Real>& out = c == below ? send_buf_ : to_upper;
+                out.insert(out.end(), {r[0], r[1], r[2], v[0][i], v[1][i], v[2][i], m[i]});
+                (c == below ? ids_to_lower : ids_to_upper).push_back(ids[i]);
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                x[k][kept] = x[k][i];
+                v[k][kept] = v[k][i];
+            }
+            if (kept != i) owned.set_mass(kept, m[i]);
+            ids[kept] = ids[i];
+            ++kept;
+        }
+        owned.resize(kept);
+        ids.resize(kept);
+
+        for (int dir = 0; dir < 2; ++dir) {
+            if (dir == 0) {
+                comm.sendrecv(lower_[d], send_buf_, upper_[d], recv_buf_);
+                comm.sendrecv(lower_[d], ids_to_lower, upper_[d], ids_in);
+            } else {
+                comm.sendrecv(upper_[d], to_upper, lower_[d], recv_buf_);
+                comm.sendrecv(upper_[d], ids_to_upper, lower_[d], ids_in);
+            }
+            const std::size_t count = std::min(recv_buf_.size() / kMigrateStride, ids_in.size());
+            for (std::size_t k = 0; k < count; ++k) {
+                const Real* rec = recv_buf_.data() + k * kMigrateStride;
+                Particle p;
+                for (int c = 0; c < 3; ++c) {
+                    p.pos[c] = rec[c];
+                    p.vel[c] = rec[3 + c];
+                }
+                p.mass = rec[6];
+                owned.add_particle(p);
+                ids.push_back(ids_in[k]);
+            }
+        }
+        owned.set_ids(ids.data());
+    }
+}
+
+void DomainDecomposition::build_ghosts(const ParticleSystem& owned, ParticleSystem& local,
+                                       Communicator& comm) {
+    const std::size_t n_owned = owned.size();
+    local.resize(n_owned);
+    for (int d = 0; d < 3; ++d) std::copy(owned.pos(d), owned.pos(d) + n_owned, local.pos(d));
+
+    const Real* a[3] = {lattice_.a1, lattice_.a2, lattice_.a3};
+    for (int d = 0; d < 3; ++d) {
+        // Both directions of an axis choose from the particles present before
+        // it: copies just received from above lie above this subdomain and
+        // must not be sent straight back up.
+        const std::size_t candidates = local.size();
+        const Real lo = static_cast<Real>(coords_[d]) / static_cast<Real>(grid_[d]);
+        const Real hi = static_cast<Real>(coords_[d] + 1) / static_cast<Real>(grid_[d]);
+        for (int dir = 0; dir < 2; ++dir) {
+            Swap& swap = swaps_[static_cast<std::size_t>(2 * d + dir)];
+            const bool down = dir == 0;
+            swap.dest = down ? lower_[d] : upper_[d];
+            swap.src = down ? upper_[d] : lower_[d];
+            // Crossing the periodic boundary: the copy is an image one cell over.
+            const bool wraps = down ? coords_[d] == 0 : coords_[d] == grid_[d] - 1;
+            for (int k = 0; k < 3; ++k) swap.shift[k] = wraps ? (down ? a[d][k] : -a[d][k]) : 0.0;
+
+            swap.send.clear();
+            const Real* x[3] = {local.pos(0), local.pos(1), local.pos(2)};
+            for (std::size_t i = 0; i < candidates; ++i) {
+                const Real r[3] = {x[0][i], x[1][i], x[2][i]};
+                Real s[3];
+                lattice_.cartesian_to_fractional(r, s);
+                if (down ? s[d] < lo + halo_frac_[d] : s[d] >= hi - halo_frac_[d])
+                    swap.send.push_back(static_cast<std::uint32_t>(i));
+            }
+
+            send_buf_.clear();
+            for (std::uint32_t i : swap.send)
+                for (int k = 0; k < 3; ++k) send_buf_.push_back(x[k][i] + swap.shift[k]);
+            comm.sendrecv(swap.dest, send_buf_, swap.src, recv_buf_);
+
+            swap.recv_begin = local.size();
+            swap.recv_count = recv_buf_.size() / 3;
+            local.resize(swap.recv_begin + swap.recv_count);
+            for (int k = 0; k < 3; ++k) {
+                Real* xk = local.pos(k);
+                for (std::size_t g = 0; g < swap.recv_count; ++g)
+                    xk[swap.recv_begin + g] = recv_buf_[3 * g + static_cast<std::size_t>(k)];
+            }
+        }
+    }
+    ghost_count_ = local.size() - n_owned;
+}
+
+void DomainDecomposition::update_ghosts(const ParticleSystem& owned, ParticleSystem& local,
+                                        Communicator& comm) {
+    const std::size_t n_owned = owned.size();
+    Real* x[3] = {local.pos(0), local.pos(1), local.pos(2)};
+    for (int d = 0; d < 3; ++d) std::copy(owned.pos(d), owned.pos(d) + n_owned, x[d]);
+    for (const Swap& swap : swaps_) {
+        send_buf_.clear();
+        for (std::uint32_t i : swap.send)
+            for (int k = 0; k < 3; ++k) send_buf_.push_back(x[k][i] + swap.shift[k]);
+        comm.sendrecv(swap.dest, send_buf_, swap.src, recv_buf_);
+        const std::size_t count = std::min(swap.recv_count, recv_buf_.size() / 3);
+        for (int k = 0; k < 3; ++k)
+            for (std::size_t g = 0; g < count; ++g)
+                x[k][swap.recv_begin + g] = recv_buf_[3 * g + static_cast<std::size_t>(k)];
+    }
+}
+
+}  // namespace matsimu
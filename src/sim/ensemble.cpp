@@ -0,0 +1,164 @@
+#include <matsimu/sim/ensemble.hpp>
+#include <matsimu/parallel/thread_pool.hpp>
+#include <matsimu/physics/particle_builder.hpp>
+#include <matsimu/physics/potential.hpp>
+#include <matsimu/physics/thermostat.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <new>
+
+namespace matsimu {
+
+std::optional<std::string> ReplicaSystem::validate() const {
+    if (cells == 0)
+        return "Replica cells per edge must be at least 1.";
+    if (!std::isfinite(spacing) || spacing <= 0.0)
+        return "Replica lattice spacing must be positive and finite.";
+    if (!std::isfinite(mass) || mass <= 0.0)
+        return "Replica atom mass must be positive and finite.";
+    if (!std::isfinite(epsilon) || epsilon <= 0.0 || !std::isfinite(sigma) || sigma <= 0.0)
+        return "Replica LJ epsilon and sigma must be positive and finite.";
+    if (thermostat != ReplicaThermostat::None && (!std::isfinite(thermostat_tau) || thermostat_tau <= 0.0))
+        return "Replica thermostat tau must be positive and finite.";
+    return std::nullopt;
+}
+
+namespace {
+
+/// fcc crystal of spec.system with Maxwell velocities.
+void build_crystal(Simulation& sim, const ReplicaSpec& spec) {
+    const ReplicaSystem& rs = spec.system;
+    Lattice cell;
+    cell.a1[0] = rs.spacing;
+    cell.a2[1] = rs.spacing;
+    cell.a3[2] = rs.spacing;
+    CrystalSpec crystal;
+    crystal.basis = CrystalBasis::FCC;
+    for (auto& r : crystal.repeats) r = rs.cells;
+    for (auto& o : crystal.offset) o = 0.25;
+    crystal.mass = rs.mass;
+
+    ParticleSystem& ps = sim.system();
+    ps.clear();
+    // Throws std::bad_alloc past the replica budget.
+    sim.set_lattice(fill_crystal(ps, cell, crystal));
+    assign_maxwell_velocities(ps, spec.params.temperature, spec.seed);
+    ps.zero_com_velocity();
+}
+
+/// spec.system.source into sim: box, positions, velocities, masses.
+/// Returns false when the file carried no velocities.
+bool copy_source(Simulation& sim, const ParticleSource& src) {
+    sim.set_lattice(src.lattice);
+    const ParticleSystem& from = src.particles;
+    ParticleSystem& ps = sim.system();
+    ps.clear();
+    ps.resize(from.size());  // throws std::bad_alloc past the replica budget
+    bool moving = false;
+    for (int d = 0; d < 3; ++d) {
+        std::copy(from.pos(d), from.pos(d) + from.size(), ps.pos(d));
+        std::copy(from.vel(d), from.vel(d) + from.size(), ps.vel(d));
+        moving = moving || std::any_of(from.vel(d), from.vel(d) + from.size(),
+                                       [](Real v) { return v != 0.0; });
+    }
+    ps.set_masses(from.masses());
+    return moving;
+}
+
+}  // namespace
+
+void build_replica(Simulation& sim, const ReplicaSpec& spec) {
+    const ReplicaSystem& rs = spec.system;
+    if (rs.source) {
+        if (!copy_source(sim, *rs.source)) {
+            assign_maxwell_velocities(sim.system(), spec.params.temperature, spec.seed);
+            sim.system().zero_com_velocity();
+        }
+    } else {
+        build_crystal(sim, spec);
+    }
+
+    if (rs.potential)
+        sim.set_potential(rs.potential);
+    else
+        sim.set_potential(std::make_shared<LennardJones>(rs.epsilon, rs.sigma, spec.params.cutoff));
+    switch (rs.thermostat) {
+        case ReplicaThermostat::Rescale:
+            sim.set_thermostat(std::make_shared<VelocityRescaleThermostat>(spec.params.temperature, rs.thermostat_tau));
+            break;
+        case ReplicaThermostat::Andersen:
+            sim.set_thermostat(std::make_shared<AndersenThermostat>(spec.params.temperature,
+                                                                    1.0 / rs.thermostat_tau, spec.seed,
+                                                                    ThermostatRng::Counter));
+            break;
+        case ReplicaThermostat::None:
+            break;
+    }
+}
+
+ReplicaResult run_replica(const ReplicaSpec& spec, std::size_t max_bytes) {
+    ReplicaResult r;
+    r.index = spec.index;
+    const auto start = std::chrono::steady_clock::now();
+    auto finish = [&] {
+        r.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return r;
+    };
+
+    if (auto err = spec.system.validate()) {
+        r.error = *err;
+        return finish();
+    }
+    SimulationParams params = spec.params;
+    params.max_bytes = std::min(params.max_bytes, max_bytes);
+    try {
+        Simulation sim(params);
+        if (!sim.is_valid()) {
+            r.error = sim.error_message();
+            return finish();
+        }
+        build_replica(sim, spec);
+        sim.run();
+        r.atoms = sim.system().size();
+        r.steps = sim.step_count();
+        r.time = sim.time();
+        r.kinetic_energy = sim.kinetic_energy();
+        r.potential_energy = sim.potential_energy();
+        r.total_energy = r.kinetic_energy + r.potential_energy;
+        r.temperature = sim.temperature();
+        r.error = sim.error_message();
+        r.ok = r.error.empty();
+    } catch (const std::bad_alloc&) {
+        r.error = "Replica exceeds its memory budget of " + std::to_string(params.max_bytes) + " bytes.";
+    }
+    return finish();
+}
+
+std::vector<ReplicaResult> run_ensemble(const std::vector<ReplicaSpec>& specs,
+                                        const EnsembleOptions& options) {
+    std::vector<ReplicaResult> results(specs.size());
+    if (specs.empty()) return results;
+    const std::size_t workers = std::max<std::size_t>(1, std::min(options.threads, specs.size()));
+    const std::size_t budget = options.max_bytes / workers;
+
+    std::atomic<std::size_t> next{0};
+    auto work = [&](std::size_t) {
+        for (;;) {
+            const std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= specs.size()) return;
+            results[i] = run_replica(specs[i], budget);
+        }
+    };
+    if (workers < 2) {
+        work(0);
+    } else {
+        ThreadPool pool(workers);
+        pool.run(work);
+    }
+    return results;
+}
+
+}  // namespace matsimu
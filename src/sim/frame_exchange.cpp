@@ -0,0 +1,93 @@
+#include <matsimu/sim/frame_exchange.hpp>
+#include <matsimu/sim/simulation.hpp>
+#include <matsimu/sim/heat_diffusion_2d.hpp>
+#include <atomic>
+
+namespace matsimu {
+
+void capture_frame(const ParticleSystem& ps, SimFrame& frame) {
+    const std::size_t n = ps.size();
+    frame.kind = SimFrame::Kind::Particles;
+    for (int d = 0; d < 3; ++d) {
+        frame.pos[d].assign(ps.pos(d), ps.pos(d) + n);
+        frame.vel[d].assign(ps.vel(d), ps.vel(d) + n);
+    }
+    frame.field.clear();
+    frame.nx = frame.ny = 0;
+}
+
+void capture_frame(const Simulation& sim, SimFrame& frame) {
+    frame.step = sim.step_count();
+    frame.time = sim.time();
+    if (sim.mode() == SimMode::MD) {
+        capture_frame(sim.system(), frame);
+        return;
+    }
+    for (int d = 0; d < 3; ++d) {
+        frame.pos[d].clear();
+        frame.vel[d].clear();
+    }
+    const HeatDiffusion2DModel* model = sim.heat_2d_model();
+    if (!model) {
+        frame.kind = SimFrame::Kind::Empty;
+        frame.field.clear();
+        frame.nx = frame.ny = 0;
+        return;
+    }
+    const auto& T = model->temperature();
+    frame.kind = SimFrame::Kind::Field2D;
+    frame.field.assign(T.begin(), T.end());
+    frame.nx = model->nx();
+    frame.ny = model->ny();
+    frame.T_cold = model->T_cold();
+    frame.T_hot = model->T_hot();
+}
+
+FrameExchange::FrameExchange(std::size_t buffers) {
+    pool_.reserve(buffers);
+    for (std::size_t i = 0; i < buffers; ++i)
+        pool_.push_back(std::make_shared<SimFrame>());
+}
+
+SimFrame& FrameExchange::begin_write() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (writing_) return *writing_;
+    // A frame referenced only by the pool is neither published nor held by a
+    // reader; readers only obtain frames through latest(), under the mutex.
+    for (const auto& frame : pool_) {
+        if (frame.use_count() == 1) {
+            // Pairs with the release in the reader's last shared_ptr drop,
+            // so its reads of the old contents happen before our writes.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            writing_ = frame;
+            return *writing_;
+        }
+    }
+    pool_.push_back(std::make_shared<SimFrame>());
+    writing_ = pool_.back();
+    return *writing_;
+}
+
+void FrameExchange::publish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!writing_) return;
+    published_ = std::move(writing_);
+    ++generation_;
+}
+
+std::shared_ptr<const SimFrame> FrameExchange::latest() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return published_;
+}
+
+std::uint64_t FrameExchange::generation() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+std::size_t FrameExchange::buffers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pool_.size();
+}
+
+}  // namespace matsimu
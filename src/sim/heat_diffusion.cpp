@@ -1,4 +1,5 @@
 #include <matsimu/sim/heat_diffusion.hpp>
+#include <matsimu/sim/heat_stencil.hpp>
 #include <cmath>
 #include <algorithm>
 #include <limits>
@@ -23,6 +24,7 @@ std::optional<std::string> HeatDiffusionParams::validate() const {
     return "Maximum steps must be greater than 0.";
   if (n_cells < 2)
     return "Number of cells must be at least 2.";
+  if (scheme == HeatScheme::Implicit) return std::nullopt;
   Real limit = stability_limit();
   if (!std::isfinite(limit) || dt > limit)
     return "Time step dt exceeds stability limit (dt <= dx²/(2*alpha)).";
@@ -31,7 +33,8 @@ std::optional<std::string> HeatDiffusionParams::validate() const {
 
 HeatDiffusionModel::HeatDiffusionModel(const HeatDiffusionParams& params, std::size_t max_bytes)
     : params_(params), n_(params.n_cells), 
-      T_(HeatAllocator(max_bytes)), T_next_(T_.get_allocator()) {
+      T_(HeatAllocator(max_bytes)), T_next_(T_.get_allocator()),
+      scratch_(T_.get_allocator()) {
   auto err = params_.validate();
   if (err) {
     error_msg_ = *err;
@@ -40,6 +43,10 @@ HeatDiffusionModel::HeatDiffusionModel(const HeatDiffusionParams& params, std::s
   T_.resize(n_);
   T_next_.resize(n_);
   initialize();
+  if (params_.scheme == HeatScheme::Implicit) {
+    const Real r = params_.alpha * params_.dt / (params_.dx * params_.dx);
+    solver_ = TridiagonalSolver(n_ - 2, -0.5 * r, 1.0 + r, -0.5 * r);
+  }
   valid_ = true;
 }
 
@@ -58,12 +65,16 @@ bool HeatDiffusionModel::step() {
   if (!valid_ || finished()) return false;
 
   Real r = params_.alpha * params_.dt / (params_.dx * params_.dx);
-  // Explicit Euler: T_new[i] = T[i] + r*(T[i-1] - 2*T[i] + T[i+1])
-  for (std::size_t i = 1; i + 1 < n_; ++i) {
-    T_next_[i] = T_[i] + r * (T_[i - 1] - 2.0 * T_[i] + T_[i + 1]);
+  if (params_.scheme == HeatScheme::Implicit) {
+    heat_cn_step_1d(solver_, T_.data(), T_next_.data(), n_, r);
+  } else {
+    // Explicit Euler: T_new[i] = T[i] + r*(T[i-1] - 2*T[i] + T[i+1])
+    for (std::size_t i = 1; i + 1 < n_; ++i) {
+      T_next_[i] = T_[i] + r * (T_[i - 1] - 2.0 * T_[i] + T_[i + 1]);
+    }
+    T_next_[0] = T_[0];
+    T_next_[n_ - 1] = T_[n_ - 1];
   }
-  T_next_[0] = T_[0];
-  T_next_[n_ - 1] = T_[n_ - 1];
   std::swap(T_, T_next_);
 
   time_ += params_.dt;
@@ -77,6 +88,37 @@ bool HeatDiffusionModel::step() {
   return true;
 }
 
+std::size_t HeatDiffusionModel::take_steps(std::size_t max_steps) {
+  std::size_t n = 0;
+  while (n < max_steps && !finished()) {
+    time_ += params_.dt;
+    ++step_count_;
+    ++n;
+  }
+  return n;
+}
+
+std::size_t HeatDiffusionModel::advance(std::size_t k) {
+  if (!valid_) return 0;
+  if (params_.scheme == HeatScheme::Implicit) return ISimModel::advance(k);
+  const Real r = params_.alpha * params_.dt / (params_.dx * params_.dx);
+  std::size_t done = 0;
+  while (done < k) {
+    const std::size_t pass = take_steps(std::min(kHeatTimeBlock1D, k - done));
+    if (pass == 0) break;
+    scratch_.resize(heat_scratch_size_1d(pass));
+    heat_advance_1d(T_.data(), T_next_.data(), n_, r, pass, scratch_.data());
+    std::swap(T_, T_next_);
+    done += pass;
+    if (!std::isfinite(time_)) {
+      error_msg_ = "Time became non-finite.";
+      valid_ = false;
+      break;
+    }
+  }
+  return done;
+}
+
 bool HeatDiffusionModel::finished() const {
   if (!valid_) return true;
   if (step_count_ >= params_.max_steps) return true;
@@ -89,4 +131,14 @@ std::size_t HeatDiffusionModel::step_count() const { return step_count_; }
 const std::string& HeatDiffusionModel::error_message() const { return error_msg_; }
 bool HeatDiffusionModel::is_valid() const { return valid_; }
 
+std::vector<StateBuffer> HeatDiffusionModel::state_buffers() {
+  if (!valid_) return {};
+  return {{T_.data(), T_.size() * sizeof(Real)}};
+}
+
+void HeatDiffusionModel::restore_clock(Real time, std::size_t step_count) {
+  time_ = time;
+  step_count_ = step_count;
+}
+
 }  // namespace matsimu
@@ -1,4 +1,5 @@
 #include <matsimu/sim/heat_diffusion_2d.hpp>
+#include <matsimu/sim/heat_stencil.hpp>
 #include <cmath>
 #include <algorithm>
 #include <limits>
@@ -36,7 +37,17 @@ std::optional<std::string> HeatDiffusion2DParams::validate() const {
         return "Hot temperature must be finite and greater than boundary temperature.";
     if (ic == HeatIC2D::HotCenter && (!std::isfinite(hot_radius_frac) || hot_radius_frac <= 0.0))
         return "Hot radius fraction must be positive and finite.";
+    if (num_threads == 0)
+        return "Thread count must be at least 1.";
 
+    if (precision == Precision::Single && scheme == HeatScheme::Implicit)
+        return "Single precision requires the explicit scheme (ADI solves run in double).";
+    if (backend == ComputeBackend::Device &&
+        (scheme != HeatScheme::Explicit || precision != Precision::Double))
+        return "Device backend supports the explicit scheme in double precision only.";
+
+    if (scheme == HeatScheme::Implicit)
+        return std::nullopt;
     const Real limit = stability_limit();
     if (!std::isfinite(limit) || dt > limit)
         return "Time step dt exceeds 2D stability limit: dt <= dx^2 / (4*alpha). "
@@ -51,7 +62,15 @@ std::optional<std::string> HeatDiffusion2DParams::validate() const {
 
 HeatDiffusion2DModel::HeatDiffusion2DModel(const HeatDiffusion2DParams& params, std::size_t max_bytes)
     : params_(params), nx_(params.nx), ny_(params.ny),
-      T_(HeatAllocator(max_bytes)), T_next_(HeatAllocator(max_bytes)) {
+      pool_(params.num_threads > 1 && !params.validate()
+                ? std::make_shared<ThreadPool>(params.num_threads) : nullptr),
+      placement_(make_memory_placement(params.huge_pages, params.first_touch, pool_)),
+      T_(HeatAllocator(max_bytes, placement_allocator<Real>(placement_))),
+      T_next_(HeatAllocator(max_bytes, placement_allocator<Real>(placement_))),
+      scratch_(HeatAllocator(max_bytes, placement_allocator<Real>(placement_))),
+      Tf_(FloatAllocator(max_bytes, placement_allocator<float>(placement_))),
+      Tf_next_(FloatAllocator(max_bytes, placement_allocator<float>(placement_))),
+      scratch_f_(FloatAllocator(max_bytes, placement_allocator<float>(placement_))) {
 
     auto err = this->params_.validate();
     if (err) {
@@ -60,8 +79,18 @@ HeatDiffusion2DModel::HeatDiffusion2DModel(const HeatDiffusion2DParams& params,
     }
 
     this->T_.resize(this->nx_ * this->ny_);
-    this->T_next_.resize(this->nx_ * this->ny_);
+    if (this->params_.precision == Precision::Double)
+        this->T_next_.resize(this->nx_ * this->ny_);
     this->initialize();
+    if (this->params_.scheme == HeatScheme::Implicit) {
+        const Real r = this->params_.alpha * this->params_.dt / (this->params_.dx * this->params_.dx);
+        this->x_solver_ = TridiagonalSolver(this->nx_ - 2, -0.5 * r, 1.0 + r, -0.5 * r);
+        this->y_solver_ = TridiagonalSolver(this->ny_ - 2, -0.5 * r, 1.0 + r, -0.5 * r);
+    }
+    if (this->params_.backend == ComputeBackend::Device) {
+        this->device_T_.map(this->T_.data(), this->T_.size());
+        this->device_T_next_.map(this->T_next_.data(), this->T_next_.size());
+    }
     this->valid_ = true;
 }
 
@@ -76,7 +105,14 @@ void HeatDiffusion2DModel::initialize() {
     }
     // Enforce Dirichlet boundaries on initial state.
     this->apply_boundary_conditions(this->T_);
-    this->T_next_ = this->T_;
+    if (this->params_.precision == Precision::Single) {
+        this->Tf_.assign(this->T_.begin(), this->T_.end());
+        this->Tf_next_ = this->Tf_;
+        // Report the rounded state so temperature() is consistent from step 0.
+        std::copy(this->Tf_.begin(), this->Tf_.end(), this->T_.begin());
+    } else {
+        this->T_next_ = this->T_;
+    }
 }
 
 void HeatDiffusion2DModel::apply_initial_condition_hot_center() {
@@ -123,23 +159,29 @@ bool HeatDiffusion2DModel::step() {
     // Diffusion number r = α · dt / dx²
     const Real r = params_.alpha * params_.dt / (params_.dx * params_.dx);
 
-    // Explicit Euler with 5-point stencil:
-    //   T_new[i,j] = T[i,j] + r * (T[i-1,j] + T[i+1,j] + T[i,j-1] + T[i,j+1] - 4·T[i,j])
-    for (std::size_t j = 1; j + 1 < ny_; ++j) {
-        for (std::size_t i = 1; i + 1 < nx_; ++i) {
-            const std::size_t idx = j * nx_ + i;
-            this->T_next_[idx] = this->T_[idx] + r * (
-                this->T_[idx - 1] + this->T_[idx + 1] +       // x neighbors
-                this->T_[idx - nx_] + this->T_[idx + nx_] -    // y neighbors
-                4.0 * this->T_[idx]
-            );
-        }
+    if (params_.backend == ComputeBackend::Device) {
+        heat_step_2d_device(T_.data(), T_next_.data(), nx_, ny_, r, params_.T_boundary);
+        std::swap(T_, T_next_);
+        device_T_.swap(device_T_next_);
+        mirror_stale_ = true;
+    } else if (params_.scheme == HeatScheme::Implicit) {
+        // ADI: T_next_ holds the half-step field, result lands in T_.
+        heat_adi_step_2d(x_solver_, y_solver_, T_.data(), T_next_.data(), nx_, ny_, r,
+                         params_.T_boundary, pool_.get());
+    } else if (params_.precision == Precision::Single) {
+        heat_step_2d(Tf_.data(), Tf_next_.data(), nx_, ny_, r, params_.T_boundary,
+                     pool_.get(), simd_level_);
+        std::swap(Tf_, Tf_next_);
+        mirror_stale_ = true;
+    } else {
+        // Explicit Euler with 5-point stencil:
+        //   T_new[i,j] = T[i,j] + r * (T[i-1,j] + T[i+1,j] + T[i,j-1] + T[i,j+1] - 4·T[i,j])
+        // Dirichlet boundaries are written by the same sweep.
+        heat_step_2d(T_.data(), T_next_.data(), nx_, ny_, r, params_.T_boundary,
+                     pool_.get(), simd_level_);
+        std::swap(T_, T_next_);
     }
 
-    // Fix Dirichlet boundaries.
-    apply_boundary_conditions(T_next_);
-
-    std::swap(T_, T_next_);
     time_ += params_.dt;
     ++step_count_;
 
@@ -152,6 +194,67 @@ bool HeatDiffusion2DModel::step() {
     return true;
 }
 
+std::size_t HeatDiffusion2DModel::take_steps(std::size_t max_steps) {
+    std::size_t n = 0;
+    while (n < max_steps && !finished()) {
+        time_ += params_.dt;
+        ++step_count_;
+        ++n;
+    }
+    return n;
+}
+
+std::size_t HeatDiffusion2DModel::advance(std::size_t k) {
+    if (!valid_) return 0;
+    if (params_.scheme == HeatScheme::Implicit || params_.backend == ComputeBackend::Device)
+        return ISimModel::advance(k);
+    const Real r = params_.alpha * params_.dt / (params_.dx * params_.dx);
+    const bool single = params_.precision == Precision::Single;
+    const std::size_t depth = heat_time_block_2d(nx_, ny_, single ? sizeof(float) : sizeof(Real));
+    const std::size_t threads = pool_ ? pool_->size() : 1;
+    // One pass over either field type; the result lands in cur.
+    auto run_pass = [&](auto& cur, auto& next, auto& scratch, std::size_t pass) {
+        if (pass == 1) {
+            heat_step_2d(cur.data(), next.data(), nx_, ny_, r, params_.T_boundary,
+                         pool_.get(), simd_level_);
+        } else {
+            scratch.resize(heat_scratch_size_2d(nx_, pass, threads));
+            heat_advance_2d(cur.data(), next.data(), nx_, ny_, r, params_.T_boundary,
+                            pass, scratch.data(), pool_.get(), simd_level_);
+        }
+        std::swap(cur, next);
+    };
+    std::size_t done = 0;
+    while (done < k) {
+        const std::size_t pass = take_steps(std::min(depth, k - done));
+        if (pass == 0) break;
+        if (single) {
+            run_pass(Tf_, Tf_next_, scratch_f_, pass);
+            mirror_stale_ = true;
+        } else {
+            run_pass(T_, T_next_, scratch_, pass);
+        }
+        done += pass;
+        if (!std::isfinite(time_)) {
+            error_msg_ = "Time became non-finite.";
+            valid_ = false;
+            break;
+        }
+    }
+    return done;
+}
+
+const std::vector<Real, HeatDiffusion2DModel::HeatAllocator>& HeatDiffusion2DModel::temperature() const {
+    if (mirror_stale_) {
+        if (params_.backend == ComputeBackend::Device)
+            device_T_.download();
+        else
+            std::copy(Tf_.begin(), Tf_.end(), T_.begin());
+        mirror_stale_ = false;
+    }
+    return T_;
+}
+
 bool HeatDiffusion2DModel::finished() const {
     if (!valid_) return true;
     if (step_count_ >= params_.max_steps) return true;
@@ -164,4 +267,19 @@ std::size_t HeatDiffusion2DModel::step_count() const { return step_count_; }
 const std::string& HeatDiffusion2DModel::error_message() const { return error_msg_; }
 bool HeatDiffusion2DModel::is_valid() const { return valid_; }
 
+std::vector<StateBuffer> HeatDiffusion2DModel::state_buffers() {
+    if (!valid_) return {};
+    if (params_.precision == Precision::Single)
+        return {{Tf_.data(), Tf_.size() * sizeof(float)}};
+    temperature();  // Device: current field on the host
+    return {{T_.data(), T_.size() * sizeof(Real)}};
+}
+
+void HeatDiffusion2DModel::restore_clock(Real time, std::size_t step_count) {
+    time_ = time;
+    step_count_ = step_count;
+    mirror_stale_ = params_.precision == Precision::Single;
+    if (params_.backend == ComputeBackend::Device) device_T_.upload();
+}
+
 }  // namespace matsimu
@@ -0,0 +1,162 @@
+#include <matsimu/sim/heat_diffusion_3d.hpp>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace matsimu {
+
+// ---------------------------------------------------------------------------
+// HeatDiffusion3DParams
+// ---------------------------------------------------------------------------
+
+Real HeatDiffusion3DParams::stability_limit() const {
+    if (alpha <= 0.0 || dx <= 0.0) return 0.0;
+    // 3D explicit Euler with 7-point stencil: dt ≤ dx² / (6·α)
+    return (dx * dx) / (6.0 * alpha);
+}
+
+std::optional<std::string> HeatDiffusion3DParams::validate() const {
+    if (!std::isfinite(alpha) || alpha <= 0.0)
+        return "Thermal diffusivity alpha must be positive and finite.";
+    if (!std::isfinite(dx) || dx <= 0.0)
+        return "Grid spacing dx must be positive and finite.";
+    if (!std::isfinite(dt) || dt <= 0.0)
+        return "Time step dt must be positive and finite.";
+    if (!std::isfinite(end_time) || end_time < 0.0)
+        return "End time must be non-negative and finite.";
+    if (max_steps == 0)
+        return "Maximum steps must be greater than 0.";
+    if (nx < 3 || ny < 3 || nz < 3)
+        return "Grid dimensions nx, ny, nz must be at least 3 (need interior cells).";
+    if (!std::isfinite(T_boundary) || T_boundary < 0.0)
+        return "Boundary temperature must be non-negative and finite.";
+    if (!std::isfinite(T_hot) || T_hot <= T_boundary)
+        return "Hot temperature must be finite and greater than boundary temperature.";
+    if (ic == HeatIC3D::HotCenter && (!std::isfinite(hot_radius_frac) || hot_radius_frac <= 0.0))
+        return "Hot radius fraction must be positive and finite.";
+    if (num_threads == 0)
+        return "Thread count must be at least 1.";
+
+    const Real limit = stability_limit();
+    if (!std::isfinite(limit) || dt > limit)
+        return "Time step dt exceeds 3D stability limit: dt <= dx^2 / (6*alpha). "
+               "Reduce dt or increase dx.";
+
+    return std::nullopt;
+}
+
+// ---------------------------------------------------------------------------
+// HeatDiffusion3DModel
+// ---------------------------------------------------------------------------
+
+HeatDiffusion3DModel::HeatDiffusion3DModel(const HeatDiffusion3DParams& params, std::size_t max_bytes)
+    : params_(params),
+      pool_(params.num_threads > 1 && !params.validate()
+                ? std::make_shared<ThreadPool>(params.num_threads) : nullptr),
+      T_(HeatAllocator(max_bytes, placement_allocator<Real>(
+             make_memory_placement(params.huge_pages, params.first_touch, pool_)))),
+      T_next_(T_.get_allocator()) {
+
+    auto err = params_.validate();
+    if (err) {
+        error_msg_ = *err;
+        return;
+    }
+
+    grid_ = make_heat_grid_3d(params_.nx, params_.ny, params_.nz);
+    const std::size_t cells = grid_.size();
+    // Padded row and plane sizes can wrap before the cell count does.
+    if (grid_.pitch < grid_.nx || grid_.plane / grid_.pitch != grid_.ny ||
+        cells / grid_.plane != grid_.nz ||
+        cells > max_bytes / (2 * sizeof(Real))) {
+        error_msg_ = "3D grid does not fit the memory budget (two fields of nx*ny*nz cells).";
+        return;
+    }
+
+    T_.resize(cells);
+    T_next_.resize(cells);
+    initialize();
+    if (params_.backend == ComputeBackend::Device) {
+        device_T_.map(T_.data(), cells);
+        device_T_next_.map(T_next_.data(), cells);
+    }
+    valid_ = true;
+}
+
+void HeatDiffusion3DModel::initialize() {
+    const Real Tb = params_.T_boundary;
+    std::fill(T_.begin(), T_.end(), Tb);
+    const Real sigma = params_.hot_radius_frac;
+    const Real inv_2sigma2 = 1.0 / (2.0 * sigma * sigma);
+    const Real T_delta = params_.T_hot - Tb;
+
+    // Interior only; faces stay at T_boundary.
+    for (std::size_t k = 1; k + 1 < grid_.nz; ++k) {
+        const Real fz = (static_cast<Real>(k) + 0.5) / static_cast<Real>(grid_.nz) - 0.5;
+        for (std::size_t j = 1; j + 1 < grid_.ny; ++j) {
+            const Real fy = (static_cast<Real>(j) + 0.5) / static_cast<Real>(grid_.ny) - 0.5;
+            for (std::size_t i = 1; i + 1 < grid_.nx; ++i) {
+                Real& t = T_[grid_.index(i, j, k)];
+                if (params_.ic == HeatIC3D::UniformHot) {
+                    t = params_.T_hot;
+                } else {
+                    const Real fx = (static_cast<Real>(i) + 0.5) / static_cast<Real>(grid_.nx) - 0.5;
+                    t = Tb + T_delta * std::exp(-(fx * fx + fy * fy + fz * fz) * inv_2sigma2);
+                }
+            }
+        }
+    }
+    T_next_ = T_;
+}
+
+bool HeatDiffusion3DModel::step() {
+    if (!valid_ || finished()) return false;
+
+    // Diffusion number r = α · dt / dx²
+    const Real r = params_.alpha * params_.dt / (params_.dx * params_.dx);
+    if (params_.backend == ComputeBackend::Device) {
+        heat_step_3d_device(T_.data(), T_next_.data(), grid_, r, params_.T_boundary);
+        device_T_.swap(device_T_next_);
+        device_stale_ = true;
+    } else {
+        heat_step_3d(T_.data(), T_next_.data(), grid_, r, params_.T_boundary,
+                     pool_.get(), simd_level_);
+    }
+    std::swap(T_, T_next_);
+    time_ += params_.dt;
+    ++step_count_;
+
+    if (!std::isfinite(time_)) {
+        error_msg_ = "Time became non-finite.";
+        valid_ = false;
+        return false;
+    }
+    return true;
+}
+
+bool HeatDiffusion3DModel::finished() const {
+    if (!valid_) return true;
+    if (step_count_ >= params_.max_steps) return true;
+    if (params_.end_time > 0.0 && time_ >= params_.end_time) return true;
+    return false;
+}
+
+Real HeatDiffusion3DModel::time() const { return time_; }
+std::size_t HeatDiffusion3DModel::step_count() const { return step_count_; }
+const std::string& HeatDiffusion3DModel::error_message() const { return error_msg_; }
+bool HeatDiffusion3DModel::is_valid() const { return valid_; }
+
+std::vector<StateBuffer> HeatDiffusion3DModel::state_buffers() {
+    if (!valid_) return {};
+    sync_host();
+    return {{T_.data(), T_.size() * sizeof(Real)}};
+}
+
+void HeatDiffusion3DModel::restore_clock(Real time, std::size_t step_count) {
+    time_ = time;
+    step_count_ = step_count;
+    device_stale_ = false;
+    if (params_.backend == ComputeBackend::Device) device_T_.upload();
+}
+
+}  // namespace matsimu
@@ -0,0 +1,380 @@
+#include <matsimu/sim/heat_stencil.hpp>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATSIMU_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace matsimu {
+
+namespace {
+
+/// Interior cells [begin, end) of one row; c = row j, s/n = rows j-1/j+1.
+template <typename T>
+void row_5pt_scalar(const T* c, const T* s, const T* n, T* out,
+                    std::size_t begin, std::size_t end, T r) {
+    for (std::size_t i = begin; i < end; ++i)
+        out[i] = c[i] + r * (c[i - 1] + c[i + 1] + s[i] + n[i] - T(4) * c[i]);
+}
+
+#ifdef MATSIMU_X86_SIMD
+
+// No FMA: mul/add in the scalar order keeps the result bit-identical.
+__attribute__((target("avx2")))
+void row_5pt_avx2(const Real* c, const Real* s, const Real* n, Real* out,
+                  std::size_t begin, std::size_t end, Real r) {
+    const __m256d rv = _mm256_set1_pd(r);
+    const __m256d four = _mm256_set1_pd(4.0);
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m256d ci = _mm256_loadu_pd(c + i);
+        __m256d sum = _mm256_add_pd(_mm256_loadu_pd(c + i - 1), _mm256_loadu_pd(c + i + 1));
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(s + i));
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(n + i));
+        sum = _mm256_sub_pd(sum, _mm256_mul_pd(four, ci));
+        _mm256_storeu_pd(out + i, _mm256_add_pd(ci, _mm256_mul_pd(rv, sum)));
+    }
+    // Tail stays in this function: a call into non-VEX code with dirty
+    // upper lanes would pay the AVX/SSE transition on every row.
+    for (; i < end; ++i)
+        out[i] = c[i] + r * (c[i - 1] + c[i + 1] + s[i] + n[i] - 4.0 * c[i]);
+}
+
+__attribute__((target("avx2")))
+void row_5pt_avx2(const float* c, const float* s, const float* n, float* out,
+                  std::size_t begin, std::size_t end, float r) {
+    const __m256 rv = _mm256_set1_ps(r);
+    const __m256 four = _mm256_set1_ps(4.0f);
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m256 ci = _mm256_loadu_ps(c + i);
+        __m256 sum = _mm256_add_ps(_mm256_loadu_ps(c + i - 1), _mm256_loadu_ps(c + i + 1));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(s + i));
+        sum = _mm256_add_ps(sum, _mm256_loadu_ps(n + i));
+        sum = _mm256_sub_ps(sum, _mm256_mul_ps(four, ci));
+        _mm256_storeu_ps(out + i, _mm256_add_ps(ci, _mm256_mul_ps(rv, sum)));
+    }
+    for (; i < end; ++i)
+        out[i] = c[i] + r * (c[i - 1] + c[i + 1] + s[i] + n[i] - 4.0f * c[i]);
+}
+
+#endif
+
+/// 7-point row: s/n = rows j∓1, d/u = planes k∓1.
+void row_7pt_scalar(const Real* c, const Real* s, const Real* n, const Real* d,
+                    const Real* u, Real* out, std::size_t begin, std::size_t end, Real r) {
+    for (std::size_t i = begin; i < end; ++i)
+        out[i] = c[i] + r * (c[i - 1] + c[i + 1] + s[i] + n[i] + d[i] + u[i] - 6.0 * c[i]);
+}
+
+#ifdef MATSIMU_X86_SIMD
+
+__attribute__((target("avx2")))
+void row_7pt_avx2(const Real* c, const Real* s, const Real* n, const Real* d,
+                  const Real* u, Real* out, std::size_t begin, std::size_t end, Real r) {
+    const __m256d rv = _mm256_set1_pd(r);
+    const __m256d six = _mm256_set1_pd(6.0);
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m256d ci = _mm256_loadu_pd(c + i);
+        __m256d sum = _mm256_add_pd(_mm256_loadu_pd(c + i - 1), _mm256_loadu_pd(c + i + 1));
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(s + i));
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(n + i));
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(d + i));
+        sum = _mm256_add_pd(sum, _mm256_loadu_pd(u + i));
+        sum = _mm256_sub_pd(sum, _mm256_mul_pd(six, ci));
+        _mm256_storeu_pd(out + i, _mm256_add_pd(ci, _mm256_mul_pd(rv, sum)));
+    }
+    for (; i < end; ++i)
+        out[i] = c[i] + r * (c[i - 1] + c[i + 1] + s[i] + n[i] + d[i] + u[i] - 6.0 * c[i]);
+}
+
+#endif
+
+template <typename T>
+using RowKernel = void (*)(const T*, const T*, const T*, T*, std::size_t, std::size_t, T);
+using RowKernel3D = void (*)(const Real*, const Real*, const Real*, const Real*,
+                             const Real*, Real*, std::size_t, std::size_t, Real);
+
+RowKernel3D select_row_kernel_3d(SimdLevel level) {
+#ifdef MATSIMU_X86_SIMD
+    if (level != SimdLevel::Scalar) return row_7pt_avx2;
+#else
+    (void)level;
+#endif
+    return row_7pt_scalar;
+}
+
+/// Planes [k_begin, k_end) of the 3D grid, boundary faces included.
+void sweep_band_3d(RowKernel3D kernel, const Real* src, Real* dst, const HeatGrid3D& g,
+                   Real r, Real Tb, std::size_t k_begin, std::size_t k_end) {
+    const std::size_t pitch = g.pitch, plane = g.plane;
+    auto fill_plane = [&](std::size_t k) {
+        for (std::size_t j = 0; j < g.ny; ++j) {
+            Real* row = dst + k * plane + j * pitch;
+            std::fill(row, row + g.nx, Tb);
+        }
+    };
+    if (k_begin >= k_end) return;
+    if (k_begin == 0) fill_plane(k_begin++);
+    const bool owns_last = (k_end == g.nz);
+    if (owns_last) --k_end;
+
+    for (std::size_t j0 = 1; j0 + 1 < g.ny; j0 += kHeatTileRows3D) {
+        const std::size_t j1 = std::min(j0 + kHeatTileRows3D, g.ny - 1);
+        for (std::size_t i0 = 1; i0 + 1 < g.nx; i0 += kHeatTileCols) {
+            const std::size_t i1 = std::min(i0 + kHeatTileCols, g.nx - 1);
+            for (std::size_t k = k_begin; k < k_end; ++k) {
+                for (std::size_t j = j0; j < j1; ++j) {
+                    const Real* c = src + k * plane + j * pitch;
+                    Real* out = dst + k * plane + j * pitch;
+                    kernel(c, c - pitch, c + pitch, c - plane, c + plane, out, i0, i1, r);
+                    if (i0 == 1) out[0] = Tb;
+                    if (i1 == g.nx - 1) out[g.nx - 1] = Tb;
+                }
+            }
+        }
+    }
+    // Rows j = 0 and ny-1 of the interior planes.
+    for (std::size_t k = k_begin; k < k_end; ++k) {
+        Real* first = dst + k * plane;
+        Real* last = first + (g.ny - 1) * pitch;
+        std::fill(first, first + g.nx, Tb);
+        std::fill(last, last + g.nx, Tb);
+    }
+    if (owns_last) fill_plane(g.nz - 1);
+}
+
+template <typename T>
+RowKernel<T> select_row_kernel(SimdLevel level) {
+#ifdef MATSIMU_X86_SIMD
+    // AVX-512 gains nothing on a bandwidth-bound sweep and would enable FMA
+    // contraction; both vector levels share the AVX2 row.
+    if (level != SimdLevel::Scalar) return static_cast<RowKernel<T>>(row_5pt_avx2);
+#else
+    (void)level;
+#endif
+    return row_5pt_scalar<T>;
+}
+
+/// Rows [j_begin, j_end) of the 2D grid, edges included when the band owns them.
+template <typename T>
+void sweep_band_2d(RowKernel<T> kernel, const T* src, T* dst, std::size_t nx,
+                   std::size_t ny, T r, T Tb, std::size_t j_begin, std::size_t j_end) {
+    if (j_begin >= j_end) return;
+    if (j_begin == 0) {
+        std::fill(dst, dst + nx, Tb);
+        ++j_begin;
+    }
+    const bool owns_last = (j_end == ny);
+    if (owns_last) --j_end;
+
+    for (std::size_t i0 = 1; i0 + 1 < nx; i0 += kHeatTileCols) {
+        const std::size_t i1 = std::min(i0 + kHeatTileCols, nx - 1);
+        for (std::size_t j = j_begin; j < j_end; ++j) {
+            const T* c = src + j * nx;
+            T* out = dst + j * nx;
+            kernel(c, c - nx, c + nx, out, i0, i1, r);
+            if (i0 == 1) out[0] = Tb;
+            if (i1 == nx - 1) out[nx - 1] = Tb;
+        }
+    }
+
+    if (owns_last) std::fill(dst + (ny - 1) * nx, dst + ny * nx, Tb);
+}
+
+/// Rows [j_begin, j_end) of a rectangle, interior update only.
+void sweep_rect_2d(RowKernel<Real> kernel, const Real* src, Real* dst, std::size_t pitch,
+                   std::size_t i_begin, std::size_t i_end, std::size_t j_begin,
+                   std::size_t j_end, Real r) {
+    for (std::size_t i0 = i_begin; i0 < i_end; i0 += kHeatTileCols) {
+        const std::size_t i1 = std::min(i0 + kHeatTileCols, i_end);
+        for (std::size_t j = j_begin; j < j_end; ++j) {
+            const Real* c = src + j * pitch;
+            kernel(c, c - pitch, c + pitch, dst + j * pitch, i0, i1, r);
+        }
+    }
+}
+
+/// Output rows [j_begin, j_end) after k steps; scratch holds (k-1) 3-row rings.
+template <typename T>
+void wavefront_band_2d(RowKernel<T> kernel, const T* src, T* dst, std::size_t nx,
+                       std::size_t ny, T r, T Tb, std::size_t k, T* scratch,
+                       std::size_t j_begin, std::size_t j_end) {
+    if (j_begin >= j_end) return;
+    // Level l (1..k) is needed on rows [lo(l), hi(l)).
+    auto lo = [&](std::size_t l) { return j_begin > k - l ? j_begin - (k - l) : 0; };
+    auto hi = [&](std::size_t l) { return std::min(ny, j_end + (k - l)); };
+    auto level_row = [&](std::size_t l, std::size_t j) -> T* {
+        if (l == k) return dst + j * nx;
+        return scratch + ((l - 1) * 3 + j % 3) * nx;
+    };
+    auto input_row = [&](std::size_t l, std::size_t j) -> const T* {
+        return l == 0 ? src + j * nx : level_row(l, j);
+    };
+
+    // At wavefront position t, level l computes row t - (l - 1); its
+    // neighbor rows at level l-1 were produced at positions t-2 .. t.
+    const std::size_t t_end = hi(1) + k - 1;
+    for (std::size_t t = lo(1); t < t_end; ++t) {
+        for (std::size_t l = 1; l <= k && l - 1 <= t; ++l) {
+            const std::size_t j = t - (l - 1);
+            if (j < lo(l) || j >= hi(l)) continue;
+            T* out = level_row(l, j);
+            if (j == 0 || j == ny - 1) {
+                std::fill(out, out + nx, Tb);
+                continue;
+            }
+            kernel(input_row(l - 1, j), input_row(l - 1, j - 1), input_row(l - 1, j + 1),
+                   out, 1, nx - 1, r);
+            out[0] = Tb;
+            out[nx - 1] = Tb;
+        }
+    }
+}
+
+template <typename T>
+void heat_step_2d_impl(const T* src, T* dst, std::size_t nx, std::size_t ny,
+                       T r, T Tb, ThreadPool* pool, SimdLevel level) {
+    const RowKernel<T> kernel = select_row_kernel<T>(level);
+    if (!pool || pool->size() < 2) {
+        sweep_band_2d(kernel, src, dst, nx, ny, r, Tb, 0, ny);
+        return;
+    }
+    const std::size_t parts = pool->size();
+    pool->run([&](std::size_t tid) {
+        sweep_band_2d(kernel, src, dst, nx, ny, r, Tb, ny * tid / parts, ny * (tid + 1) / parts);
+    });
+}
+
+template <typename T>
+void heat_advance_2d_impl(const T* src, T* dst, std::size_t nx, std::size_t ny, T r, T Tb,
+                          std::size_t k, T* scratch, ThreadPool* pool, SimdLevel level) {
+    const RowKernel<T> kernel = select_row_kernel<T>(level);
+    if (!pool || pool->size() < 2) {
+        wavefront_band_2d(kernel, src, dst, nx, ny, r, Tb, k, scratch, 0, ny);
+        return;
+    }
+    const std::size_t parts = pool->size();
+    const std::size_t per_thread = heat_scratch_size_2d(nx, k, 1);
+    pool->run([&](std::size_t tid) {
+        wavefront_band_2d(kernel, src, dst, nx, ny, r, Tb, k, scratch + tid * per_thread,
+                          ny * tid / parts, ny * (tid + 1) / parts);
+    });
+}
+
+}  // namespace
+
+void heat_step_2d(const Real* src, Real* dst, std::size_t nx, std::size_t ny,
+                  Real r, Real T_boundary, ThreadPool* pool, SimdLevel level) {
+    heat_step_2d_impl(src, dst, nx, ny, r, T_boundary, pool, level);
+}
+
+void heat_step_2d(const float* src, float* dst, std::size_t nx, std::size_t ny,
+                  Real r, Real T_boundary, ThreadPool* pool, SimdLevel level) {
+    heat_step_2d_impl(src, dst, nx, ny, static_cast<float>(r),
+                      static_cast<float>(T_boundary), pool, level);
+}
+
+void heat_update_rect_2d(const Real* src, Real* dst, std::size_t pitch,
+                         std::size_t i_begin, std::size_t i_end,
+                         std::size_t j_begin, std::size_t j_end,
+                         Real r, ThreadPool* pool, SimdLevel level) {
+    if (i_begin >= i_end || j_begin >= j_end) return;
+    const RowKernel<Real> kernel = select_row_kernel<Real>(level);
+    if (!pool || pool->size() < 2) {
+        sweep_rect_2d(kernel, src, dst, pitch, i_begin, i_end, j_begin, j_end, r);
+        return;
+    }
+    const std::size_t parts = pool->size();
+    const std::size_t rows = j_end - j_begin;
+    pool->run([&](std::size_t tid) {
+        sweep_rect_2d(kernel, src, dst, pitch, i_begin, i_end, j_begin + rows * tid / parts,
+                      j_begin + rows * (tid + 1) / parts, r);
+    });
+}
+
+std::size_t heat_time_block_2d(std::size_t nx, std::size_t ny, std::size_t cell_bytes) {
+    constexpr std::size_t kBudgetBytes = 1u << 20;
+    constexpr std::size_t kMaxDepth = 16;
+    if (2 * nx * ny * cell_bytes <= kBudgetBytes) return 1;
+    const std::size_t rows = kBudgetBytes / (nx * cell_bytes);
+    return std::clamp<std::size_t>(rows / 3, 1, kMaxDepth);
+}
+
+std::size_t heat_scratch_size_2d(std::size_t nx, std::size_t k, std::size_t threads) {
+    return k > 1 ? threads * (k - 1) * 3 * nx : 0;
+}
+
+void heat_advance_2d(const Real* src, Real* dst, std::size_t nx, std::size_t ny,
+                     Real r, Real T_boundary, std::size_t k, Real* scratch,
+                     ThreadPool* pool, SimdLevel level) {
+    heat_advance_2d_impl(src, dst, nx, ny, r, T_boundary, k, scratch, pool, level);
+}
+
+void heat_advance_2d(const float* src, float* dst, std::size_t nx, std::size_t ny,
+                     Real r, Real T_boundary, std::size_t k, float* scratch,
+                     ThreadPool* pool, SimdLevel level) {
+    heat_advance_2d_impl(src, dst, nx, ny, static_cast<float>(r),
+                         static_cast<float>(T_boundary), k, scratch, pool, level);
+}
+
+std::size_t heat_scratch_size_1d(std::size_t k) {
+    return 2 * (kHeatTileCols + 2 * k);
+}
+
+void heat_advance_1d(const Real* src, Real* dst, std::size_t n, Real r,
+                     std::size_t k, Real* scratch) {
+    for (std::size_t ib = 0; ib < n; ib += kHeatTileCols) {
+        const std::size_t ie = std::min(ib + kHeatTileCols, n);
+        const std::size_t wlo = ib > k ? ib - k : 0;
+        const std::size_t whi = std::min(n, ie + k);
+        Real* a = scratch;  // a[i - wlo] holds cell i of the window
+        Real* b = scratch + (kHeatTileCols + 2 * k);
+        std::copy(src + wlo, src + whi, a);
+        // The valid range shrinks by one cell per step at interior window edges.
+        std::size_t lo = wlo, hi = whi;
+        for (std::size_t s = 0; s < k; ++s) {
+            if (lo > 0) ++lo;
+            if (hi < n) --hi;
+            for (std::size_t i = lo; i < hi; ++i) {
+                const std::size_t w = i - wlo;
+                b[w] = (i == 0 || i == n - 1)
+                    ? a[w]
+                    : a[w] + r * (a[w - 1] - 2.0 * a[w] + a[w + 1]);
+            }
+            std::swap(a, b);
+        }
+        std::copy(a + (ib - wlo), a + (ie - wlo), dst + ib);
+    }
+}
+
+HeatGrid3D make_heat_grid_3d(std::size_t nx, std::size_t ny, std::size_t nz) {
+    constexpr std::size_t kLine = 64 / sizeof(Real);
+    constexpr std::size_t kPage = 4096 / sizeof(Real);
+    HeatGrid3D g;
+    g.nx = nx;
+    g.ny = ny;
+    g.nz = nz;
+    g.pitch = (nx + kLine - 1) / kLine * kLine;
+    g.plane = ny * g.pitch;
+    if (g.plane % kPage == 0) g.plane += kLine;
+    return g;
+}
+
+void heat_step_3d(const Real* src, Real* dst, const HeatGrid3D& grid, Real r,
+                  Real T_boundary, ThreadPool* pool, SimdLevel level) {
+    const RowKernel3D kernel = select_row_kernel_3d(level);
+    if (!pool || pool->size() < 2) {
+        sweep_band_3d(kernel, src, dst, grid, r, T_boundary, 0, grid.nz);
+        return;
+    }
+    const std::size_t parts = pool->size();
+    pool->run([&](std::size_t tid) {
+        sweep_band_3d(kernel, src, dst, grid, r, T_boundary,
+                      grid.nz * tid / parts, grid.nz * (tid + 1) / parts);
+    });
+}
+
+}  // namespace matsimu
@@ -0,0 +1,41 @@
+#include <matsimu/sim/heat_stencil.hpp>
+#include <matsimu/parallel/device.hpp>
+
+namespace matsimu {
+
+void heat_step_2d_device(const Real* src, Real* dst, std::size_t nx, std::size_t ny,
+                         Real r, Real T_boundary) {
+    const std::size_t n = nx * ny;
+    MATSIMU_OFFLOAD(target teams distribute parallel for collapse(2) map(alloc: src[0:n], dst[0:n]))
+    for (std::size_t j = 0; j < ny; ++j) {
+        for (std::size_t i = 0; i < nx; ++i) {
+            const std::size_t c = j * nx + i;
+            dst[c] = i == 0 || j == 0 || i + 1 == nx || j + 1 == ny
+                ? T_boundary
+                : src[c] + r * (src[c - 1] + src[c + 1] + src[c - nx] + src[c + nx] - 4.0 * src[c]);
+        }
+    }
+    (void)n;
+}
+
+void heat_step_3d_device(const Real* src, Real* dst, const HeatGrid3D& grid, Real r,
+                         Real T_boundary) {
+    const std::size_t n = grid.size();
+    const std::size_t nx = grid.nx, ny = grid.ny, nz = grid.nz;
+    const std::size_t pitch = grid.pitch, plane = grid.plane;
+    MATSIMU_OFFLOAD(target teams distribute parallel for collapse(3) map(alloc: src[0:n], dst[0:n]))
+    for (std::size_t k = 0; k < nz; ++k) {
+        for (std::size_t j = 0; j < ny; ++j) {
+            for (std::size_t i = 0; i < nx; ++i) {
+                const std::size_t c = k * plane + j * pitch + i;
+                dst[c] = i == 0 || j == 0 || k == 0 || i + 1 == nx || j + 1 == ny || k + 1 == nz
+                    ? T_boundary
+                    : src[c] + r * (src[c - 1] + src[c + 1] + src[c - pitch] + src[c + pitch] +
+                                    src[c - plane] + src[c + plane] - 6.0 * src[c]);
+            }
+        }
+    }
+    (void)n;
+}
+
+}  // namespace matsimu
@@ -1,4 +1,5 @@
 #include <matsimu/sim/simulation.hpp>
+#include <matsimu/sim/device_simulation.hpp>
 #include <cmath>
 #include <algorithm>
 
@@ -6,10 +7,17 @@ namespace matsimu {
 
 namespace {
 bool has_non_finite_particle_state(const ParticleSystem& system) {
-    for (const auto& p : system.particles()) {
-        if (!std::isfinite(p.mass) || p.mass <= 0.0) return true;
-        for (int d = 0; d < 3; ++d) {
-            if (!std::isfinite(p.pos[d]) || !std::isfinite(p.vel[d]) || !std::isfinite(p.force[d])) {
+    const std::size_t n = system.size();
+    const Real* m = system.masses();
+    for (std::size_t i = 0; i < n; ++i) {
+        if (!std::isfinite(m[i]) || m[i] <= 0.0) return true;
+    }
+    for (int d = 0; d < 3; ++d) {
+        const Real* x = system.pos(d);
+        const Real* v = system.vel(d);
+        const Real* f = system.force(d);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!std::isfinite(x[i]) || !std::isfinite(v[i]) || !std::isfinite(f[i])) {
                 return true;
             }
         }
@@ -37,6 +45,34 @@ std::optional<std::string> SimulationParams::validate() const {
     if (!std::isfinite(neighbor_skin) || neighbor_skin < 0.0) {
         return "Neighbor skin must be non-negative and finite.";
     }
+    if (!std::isfinite(neighbor_skin_min) || !std::isfinite(neighbor_skin_max)
+        || neighbor_skin_min < 0.0 || neighbor_skin_max < 0.0
+        || (neighbor_skin_max > 0.0 && neighbor_skin_min > neighbor_skin_max)) {
+        return "Neighbor skin bounds must be non-negative, finite and ordered.";
+    }
+    if (health_check == HealthCheck::Interval && health_check_interval == 0) {
+        return "Health check interval must be at least 1.";
+    }
+    if (num_threads == 0) {
+        return "Thread count must be at least 1.";
+    }
+    if (respa_steps == 0) {
+        return "RESPA inner step count must be at least 1.";
+    }
+    if (!std::isfinite(respa_split) || !std::isfinite(respa_switch)
+        || respa_split < 0.0 || respa_switch < 0.0 || respa_split > cutoff
+        || resolved_respa_switch() > resolved_respa_split()) {
+        return "RESPA split must lie within the cutoff and exceed its switching width.";
+    }
+    if (respa_steps > 1 && !use_neighbor_list) {
+        return "RESPA (respa_steps > 1) requires the neighbor list.";
+    }
+    if (max_bytes == 0) {
+        return "Particle memory budget 'max_bytes' must be positive.";
+    }
+    if (backend == ComputeBackend::Device && (respa_steps > 1 || neighbor_skin_auto || sort_interval > 0)) {
+        return "Device backend supports neither r-RESPA, skin auto-tuning nor Morton sorting.";
+    }
     if (end_time > 0.0 && dt > end_time) {
         return "Time step cannot be greater than end time.";
     }
@@ -45,20 +81,37 @@ std::optional<std::string> SimulationParams::validate() const {
 
 Simulation::Simulation(const SimulationParams& params,
                        std::shared_ptr<Potential> potential)
-    : mode_(SimMode::MD), params_(params), time_(0), step_count_(0), valid_(false), last_epot_(0.0) {
+    : mode_(SimMode::MD), params_(params), time_(0), step_count_(0), valid_(false),
+      thread_pool_(params.num_threads > 1 && params.backend == ComputeBackend::Host && !params.validate()
+                       ? std::make_shared<ThreadPool>(params.num_threads) : nullptr),
+      system_(0, params.max_bytes,
+              make_memory_placement(params.huge_pages, params.first_touch, thread_pool_)),
+      last_epot_(0.0) {
 
     auto validation_error = params_.validate();
     if (validation_error) {
         error_msg_ = *validation_error;
         return;
     }
+    if (params_.backend == ComputeBackend::Device) {
+        device_ = std::make_unique<DeviceSimulation>(params_, std::move(potential));
+        valid_ = true;  // is_valid() asks device_
+        return;
+    }
 
-    integrator_ = std::make_unique<VelocityVerlet>(params_.dt);
+    if (params_.respa_steps > 1)
+        integrator_ = std::make_unique<RespaIntegrator>(params_.dt, params_.respa_steps,
+                                                        params_.resolved_respa_split(),
+                                                        params_.resolved_respa_switch());
+    else
+        integrator_ = std::make_unique<VelocityVerlet>(params_.dt);
     if (potential)
         set_potential(potential);
     valid_ = true;
 }
 
+Simulation::~Simulation() = default;
+
 Simulation::Simulation(const HeatDiffusionParams& heat_params)
     : mode_(SimMode::HeatDiffusion), params_(), time_(0), step_count_(0), valid_(false) {
     model_ = std::make_unique<HeatDiffusionModel>(heat_params);
@@ -75,6 +128,20 @@ Simulation::Simulation(const HeatDiffusion2DParams& heat_2d_params)
         error_msg_ = model_->error_message();
 }
 
+Simulation::Simulation(const HeatDiffusion3DParams& heat_3d_params)
+    : mode_(SimMode::HeatDiffusion3D), params_(), time_(0), step_count_(0), valid_(false) {
+    model_ = std::make_unique<HeatDiffusion3DModel>(heat_3d_params);
+    valid_ = model_->is_valid();
+    if (!valid_)
+        error_msg_ = model_->error_message();
+}
+
+const HeatDiffusion3DModel* Simulation::heat_3d_model() const {
+    if (mode_ != SimMode::HeatDiffusion3D || !model_) return nullptr;
+    // Safe: only the HeatDiffusion3DParams constructor sets this mode.
+    return static_cast<const HeatDiffusion3DModel*>(model_.get());
+}
+
 const HeatDiffusion2DModel* Simulation::heat_2d_model() const {
     if (mode_ != SimMode::HeatDiffusion2D || !model_) return nullptr;
     // Safe: the only code path that sets mode_ to HeatDiffusion2D
@@ -82,66 +149,227 @@ const HeatDiffusion2DModel* Simulation::heat_2d_model() const {
     return static_cast<const HeatDiffusion2DModel*>(model_.get());
 }
 
+std::vector<StateBuffer> Simulation::model_state_buffers() const {
+    if (!model_) return {};
+    return model_->state_buffers();
+}
+
+void Simulation::restore_clock(Real time, std::size_t step_count) {
+    stats_step_base_ = step_count;
+    if (model_) {
+        model_->restore_clock(time, step_count);
+        return;
+    }
+    if (device_) {
+        device_->restore_clock(time, step_count);
+        return;
+    }
+    time_ = time;
+    step_count_ = step_count;
+    epot_valid_ = false;
+}
+
+ParticleSystem& Simulation::system() {
+    return device_ ? device_->system() : system_;
+}
+
+const ParticleSystem& Simulation::system() const {
+    return device_ ? static_cast<const DeviceSimulation&>(*device_).system() : system_;
+}
+
+void Simulation::set_lattice(const Lattice& lat) {
+    lattice_ = lat;
+    lattice_.update_cache();
+    if (device_) device_->set_lattice(lattice_);
+}
+
+Potential* Simulation::potential() const {
+    if (device_) return device_->potential();
+    return force_field_ ? force_field_->potential() : nullptr;
+}
+
+void Simulation::set_thermostat(std::shared_ptr<Thermostat> therm) {
+    thermostat_ = std::move(therm);
+    if (thermostat_) thermostat_->set_thread_pool(thread_pool_);
+    if (device_) device_->set_thermostat(thermostat_);
+}
+
+const KineticMoments& Simulation::kinetic_moments() const {
+    if (device_) return device_->kinetic_moments();
+    return system_.kinetic_moments(thread_pool_.get());
+}
+
 void Simulation::set_potential(std::shared_ptr<Potential> pot) {
+    if (device_) {
+        device_->set_potential(std::move(pot));
+        return;
+    }
     if (params_.use_neighbor_list) {
         neighbor_force_field_ = std::make_unique<NeighborForceField>(
-            pot, params_.cutoff, params_.neighbor_skin);
+            pot, params_.cutoff, params_.neighbor_skin, params_.neighbor_build);
+        neighbor_force_field_->set_thread_pool(thread_pool_);
+        neighbor_force_field_->set_precision(params_.precision);
+        neighbor_force_field_->set_sort_interval(params_.sort_interval);
         force_field_.reset();
+        if (params_.neighbor_skin_auto) {
+            skin_tuner_ = std::make_unique<SkinTuner>(params_.cutoff, params_.neighbor_skin,
+                                                      params_.neighbor_skin_min, params_.neighbor_skin_max);
+            neighbor_force_field_->neighbor_list().set_cutoff(params_.cutoff, skin_tuner_->skin());
+        }
+        apply_shell_switch();
     } else {
         force_field_ = std::make_unique<ForceField>(pot);
+        force_field_->set_thread_pool(thread_pool_);
         neighbor_force_field_.reset();
+        skin_tuner_.reset();
     }
+    epot_valid_ = false;
 }
 
 void Simulation::set_integrator(std::unique_ptr<VelocityVerlet> integrator) {
     integrator_ = std::move(integrator);
+    apply_shell_switch();
+}
+
+RespaIntegrator* Simulation::respa_integrator() const {
+    return dynamic_cast<RespaIntegrator*>(integrator_.get());
+}
+
+void Simulation::apply_shell_switch() {
+    const RespaIntegrator* respa = respa_integrator();
+    if (respa && neighbor_force_field_)
+        neighbor_force_field_->set_shell_switch(respa->split(), respa->switch_width());
 }
 
 void Simulation::initialize() {
+    if (device_) {
+        device_->initialize();
+        return;
+    }
     if (system_.empty()) return;
     
     // Zero center of mass velocity
     system_.zero_com_velocity();
     
     // Compute initial forces
+    if (RespaIntegrator* respa = respa_integrator(); respa && neighbor_force_field_) {
+        Real outer_epot = 0.0;
+        respa->prime(system_,
+                     [&](ParticleSystem&) { compute_forces(true, ForceShell::Inner); },
+                     [&](ParticleSystem&) { compute_forces(true, ForceShell::Outer); outer_epot = last_epot_; });
+        last_epot_ += outer_epot;
+        epot_valid_ = true;
+        return;
+    }
     compute_forces();
 }
 
-void Simulation::compute_forces() {
+std::uint64_t Simulation::compute_forces(bool with_energy, ForceShell shell, PairSampler* sampler) {
     const Lattice* lat = has_lattice() ? &lattice_ : nullptr;
+    std::uint64_t rebuild_ns = 0;
     
     if (neighbor_force_field_) {
-        last_epot_ = neighbor_force_field_->compute_forces(system_, lat);
+        const NeighborList& nl = neighbor_force_field_->neighbor_list();
+        const std::size_t builds = nl.build_count();
+        const std::size_t pairs = nl.pairs_built();
+        const std::size_t sorts = neighbor_force_field_->sort_count();
+        const std::uint64_t ns = nl.build_ns() + neighbor_force_field_->sort_ns();
+        last_epot_ = neighbor_force_field_->compute_forces(system_, lat, with_energy, shell, sampler);
+        stats_.neighbor_rebuilds += nl.build_count() - builds;
+        stats_.neighbor_pairs += nl.pairs_built() - pairs;
+        stats_.particle_sorts += neighbor_force_field_->sort_count() - sorts;
+        rebuild_ns = nl.build_ns() + neighbor_force_field_->sort_ns() - ns;
     } else if (force_field_) {
-        last_epot_ = force_field_->compute_forces(system_, lat);
+        last_epot_ = force_field_->compute_forces(system_, lat, with_energy, sampler);
     } else {
         system_.clear_forces();
         last_epot_ = 0.0;
     }
+    epot_valid_ = with_energy && shell == ForceShell::All;
+    return rebuild_ns;
+}
+
+std::optional<std::string> Simulation::set_observables(const ObservableParams& params) {
+    if (auto err = params.validate()) return err;
+    if (device_) return std::string("Observables are not available on the device backend.");
+    observables_.configure(params, params_.cutoff);
+    return std::nullopt;
+}
+
+StepStats Simulation::stats() const {
+    StepStats s = stats_;
+    s.steps = step_count() - stats_step_base_;
+    if (device_) return s;
+    s.bytes_in_use = system_.bytes_in_use();
+    s.peak_bytes = system_.peak_bytes();
+    s.max_bytes = system_.max_bytes();
+    if (neighbor_force_field_) s.neighbor_skin = neighbor_force_field_->neighbor_list().skin();
+    if (skin_tuner_) s.skin_adjustments = skin_tuner_->adjustments();
+    return s;
+}
+
+void Simulation::reset_stats() {
+    stats_ = StepStats{};
+    stats_step_base_ = step_count();
+}
+
+Real Simulation::potential_energy() const {
+    if (device_) return device_->potential_energy();
+    if (!epot_valid_) {
+        const Lattice* lat = has_lattice() ? &lattice_ : nullptr;
+        if (neighbor_force_field_)
+            last_epot_ = neighbor_force_field_->compute_energy(system_, lat);
+        else if (force_field_)
+            last_epot_ = force_field_->compute_energy(system_, lat);
+        else
+            last_epot_ = 0.0;
+        epot_valid_ = true;
+    }
+    return last_epot_;
+}
+
+bool Simulation::health_check_due() const {
+    switch (params_.health_check) {
+        case HealthCheck::EveryStep: return true;
+        case HealthCheck::Interval: return (step_count_ + 1) % params_.health_check_interval == 0;
+        case HealthCheck::DebugOnly:
+#ifdef NDEBUG
+            return false;
+#else
+            return true;
+#endif
+        case HealthCheck::Fused: return false;
+    }
+    return true;
 }
 
 bool Simulation::is_valid() const {
     if (model_) return model_->is_valid();
+    if (device_) return device_->is_valid();
     return valid_;
 }
 
 const std::string& Simulation::error_message() const {
     if (model_) return model_->error_message();
+    if (device_) return device_->error_message();
     return error_msg_;
 }
 
 Real Simulation::time() const {
     if (model_) return model_->time();
+    if (device_) return device_->time();
     return time_;
 }
 
 std::size_t Simulation::step_count() const {
     if (model_) return model_->step_count();
+    if (device_) return device_->step_count();
     return step_count_;
 }
 
 bool Simulation::finished() const {
     if (model_) return model_->finished();
+    if (device_) return device_->finished();
     if (!valid_) return true;
     if (step_count_ >= params_.max_steps) return true;
     if (params_.end_time > 0.0 && time_ >= params_.end_time) return true;
@@ -150,6 +378,12 @@ bool Simulation::finished() const {
 
 bool Simulation::step() {
     if (model_) return model_->step();
+    if (device_) {
+        if (!device_->step()) return false;
+        if (step_callback_)
+            step_callback_(*this);
+        return true;
+    }
 
     if (!valid_) {
         error_msg_ = "Simulation not properly initialized";
@@ -166,19 +400,41 @@ bool Simulation::step() {
         return false;
     }
 
-    integrator_->step1(system_);
-    if (has_lattice())
-        system_.apply_pbc(lattice_);
-    compute_forces();
-    integrator_->step2(system_);
+    const bool energy_due = params_.energy_interval > 0
+        && (step_count_ + 1) % params_.energy_interval == 0;
+    PhaseTimer timer(stats_, params_.profile);
+    const bool fused = params_.health_check == HealthCheck::Fused;
+    RespaIntegrator* respa = respa_integrator();
+    if (respa && !neighbor_force_field_ && force_field_) {
+        error_msg_ = "RESPA integrator requires the neighbor list";
+        valid_ = false;
+        return false;
+    }
+    // Analysis hooks due this step (null otherwise).
+    const std::size_t step = step_count_ + 1;
+    const Lattice* lat = has_lattice() ? &lattice_ : nullptr;
+    PairSampler* sampler = observables_.pair_sampler(step);
+    KineticProfile* profile = observables_.kinetic_profile(step, lat, system_.size());
+    bool healthy = respa && neighbor_force_field_
+        ? integrate_respa(*respa, timer, energy_due, fused, profile)
+        : integrate_verlet(timer, energy_due, fused, sampler, profile);
+    // Pressure takes K where the profile summed it: after the last kick,
+    // before the thermostat.
+    const Real sampled_ekin = sampler && observables_.pressure_due(step) ? kinetic_energy() : 0.0;
     if (thermostat_)
         thermostat_->apply(system_, params_.dt);
+    timer.mark(StepPhase::Thermostat);
 
-    if (has_non_finite_particle_state(system_)) {
+    if (healthy && health_check_due())
+        healthy = !has_non_finite_particle_state(system_);
+    timer.mark(StepPhase::HealthCheck);
+    if (!healthy) {
         error_msg_ = "Particle state became non-finite";
         valid_ = false;
         return false;
     }
+    if (sampler || profile)
+        observables_.finish_step(step, system_, lat, sampled_ekin);
 
     time_ += params_.dt;
     ++step_count_;
@@ -200,9 +456,89 @@ bool Simulation::step() {
     return true;
 }
 
+bool Simulation::integrate_verlet(PhaseTimer& timer, bool energy_due, bool fused,
+                                  PairSampler* sampler, KineticProfile* profile) {
+    bool healthy = true;
+    if (fused)
+        healthy = integrator_->step1_checked(system_);
+    else
+        integrator_->step1(system_);
+    timer.mark(StepPhase::Integrate1);
+    if (has_lattice())
+        system_.apply_pbc(lattice_);
+    timer.mark(StepPhase::Boundary);
+    const std::size_t builds = stats_.neighbor_rebuilds;
+    const std::uint64_t force_start = skin_tuner_ ? SkinTuner::clock_ns() : 0;
+    const std::uint64_t rebuild_ns = compute_forces(energy_due, ForceShell::All, sampler);
+    if (skin_tuner_)
+        tune_skin(SkinTuner::clock_ns() - force_start, stats_.neighbor_rebuilds != builds);
+    timer.mark(StepPhase::Forces);
+    timer.transfer(StepPhase::Forces, StepPhase::Neighbor, rebuild_ns);
+    if (fused)
+        healthy = integrator_->step2_checked(system_, profile) && healthy;
+    else
+        integrator_->step2(system_, profile);
+    timer.mark(StepPhase::Integrate2);
+    return healthy;
+}
+
+bool Simulation::integrate_respa(RespaIntegrator& respa, PhaseTimer& timer, bool energy_due,
+                                 bool fused, KineticProfile* profile) {
+    // Kicks and drifts up to the last force pass count as Integrate1, the
+    // final outer kick as Integrate2.
+    const std::size_t builds = stats_.neighbor_rebuilds;
+    std::uint64_t force_ns = 0;
+    Real inner_epot = 0.0;
+    const auto pass = [&](ForceShell shell) {
+        const std::uint64_t start = skin_tuner_ ? SkinTuner::clock_ns() : 0;
+        const std::uint64_t rebuild_ns = compute_forces(energy_due, shell);
+        if (skin_tuner_) force_ns += SkinTuner::clock_ns() - start;
+        timer.mark(StepPhase::Forces);
+        timer.transfer(StepPhase::Forces, StepPhase::Neighbor, rebuild_ns);
+    };
+    const bool healthy = respa.step(
+        system_,
+        [&](ParticleSystem&) {
+            timer.mark(StepPhase::Integrate1);
+            if (has_lattice())
+                system_.apply_pbc(lattice_);
+            timer.mark(StepPhase::Boundary);
+            pass(ForceShell::Inner);
+            inner_epot = last_epot_;
+        },
+        [&](ParticleSystem&) {
+            timer.mark(StepPhase::Integrate1);
+            pass(ForceShell::Outer);
+        },
+        fused, profile);
+    timer.mark(StepPhase::Integrate2);
+    // Both shells were summed at the final positions.
+    last_epot_ += inner_epot;
+    epot_valid_ = energy_due;
+    if (skin_tuner_)
+        tune_skin(force_ns, stats_.neighbor_rebuilds != builds);
+    return healthy;
+}
+
+void Simulation::tune_skin(std::uint64_t force_ns, bool rebuilt) {
+    if (auto skin = skin_tuner_->record(force_ns, rebuilt)) {
+        NeighborList& nl = neighbor_force_field_->neighbor_list();
+        nl.set_cutoff(params_.cutoff, *skin);
+        nl.clear();  // a larger skin needs the wider pair search next step
+    }
+}
+
+std::size_t Simulation::advance(std::size_t k) {
+    if (model_) return model_->advance(k);
+    std::size_t n = 0;
+    while (n < k && step()) ++n;
+    return n;
+}
+
 void Simulation::run() {
     if (model_) {
-        while (model_->step()) {}
+        constexpr std::size_t kStepsPerAdvance = 256;
+        while (model_->advance(kStepsPerAdvance) == kStepsPerAdvance) {}
         return;
     }
     initialize();
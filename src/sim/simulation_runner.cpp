@@ -0,0 +1,57 @@
+#include <matsimu/sim/simulation_runner.hpp>
+#include <algorithm>
+#include <exception>
+
+namespace matsimu {
+
+SimulationRunner::SimulationRunner(Simulation& sim, FrameExchange& frames,
+                                   std::size_t steps_per_chunk,
+                                   std::chrono::microseconds frame_interval)
+    : sim_(sim), frames_(frames),
+      steps_per_chunk_(std::max<std::size_t>(1, steps_per_chunk)),
+      frame_interval_(frame_interval) {}
+
+SimulationRunner::~SimulationRunner() { stop(); }
+
+void SimulationRunner::start() {
+    if (thread_.joinable() || finished()) return;
+    stop_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread([this] { run(); });
+}
+
+void SimulationRunner::stop() {
+    stop_.store(true, std::memory_order_relaxed);
+    if (thread_.joinable()) thread_.join();
+}
+
+void SimulationRunner::publish() {
+    capture_frame(sim_, frames_.begin_write());
+    frames_.publish();
+}
+
+void SimulationRunner::run() {
+    using clock = std::chrono::steady_clock;
+    auto last_frame = clock::now();
+    try {
+        while (!stop_.load(std::memory_order_relaxed)) {
+            const std::size_t taken = sim_.advance(steps_per_chunk_);
+            steps_.fetch_add(taken, std::memory_order_relaxed);
+            if (taken < steps_per_chunk_) {
+                publish();
+                finished_.store(true, std::memory_order_release);
+                return;
+            }
+            const auto now = clock::now();
+            if (now - last_frame >= frame_interval_) {
+                publish();
+                last_frame = now;
+            }
+        }
+        publish();  // leave the stopped state on screen
+    } catch (const std::exception& e) {
+        error_ = e.what();
+        finished_.store(true, std::memory_order_release);
+    }
+}
+
+}  // namespace matsimu
@@ -0,0 +1,86 @@
+#include <matsimu/sim/skin_tuner.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace matsimu {
+
+SkinTuner::SkinTuner(Real cutoff, Real skin, Real min_skin, Real max_skin)
+    : cutoff_(cutoff),
+      min_skin_(min_skin > 0 ? min_skin : 0.05 * cutoff),
+      max_skin_(max_skin > 0 ? max_skin : 0.6 * cutoff) {
+    if (max_skin_ < min_skin_) std::swap(min_skin_, max_skin_);
+    skin_ = std::clamp(skin, min_skin_, max_skin_);
+}
+
+std::uint64_t SkinTuner::clock_ns() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void SkinTuner::reset_window() {
+    steps_ = 0;
+    rebuilds_ = 0;
+    plain_ns_ = 0;
+    rebuild_ns_ = 0;
+}
+
+std::optional<Real> SkinTuner::record(std::uint64_t ns, bool rebuilt) {
+    if (skip_forced_rebuild_) {
+        skip_forced_rebuild_ = false;
+        if (rebuilt) return std::nullopt;
+    }
+    ++steps_;
+    if (rebuilt) {
+        ++rebuilds_;
+        rebuild_ns_ += ns;
+    } else {
+        plain_ns_ += ns;
+    }
+    if (rebuilds_ < kWindowRebuilds && steps_ < kMaxWindowSteps) return std::nullopt;
+
+    const std::size_t plain_steps = steps_ - rebuilds_;
+    if (plain_steps == 0) {
+        // Rebuilding every step: the skin is certainly too small.
+        const Real grown = std::min(max_skin_, skin_ * 2.0);
+        reset_window();
+        if (grown <= skin_) return std::nullopt;
+        skin_ = grown;
+        ++adjustments_;
+        skip_forced_rebuild_ = true;
+        return skin_;
+    }
+    const double f = static_cast<double>(plain_ns_) / static_cast<double>(plain_steps);
+    if (rebuilds_ > 0)
+        last_build_extra_ = std::max(0.0, static_cast<double>(rebuild_ns_) / rebuilds_ - f);
+    const double b = last_build_extra_;
+    // No rebuild in the window: the interval is at least the window length.
+    const double interval = static_cast<double>(steps_) / static_cast<double>(std::max<std::size_t>(rebuilds_, 1));
+    reset_window();
+
+    const double rc = static_cast<double>(cutoff_);
+    const double s = static_cast<double>(skin_);
+    auto cost = [&](double cand) {
+        const double g = std::pow((rc + cand) / (rc + s), 3.0);
+        return g * f + g * b / (interval * cand / s);
+    };
+    const double current = cost(s);
+    double best = s;
+    double best_cost = current;
+    for (int k = -4; k <= 4; ++k) {
+        const double cand = std::clamp(s * std::exp2(k / 4.0), static_cast<double>(min_skin_),
+                                       static_cast<double>(max_skin_));
+        const double c = cost(cand);
+        if (c < best_cost) {
+            best_cost = c;
+            best = cand;
+        }
+    }
+    if (best == s || best_cost > 0.98 * current) return std::nullopt;
+    skin_ = static_cast<Real>(best);
+    ++adjustments_;
+    skip_forced_rebuild_ = true;
+    return skin_;
+}
+
+}  // namespace matsimu
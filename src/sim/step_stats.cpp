@@ -0,0 +1,19 @@
+#include <matsimu/sim/step_stats.hpp>
+
+namespace matsimu {
+
+const char* step_phase_name(StepPhase phase) {
+    switch (phase) {
+        case StepPhase::Integrate1: return "integrate1";
+        case StepPhase::Boundary: return "boundary";
+        case StepPhase::Neighbor: return "neighbor";
+        case StepPhase::Forces: return "forces";
+        case StepPhase::Integrate2: return "integrate2";
+        case StepPhase::Thermostat: return "thermostat";
+        case StepPhase::HealthCheck: return "health_check";
+        case StepPhase::Count: break;
+    }
+    return "unknown";
+}
+
+}  // namespace matsimu
@@ -4,6 +4,9 @@
 #include <matsimu/ui/view_3d_tab.hpp>
 #include <matsimu/sim/simulation.hpp>
 #include <matsimu/sim/heat_diffusion_2d.hpp>
+#include <matsimu/sim/frame_exchange.hpp>
+#include <matsimu/sim/simulation_runner.hpp>
+#include <matsimu/physics/particle_builder.hpp>
 #include <matsimu/physics/potential.hpp>
 #include <matsimu/physics/thermostat.hpp>
 #include <QTabWidget>
@@ -17,8 +20,11 @@
 #include <QElapsedTimer>
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -79,50 +85,30 @@ void populate_argon_crystal(Simulation& sim, const Lattice& lat) {
 void populate_thermal_shock(Simulation& sim, const Lattice& lat) {
   sim.set_lattice(lat);
 
-  auto& ps = sim.system();
-  ps.clear();
-  ps.reserve(2000);
+  const int n_per_cluster = 700;
+  const Real min_dist2 = 8.5e-20;  // (0.29 nm)^2, avoids LJ singular overlaps.
+  // Overlap rejection on a cell list: O(1) per candidate, periodic.
+  PlacementGrid grid(lat, std::sqrt(min_dist2));
+  std::vector<Real> xyz[3];
+  std::vector<Real> drift_x;  // cluster velocity, added to the thermal draw
+  for (auto& v : xyz) v.reserve(static_cast<std::size_t>(2 * n_per_cluster + 160));
+  drift_x.reserve(xyz[0].capacity());
+
+  auto try_place = [&](Real px, Real py, Real pz, Real drift) {
+    const Real pos[3] = {px, py, pz};
+    if (!grid.try_insert(pos)) return false;
+    for (int d = 0; d < 3; ++d) xyz[d].push_back(pos[d]);
+    drift_x.push_back(drift);
+    return true;
+  };
 
   std::mt19937 rng(1337u);
   std::uniform_real_distribution<Real> uni(0.0, 1.0);
-  std::normal_distribution<Real> thermal(0.0, thermal_velocity_stddev(650.0, 6.63e-26));
   const Real cx_left = 0.32 * lat.a1[0];
   const Real cx_right = 0.68 * lat.a1[0];
   const Real cy = 0.5 * lat.a2[1];
   const Real cz = 0.5 * lat.a3[2];
   const Real radius = std::min({lat.a1[0], lat.a2[1], lat.a3[2]}) * 0.25;
-  const int n_per_cluster = 700;
-  const Real min_dist2 = 8.5e-20;  // (0.29 nm)^2, avoids LJ singular overlaps.
-  std::vector<std::array<Real, 3>> placed_positions;
-  placed_positions.reserve(static_cast<std::size_t>(2 * n_per_cluster + 160));
-
-  auto can_place = [&](Real px, Real py, Real pz) {
-    const Real candidate[3] = {px, py, pz};
-    for (const auto& pos : placed_positions) {
-      const Real existing[3] = {pos[0], pos[1], pos[2]};
-      Real dr[3];
-      // Respect periodic boundaries when checking minimum separation.
-      const_cast<Lattice&>(lat).min_image_displacement(existing, candidate, dr);
-      const Real dx = dr[0];
-      const Real dy = dr[1];
-      const Real dz = dr[2];
-      if (dx * dx + dy * dy + dz * dz < min_dist2) return false;
-    }
-    return true;
-  };
-
-  auto add_particle = [&](Real px, Real py, Real pz, Real drift) {
-    Particle p;
-    p.mass = 6.63e-26;
-    p.pos[0] = px;
-    p.pos[1] = py;
-    p.pos[2] = pz;
-    p.vel[0] = drift + thermal(rng);
-    p.vel[1] = thermal(rng);
-    p.vel[2] = thermal(rng);
-    ps.add_particle(p);
-    placed_positions.push_back({px, py, pz});
-  };
 
   auto sample_in_sphere = [&](Real cx, Real drift) {
     int accepted = 0;
@@ -136,12 +122,7 @@ void populate_thermal_shock(Simulation& sim, const Lattice& lat) {
         ry = (uni(rng) * 2.0 - 1.0) * radius;
         rz = (uni(rng) * 2.0 - 1.0) * radius;
       } while (rx * rx + ry * ry + rz * rz > radius * radius);
-      const Real px = cx + rx;
-      const Real py = cy + ry;
-      const Real pz = cz + rz;
-      if (!can_place(px, py, pz)) continue;
-      add_particle(px, py, pz, drift);
-      ++accepted;
+      if (try_place(cx + rx, cy + ry, cz + rz, drift)) ++accepted;
     }
   };
 
@@ -155,11 +136,20 @@ void populate_thermal_shock(Simulation& sim, const Lattice& lat) {
     const Real px = uni(rng) * lat.a1[0];
     const Real py = uni(rng) * lat.a2[1];
     const Real pz = uni(rng) * lat.a3[2];
-    if (!can_place(px, py, pz)) continue;
-    add_particle(px, py, pz, 0.0);
-    ++gas_added;
+    if (try_place(px, py, pz, 0.0)) ++gas_added;
   }
 
+  // One bulk import of the accepted positions. Placement is a serial
+  // rejection walk; velocities come afterwards from the counter RNG, keyed
+  // per particle rather than by draw order.
+  auto& ps = sim.system();
+  ps.clear();
+  const Real* pos[3] = {xyz[0].data(), xyz[1].data(), xyz[2].data()};
+  ps.append(drift_x.size(), pos, nullptr, 6.63e-26);
+  assign_maxwell_velocities(ps, 650.0, 1337u);
+  Real* vx = ps.vel(0);
+  for (std::size_t i = 0; i < ps.size(); ++i) vx[i] += drift_x[i];
+
   sim.set_potential(std::make_shared<LennardJones>(1.654e-21, 3.405e-10, 1.1e-9));
   sim.set_thermostat(std::make_shared<VelocityRescaleThermostat>(650.0, 8e-13));
 }
@@ -227,12 +217,33 @@ struct MainWindow::Impl {
   View3DTab* view3d_tab{nullptr};
   QStatusBar* status{nullptr};
   std::unique_ptr<Simulation> simulation;  ///< Active simulation instance
-  QTimer sim_timer;                        ///< Timer for non-blocking simulation steps
+  FrameExchange frames;                    ///< Triple-buffered snapshots shown by View3D
+  std::unique_ptr<SimulationRunner> runner;  ///< Worker stepping `simulation` (null when idle)
+  std::uint64_t shown_generation{0};       ///< frames.generation() last handed to the view
+  Real run_end_time{0.0};                  ///< params().end_time of the active run
+  QTimer sim_timer;                        ///< Polls the runner for new frames / completion
   QElapsedTimer sim_elapsed;               ///< Track wall-clock time for UI updates
   static constexpr int SIM_TIMER_INTERVAL_MS = 16;  ///< ~60 FPS timer interval
-  static constexpr int SIM_BATCH_BUDGET_MS = 12;    ///< Wall-time budget per batch (ms), leaves headroom for rendering
-  static constexpr int SIM_MAX_STEPS_PER_TICK_MD = 96;
-  static constexpr int SIM_MAX_STEPS_PER_TICK_HEAT = 24;
+  static constexpr std::size_t SIM_STEPS_PER_CHUNK = 10;  ///< Steps per advance() on the worker
+
+  /// Snapshot the simulation into a free frame buffer and hand it to the view.
+  void publish_frame() {
+    if (!simulation) return;
+    capture_frame(*simulation, frames.begin_write());
+    frames.publish();
+    shown_generation = frames.generation();
+    view3d_tab->set_frame(frames.latest());
+  }
+
+  /// Hand `simulation` to a worker thread; the timer only picks up frames.
+  void start_runner() {
+    run_end_time = simulation->params().end_time;
+    runner = std::make_unique<SimulationRunner>(
+        *simulation, frames, SIM_STEPS_PER_CHUNK,
+        std::chrono::milliseconds(SIM_TIMER_INTERVAL_MS));
+    runner->start();
+    sim_timer.start();
+  }
 };
 
 MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), impl_(std::make_unique<Impl>()) {
@@ -278,56 +289,30 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), impl_(std::make_u
 }
 
 void MainWindow::on_simulation_timer() {
-  if (!impl_->simulation) {
+  if (!impl_->simulation || !impl_->runner || impl_->runner->finished()) {
     finish_simulation();
     return;
   }
-  
-  // Run simulation steps within a wall-time budget.
-  // Adaptive: fast systems get many steps, heavy systems fewer — always responsive.
-  QElapsedTimer batch;
-  batch.start();
-  int batch_steps = 0;
-  const int max_steps_per_tick =
-      (impl_->simulation->mode() == SimMode::HeatDiffusion2D)
-          ? Impl::SIM_MAX_STEPS_PER_TICK_HEAT
-          : Impl::SIM_MAX_STEPS_PER_TICK_MD;
-  
-  do {
-    if (!impl_->simulation->step()) {
-      finish_simulation();
-      return;
-    }
-    ++batch_steps;
-    if (batch_steps >= max_steps_per_tick) break;
-    // Check budget every 10 steps to avoid timer-query overhead
-    if (batch_steps % 10 == 0 && batch.hasExpired(Impl::SIM_BATCH_BUDGET_MS)) break;
-  } while (!batch.hasExpired(Impl::SIM_BATCH_BUDGET_MS));
-  
-  // Update UI every tick so users always see a stable, continuous state evolution.
-  const Real t = impl_->simulation->time();
-  impl_->sim_tab->set_time(t);
-
-  if (impl_->simulation->mode() == SimMode::HeatDiffusion2D) {
-    const auto* model = impl_->simulation->heat_2d_model();
-    if (model) {
-      const auto& T = model->temperature();
-      std::vector<Real> T_copy(T.begin(), T.end());
-      impl_->view3d_tab->set_temperature_field(
-          T_copy, model->nx(), model->ny(),
-          model->T_cold(), model->T_hot());
-    }
-  } else {
-    impl_->view3d_tab->set_particles(impl_->simulation->system());
-  }
 
-  impl_->view3d_tab->set_simulation_state(true, t, impl_->simulation->params().end_time,
-                                          impl_->simulation->step_count());
+  // The worker steps flat out; each tick only shows the newest frame, if any.
+  const std::uint64_t generation = impl_->frames.generation();
+  if (generation == impl_->shown_generation) return;
+  impl_->shown_generation = generation;
+  const std::shared_ptr<const SimFrame> frame = impl_->frames.latest();
+  impl_->view3d_tab->set_frame(frame);
+  impl_->sim_tab->set_time(frame->time);
+  impl_->view3d_tab->set_simulation_state(true, frame->time, impl_->run_end_time, frame->step);
   impl_->sim_elapsed.restart();
 }
  
 void MainWindow::finish_simulation() {
   impl_->sim_timer.stop();
+  std::string runner_error;
+  if (impl_->runner) {
+    impl_->runner->stop();  // joins the worker; the simulation is ours again
+    runner_error = impl_->runner->error();
+    impl_->runner.reset();
+  }
   
   if (!impl_->simulation) {
     impl_->sim_tab->set_running(false);
@@ -337,23 +322,12 @@ void MainWindow::finish_simulation() {
   }
   
   Real final_time = impl_->simulation->time();
-  const std::string& err = impl_->simulation->error_message();
+  const std::string err = runner_error.empty() ? impl_->simulation->error_message() : runner_error;
 
   impl_->sim_tab->set_time(final_time);
   impl_->sim_tab->set_running(false);
 
-  if (impl_->simulation->mode() == SimMode::HeatDiffusion2D) {
-    const auto* model = impl_->simulation->heat_2d_model();
-    if (model) {
-      const auto& T = model->temperature();
-      std::vector<Real> T_copy(T.begin(), T.end());
-      impl_->view3d_tab->set_temperature_field(
-          T_copy, model->nx(), model->ny(),
-          model->T_cold(), model->T_hot());
-    }
-  } else {
-    impl_->view3d_tab->set_particles(impl_->simulation->system());
-  }
+  impl_->publish_frame();
 
   impl_->view3d_tab->set_simulation_state(false, final_time,
                                           impl_->simulation->params().end_time,
@@ -431,6 +405,7 @@ void MainWindow::on_run() {
     update_status(tr("Simulation already running. Press Stop before starting a new run."));
     return;
   }
+  impl_->runner.reset();
 
   const QString example_id = impl_->sim_tab->selected_example_id();
 
@@ -458,14 +433,7 @@ void MainWindow::on_run() {
       return;
     }
 
-    const auto* model = impl_->simulation->heat_2d_model();
-    if (model) {
-      const auto& T = model->temperature();
-      std::vector<Real> T_copy(T.begin(), T.end());
-      impl_->view3d_tab->set_temperature_field(
-          T_copy, model->nx(), model->ny(),
-          model->T_cold(), model->T_hot());
-    }
+    impl_->publish_frame();
 
     impl_->sim_tab->set_running(true);
     impl_->sim_tab->set_time(0.0);
@@ -475,7 +443,7 @@ void MainWindow::on_run() {
 
     update_status(tr("Running %1 simulation.").arg(example_id == "heat_hot_center" ? "Heat Hot Center" : "Heat Quenching"));
     if (impl_->tabs) impl_->tabs->setCurrentWidget(impl_->view3d_tab);
-    impl_->sim_timer.start();
+    impl_->start_runner();
     return;
   }
 
@@ -519,7 +487,7 @@ void MainWindow::on_run() {
   impl_->simulation->initialize();
   impl_->lattice_tab->set_lattice(lat);
   impl_->view3d_tab->set_lattice(lat);
-  impl_->view3d_tab->set_particles(impl_->simulation->system());
+  impl_->publish_frame();
 
   impl_->sim_tab->set_running(true);
   impl_->sim_tab->set_time(impl_->simulation->time());
@@ -530,7 +498,7 @@ void MainWindow::on_run() {
   impl_->sim_elapsed.start();
 
   if (impl_->tabs) impl_->tabs->setCurrentWidget(impl_->view3d_tab);
-  impl_->sim_timer.start();
+  impl_->start_runner();
 }
 
 void MainWindow::update_ui_for_example(const QString& example_id) {
@@ -574,23 +542,13 @@ void MainWindow::on_run_example(const QString& example_id) {
 void MainWindow::on_stop() {
   const bool was_active = (impl_->simulation && impl_->sim_timer.isActive());
   impl_->sim_timer.stop();
+  impl_->runner.reset();
   
   if (impl_->simulation) {
     const Real t = impl_->simulation->time();
     impl_->sim_tab->set_time(t);
 
-    if (impl_->simulation->mode() == SimMode::HeatDiffusion2D) {
-      const auto* model = impl_->simulation->heat_2d_model();
-      if (model) {
-        const auto& T = model->temperature();
-        std::vector<Real> T_copy(T.begin(), T.end());
-        impl_->view3d_tab->set_temperature_field(
-            T_copy, model->nx(), model->ny(),
-            model->T_cold(), model->T_hot());
-      }
-    } else {
-      impl_->view3d_tab->set_particles(impl_->simulation->system());
-    }
+    impl_->publish_frame();
 
     impl_->view3d_tab->set_simulation_state(false, t,
                                             impl_->simulation->params().end_time,
@@ -611,8 +569,7 @@ void MainWindow::on_reset() {
   on_stop();
   
   impl_->sim_tab->set_time(0.0);
-  impl_->view3d_tab->clear_particles();
-  impl_->view3d_tab->clear_temperature_field();
+  impl_->view3d_tab->clear_frame();
   impl_->view3d_tab->set_simulation_state(false, 0.0, 0.0, 0);
   update_status(tr("Reset."));
 }
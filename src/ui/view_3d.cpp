@@ -1,5 +1,7 @@
 #include <matsimu/ui/view_3d.hpp>
+#include <matsimu/ui/view_3d_renderer.hpp>
 #include <QSurfaceFormat>
+#include <QtGlobal>
 #include <cmath>
 #include <algorithm>
 #include <limits>
@@ -16,48 +18,38 @@ View3D::View3D(QWidget* parent) : QOpenGLWidget(parent) {
   setUpdateBehavior(QOpenGLWidget::NoPartialUpdate);  // Full updates are more stable for 3D
 }
 
-View3D::~View3D() = default;
+View3D::~View3D() {
+  // GL objects must be released with their context current.
+  if (renderer_) {
+    makeCurrent();
+    renderer_.reset();
+    doneCurrent();
+  }
+}
 
 void View3D::set_lattice(const Lattice& lat) {
   lattice_ = lat;
   update();
 }
 
-void View3D::set_particle_system(std::shared_ptr<const ParticleSystem> system) {
-  particle_system_ = std::move(system);
-  // When showing particles, clear temperature field so paintGL draws particles not heat map.
-  if (particle_system_ && !particle_system_->empty()) {
-    temp_field_.clear();
-    temp_nx_ = 0;
-    temp_ny_ = 0;
-  }
+void View3D::set_frame(std::shared_ptr<const SimFrame> frame) {
+  frame_ = std::move(frame);
+  ++frame_serial_;
   update();
 }
 
-void View3D::clear_particle_system() {
-  particle_system_.reset();
+void View3D::clear_frame() {
+  frame_.reset();
   update();
 }
 
-void View3D::set_temperature_field(const std::vector<Real>& T,
-                                   std::size_t nx, std::size_t ny,
-                                   Real T_cold, Real T_hot) {
-  if (T.size() != nx * ny || nx < 3 || ny < 3 || T_hot <= T_cold) return;
-  temp_field_ = T;
-  temp_nx_ = nx;
-  temp_ny_ = ny;
-  temp_T_cold_ = T_cold;
-  temp_T_hot_ = T_hot;
-  // Clear particle view when showing temperature field.
-  particle_system_.reset();
-  update();
+bool View3D::has_particles() const {
+  return frame_ && frame_->kind == SimFrame::Kind::Particles && frame_->particle_count() > 0;
 }
 
-void View3D::clear_temperature_field() {
-  temp_field_.clear();
-  temp_nx_ = 0;
-  temp_ny_ = 0;
-  update();
+bool View3D::has_field() const {
+  return frame_ && frame_->kind == SimFrame::Kind::Field2D && frame_->nx >= 3 && frame_->ny >= 3
+      && frame_->field.size() == frame_->nx * frame_->ny;
 }
 
 void View3D::set_scale(Real scale) {
@@ -100,6 +92,13 @@ void View3D::initializeGL() {
   glClearColor(0.15f, 0.15f, 0.18f, 1.0f);
   glEnable(GL_LINE_SMOOTH);
   glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+
+  renderer_.reset();
+  if (!qEnvironmentVariableIsSet("MATSIMU_GL_IMMEDIATE")) {
+    renderer_ = std::make_unique<View3DRenderer>();
+    if (!renderer_->initialize()) renderer_.reset();
+  }
+  uploaded_serial_ = 0;
 }
 
 void View3D::resizeGL(int w, int h) {
@@ -146,7 +145,7 @@ void View3D::paintGL() {
   glTranslatef(0.0f, 0.0f, -3.0f);
   glRotatef(rot_x_, 1.0f, 0.0f, 0.0f);
   glRotatef(rot_y_, 0.0f, 1.0f, 0.0f);
-  if (sim_running_ && (!particle_system_ || particle_system_->empty())) {
+  if (sim_running_ && !has_particles()) {
     // Visual cue: while running, slowly spin like a turntable.
     const float spin = static_cast<float>(std::fmod(sim_time_ * 1e15 * 8.0, 360.0));
     glRotatef(spin, 0.0f, 1.0f, 0.0f);
@@ -160,9 +159,9 @@ void View3D::paintGL() {
   glScalef(scale, scale, scale);
 
   draw_axes();
-  if (!temp_field_.empty() && temp_nx_ >= 3 && temp_ny_ >= 3) {
+  if (has_field()) {
     draw_temperature_field();
-  } else if (show_particles_ && particle_system_ && !particle_system_->empty()) {
+  } else if (show_particles_ && has_particles()) {
     draw_particles();  // Also draws simulation box in particle coordinate space
   } else if (show_lattice_) {
     draw_lattice_cell();  // Standalone lattice cell when no particles
@@ -323,9 +322,11 @@ void View3D::wheelEvent(QWheelEvent* event) {
 }
 
 void View3D::draw_particles() {
-  if (!particle_system_ || particle_system_->empty()) {
+  if (!has_particles()) {
     return;
   }
+  const SimFrame& frame = *frame_;
+  const std::size_t n = frame.particle_count();
 
   // Compute bounding box of all finite-position particles
   float min_p[3] = { std::numeric_limits<float>::max(),
@@ -335,13 +336,13 @@ void View3D::draw_particles() {
                      -std::numeric_limits<float>::max(),
                      -std::numeric_limits<float>::max() };
   std::size_t finite_count = 0;
-  for (std::size_t i = 0; i < particle_system_->size(); ++i) {
-    const auto& p = (*particle_system_)[i];
-    if (!std::isfinite(p.pos[0]) || !std::isfinite(p.pos[1]) || !std::isfinite(p.pos[2])) continue;
+  for (std::size_t i = 0; i < n; ++i) {
+    const Real p_pos[3] = {frame.pos[0][i], frame.pos[1][i], frame.pos[2][i]};
+    if (!std::isfinite(p_pos[0]) || !std::isfinite(p_pos[1]) || !std::isfinite(p_pos[2])) continue;
     ++finite_count;
-    const float px = static_cast<float>(p.pos[0]);
-    const float py = static_cast<float>(p.pos[1]);
-    const float pz = static_cast<float>(p.pos[2]);
+    const float px = static_cast<float>(p_pos[0]);
+    const float py = static_cast<float>(p_pos[1]);
+    const float pz = static_cast<float>(p_pos[2]);
     min_p[0] = std::min(min_p[0], px); min_p[1] = std::min(min_p[1], py); min_p[2] = std::min(min_p[2], pz);
     max_p[0] = std::max(max_p[0], px); max_p[1] = std::max(max_p[1], py); max_p[2] = std::max(max_p[2], pz);
   }
@@ -413,21 +414,32 @@ void View3D::draw_particles() {
     glLineWidth(1.0f);
   }
 
+  const float point_size = std::max(8.0f, particle_radius_ * 140.0f);
+  if (renderer_) {
+    if (uploaded_serial_ != frame_serial_) {
+      renderer_->upload_particles(frame);
+      uploaded_serial_ = frame_serial_;
+    }
+    const float center[3] = {cx, cy, cz};
+    renderer_->draw_particles(center, s, point_size);
+    return;
+  }
+
   // --- Draw particles as color-coded points ---
   glEnable(GL_POINT_SMOOTH);
-  glPointSize(std::max(8.0f, particle_radius_ * 140.0f));
+  glPointSize(point_size);
 
   glBegin(GL_POINTS);
-  for (std::size_t i = 0; i < particle_system_->size(); ++i) {
-    const auto& p = (*particle_system_)[i];
-    if (std::isfinite(p.pos[0]) && std::isfinite(p.pos[1]) && std::isfinite(p.pos[2])) {
-      const float speed = static_cast<float>(std::sqrt(
-          p.vel[0] * p.vel[0] + p.vel[1] * p.vel[1] + p.vel[2] * p.vel[2]));
+  for (std::size_t i = 0; i < n; ++i) {
+    const Real p_pos[3] = {frame.pos[0][i], frame.pos[1][i], frame.pos[2][i]};
+    if (std::isfinite(p_pos[0]) && std::isfinite(p_pos[1]) && std::isfinite(p_pos[2])) {
+      const Real vx = frame.vel[0][i], vy = frame.vel[1][i], vz = frame.vel[2][i];
+      const float speed = static_cast<float>(std::sqrt(vx * vx + vy * vy + vz * vz));
       const float heat = std::min(1.0f, speed / 250.0f);
       glColor3f(0.25f + 0.75f * heat, 0.85f - 0.55f * heat, 1.0f - 0.75f * heat);
-      const float px = (static_cast<float>(p.pos[0]) - cx) * s;
-      const float py = (static_cast<float>(p.pos[1]) - cy) * s;
-      const float pz = (static_cast<float>(p.pos[2]) - cz) * s;
+      const float px = (static_cast<float>(p_pos[0]) - cx) * s;
+      const float py = (static_cast<float>(p_pos[1]) - cy) * s;
+      const float pz = (static_cast<float>(p_pos[2]) - cz) * s;
       glVertex3f(px, py, pz);
     }
   }
@@ -436,17 +448,17 @@ void View3D::draw_particles() {
 
   // --- Draw wireframe spheres for 3D depth perception ---
   const float sphere_r = std::max(0.022f, particle_radius_ * 0.5f);
-  for (std::size_t i = 0; i < particle_system_->size(); ++i) {
-    const auto& p = (*particle_system_)[i];
-    if (std::isfinite(p.pos[0]) && std::isfinite(p.pos[1]) && std::isfinite(p.pos[2])) {
-      const float speed = static_cast<float>(std::sqrt(
-          p.vel[0] * p.vel[0] + p.vel[1] * p.vel[1] + p.vel[2] * p.vel[2]));
+  for (std::size_t i = 0; i < n; ++i) {
+    const Real p_pos[3] = {frame.pos[0][i], frame.pos[1][i], frame.pos[2][i]};
+    if (std::isfinite(p_pos[0]) && std::isfinite(p_pos[1]) && std::isfinite(p_pos[2])) {
+      const Real vx = frame.vel[0][i], vy = frame.vel[1][i], vz = frame.vel[2][i];
+      const float speed = static_cast<float>(std::sqrt(vx * vx + vy * vy + vz * vz));
       const float heat = std::min(1.0f, speed / 250.0f);
       const float particle_color[3] = {0.25f + 0.75f * heat, 0.85f - 0.55f * heat, 1.0f - 0.75f * heat};
       float pos[3] = {
-        (static_cast<float>(p.pos[0]) - cx) * s,
-        (static_cast<float>(p.pos[1]) - cy) * s,
-        (static_cast<float>(p.pos[2]) - cz) * s
+        (static_cast<float>(p_pos[0]) - cx) * s,
+        (static_cast<float>(p_pos[1]) - cy) * s,
+        (static_cast<float>(p_pos[2]) - cz) * s
       };
       draw_particle_sphere(pos, sphere_r, particle_color);
     }
@@ -496,20 +508,30 @@ void View3D::colormap_thermal(float t, float& r, float& g, float& b) {
 //  - OpenGL Gouraud shading interpolates within each quad.
 // ---------------------------------------------------------------------------
 void View3D::draw_temperature_field() {
-    if (temp_field_.empty() || temp_nx_ < 3 || temp_ny_ < 3) return;
+    if (!has_field()) return;
+
+    const SimFrame& frame = *frame_;
+    if (renderer_) {
+        if (uploaded_serial_ != frame_serial_) {
+            renderer_->upload_field(frame);
+            uploaded_serial_ = frame_serial_;
+        }
+        renderer_->draw_field();
+        return;
+    }
 
-    const std::size_t nx = temp_nx_;
-    const std::size_t ny = temp_ny_;
-    const float inv_range = (temp_T_hot_ > temp_T_cold_)
-                            ? 1.0f / static_cast<float>(temp_T_hot_ - temp_T_cold_)
+    const std::size_t nx = frame.nx;
+    const std::size_t ny = frame.ny;
+    const float inv_range = (frame.T_hot > frame.T_cold)
+                            ? 1.0f / static_cast<float>(frame.T_hot - frame.T_cold)
                             : 1.0f;
-    const float T_cold_f = static_cast<float>(temp_T_cold_);
+    const float T_cold_f = static_cast<float>(frame.T_cold);
 
     // Helper: cell temperature (clamped indices).
     auto cell_T = [&](int ci, int cj) -> float {
         ci = std::max(0, std::min(ci, static_cast<int>(nx) - 1));
         cj = std::max(0, std::min(cj, static_cast<int>(ny) - 1));
-        return static_cast<float>(temp_field_[static_cast<std::size_t>(cj) * nx
+        return static_cast<float>(frame.field[static_cast<std::size_t>(cj) * nx
                                               + static_cast<std::size_t>(ci)]);
     };
 
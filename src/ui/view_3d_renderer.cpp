@@ -0,0 +1,207 @@
+#include <matsimu/ui/view_3d_renderer.hpp>
+#include <QOpenGLContext>
+#include <QVector3D>
+#include <algorithm>
+#include <cmath>
+
+namespace matsimu {
+
+namespace {
+
+constexpr int kPosAttr = 0;
+constexpr int kHeatAttr = 1;
+constexpr int kFloatsPerAtom = 4;  // x, y, z, heat
+
+const char* const kParticleVertex = R"(
+#version 120
+attribute vec3 a_pos;
+attribute float a_heat;
+uniform vec3 u_center;
+uniform float u_scale;
+uniform float u_point_size;
+varying vec3 v_color;
+void main() {
+  gl_Position = gl_ModelViewProjectionMatrix * vec4((a_pos - u_center) * u_scale, 1.0);
+  gl_PointSize = u_point_size;
+  v_color = vec3(0.25 + 0.75 * a_heat, 0.85 - 0.55 * a_heat, 1.0 - 0.75 * a_heat);
+}
+)";
+
+// Round sprite with a fake sphere shade (replaces the per-atom wireframe).
+const char* const kParticleFragment = R"(
+#version 120
+varying vec3 v_color;
+void main() {
+  vec2 d = gl_PointCoord * 2.0 - 1.0;
+  float r2 = dot(d, d);
+  if (r2 > 1.0) discard;
+  gl_FragColor = vec4(v_color * (0.55 + 0.45 * sqrt(1.0 - r2)), 1.0);
+}
+)";
+
+const char* const kFieldVertex = R"(
+#version 120
+attribute vec2 a_xy;
+varying vec2 v_uv;
+void main() {
+  gl_Position = gl_ModelViewProjectionMatrix * vec4(a_xy, 0.0, 1.0);
+  v_uv = a_xy * 0.5 + 0.5;
+}
+)";
+
+// Same control points as View3D::colormap_thermal.
+const char* const kFieldFragment = R"(
+#version 120
+uniform sampler2D u_field;
+varying vec2 v_uv;
+vec3 thermal(float t) {
+  t = clamp(t, 0.0, 1.0);
+  if (t < 0.2) return mix(vec3(0.00, 0.00, 0.07), vec3(0.27, 0.004, 0.43), t / 0.2);
+  if (t < 0.4) return mix(vec3(0.27, 0.004, 0.43), vec3(0.65, 0.12, 0.42), (t - 0.2) / 0.2);
+  if (t < 0.6) return mix(vec3(0.65, 0.12, 0.42), vec3(0.91, 0.35, 0.15), (t - 0.4) / 0.2);
+  if (t < 0.8) return mix(vec3(0.91, 0.35, 0.15), vec3(0.98, 0.72, 0.07), (t - 0.6) / 0.2);
+  return mix(vec3(0.98, 0.72, 0.07), vec3(0.99, 0.99, 0.75), (t - 0.8) / 0.2);
+}
+void main() {
+  gl_FragColor = vec4(thermal(texture2D(u_field, v_uv).r), 1.0);
+}
+)";
+
+bool build(QOpenGLShaderProgram& program, const char* vertex, const char* fragment,
+           const char* attr0, const char* attr1) {
+  if (!program.addShaderFromSourceCode(QOpenGLShader::Vertex, vertex)) return false;
+  if (!program.addShaderFromSourceCode(QOpenGLShader::Fragment, fragment)) return false;
+  program.bindAttributeLocation(attr0, kPosAttr);
+  if (attr1) program.bindAttributeLocation(attr1, kHeatAttr);
+  return program.link();
+}
+
+}  // namespace
+
+View3DRenderer::~View3DRenderer() {
+  if (field_texture_ != 0 && QOpenGLContext::currentContext())
+    glDeleteTextures(1, &field_texture_);
+}
+
+bool View3DRenderer::initialize() {
+  QOpenGLContext* ctx = QOpenGLContext::currentContext();
+  if (!ctx || ctx->isOpenGLES() || ctx->format().majorVersion() < 2) return false;
+  initializeOpenGLFunctions();
+
+  if (!build(particle_program_, kParticleVertex, kParticleFragment, "a_pos", "a_heat")) return false;
+  if (!build(field_program_, kFieldVertex, kFieldFragment, "a_xy", nullptr)) return false;
+
+  if (!particle_vbo_.create() || !quad_vbo_.create()) return false;
+  particle_vbo_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+  static const float quad[8] = {-1.f, -1.f, 1.f, -1.f, -1.f, 1.f, 1.f, 1.f};
+  quad_vbo_.bind();
+  quad_vbo_.allocate(quad, sizeof(quad));
+  quad_vbo_.release();
+
+  glGenTextures(1, &field_texture_);
+  glBindTexture(GL_TEXTURE_2D, field_texture_);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  ready_ = true;
+  return true;
+}
+
+void View3DRenderer::upload_particles(const SimFrame& frame) {
+  if (!ready_) return;
+  const std::size_t n = frame.particle_count();
+  particle_staging_.resize(n * kFloatsPerAtom);
+  float* out = particle_staging_.data();
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    const Real x = frame.pos[0][i], y = frame.pos[1][i], z = frame.pos[2][i];
+    if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z)) continue;
+    const Real vx = frame.vel[0][i], vy = frame.vel[1][i], vz = frame.vel[2][i];
+    const float speed = static_cast<float>(std::sqrt(vx * vx + vy * vy + vz * vz));
+    out[0] = static_cast<float>(x);
+    out[1] = static_cast<float>(y);
+    out[2] = static_cast<float>(z);
+    out[3] = std::min(1.0f, speed / 250.0f);
+    out += kFloatsPerAtom;
+    ++count;
+  }
+  particle_count_ = count;
+  const std::size_t bytes = count * kFloatsPerAtom * sizeof(float);
+  particle_vbo_.bind();
+  if (bytes > particle_capacity_) {
+    particle_capacity_ = bytes + bytes / 2;  // headroom so growth reallocates rarely
+    particle_vbo_.allocate(static_cast<int>(particle_capacity_));
+  }
+  if (bytes > 0) particle_vbo_.write(0, particle_staging_.data(), static_cast<int>(bytes));
+  particle_vbo_.release();
+}
+
+void View3DRenderer::draw_particles(const float center[3], float scale, float point_size) {
+  if (!ready_ || particle_count_ == 0) return;
+  particle_program_.bind();
+  particle_program_.setUniformValue("u_center", QVector3D(center[0], center[1], center[2]));
+  particle_program_.setUniformValue("u_scale", scale);
+  particle_program_.setUniformValue("u_point_size", point_size);
+  particle_vbo_.bind();
+  const int stride = kFloatsPerAtom * static_cast<int>(sizeof(float));
+  particle_program_.enableAttributeArray(kPosAttr);
+  particle_program_.enableAttributeArray(kHeatAttr);
+  particle_program_.setAttributeBuffer(kPosAttr, GL_FLOAT, 0, 3, stride);
+  particle_program_.setAttributeBuffer(kHeatAttr, GL_FLOAT, 3 * static_cast<int>(sizeof(float)), 1, stride);
+  glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+  glEnable(GL_POINT_SPRITE);
+  glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(particle_count_));
+  glDisable(GL_POINT_SPRITE);
+  glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+  particle_program_.disableAttributeArray(kHeatAttr);
+  particle_program_.disableAttributeArray(kPosAttr);
+  particle_vbo_.release();
+  particle_program_.release();
+}
+
+void View3DRenderer::upload_field(const SimFrame& frame) {
+  if (!ready_) return;
+  const std::size_t cells = frame.nx * frame.ny;
+  const Real range = frame.T_hot - frame.T_cold;
+  const Real to_unorm = range > 0 ? 65535.0 / range : 0.0;
+  field_staging_.resize(cells);
+  for (std::size_t k = 0; k < cells; ++k) {
+    const Real t = std::clamp((frame.field[k] - frame.T_cold) * to_unorm, Real(0), Real(65535));
+    field_staging_[k] = static_cast<std::uint16_t>(t + 0.5);
+  }
+  glBindTexture(GL_TEXTURE_2D, field_texture_);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+  const GLsizei w = static_cast<GLsizei>(frame.nx);
+  const GLsizei h = static_cast<GLsizei>(frame.ny);
+  if (frame.nx != texture_nx_ || frame.ny != texture_ny_) {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE16, w, h, 0, GL_LUMINANCE, GL_UNSIGNED_SHORT,
+                 field_staging_.data());
+    texture_nx_ = frame.nx;
+    texture_ny_ = frame.ny;
+  } else {
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_LUMINANCE, GL_UNSIGNED_SHORT,
+                    field_staging_.data());
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void View3DRenderer::draw_field() {
+  if (!ready_ || texture_nx_ == 0) return;
+  field_program_.bind();
+  field_program_.setUniformValue("u_field", 0);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, field_texture_);
+  quad_vbo_.bind();
+  field_program_.enableAttributeArray(kPosAttr);
+  field_program_.setAttributeBuffer(kPosAttr, GL_FLOAT, 0, 2);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  field_program_.disableAttributeArray(kPosAttr);
+  quad_vbo_.release();
+  glBindTexture(GL_TEXTURE_2D, 0);
+  field_program_.release();
+}
+
+}  // namespace matsimu
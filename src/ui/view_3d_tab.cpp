@@ -76,26 +76,14 @@ void View3DTab::set_lattice(const Lattice& lat) {
   }
 }
 
-void View3DTab::set_particles(const ParticleSystem& system) {
+void View3DTab::set_frame(std::shared_ptr<const SimFrame> frame) {
   if (!view_) return;
-  view_->set_particle_system(std::make_shared<ParticleSystem>(system));
+  view_->set_frame(std::move(frame));
 }
 
-void View3DTab::clear_particles() {
+void View3DTab::clear_frame() {
   if (!view_) return;
-  view_->clear_particle_system();
-}
-
-void View3DTab::set_temperature_field(const std::vector<Real>& T,
-                                      std::size_t nx, std::size_t ny,
-                                      Real T_cold, Real T_hot) {
-  if (!view_) return;
-  view_->set_temperature_field(T, nx, ny, T_cold, T_hot);
-}
-
-void View3DTab::clear_temperature_field() {
-  if (!view_) return;
-  view_->clear_temperature_field();
+  view_->clear_frame();
 }
 
 void View3DTab::set_simulation_state(bool running, Real time_s, Real end_time_s, std::size_t step_count) {
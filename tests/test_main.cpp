@@ -5,28 +5,86 @@
 #include <matsimu/core/types.hpp>
 #include <matsimu/core/units.hpp>
 #include <matsimu/io/config.hpp>
+#include <matsimu/io/checkpoint.hpp>
+#include <matsimu/io/potential_table.hpp>
+#include <matsimu/io/run_file.hpp>
+#include <matsimu/io/sweep.hpp>
+#include <matsimu/io/trajectory_writer.hpp>
 #include <matsimu/lattice/lattice.hpp>
 #include <matsimu/sim/simulation.hpp>
 #include <matsimu/sim/heat_diffusion.hpp>
 #include <matsimu/sim/heat_diffusion_2d.hpp>
+#include <matsimu/sim/heat_diffusion_3d.hpp>
+#include <matsimu/sim/heat_stencil.hpp>
+#include <matsimu/sim/frame_exchange.hpp>
+#include <matsimu/sim/simulation_runner.hpp>
+#include <matsimu/sim/ensemble.hpp>
+#include <matsimu/sim/distributed_simulation.hpp>
+#include <matsimu/sim/distributed_heat_2d.hpp>
+#include <matsimu/sim/device_simulation.hpp>
+#include <matsimu/sim/skin_tuner.hpp>
 #include <matsimu/physics/potential.hpp>
+#include <matsimu/physics/neighbor_list.hpp>
+#include <matsimu/physics/simd_lj.hpp>
+#include <matsimu/physics/counter_rng.hpp>
+#include <matsimu/physics/particle_builder.hpp>
+#include <matsimu/physics/spatial_sort.hpp>
 #include <matsimu/physics/thermostat.hpp>
+#include <matsimu/physics/device_force_field.hpp>
+#include <matsimu/parallel/communicator.hpp>
+#include <matsimu/parallel/device.hpp>
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <limits>
+#include <new>
 #include <random>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 #include <array>
+#include <chrono>
+#include <filesystem>
+#ifdef MATSIMU_USE_ZLIB
+#include <zlib.h>
+#endif
 
 #define ASSERT(x) do { if (!(x)) { std::cerr << "FAIL: " << #x << " at " << __FILE__ << ":" << __LINE__ << "\n"; return 1; } } while(0)
 #define ASSERT_EQ(a, b) do { if ((a) != (b)) { std::cerr << "FAIL: " << #a << " == " << #b << " at " << __FILE__ << ":" << __LINE__ << " (" << (a) << " != " << (b) << ")\n"; return 1; } } while(0)
 
 namespace {
 
+/// Temporary directory private to this test run (created on first use,
+/// removed at exit), so concurrent runs do not share scratch files.
+const std::filesystem::path& test_dir() {
+  struct ScratchDir {
+    std::filesystem::path path;
+    ScratchDir() {
+      const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+      path = std::filesystem::temp_directory_path() /
+          ("matsimu_test_" + std::to_string(std::random_device{}()) + "_" + std::to_string(stamp));
+      std::filesystem::create_directories(path);
+    }
+    ~ScratchDir() {
+      std::error_code ignored;
+      std::filesystem::remove_all(path, ignored);
+    }
+  };
+  static const ScratchDir dir;
+  return dir.path;
+}
+
+/// Scratch file `name` in test_dir()
+std::string test_path(const std::string& name) {
+  return (test_dir() / name).string();
+}
+
 int test_param_validation() {
   matsimu::SimulationParams p;
   p.dt = 0;
@@ -257,6 +315,2636 @@ int test_thermal_shock_like_md_smoke() {
   return 0;
 }
 
+int compare_neighbor_builds(const matsimu::ParticleSystem& ps, const matsimu::Lattice* lat) {
+  matsimu::NeighborList cells(1.0e-9, 0.2e-9, matsimu::NeighborBuild::Cells);
+  matsimu::NeighborList brute(1.0e-9, 0.2e-9, matsimu::NeighborBuild::BruteForce);
+  const std::size_t n_cells = cells.build(ps, lat);
+  const std::size_t n_brute = brute.build(ps, lat);
+  ASSERT(n_brute > 0);
+  ASSERT_EQ(n_cells, n_brute);
+  ASSERT_EQ(cells.size(), brute.size());
+  for (std::size_t i = 0; i < ps.size(); ++i) {
+    const auto a = cells.neighbors(i);
+    const auto b = brute.neighbors(i);
+    ASSERT(a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin()));
+  }
+  return 0;
+}
+
+int test_neighbor_build_modes_match() {
+  std::mt19937 rng(7u);
+  std::uniform_real_distribution<matsimu::Real> uni(0.0, 1.0);
+
+  // Triclinic cell wide enough for a 3x3x3 (or larger) grid at rc = 1.2 nm.
+  matsimu::Lattice tri;
+  tri.a1[0] = 5.0e-9; tri.a1[1] = 0.0;    tri.a1[2] = 0.0;
+  tri.a2[0] = 1.2e-9; tri.a2[1] = 4.8e-9; tri.a2[2] = 0.0;
+  tri.a3[0] = 0.7e-9; tri.a3[1] = 0.9e-9; tri.a3[2] = 4.6e-9;
+  matsimu::ParticleSystem ps;
+  for (int k = 0; k < 700; ++k) {
+    matsimu::Real frac[3] = {uni(rng), uni(rng), uni(rng)};
+    matsimu::Particle p;
+    tri.fractional_to_cartesian(frac, p.pos);
+    ps.add_particle(p);
+  }
+  if (compare_neighbor_builds(ps, &tri) != 0) return 1;
+
+  // Orthorhombic box, with some particles slightly outside the primary cell.
+  matsimu::Lattice box;
+  box.a1[0] = 6.0e-9; box.a2[1] = 4.0e-9; box.a3[2] = 5.0e-9;
+  for (std::size_t k = 0; k < ps.size(); ++k) {
+    ps[k].pos[0] = (uni(rng) * 1.1 - 0.05) * 6.0e-9;
+    ps[k].pos[1] = (uni(rng) * 1.1 - 0.05) * 4.0e-9;
+    ps[k].pos[2] = (uni(rng) * 1.1 - 0.05) * 5.0e-9;
+  }
+  if (compare_neighbor_builds(ps, &box) != 0) return 1;
+
+  // Open (non-periodic) boundaries.
+  if (compare_neighbor_builds(ps, nullptr) != 0) return 1;
+  return 0;
+}
+
+int test_neighbor_csr_reuses_storage() {
+  matsimu::Lattice box;
+  box.a1[0] = 4.0e-9; box.a2[1] = 4.0e-9; box.a3[2] = 4.0e-9;
+  matsimu::ParticleSystem ps;
+  std::mt19937 rng(11u);
+  std::uniform_real_distribution<matsimu::Real> uni(0.0, 4.0e-9);
+  for (int k = 0; k < 300; ++k) {
+    matsimu::Particle p;
+    p.pos[0] = uni(rng); p.pos[1] = uni(rng); p.pos[2] = uni(rng);
+    ps.add_particle(p);
+  }
+  matsimu::NeighborList nl(1.0e-9, 0.2e-9);
+  const std::size_t pairs = nl.build(ps, &box);
+  ASSERT(pairs > 0);
+  ASSERT_EQ(nl.offsets().size(), ps.size() + 1);
+  ASSERT_EQ(nl.offsets().back(), pairs);
+  ASSERT_EQ(nl.indices().size(), pairs);
+  const auto* data = nl.indices().data();
+  const auto capacity = nl.indices().capacity();
+  ASSERT_EQ(nl.build(ps, &box), pairs);
+  ASSERT(nl.indices().data() == data);
+  ASSERT_EQ(nl.indices().capacity(), capacity);
+  for (std::size_t i = 0; i < ps.size(); ++i) {
+    for (std::uint32_t j : nl.neighbors(i)) ASSERT(j > i && j < ps.size());
+  }
+  return 0;
+}
+
+int test_config_neighbor_build() {
+  std::string path = "/tmp/matsimu_test_neighbor_build.conf";
+  {
+    std::ofstream f(path);
+    f << "neighbor_build = brute\nprecision = single\n";
+  }
+  matsimu::ConfigResult r = matsimu::load_config(path);
+  ASSERT(r.ok);
+  ASSERT(r.params.neighbor_build == matsimu::NeighborBuild::BruteForce);
+  ASSERT(r.params.precision == matsimu::Precision::Single);
+  {
+    std::ofstream f(path);
+    f << "neighbor_build = octree\n";
+  }
+  r = matsimu::load_config(path);
+  ASSERT(!r.ok);
+  {
+    std::ofstream f(path);
+    f << "precision = half\n";
+  }
+  r = matsimu::load_config(path);
+  std::remove(path.c_str());
+  ASSERT(!r.ok);
+  return 0;
+}
+
+int test_particle_soa_layout() {
+  matsimu::ParticleSystem ps(0, 8 * 8 * sizeof(matsimu::Real));
+  matsimu::Particle p;
+  p.pos[0] = 1.0; p.pos[1] = 2.0; p.pos[2] = 3.0;
+  p.vel[1] = -4.0;
+  p.mass = 2.0;
+  ps.add_particle(p);
+  p.pos[0] = 5.0;
+  ps.add_particle(p);
+  // Proxies read and write the stride-1 arrays.
+  ASSERT_EQ(ps.pos(0)[1], 5.0);
+  ASSERT_EQ(ps[0].pos[2], 3.0);
+  ps[1].add_force(1.0, 0.0, -2.0);
+  ASSERT_EQ(ps.force(0)[1], 1.0);
+  ASSERT_EQ(ps.force(2)[1], -2.0);
+  ps.set_mass(1, 4.0);
+  ASSERT_EQ(ps[1].mass, 4.0);
+  ASSERT_EQ(ps.inverse_masses()[1], 0.25);
+  const matsimu::Particle copy = ps[0];
+  ASSERT_EQ(copy.vel[1], -4.0);
+  ASSERT_EQ(copy.mass, 2.0);
+  // All arrays draw on one shared budget.
+  bool threw = false;
+  try {
+    ps.reserve(1000);
+  } catch (const std::bad_alloc&) {
+    threw = true;
+  }
+  ASSERT(threw);
+  return 0;
+}
+
+int test_particle_builder() {
+  // Bulk append matches add_particle one at a time.
+  const matsimu::Real x[3][2] = {{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}};
+  const matsimu::Real v[3][2] = {{-1.0, 0.5}, {0.0, 2.0}, {7.0, -3.0}};
+  const matsimu::Real m[2] = {2.0, 4.0};
+  const matsimu::Real* pos[3] = {x[0], x[1], x[2]};
+  const matsimu::Real* vel[3] = {v[0], v[1], v[2]};
+  matsimu::ParticleSystem bulk, single;
+  bulk.append(2, pos, vel, m);
+  for (int i = 0; i < 2; ++i) {
+    matsimu::Particle p;
+    for (int d = 0; d < 3; ++d) {
+      p.pos[d] = x[d][i];
+      p.vel[d] = v[d][i];
+    }
+    p.mass = m[i];
+    single.add_particle(p);
+  }
+  ASSERT_EQ(bulk.size(), single.size());
+  for (std::size_t i = 0; i < 2; ++i) {
+    for (int d = 0; d < 3; ++d) {
+      ASSERT_EQ(bulk.pos(d)[i], single.pos(d)[i]);
+      ASSERT_EQ(bulk.vel(d)[i], single.vel(d)[i]);
+      ASSERT_EQ(bulk.force(d)[i], 0.0);
+    }
+    ASSERT_EQ(bulk.inverse_masses()[i], single.inverse_masses()[i]);
+  }
+  // Appending to a reordered system continues the ids; no velocities = at rest.
+  const std::uint32_t swap[2] = {1, 0};
+  bulk.reorder(swap);
+  bulk.append(2, pos, nullptr, 3.0);
+  ASSERT_EQ(bulk.size(), 4u);
+  ASSERT_EQ(bulk.id(0), 1u);
+  ASSERT_EQ(bulk.id(3), 3u);
+  ASSERT_EQ(bulk.vel(2)[3], 0.0);
+  ASSERT_EQ(bulk.masses()[2], 3.0);
+
+  // fcc / bcc replication of a triclinic cell.
+  matsimu::Lattice cell;
+  cell.a1[0] = 0.5e-9;
+  cell.a2[0] = 0.1e-9; cell.a2[1] = 0.5e-9;
+  cell.a3[2] = 0.6e-9;
+  matsimu::CrystalSpec spec;
+  spec.repeats[0] = 3; spec.repeats[1] = 2; spec.repeats[2] = 4;
+  spec.mass = 6.63e-26;
+  matsimu::ParticleSystem fcc;
+  const matsimu::Lattice super = matsimu::fill_crystal(fcc, cell, spec);
+  ASSERT_EQ(fcc.size(), 4u * 3 * 2 * 4);
+  ASSERT(std::fabs(super.volume() - 24.0 * cell.volume()) <= 1e-12 * super.volume());
+  ASSERT_EQ(super.a2[0], 2.0 * cell.a2[0]);
+  // Last atom: cell (2, 1, 3), site (0, 1/2, 1/2).
+  const std::size_t last = fcc.size() - 1;
+  ASSERT(std::fabs(fcc.pos(0)[last] - (2.0 * 0.5e-9 + 1.5 * 0.1e-9)) <= 1e-21);
+  ASSERT(std::fabs(fcc.pos(1)[last] - 1.5 * 0.5e-9) <= 1e-21);
+  ASSERT(std::fabs(fcc.pos(2)[last] - 3.5 * 0.6e-9) <= 1e-21);
+  ASSERT_EQ(fcc.masses()[last], 6.63e-26);
+  // Nearest-neighbor distance of a cubic fcc crystal is a / sqrt(2).
+  matsimu::Lattice cubic;
+  cubic.a1[0] = cubic.a2[1] = cubic.a3[2] = 0.4e-9;
+  spec.repeats[0] = spec.repeats[1] = spec.repeats[2] = 3;
+  matsimu::ParticleSystem ordered;
+  const matsimu::Lattice box = matsimu::fill_crystal(ordered, cubic, spec);
+  matsimu::Real closest = 1.0;
+  for (std::size_t j = 1; j < ordered.size(); ++j) {
+    const matsimu::Real r0[3] = {ordered.pos(0)[0], ordered.pos(1)[0], ordered.pos(2)[0]};
+    const matsimu::Real rj[3] = {ordered.pos(0)[j], ordered.pos(1)[j], ordered.pos(2)[j]};
+    matsimu::Real dr[3];
+    box.min_image_displacement(r0, rj, dr);
+    closest = std::min(closest, std::sqrt(dr[0] * dr[0] + dr[1] * dr[1] + dr[2] * dr[2]));
+  }
+  ASSERT(std::fabs(closest - 0.4e-9 / std::sqrt(2.0)) <= 1e-18);
+  spec.basis = matsimu::CrystalBasis::BCC;
+  matsimu::ParticleSystem bcc;
+  matsimu::fill_crystal(bcc, cubic, spec);
+  ASSERT_EQ(bcc.size(), 2u * 27);
+
+  // Cell-list overlap rejection agrees with a brute-force minimum-image scan,
+  // including across the periodic faces of a skewed box.
+  matsimu::Lattice skew = super;
+  skew.update_cache();
+  const matsimu::Real min_dist = 0.3e-9;
+  matsimu::PlacementGrid grid(skew, min_dist);
+  ASSERT(grid.dims()[0] * grid.dims()[1] * grid.dims()[2] > 1);
+  std::vector<std::array<matsimu::Real, 3>> placed;
+  std::mt19937 rng(11u);
+  std::uniform_real_distribution<matsimu::Real> uni(-0.2, 1.2);
+  int accepted = 0, rejected = 0;
+  for (int k = 0; k < 4000; ++k) {
+    const matsimu::Real f[3] = {uni(rng), uni(rng), uni(rng)};
+    matsimu::Real r[3];
+    skew.fractional_to_cartesian(f, r);
+    bool brute_fits = true;
+    for (const auto& q : placed) {
+      matsimu::Real dr[3];
+      skew.min_image_displacement(q.data(), r, dr);
+      if (dr[0] * dr[0] + dr[1] * dr[1] + dr[2] * dr[2] < min_dist * min_dist) brute_fits = false;
+    }
+    ASSERT_EQ(grid.try_insert(r), brute_fits);
+    if (brute_fits) {
+      placed.push_back({r[0], r[1], r[2]});
+      ++accepted;
+    } else {
+      ++rejected;
+    }
+  }
+  ASSERT(accepted > 20 && rejected > 100);
+  ASSERT_EQ(grid.size(), placed.size());
+  return 0;
+}
+
+// Random periodic LJ system for comparing force paths.
+matsimu::ParticleSystem make_lj_gas(matsimu::Lattice& box, int n) {
+  box.a1[0] = 4.0e-9; box.a2[1] = 4.0e-9; box.a3[2] = 4.0e-9;
+  matsimu::ParticleSystem ps;
+  std::mt19937 rng(5u);
+  std::uniform_real_distribution<matsimu::Real> uni(0.0, 4.0e-9);
+  for (int k = 0; k < n; ++k) {
+    matsimu::Particle p;
+    p.pos[0] = uni(rng); p.pos[1] = uni(rng); p.pos[2] = uni(rng);
+    ps.add_particle(p);
+  }
+  return ps;
+}
+
+int test_parallel_forces_deterministic() {
+  matsimu::Lattice box;
+  matsimu::ParticleSystem serial = make_lj_gas(box, 400);
+  matsimu::ParticleSystem par_a = serial;
+  matsimu::ParticleSystem par_b = serial;
+  auto lj = std::make_shared<matsimu::LennardJones>(1.65e-21, 0.34e-9, 1.0e-9);
+  auto pool = std::make_shared<matsimu::ThreadPool>(4);
+  ASSERT_EQ(pool->size(), std::size_t(4));
+
+  matsimu::NeighborForceField nf_serial(lj, 1.0e-9, 0.2e-9);
+  matsimu::NeighborForceField nf_par(lj, 1.0e-9, 0.2e-9);
+  nf_serial.set_simd_level(matsimu::SimdLevel::Scalar);
+  nf_par.set_simd_level(matsimu::SimdLevel::Scalar);
+  nf_par.set_thread_pool(pool);
+  const matsimu::Real e_serial = nf_serial.compute_forces(serial, &box);
+  const matsimu::Real e_a = nf_par.compute_forces(par_a, &box);
+  const matsimu::Real e_b = nf_par.compute_forces(par_b, &box);
+  ASSERT_EQ(e_a, e_b);
+  ASSERT(std::fabs(e_a - e_serial) <= 1e-12 * std::fabs(e_serial));
+  for (int d = 0; d < 3; ++d) {
+    for (std::size_t i = 0; i < serial.size(); ++i) {
+      ASSERT_EQ(par_a.force(d)[i], par_b.force(d)[i]);
+      const matsimu::Real ref = serial.force(d)[i];
+      ASSERT(std::fabs(par_a.force(d)[i] - ref) <= 1e-9 * (std::fabs(ref) + 1e-15));
+    }
+  }
+
+  // All-pairs ForceField takes the same path.
+  matsimu::ForceField ff(lj);
+  ff.set_thread_pool(pool);
+  const matsimu::Real e_ff = ff.compute_forces(par_a, &box);
+  ASSERT(std::fabs(e_ff - e_serial) <= 1e-12 * std::fabs(e_serial));
+  return 0;
+}
+
+int test_energy_cache_and_energy_free_forces() {
+  matsimu::Lattice box;
+  matsimu::ParticleSystem ps = make_lj_gas(box, 200);
+  auto lj = std::make_shared<matsimu::LennardJones>(1.65e-21, 0.34e-9, 1.0e-9);
+  matsimu::NeighborForceField nf(lj, 1.0e-9, 0.2e-9);
+  nf.set_simd_level(matsimu::SimdLevel::Scalar);
+
+  // Energy-free pass: same forces, no energy.
+  ASSERT_EQ(nf.compute_forces(ps, &box, false), 0.0);
+  std::vector<matsimu::Real> fx(ps.force(0), ps.force(0) + ps.size());
+  const matsimu::Real e = nf.compute_forces(ps, &box);
+  ASSERT(e != 0.0);
+  for (std::size_t i = 0; i < ps.size(); ++i) ASSERT_EQ(ps.force(0)[i], fx[i]);
+
+  // Cache hit returns the stored value; moving a particle invalidates it.
+  const matsimu::ParticleSystem& cps = ps;
+  ASSERT_EQ(nf.compute_energy(cps, &box), e);
+  matsimu::NeighborForceField fresh(lj, 1.0e-9, 0.2e-9);
+  ASSERT(std::fabs(fresh.compute_energy(cps, &box) - e) <= 1e-12 * std::fabs(e));
+  ps.pos(0)[0] += 0.05e-9;
+  const matsimu::Real e_moved = nf.compute_energy(cps, &box);
+  ASSERT(e_moved != e);
+  ASSERT(std::fabs(fresh.compute_energy(cps, &box) - e_moved) <= 1e-12 * std::fabs(e));
+  return 0;
+}
+
+int test_energy_interval() {
+  matsimu::Real epot[2];
+  const std::size_t intervals[2] = {1, 0};
+  for (int k = 0; k < 2; ++k) {
+    matsimu::SimulationParams p;
+    p.dt = 1e-15;
+    p.energy_interval = intervals[k];
+    p.precision = matsimu::Precision::Double;  // compute_energy always sums in Real
+    auto lj = std::make_shared<matsimu::LennardJones>(1.65e-21, 0.34e-9, 1.0e-9);
+    matsimu::Simulation sim(p, lj);
+    ASSERT(sim.is_valid());
+    matsimu::Lattice box;
+    sim.system() = make_lj_gas(box, 100);
+    box.update_cache();
+    sim.set_lattice(box);
+    sim.initialize();
+    for (int s = 0; s < 5; ++s) ASSERT(sim.step());
+    epot[k] = sim.potential_energy();
+  }
+  ASSERT(std::fabs(epot[0] - epot[1]) <= 1e-12 * std::fabs(epot[0]));
+
+  std::string path = "/tmp/matsimu_test_energy_interval.conf";
+  {
+    std::ofstream f(path);
+    f << "energy_interval = 0\n";
+  }
+  matsimu::ConfigResult r = matsimu::load_config(path);
+  std::remove(path.c_str());
+  ASSERT(r.ok);
+  ASSERT_EQ(r.params.energy_interval, std::size_t(0));
+  return 0;
+}
+
+int test_heat2d_tiled_matches_reference() {
+  // Wider than one tile and not a multiple of the vector width.
+  matsimu::HeatDiffusion2DParams p;
+  p.precision = matsimu::Precision::Double;
+  p.nx = matsimu::kHeatTileCols + 77;
+  p.ny = 37;
+  p.hot_radius_frac = 0.2;
+  p.dt = 0.9 * p.stability_limit();
+  p.num_threads = 3;
+  matsimu::HeatDiffusion2DModel par(p);
+  p.num_threads = 1;
+  matsimu::HeatDiffusion2DModel serial(p);
+  serial.set_simd_level(matsimu::SimdLevel::Scalar);
+  ASSERT(par.is_valid());
+  ASSERT(serial.is_valid());
+
+  // Reference: the plain double loop plus a separate boundary pass.
+  const std::size_t nx = p.nx, ny = p.ny;
+  const matsimu::Real r = p.alpha * p.dt / (p.dx * p.dx);
+  std::vector<matsimu::Real> T(serial.temperature().begin(), serial.temperature().end());
+  std::vector<matsimu::Real> Tn(T.size());
+  for (int step = 0; step < 25; ++step) {
+    for (std::size_t j = 1; j + 1 < ny; ++j)
+      for (std::size_t i = 1; i + 1 < nx; ++i) {
+        const std::size_t k = j * nx + i;
+        Tn[k] = T[k] + r * (T[k - 1] + T[k + 1] + T[k - nx] + T[k + nx] - 4.0 * T[k]);
+      }
+    for (std::size_t i = 0; i < nx; ++i) Tn[i] = Tn[(ny - 1) * nx + i] = p.T_boundary;
+    for (std::size_t j = 0; j < ny; ++j) Tn[j * nx] = Tn[j * nx + nx - 1] = p.T_boundary;
+    std::swap(T, Tn);
+    ASSERT(par.step());
+    ASSERT(serial.step());
+  }
+  for (std::size_t k = 0; k < T.size(); ++k) {
+    ASSERT_EQ(serial.temperature()[k], T[k]);
+    ASSERT_EQ(par.temperature()[k], T[k]);
+  }
+
+  p.num_threads = 0;
+  ASSERT(p.validate().has_value());
+  return 0;
+}
+
+int test_heat_advance_matches_steps() {
+  // 2D: fused passes (several depths, serial and threaded) vs single steps.
+  matsimu::HeatDiffusion2DParams p;
+  p.precision = matsimu::Precision::Double;
+  p.nx = 70;
+  p.ny = 45;
+  p.hot_radius_frac = 0.2;
+  p.dt = 0.9 * p.stability_limit();
+  p.max_steps = 40;
+  matsimu::HeatDiffusion2DModel ref(p);
+  for (int s = 0; s < 40; ++s) ASSERT(ref.step());
+  ASSERT(!ref.step());
+  for (std::size_t threads : {std::size_t(1), std::size_t(3)}) {
+    p.num_threads = threads;
+    matsimu::HeatDiffusion2DModel fused(p);
+    ASSERT_EQ(fused.advance(3), std::size_t(3));
+    ASSERT_EQ(fused.advance(7), std::size_t(7));
+    ASSERT_EQ(fused.advance(100), std::size_t(30));  // stops at max_steps
+    ASSERT_EQ(fused.advance(5), std::size_t(0));
+    ASSERT_EQ(fused.step_count(), ref.step_count());
+    ASSERT_EQ(fused.time(), ref.time());
+    for (std::size_t k = 0; k < ref.temperature().size(); ++k)
+      ASSERT_EQ(fused.temperature()[k], ref.temperature()[k]);
+  }
+
+  // The model skips fusion for cache-resident grids; drive the wavefront
+  // directly at several depths, serial and banded.
+  matsimu::HeatDiffusion2DModel init(p);
+  const std::size_t nx = p.nx, ny = p.ny;
+  const matsimu::Real r = p.alpha * p.dt / (p.dx * p.dx);
+  const std::vector<matsimu::Real> T0(init.temperature().begin(), init.temperature().end());
+  matsimu::ThreadPool pool(3);
+  for (std::size_t k : {std::size_t(2), std::size_t(5), std::size_t(16)}) {
+    std::vector<matsimu::Real> a = T0, b(T0.size());
+    for (std::size_t s = 0; s < k; ++s) {
+      matsimu::heat_step_2d(a.data(), b.data(), nx, ny, r, p.T_boundary, nullptr,
+                            matsimu::SimdLevel::Scalar);
+      std::swap(a, b);
+    }
+    for (matsimu::ThreadPool* tp : {static_cast<matsimu::ThreadPool*>(nullptr), &pool}) {
+      std::vector<matsimu::Real> out(T0.size(), -1.0);
+      std::vector<matsimu::Real> scratch(matsimu::heat_scratch_size_2d(nx, k, 3));
+      matsimu::heat_advance_2d(T0.data(), out.data(), nx, ny, r, p.T_boundary, k,
+                               scratch.data(), tp, matsimu::detect_simd_level());
+      for (std::size_t c = 0; c < out.size(); ++c) ASSERT_EQ(out[c], a[c]);
+    }
+  }
+
+  // 1D: rod spanning several tiles, depth not a multiple of the block.
+  matsimu::HeatDiffusionParams q;
+  q.n_cells = 2 * matsimu::kHeatTileCols + 13;
+  q.dt = 0.9 * q.stability_limit();
+  q.end_time = 100.0;
+  matsimu::HeatDiffusionModel ref1(q);
+  matsimu::HeatDiffusionModel fused1(q);
+  for (int s = 0; s < 45; ++s) ASSERT(ref1.step());
+  ASSERT_EQ(fused1.advance(45), std::size_t(45));
+  ASSERT_EQ(fused1.time(), ref1.time());
+  for (std::size_t k = 0; k < q.n_cells; ++k)
+    ASSERT_EQ(fused1.temperature()[k], ref1.temperature()[k]);
+  return 0;
+}
+
+// Sum of squared deviations from T_boundary (never increases under CN/ADI).
+template <typename Field>
+double deviation_l2(const Field& T, double Tb) {
+  double sum = 0.0;
+  for (double t : T) sum += (t - Tb) * (t - Tb);
+  return sum;
+}
+
+int test_heat_implicit_schemes() {
+  // Dt far above the explicit cap is rejected for Explicit only.
+  matsimu::HeatDiffusion2DParams p;
+  p.precision = matsimu::Precision::Double;
+  p.nx = 48;
+  p.ny = 40;
+  p.hot_radius_frac = 0.15;
+  p.dt = 1000.0 * p.stability_limit();
+  ASSERT(p.validate().has_value());
+  p.scheme = matsimu::HeatScheme::Implicit;
+  ASSERT(!p.validate().has_value());
+
+  // Large steps stay finite, decay monotonically, and do not depend on threads.
+  matsimu::HeatDiffusion2DModel serial(p);
+  p.num_threads = 3;
+  matsimu::HeatDiffusion2DModel par(p);
+  ASSERT(serial.is_valid());
+  double prev = deviation_l2(serial.temperature(), p.T_boundary);
+  for (int s = 0; s < 20; ++s) {
+    ASSERT(serial.step());
+    ASSERT_EQ(par.advance(1), std::size_t(1));
+    const double dev = deviation_l2(serial.temperature(), p.T_boundary);
+    ASSERT(std::isfinite(dev));
+    ASSERT(dev <= prev);
+    prev = dev;
+  }
+  for (std::size_t k = 0; k < serial.temperature().size(); ++k)
+    ASSERT_EQ(par.temperature()[k], serial.temperature()[k]);
+
+  // Same physics as explicit at matching end time.
+  matsimu::HeatDiffusion2DParams e = p;
+  e.scheme = matsimu::HeatScheme::Explicit;
+  e.num_threads = 1;
+  e.dt = 0.2 * e.stability_limit();
+  matsimu::HeatDiffusion2DParams im = e;
+  im.scheme = matsimu::HeatScheme::Implicit;
+  im.dt = 4.0 * e.dt;
+  matsimu::HeatDiffusion2DModel me(e), mi(im);
+  ASSERT_EQ(me.advance(400), std::size_t(400));
+  ASSERT_EQ(mi.advance(100), std::size_t(100));
+  for (std::size_t k = 0; k < me.temperature().size(); ++k)
+    ASSERT(std::fabs(me.temperature()[k] - mi.temperature()[k]) < 0.005 * (e.T_hot - e.T_boundary));
+
+  // 1D Crank–Nicolson vs explicit.
+  matsimu::HeatDiffusionParams q;
+  q.n_cells = 60;
+  q.end_time = 100.0;
+  q.dt = 0.2 * q.stability_limit();
+  matsimu::HeatDiffusionParams qi = q;
+  qi.scheme = matsimu::HeatScheme::Implicit;
+  qi.dt = 4.0 * q.dt;
+  matsimu::HeatDiffusionModel he(q), hi(qi);
+  ASSERT_EQ(he.advance(800), std::size_t(800));
+  ASSERT_EQ(hi.advance(200), std::size_t(200));
+  for (std::size_t k = 0; k < q.n_cells; ++k)
+    ASSERT(std::fabs(he.temperature()[k] - hi.temperature()[k]) < 1.5);
+  qi.dt = 1e4 * q.stability_limit();
+  ASSERT(!qi.validate().has_value());
+  return 0;
+}
+
+int test_heat3d_matches_reference() {
+  matsimu::HeatDiffusion3DParams p;
+  p.nx = 37;  // padded pitch, several tiles in y
+  p.ny = 2 * matsimu::kHeatTileRows3D + 5;
+  p.nz = 11;
+  p.hot_radius_frac = 0.25;
+  p.dt = 0.9 * p.stability_limit();
+  p.num_threads = 3;
+  matsimu::HeatDiffusion3DModel par(p);
+  p.num_threads = 1;
+  matsimu::HeatDiffusion3DModel serial(p);
+  serial.set_simd_level(matsimu::SimdLevel::Scalar);
+  ASSERT(par.is_valid());
+  ASSERT(serial.is_valid());
+  const matsimu::HeatGrid3D& g = serial.grid();
+  ASSERT(g.pitch >= g.nx && g.pitch % 8 == 0);
+
+  // Reference on an unpadded copy.
+  const std::size_t nx = p.nx, ny = p.ny, nz = p.nz;
+  auto at = [&](std::size_t i, std::size_t j, std::size_t k) { return (k * ny + j) * nx + i; };
+  std::vector<matsimu::Real> T(nx * ny * nz), Tn(T.size());
+  for (std::size_t k = 0; k < nz; ++k)
+    for (std::size_t j = 0; j < ny; ++j)
+      for (std::size_t i = 0; i < nx; ++i) T[at(i, j, k)] = serial.temperature(i, j, k);
+  const matsimu::Real r = p.alpha * p.dt / (p.dx * p.dx);
+  for (int step = 0; step < 15; ++step) {
+    for (std::size_t k = 0; k < nz; ++k)
+      for (std::size_t j = 0; j < ny; ++j)
+        for (std::size_t i = 0; i < nx; ++i) {
+          const std::size_t c = at(i, j, k);
+          if (i == 0 || j == 0 || k == 0 || i == nx - 1 || j == ny - 1 || k == nz - 1) {
+            Tn[c] = p.T_boundary;
+            continue;
+          }
+          Tn[c] = T[c] + r * (T[c - 1] + T[c + 1] + T[c - nx] + T[c + nx] + T[c - nx * ny] +
+                              T[c + nx * ny] - 6.0 * T[c]);
+        }
+    std::swap(T, Tn);
+    ASSERT(serial.step());
+    ASSERT(par.step());
+  }
+  for (std::size_t k = 0; k < nz; ++k)
+    for (std::size_t j = 0; j < ny; ++j)
+      for (std::size_t i = 0; i < nx; ++i) {
+        ASSERT_EQ(serial.temperature(i, j, k), T[at(i, j, k)]);
+        ASSERT_EQ(par.temperature(i, j, k), T[at(i, j, k)]);
+      }
+
+  // Through Simulation; too-small budget is reported, not thrown.
+  matsimu::Simulation sim(p);
+  ASSERT(sim.is_valid());
+  ASSERT(sim.mode() == matsimu::SimMode::HeatDiffusion3D);
+  ASSERT(sim.heat_3d_model() != nullptr);
+  ASSERT(sim.heat_2d_model() == nullptr);
+  ASSERT_EQ(sim.advance(3), std::size_t(3));
+  matsimu::HeatDiffusion3DModel tiny(p, 1024);
+  ASSERT(!tiny.is_valid());
+  ASSERT(!tiny.error_message().empty());
+  matsimu::HeatDiffusion3DParams huge = p;
+  huge.ny = std::numeric_limits<std::size_t>::max() / 8 + 2;  // ny * pitch wraps
+  matsimu::HeatDiffusion3DModel wrapped(huge);
+  ASSERT(!wrapped.is_valid());
+  p.dt = 2.0 * p.stability_limit();
+  ASSERT(p.validate().has_value());
+  return 0;
+}
+
+int test_config_num_threads() {
+  std::string path = "/tmp/matsimu_test_num_threads.conf";
+  {
+    std::ofstream f(path);
+    f << "num_threads = 8\n";
+  }
+  matsimu::ConfigResult r = matsimu::load_config(path);
+  ASSERT(r.ok);
+  ASSERT_EQ(r.params.num_threads, std::size_t(8));
+  {
+    std::ofstream f(path);
+    f << "num_threads = 0\n";
+  }
+  r = matsimu::load_config(path);
+  std::remove(path.c_str());
+  ASSERT(!r.ok);
+  return 0;
+}
+
+int test_pair_force_direction() {
+  // Inside sigma the pair repels; near the cutoff it attracts (every force path).
+  const matsimu::Real sigma = 3.405e-10;
+  for (int path = 0; path < 3; ++path) {
+    for (matsimu::Real sep : {0.9 * sigma, 1.5 * sigma}) {
+      matsimu::SimulationParams p;
+      p.use_neighbor_list = path != 0;
+      p.num_threads = path == 2 ? 2 : 1;
+      p.precision = matsimu::Precision::Double;
+      matsimu::Simulation sim(p, std::make_shared<matsimu::LennardJones>(1.654e-21, sigma, 1.0e-9));
+      matsimu::Particle a;
+      a.mass = 6.63e-26;
+      a.pos[0] = a.pos[1] = a.pos[2] = 1.0e-9;
+      sim.system().add_particle(a);
+      a.pos[0] += sep;
+      sim.system().add_particle(a);
+      sim.initialize();
+      const matsimu::Real f0 = sim.system().force(0)[0];
+      ASSERT(sep < sigma ? f0 < 0.0 : f0 > 0.0);
+      ASSERT_EQ(sim.system().force(0)[0], -sim.system().force(0)[1]);
+    }
+  }
+  return 0;
+}
+
+// LJ seen only through the virtual interface (no fused kernel).
+class OpaqueLJ : public matsimu::Potential {
+public:
+  explicit OpaqueLJ(const matsimu::LennardJones& lj) : lj_(lj) {}
+  matsimu::Real energy(matsimu::Real r2) const override { return lj_.energy(r2); }
+  matsimu::Real force_div_r(matsimu::Real r2) const override { return lj_.force_div_r(r2); }
+  matsimu::Real cutoff_squared() const override { return lj_.cutoff_squared(); }
+
+private:
+  matsimu::LennardJones lj_;
+};
+
+int test_fused_pair_kernel_matches_virtual() {
+  const matsimu::LennardJones lj(1.65e-21, 0.34e-9, 1.0e-9);
+  for (matsimu::Real r = 0.3e-9; r < 1.1e-9; r += 0.01e-9) {
+    matsimu::Real e, f;
+    lj.energy_and_force(r * r, e, f);
+    ASSERT_EQ(e, lj.energy(r * r));
+    ASSERT_EQ(f, lj.force_div_r(r * r));
+  }
+  const matsimu::HarmonicPotential spring(10.0, 0.5e-9, 1.0e-9);
+  for (matsimu::Real r = 0.0; r < 1.1e-9; r += 0.05e-9) {
+    matsimu::Real e, f;
+    spring.energy_and_force(r * r, e, f);
+    ASSERT_EQ(e, spring.energy(r * r));
+    ASSERT_EQ(f, spring.force_div_r(r * r));
+  }
+
+  // Specialized LJ kernel and the virtual fallback give the same forces.
+  matsimu::Lattice box;
+  matsimu::ParticleSystem fused = make_lj_gas(box, 200);
+  matsimu::ParticleSystem virt = fused;
+  matsimu::NeighborForceField nf_fused(std::make_shared<matsimu::LennardJones>(lj), 1.0e-9, 0.2e-9);
+  matsimu::NeighborForceField nf_virt(std::make_shared<OpaqueLJ>(lj), 1.0e-9, 0.2e-9);
+  nf_fused.set_simd_level(matsimu::SimdLevel::Scalar);
+  ASSERT_EQ(nf_fused.compute_forces(fused, &box), nf_virt.compute_forces(virt, &box));
+  for (int d = 0; d < 3; ++d)
+    for (std::size_t i = 0; i < fused.size(); ++i)
+      ASSERT_EQ(fused.force(d)[i], virt.force(d)[i]);
+  return 0;
+}
+
+int test_simd_lj_matches_scalar() {
+  const matsimu::SimdLevel best = matsimu::detect_simd_level();
+  auto lj = std::make_shared<matsimu::LennardJones>(1.65e-21, 0.34e-9, 1.0e-9);
+  matsimu::Lattice box;
+  const matsimu::ParticleSystem gas = make_lj_gas(box, 400);
+  matsimu::Lattice skewed = box;
+  skewed.a2[0] = 1.0e-9;
+  matsimu::SimdBox sbox;
+  ASSERT(!matsimu::make_simd_box(&skewed, sbox));
+
+  for (const matsimu::Lattice* lat : {static_cast<const matsimu::Lattice*>(&box),
+                                      static_cast<const matsimu::Lattice*>(nullptr)}) {
+    matsimu::ParticleSystem ref = gas;
+    matsimu::NeighborForceField nf_ref(lj, 1.0e-9, 0.2e-9);
+    nf_ref.set_simd_level(matsimu::SimdLevel::Scalar);
+    const matsimu::Real e_ref = nf_ref.compute_forces(ref, lat);
+    ASSERT(e_ref != 0.0);
+    for (matsimu::SimdLevel level : {matsimu::SimdLevel::AVX2, matsimu::SimdLevel::AVX512}) {
+      if (level > best) continue;
+      matsimu::ParticleSystem vec = gas;
+      matsimu::NeighborForceField nf_vec(lj, 1.0e-9, 0.2e-9);
+      nf_vec.set_simd_level(level);
+      nf_vec.set_precision(matsimu::Precision::Double);
+      ASSERT(nf_vec.simd_level() == level);
+      const matsimu::Real e_vec = nf_vec.compute_forces(vec, lat);
+      ASSERT(std::fabs(e_vec - e_ref) <= 1e-12 * std::fabs(e_ref));
+      for (int d = 0; d < 3; ++d) {
+        for (std::size_t i = 0; i < ref.size(); ++i) {
+          const matsimu::Real f = ref.force(d)[i];
+          ASSERT(std::fabs(vec.force(d)[i] - f) <= 1e-10 * (std::fabs(f) + 1e-15));
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+// Mixed precision against the double kernels (Precision::Single). Measured
+// on an AVX-512 host: LJ force RMS error 6e-7 of the RMS force and energy
+// 6e-7 relative on a random gas (AVX2 and AVX-512 agree); 2D heat max
+// deviation 3e-7 of the hot-cold range after 400 steps. The bounds below
+// leave ~10x margin.
+int test_precision_accuracy() {
+  const matsimu::SimdLevel best = matsimu::detect_simd_level();
+  auto lj = std::make_shared<matsimu::LennardJones>(1.65e-21, 0.34e-9, 1.0e-9);
+  matsimu::Lattice box;
+  const matsimu::ParticleSystem gas = make_lj_gas(box, 400);
+  matsimu::ParticleSystem ref = gas;
+  matsimu::NeighborForceField nf_ref(lj, 1.0e-9, 0.2e-9);
+  nf_ref.set_precision(matsimu::Precision::Double);
+  const matsimu::Real e_ref = nf_ref.compute_forces(ref, &box);
+  for (matsimu::SimdLevel level : {matsimu::SimdLevel::AVX2, matsimu::SimdLevel::AVX512}) {
+    if (level > best) continue;
+    matsimu::ParticleSystem fp32 = gas;
+    matsimu::NeighborForceField nf(lj, 1.0e-9, 0.2e-9);
+    nf.set_simd_level(level);
+    nf.set_precision(matsimu::Precision::Single);
+    ASSERT(nf.precision() == matsimu::Precision::Single);
+    const matsimu::Real e = nf.compute_forces(fp32, &box);
+    double err2 = 0.0, ref2 = 0.0;
+    for (int d = 0; d < 3; ++d) {
+      for (std::size_t i = 0; i < ref.size(); ++i) {
+        const double diff = fp32.force(d)[i] - ref.force(d)[i];
+        err2 += diff * diff;
+        ref2 += ref.force(d)[i] * ref.force(d)[i];
+      }
+    }
+    ASSERT(std::sqrt(err2 / ref2) < 5e-6);
+    ASSERT(std::fabs(e - e_ref) < 5e-6 * std::fabs(e_ref));
+  }
+
+  matsimu::HeatDiffusion2DParams p;
+  p.nx = 203;
+  p.ny = 67;
+  p.end_time = 1e3;
+  p.precision = matsimu::Precision::Double;
+  matsimu::HeatDiffusion2DModel dbl(p);
+  p.precision = matsimu::Precision::Single;
+  matsimu::HeatDiffusion2DModel sgl(p);
+  matsimu::HeatDiffusion2DModel sgl_scalar(p);
+  sgl_scalar.set_simd_level(matsimu::SimdLevel::Scalar);
+  ASSERT(sgl.is_valid());
+  for (int s = 0; s < 400; ++s) {
+    ASSERT(dbl.step());
+    ASSERT(sgl.step());
+    ASSERT(sgl_scalar.step());
+  }
+  double max_dev = 0.0;
+  for (std::size_t k = 0; k < dbl.temperature().size(); ++k) {
+    max_dev = std::max(max_dev, std::fabs(sgl.temperature()[k] - dbl.temperature()[k]));
+    ASSERT_EQ(sgl.temperature()[k], sgl_scalar.temperature()[k]);
+  }
+  max_dev /= p.T_hot - p.T_boundary;
+  ASSERT(max_dev < 5e-6);
+
+  p.scheme = matsimu::HeatScheme::Implicit;
+  ASSERT(p.validate().has_value());
+  return 0;
+}
+
+int test_checkpoint_restart() {
+  const std::string path = test_path("checkpoint.bin");
+  auto lj = std::make_shared<matsimu::LennardJones>(1.65e-21, 0.34e-9, 1.0e-9);
+  matsimu::SimulationParams p;
+  p.dt = 1e-15;
+  p.use_neighbor_list = false;  // all-pairs order is position independent: bit-exact restart
+  auto make_md = [&](unsigned seed) {
+    auto sim = std::make_unique<matsimu::Simulation>(p, lj);
+    sim->set_thermostat(std::make_shared<matsimu::AndersenThermostat>(300.0, 1e13, seed));
+    return sim;
+  };
+
+  auto run = make_md(7);
+  matsimu::Lattice box;
+  run->system() = make_lj_gas(box, 60);
+  for (std::size_t i = 0; i < run->system().size(); ++i) run->system().set_mass(i, 6.6e-26);
+  run->set_lattice(box);
+  run->initialize();
+  for (int s = 0; s < 5; ++s) ASSERT(run->step());
+  matsimu::CheckpointResult r = matsimu::save_checkpoint(*run, path);
+  ASSERT(r.ok);
+  for (int s = 0; s < 5; ++s) ASSERT(run->step());
+
+  auto restored = make_md(99);  // different seed: the RNG state comes from the file
+  r = matsimu::load_checkpoint(*restored, path);
+  ASSERT(r.ok);
+  ASSERT_EQ(restored->step_count(), std::size_t(5));
+  ASSERT_EQ(restored->lattice()->a1[0], box.a1[0]);
+  for (int s = 0; s < 5; ++s) ASSERT(restored->step());
+  ASSERT_EQ(restored->time(), run->time());
+  ASSERT_EQ(restored->system().size(), run->system().size());
+  for (int d = 0; d < 3; ++d) {
+    for (std::size_t i = 0; i < run->system().size(); ++i) {
+      ASSERT_EQ(restored->system().pos(d)[i], run->system().pos(d)[i]);
+      ASSERT_EQ(restored->system().vel(d)[i], run->system().vel(d)[i]);
+    }
+  }
+
+  // Particles over the restoring simulation's budget are reported, not thrown.
+  p.max_bytes = 1024;
+  r = matsimu::load_checkpoint(*make_md(7), path);
+  ASSERT(!r.ok && !r.error.empty());
+
+  // Heat fields; a model built from other params is rejected.
+  matsimu::HeatDiffusion2DParams hp;
+  hp.nx = 33;
+  hp.ny = 21;
+  hp.precision = matsimu::Precision::Single;
+  matsimu::Simulation heat(hp);
+  ASSERT(heat.advance(7) == 7);
+  ASSERT(matsimu::save_checkpoint(heat, path).ok);
+  ASSERT(heat.advance(4) == 4);
+  matsimu::Simulation heat_back(hp);
+  ASSERT(matsimu::load_checkpoint(heat_back, path).ok);
+  ASSERT(heat_back.advance(4) == 4);
+  ASSERT_EQ(heat_back.step_count(), heat.step_count());
+  for (std::size_t k = 0; k < heat.heat_2d_model()->temperature().size(); ++k)
+    ASSERT_EQ(heat_back.heat_2d_model()->temperature()[k], heat.heat_2d_model()->temperature()[k]);
+  hp.nx = 34;
+  matsimu::Simulation other(hp);
+  ASSERT(!matsimu::load_checkpoint(other, path).ok);
+  ASSERT(!matsimu::load_checkpoint(*restored, path).ok);  // mode mismatch
+
+  {
+    std::ofstream f(path, std::ios::binary);
+    f << "not a checkpoint at all, just text";
+  }
+  r = matsimu::load_checkpoint(other, path);
+  ASSERT(!r.ok && !r.error.empty());
+  std::remove(path.c_str());
+  ASSERT(!matsimu::load_checkpoint(other, path).ok);
+  return 0;
+}
+
+int test_trajectory_writer() {
+  const std::string bin_path = "/tmp/matsimu_test_traj.bin";
+  const std::string xyz_path = "/tmp/matsimu_test_traj.xyz";
+  auto lj = std::make_shared<matsimu::LennardJones>(1.65e-21, 0.34e-9, 1.0e-9);
+  matsimu::SimulationParams p;
+  p.dt = 1e-15;
+  matsimu::Simulation sim(p, lj);
+  matsimu::Lattice box;
+  sim.system() = make_lj_gas(box, 20);
+  for (std::size_t i = 0; i < sim.system().size(); ++i) sim.system().set_mass(i, 6.6e-26);
+  sim.set_lattice(box);
+  sim.initialize();
+
+  matsimu::TrajectoryOptions bin_opts;
+  bin_opts.stride = 3;
+  bin_opts.queue_depth = 2;
+  matsimu::TrajectoryOptions xyz_opts = bin_opts;
+  xyz_opts.format = matsimu::TrajectoryFormat::XYZ;
+  matsimu::TrajectoryWriter bin(bin_path, bin_opts);
+  matsimu::TrajectoryWriter xyz(xyz_path, xyz_opts);
+  ASSERT(bin.is_open() && xyz.is_open());
+  sim.set_step_callback([&](const matsimu::Simulation& s) { bin.on_step(s); xyz.on_step(s); });
+  for (int s = 0; s < 10; ++s) ASSERT(sim.step());  // frames at steps 3, 6, 9
+  ASSERT(bin.close() && xyz.close());
+  ASSERT_EQ(bin.frames_written(), std::size_t(3));
+  ASSERT_EQ(xyz.frames_written(), std::size_t(3));
+
+  // Binary: header, then the last frame must equal the positions after step 9.
+  const std::size_t n = sim.system().size();
+  std::ifstream f(bin_path, std::ios::binary);
+  char magic[8];
+  std::uint32_t version = 0, real_bytes = 0;
+  std::uint64_t atoms = 0;
+  f.read(magic, 8);
+  f.read(reinterpret_cast<char*>(&version), 4);
+  f.read(reinterpret_cast<char*>(&real_bytes), 4);
+  f.read(reinterpret_cast<char*>(&atoms), 8);
+  ASSERT(std::equal(magic, magic + 8, matsimu::kTrajectoryMagic));
+  ASSERT_EQ(version, matsimu::kTrajectoryVersion);
+  ASSERT_EQ(real_bytes, std::uint32_t(sizeof(matsimu::Real)));
+  ASSERT_EQ(atoms, std::uint64_t(n));
+  const std::size_t frame_reals = 1 + 9 + 3 * n;
+  std::vector<matsimu::Real> frame(frame_reals);
+  std::uint64_t step = 0;
+  for (std::uint64_t expect : {3u, 6u, 9u}) {
+    f.read(reinterpret_cast<char*>(&step), 8);
+    f.read(reinterpret_cast<char*>(frame.data()), frame_reals * sizeof(matsimu::Real));
+    ASSERT(f.good());
+    ASSERT_EQ(step, expect);
+  }
+  f.peek();
+  ASSERT(f.eof());
+  ASSERT_EQ(frame[1], box.a1[0]);
+  // Rerun deterministically to the last written step and compare.
+  matsimu::Simulation again(p, lj);
+  matsimu::Lattice box2;
+  again.system() = make_lj_gas(box2, 20);
+  for (std::size_t i = 0; i < again.system().size(); ++i) again.system().set_mass(i, 6.6e-26);
+  again.set_lattice(box2);
+  again.initialize();
+  for (int s = 0; s < 9; ++s) ASSERT(again.step());
+  for (std::size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(frame[10 + i], again.system().pos(0)[i]);
+    ASSERT_EQ(frame[10 + 2 * n + i], again.system().pos(2)[i]);
+  }
+
+  // XYZ: three frames of n atom lines, in angstrom.
+  std::ifstream t(xyz_path);
+  std::size_t count = 0, frames = 0;
+  std::string line;
+  double last_x = 0;
+  while (t >> count) {
+    ASSERT_EQ(count, n);
+    std::getline(t, line);
+    std::getline(t, line);
+    ASSERT(line.find("Lattice=") != std::string::npos);
+    std::string sym;
+    double x = 0, y = 0, z = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      t >> sym >> x >> y >> z;
+      ASSERT_EQ(sym, std::string("Ar"));
+    }
+    last_x = x;
+    ++frames;
+  }
+  ASSERT_EQ(frames, std::size_t(3));
+  ASSERT(std::fabs(last_x - again.system().pos(0)[n - 1] * 1e10) < 1e-6);
+
+  matsimu::TrajectoryOptions bad;
+  bad.stride = 0;
+  ASSERT(bad.validate().has_value());
+  bad.stride = 1;
+  bad.queue_depth = 1;
+  ASSERT(bad.validate().has_value());
+  matsimu::TrajectoryWriter nowhere("/nonexistent-dir/traj.bin", {});
+  ASSERT(!nowhere.is_open() && !nowhere.error_message().empty());
+  matsimu::TrajectoryOptions gz;
+  gz.compress = true;
+#ifdef MATSIMU_USE_ZLIB
+  {
+    matsimu::TrajectoryWriter zw(bin_path, gz);
+    zw.submit(sim);
+    ASSERT(zw.close() && zw.frames_written() == 1);
+  }
+  gzFile zf = gzopen(bin_path.c_str(), "rb");
+  ASSERT(zf != nullptr);
+  char zmagic[8] = {};
+  ASSERT_EQ(gzread(zf, zmagic, 8), 8);
+  gzclose(zf);
+  ASSERT(std::equal(zmagic, zmagic + 8, matsimu::kTrajectoryMagic));
+#else
+  ASSERT(gz.validate().has_value());
+#endif
+  std::remove(bin_path.c_str());
+  std::remove(xyz_path.c_str());
+  return 0;
+}
+
+int test_frame_exchange() {
+  matsimu::HeatDiffusion2DParams hp;
+  hp.nx = 17;
+  hp.ny = 9;
+  matsimu::Simulation heat(hp);
+  matsimu::FrameExchange frames;
+  ASSERT(frames.latest() == nullptr);
+
+  // Steady state: one frame published, one held by the reader, one free.
+  std::shared_ptr<const matsimu::SimFrame> held;
+  const matsimu::Real* first_data = nullptr;
+  for (int tick = 0; tick < 12; ++tick) {
+    ASSERT(heat.advance(2) == 2);
+    matsimu::SimFrame& f = frames.begin_write();
+    matsimu::capture_frame(heat, f);
+    frames.publish();
+    held = frames.latest();
+    if (tick == 0) first_data = held->field.data();
+  }
+  ASSERT_EQ(frames.buffers(), std::size_t(3));
+  ASSERT_EQ(frames.generation(), std::uint64_t(12));
+  ASSERT(held->kind == matsimu::SimFrame::Kind::Field2D);
+  ASSERT_EQ(held->step, heat.step_count());
+  ASSERT_EQ(held->nx, std::size_t(17));
+  const auto& T = heat.heat_2d_model()->temperature();
+  ASSERT_EQ(held->field.size(), T.size());
+  for (std::size_t k = 0; k < T.size(); ++k) ASSERT_EQ(held->field[k], T[k]);
+  // Buffers are recycled, not reallocated: frame 0's storage comes back.
+  bool reused = false;
+  for (int tick = 0; tick < 3; ++tick) {
+    matsimu::capture_frame(heat, frames.begin_write());
+    frames.publish();
+    reused = reused || frames.latest()->field.data() == first_data;
+  }
+  ASSERT(reused);
+  held.reset();
+
+  // A frame the reader still holds is never handed to the producer.
+  const std::shared_ptr<const matsimu::SimFrame> pinned = frames.latest();
+  const std::size_t pinned_step = pinned->step;
+  for (int tick = 0; tick < 5; ++tick) {
+    ASSERT(heat.advance(1) == 1);
+    matsimu::SimFrame& f = frames.begin_write();
+    ASSERT(&f != pinned.get());
+    matsimu::capture_frame(heat, f);
+    frames.publish();
+  }
+  ASSERT_EQ(pinned->step, pinned_step);
+  ASSERT_EQ(frames.buffers(), std::size_t(3));
+
+  // MD frames carry positions and velocities.
+  matsimu::Lattice box;
+  matsimu::ParticleSystem ps = make_lj_gas(box, 10);
+  matsimu::SimFrame pf;
+  matsimu::capture_frame(ps, pf);
+  ASSERT(pf.kind == matsimu::SimFrame::Kind::Particles);
+  ASSERT_EQ(pf.particle_count(), ps.size());
+  ASSERT_EQ(pf.pos[2][3], ps.pos(2)[3]);
+  ASSERT(pf.field.empty());
+  return 0;
+}
+
+int test_simulation_runner() {
+  // Runs to completion on the worker; the final frame matches the end state.
+  matsimu::HeatDiffusion2DParams hp;
+  hp.nx = 24;
+  hp.ny = 16;
+  hp.max_steps = 137;
+  matsimu::Simulation heat(hp);
+  matsimu::FrameExchange frames;
+  {
+    matsimu::SimulationRunner runner(heat, frames, 10);
+    runner.start();
+    while (!runner.finished()) std::this_thread::yield();
+    runner.stop();
+    ASSERT(runner.error().empty());
+    ASSERT_EQ(runner.steps(), std::size_t(137));
+  }
+  ASSERT_EQ(heat.step_count(), std::size_t(137));
+  ASSERT(frames.latest() != nullptr);
+  ASSERT_EQ(frames.latest()->step, std::size_t(137));
+  const auto& T = heat.heat_2d_model()->temperature();
+  for (std::size_t k = 0; k < T.size(); ++k) ASSERT_EQ(frames.latest()->field[k], T[k]);
+
+  // Continuous MD run: stop() halts after the current chunk and publishes it.
+  auto lj = std::make_shared<matsimu::LennardJones>(1.65e-21, 0.34e-9, 1.0e-9);
+  matsimu::SimulationParams p;
+  p.dt = 1e-15;
+  p.end_time = 0.0;
+  matsimu::Simulation md(p, lj);
+  matsimu::Lattice box;
+  md.system() = make_lj_gas(box, 30);
+  for (std::size_t i = 0; i < md.system().size(); ++i) md.system().set_mass(i, 6.6e-26);
+  md.set_lattice(box);
+  md.initialize();
+  matsimu::SimulationRunner runner(md, frames, 4);
+  runner.start();
+  while (runner.steps() < 8) std::this_thread::yield();
+  runner.stop();
+  ASSERT(!runner.finished());
+  ASSERT_EQ(md.step_count(), runner.steps());
+  ASSERT_EQ(md.step_count() % 4, std::size_t(0));
+  const auto frame = frames.latest();
+  ASSERT(frame->kind == matsimu::SimFrame::Kind::Particles);
+  ASSERT_EQ(frame->step, md.step_count());
+  ASSERT_EQ(frame->pos[0][5], md.system().pos(0)[5]);
+  return 0;
+}
+
+int test_step_stats() {
+  auto lj = std::make_shared<matsimu::LennardJones>(1.654e-21, 3.405e-10, 0.8e-9);
+  matsimu::SimulationParams p;
+  p.profile = true;
+  p.cutoff = 0.8e-9;
+  p.max_steps = 50;
+  matsimu::Simulation sim(p, lj);
+  matsimu::Lattice box;
+  sim.system() = make_lj_gas(box, 200);  // unit masses: overlaps stay finite
+  sim.set_lattice(box);
+  sim.set_thermostat(std::make_shared<matsimu::VelocityRescaleThermostat>(300.0, 1e-13));
+  sim.run();
+
+  matsimu::StepStats s = sim.stats();
+  ASSERT_EQ(s.steps, std::size_t(50));
+  ASSERT(s.neighbor_rebuilds >= 1);  // initial build in initialize()
+  ASSERT(s.average_pairs_per_rebuild() > 0.0);
+  ASSERT(s.peak_bytes >= s.bytes_in_use);
+  ASSERT(s.bytes_in_use >= 200 * 11 * sizeof(matsimu::Real));
+  ASSERT_EQ(s.max_bytes, p.max_bytes);
+  if (matsimu::kProfileCompiled) {
+    ASSERT(s.ns(matsimu::StepPhase::Forces) > 0);
+    ASSERT(s.ns(matsimu::StepPhase::Integrate1) > 0);
+    ASSERT(s.ns(matsimu::StepPhase::Thermostat) > 0);
+    ASSERT(s.total_ns() >= s.ns(matsimu::StepPhase::Forces));
+  }
+
+  sim.reset_stats();
+  s = sim.stats();
+  ASSERT_EQ(s.steps, std::size_t(0));
+  ASSERT_EQ(s.total_ns(), std::uint64_t(0));
+  ASSERT_EQ(s.neighbor_rebuilds, std::size_t(0));
+
+  // Off by default: counters only, no timings.
+  p.profile = false;
+  matsimu::Simulation quiet(p, lj);
+  quiet.system() = make_lj_gas(box, 50);
+  quiet.set_lattice(box);
+  quiet.run();
+  ASSERT_EQ(quiet.stats().steps, std::size_t(50));
+  ASSERT_EQ(quiet.stats().total_ns(), std::uint64_t(0));
+  return 0;
+}
+
+int test_skin_tuner() {
+  // Synthetic run: per-step force work ∝ (rc + s)³, a rebuild costs 20 steps'
+  // worth and happens every 400·s/rc steps (and right after a skin change).
+  // Optimum of the model: s ≈ 0.11 rc.
+  const matsimu::Real rc = 1.0e-9;
+  auto converge = [&](matsimu::Real start) {
+    matsimu::SkinTuner tuner(rc, start);
+    std::size_t since = 0;
+    bool forced = false;
+    for (int step = 0; step < 200000; ++step) {
+      const matsimu::Real s = tuner.skin();
+      const double work = std::pow((rc + s) / rc, 3.0) * 1000.0;
+      const bool rebuild = forced || ++since >= std::max<std::size_t>(1, static_cast<std::size_t>(400.0 * s / rc));
+      if (rebuild) since = 0;
+      forced = tuner.record(static_cast<std::uint64_t>(rebuild ? 21.0 * work : work), rebuild).has_value();
+    }
+    return tuner;
+  };
+  const matsimu::SkinTuner from_small = converge(0.06e-9);
+  const matsimu::SkinTuner from_large = converge(0.55e-9);
+  ASSERT(from_small.adjustments() > 0);
+  ASSERT(from_large.adjustments() > 0);
+  ASSERT(from_small.skin() > 0.08e-9 && from_small.skin() < 0.2e-9);
+  ASSERT(from_large.skin() > 0.08e-9 && from_large.skin() < 0.2e-9);
+
+  // The rebuild forced by a skin change is not counted toward the interval.
+  matsimu::SkinTuner every_step(rc, 0.06e-9);
+  for (std::size_t k = 0; k < matsimu::SkinTuner::kWindowRebuilds - 1; ++k)
+    ASSERT(!every_step.record(1000, true));
+  ASSERT(every_step.record(1000, true));  // rebuilding every step: grow
+  for (std::size_t k = 0; k < matsimu::SkinTuner::kWindowRebuilds; ++k)
+    ASSERT(!every_step.record(1000, true));  // forced rebuild skipped
+  ASSERT(every_step.record(1000, true));
+  ASSERT_EQ(every_step.adjustments(), std::size_t(2));
+
+  // Bounds hold and the simulation reports the live skin.
+  matsimu::SkinTuner bounded(rc, 5.0e-9);
+  ASSERT_EQ(bounded.skin(), 0.6 * rc);
+  matsimu::SimulationParams p;
+  p.neighbor_skin_auto = true;
+  p.max_steps = 30;
+  matsimu::Simulation sim(p, std::make_shared<matsimu::LennardJones>(1.654e-21, 3.405e-10, p.cutoff));
+  matsimu::Lattice box;
+  sim.system() = make_lj_gas(box, 100);
+  sim.set_lattice(box);
+  sim.run();
+  ASSERT_EQ(sim.stats().steps, std::size_t(30));
+  ASSERT_EQ(sim.stats().neighbor_skin, static_cast<double>(p.neighbor_skin));  // no change yet
+  p.neighbor_skin_min = 0.3e-9;
+  p.neighbor_skin_max = 0.1e-9;
+  ASSERT(p.validate().has_value());
+  return 0;
+}
+
+int test_spatial_sort() {
+  ASSERT_EQ(matsimu::morton_key(1, 0, 0), std::uint32_t(1));
+  ASSERT_EQ(matsimu::morton_key(0, 1, 0), std::uint32_t(2));
+  ASSERT_EQ(matsimu::morton_key(0, 0, 1), std::uint32_t(4));
+  ASSERT_EQ(matsimu::morton_key(3, 3, 3), std::uint32_t(63));
+  ASSERT_EQ(matsimu::morton_key(1023, 1023, 1023), (std::uint32_t(1) << 30) - 1);
+
+  // Reorder moves every array with the particle; ids follow.
+  matsimu::Lattice box;
+  matsimu::ParticleSystem ps = make_lj_gas(box, 300);
+  for (std::size_t i = 0; i < ps.size(); ++i) ps.set_mass(i, 1.0 + static_cast<double>(i));
+  const matsimu::ParticleSystem orig = ps;
+  ASSERT(!ps.reordered());
+  matsimu::sort_particles_morton(ps, &box);
+  matsimu::sort_particles_morton(ps, nullptr);
+  ASSERT(ps.reordered());
+  std::vector<std::uint32_t> slots;
+  ps.slots_by_id(slots);
+  bool moved = false;
+  for (std::size_t i = 0; i < ps.size(); ++i) {
+    const std::uint32_t id = ps.id(i);
+    moved = moved || id != i;
+    ASSERT_EQ(slots[id], std::uint32_t(i));
+    ASSERT_EQ(ps.pos(0)[i], orig.pos(0)[id]);
+    ASSERT_EQ(ps.pos(2)[i], orig.pos(2)[id]);
+    ASSERT_EQ(ps.vel(1)[i], orig.vel(1)[id]);
+    ASSERT_EQ(ps.masses()[i], orig.masses()[id]);
+    ASSERT_EQ(ps.inverse_masses()[i], orig.inverse_masses()[id]);
+  }
+  ASSERT(moved);
+  ASSERT(ps.id(0) != ps.id(1));
+
+  // MD with sorting on every rebuild matches the unsorted run per id.
+  auto lj = std::make_shared<matsimu::LennardJones>(1.654e-21, 3.405e-10, 0.8e-9);
+  matsimu::SimulationParams p;
+  p.cutoff = 0.8e-9;
+  p.precision = matsimu::Precision::Double;
+  p.max_steps = 40;
+  matsimu::Simulation plain(p, lj);
+  plain.system() = orig;
+  plain.set_lattice(box);
+  plain.run();
+  p.sort_interval = 1;
+  matsimu::Simulation sorted(p, lj);
+  sorted.system() = orig;
+  sorted.set_lattice(box);
+  const std::string bin_path = "/tmp/matsimu_test_sorted.traj";
+  matsimu::TrajectoryOptions opts;
+  opts.stride = 40;
+  matsimu::TrajectoryWriter traj(bin_path, opts);
+  sorted.set_step_callback([&](const matsimu::Simulation& s) { traj.on_step(s); });
+  sorted.run();
+  ASSERT(traj.close());
+  ASSERT(sorted.stats().particle_sorts >= 1);
+  ASSERT(sorted.system().reordered());
+  const matsimu::ParticleSystem& a = plain.system();
+  const matsimu::ParticleSystem& b = sorted.system();
+  for (std::size_t i = 0; i < b.size(); ++i) {
+    const std::uint32_t id = b.id(i);
+    ASSERT(std::abs(b.pos(0)[i] - a.pos(0)[id]) < 1e-15);
+    ASSERT(std::abs(b.pos(1)[i] - a.pos(1)[id]) < 1e-15);
+  }
+  ASSERT(std::abs(sorted.total_energy() - plain.total_energy()) < 1e-6 * std::abs(plain.total_energy()));
+
+  // Trajectory frames are in id order.
+  {
+    std::ifstream f(bin_path, std::ios::binary);
+    f.seekg(8 + 4 + 4 + 8 + 8 + 10 * sizeof(matsimu::Real));
+    std::vector<matsimu::Real> x(b.size());
+    f.read(reinterpret_cast<char*>(x.data()), x.size() * sizeof(matsimu::Real));
+    ASSERT(f.good());
+    for (std::size_t i = 0; i < b.size(); ++i) ASSERT_EQ(x[b.id(i)], b.pos(0)[i]);
+  }
+  std::remove(bin_path.c_str());
+
+  // Checkpoints carry the ids.
+  const std::string ck = "/tmp/matsimu_test_sorted.ckpt";
+  ASSERT(matsimu::save_checkpoint(sorted, ck).ok);
+  matsimu::Simulation back(p, lj);
+  ASSERT(matsimu::load_checkpoint(back, ck).ok);
+  ASSERT(back.system().reordered());
+  for (std::size_t i = 0; i < b.size(); ++i) ASSERT_EQ(back.system().id(i), b.id(i));
+  std::remove(ck.c_str());
+  return 0;
+}
+
+int test_kinetic_moments() {
+  // Fused moments match a naive sum; parallel and cached paths agree.
+  matsimu::Lattice box;
+  matsimu::ParticleSystem ps = make_lj_gas(box, 20000);
+  std::mt19937 rng(11u);
+  std::normal_distribution<matsimu::Real> thermal(0.0, 300.0);
+  for (std::size_t i = 0; i < ps.size(); ++i) {
+    ps.set_mass(i, 6.6e-26 * (1.0 + static_cast<double>(i % 3)));
+    for (int d = 0; d < 3; ++d) ps.vel(d)[i] = thermal(rng) + (d == 0 ? 50.0 : 0.0);
+  }
+  double ekin = 0.0, px = 0.0, mass = 0.0;
+  for (std::size_t i = 0; i < ps.size(); ++i) {
+    const double m = ps.masses()[i];
+    for (int d = 0; d < 3; ++d) ekin += 0.5 * m * ps.vel(d)[i] * ps.vel(d)[i];
+    px += m * ps.vel(0)[i];
+    mass += m;
+  }
+  const matsimu::KineticMoments serial = ps.kinetic_moments();
+  ASSERT(std::abs(serial.kinetic_energy - ekin) < 1e-12 * ekin);
+  ASSERT(std::abs(serial.momentum[0] - px) < 1e-9 * std::abs(px));
+  ASSERT(std::abs(serial.total_mass - mass) < 1e-12 * mass);
+  ASSERT(std::abs(serial.temperature - 2.0 * ekin / ((3.0 * ps.size() - 3.0) * 1.380649e-23)) < 1e-9 * serial.temperature);
+  const std::uint64_t version = ps.velocity_version();
+  ASSERT(&ps.kinetic_moments() == &ps.kinetic_moments());  // cached, no new pass
+  ASSERT_EQ(ps.velocity_version(), version);
+
+  matsimu::ThreadPool pool(4);
+  ps.vel(0);  // invalidate
+  ASSERT(ps.velocity_version() != version);
+  const matsimu::KineticMoments par = ps.kinetic_moments(&pool);
+  ASSERT(std::abs(par.kinetic_energy - serial.kinetic_energy) < 1e-13 * serial.kinetic_energy);
+  ps.vel(0);
+  ASSERT_EQ(ps.kinetic_moments(&pool).kinetic_energy, par.kinetic_energy);  // deterministic
+
+  // Analytic updates of the cache match a fresh pass.
+  ps.zero_com_velocity();
+  const matsimu::KineticMoments zeroed = ps.kinetic_moments();
+  ps.scale_velocities(0.5);
+  const matsimu::KineticMoments scaled = ps.kinetic_moments();
+  ps.vel(0);
+  const matsimu::KineticMoments fresh = ps.kinetic_moments();
+  ASSERT(std::abs(fresh.momentum[0]) < 1e-9 * std::abs(px));
+  ASSERT(std::abs(zeroed.kinetic_energy - 4.0 * fresh.kinetic_energy) < 1e-10 * zeroed.kinetic_energy);
+  ASSERT(std::abs(scaled.kinetic_energy - fresh.kinetic_energy) < 1e-12 * fresh.kinetic_energy);
+  ASSERT(std::abs(scaled.temperature - fresh.temperature) < 1e-12 * fresh.temperature);
+
+  // The second kick leaves the same bits a separate pass would produce.
+  auto lj = std::make_shared<matsimu::LennardJones>(1.654e-21, 3.405e-10, 0.8e-9);
+  matsimu::SimulationParams p;
+  p.cutoff = 0.8e-9;
+  p.max_steps = 3;
+  matsimu::Simulation sim(p, lj);
+  sim.system() = make_lj_gas(box, 3000);
+  for (std::size_t i = 0; i < sim.system().size(); ++i) sim.system().set_mass(i, 6.6e-26);
+  sim.set_lattice(box);
+  sim.run();
+  const std::uint64_t after_step = sim.system().velocity_version();
+  const matsimu::Real ek = sim.kinetic_energy();
+  ASSERT_EQ(sim.system().velocity_version(), after_step);
+  matsimu::ParticleSystem copy = sim.system();
+  copy.vel(0);
+  ASSERT_EQ(copy.kinetic_energy(), ek);
+  ASSERT_EQ(copy.temperature(), sim.temperature());
+  ASSERT(ek > 0.0);
+  return 0;
+}
+
+int test_counter_rng() {
+  // Philox4x32-10 known-answer vectors (Random123).
+  const matsimu::PhiloxBlock zero = matsimu::philox4x32({0, 0, 0, 0}, 0, 0);
+  ASSERT_EQ(zero[0], 0x6627e8d5u);
+  ASSERT_EQ(zero[3], 0x9b00dbd8u);
+  const matsimu::PhiloxBlock pi = matsimu::philox4x32({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u},
+                                                      0xa4093822u, 0x299f31d0u);
+  ASSERT_EQ(pi[0], 0xd16cfe09u);
+  ASSERT_EQ(pi[1], 0x94fdccebu);
+  ASSERT_EQ(pi[2], 0x5001e420u);
+  ASSERT_EQ(pi[3], 0x24126ea1u);
+
+  // Maxwell velocities: right temperature, same bits for any pool size.
+  matsimu::Lattice box;
+  matsimu::ParticleSystem ps = make_lj_gas(box, 6000);
+  for (std::size_t i = 0; i < ps.size(); ++i) ps.set_mass(i, 6.63e-26);
+  matsimu::ParticleSystem par = ps;
+  matsimu::ThreadPool pool(4);
+  matsimu::assign_maxwell_velocities(ps, 300.0, 9);
+  matsimu::assign_maxwell_velocities(par, 300.0, 9, &pool);
+  ASSERT(std::abs(ps.temperature() - 300.0) < 10.0);
+  for (std::size_t i = 0; i < ps.size(); ++i) ASSERT_EQ(par.vel(2)[i], ps.vel(2)[i]);
+
+  // Counter Andersen: thread count and storage order do not change the result.
+  matsimu::ParticleSystem sorted = ps;
+  matsimu::sort_particles_morton(sorted, &box);
+  auto serial = std::make_shared<matsimu::AndersenThermostat>(150.0, 1e13, 21, matsimu::ThermostatRng::Counter);
+  auto threaded = std::make_shared<matsimu::AndersenThermostat>(150.0, 1e13, 21, matsimu::ThermostatRng::Counter);
+  auto reordered = std::make_shared<matsimu::AndersenThermostat>(150.0, 1e13, 21, matsimu::ThermostatRng::Counter);
+  threaded->set_thread_pool(std::make_shared<matsimu::ThreadPool>(3));
+  par = ps;
+  const matsimu::ParticleSystem before = ps;
+  for (int s = 0; s < 3; ++s) {
+    serial->apply(ps, 1e-14);
+    threaded->apply(par, 1e-14);
+    reordered->apply(sorted, 1e-14);
+  }
+  std::size_t changed = 0;
+  for (std::size_t i = 0; i < ps.size(); ++i) {
+    ASSERT_EQ(par.vel(0)[i], ps.vel(0)[i]);
+    ASSERT_EQ(sorted.vel(1)[i], ps.vel(1)[sorted.id(i)]);
+    changed += ps.vel(0)[i] != before.vel(0)[i];
+  }
+  ASSERT(changed > 500 && changed < 5000);  // p = 1 - e^-0.1 per step, 3 steps: ~26 %
+
+  // State is (seed, apply count): a restored copy continues identically.
+  auto resumed = std::make_shared<matsimu::AndersenThermostat>(150.0, 1e13, 5, matsimu::ThermostatRng::Counter);
+  ASSERT(resumed->load_state(serial->save_state()));
+  ASSERT(!resumed->load_state("1 2 3"));
+  par = ps;
+  serial->apply(ps, 1e-14);
+  resumed->apply(par, 1e-14);
+  for (std::size_t i = 0; i < ps.size(); ++i) ASSERT_EQ(par.vel(0)[i], ps.vel(0)[i]);
+  return 0;
+}
+
+int test_arena() {
+  matsimu::Arena arena(1000);
+  ASSERT(arena.capacity() >= 1000);
+  const std::size_t cap = arena.capacity();
+  void* a = arena.allocate(100, 64);
+  ASSERT(reinterpret_cast<std::uintptr_t>(a) % 64 == 0);
+  ASSERT_EQ(arena.used(), std::size_t(100));
+  void* b = arena.allocate(50, 8);  // starts at 104
+  ASSERT_EQ(arena.used(), std::size_t(154));
+  ASSERT(!arena.reserve(cap * 4));  // cannot move live blocks
+  arena.deallocate(a, 100);         // not the top: kept
+  ASSERT_EQ(arena.used(), std::size_t(154));
+  arena.deallocate(b, 50);          // top: popped back to its start
+  ASSERT_EQ(arena.used(), std::size_t(104));
+  {
+    matsimu::ArenaScope scope(arena);
+    matsimu::ArenaVector<double> v(40, 1.0, matsimu::arena_allocator<double>(&arena));
+    ASSERT(arena.used() >= 100 + 40 * sizeof(double));
+    bool threw = false;
+    try {
+      matsimu::ArenaVector<char> big(cap, 'x', matsimu::arena_allocator<char>(&arena));
+    } catch (const std::bad_alloc&) {
+      threw = true;
+    }
+    ASSERT(threw);
+  }
+  ASSERT_EQ(arena.used(), std::size_t(104));
+  arena.reset();
+  ASSERT(arena.reserve(cap * 4));
+  ASSERT_EQ(arena.regions(), std::size_t(2));
+  matsimu::ArenaVector<int> heap(10, 3);  // null arena: plain heap
+  ASSERT_EQ(heap[9], 3);
+  matsimu::Arena huge(1, true);
+  ASSERT_EQ(huge.capacity() % matsimu::Arena::kHugePageBytes, std::size_t(0));
+
+  // bounded_allocator over an arena: the cap still applies per container.
+  using Capped = matsimu::bounded_allocator<int, matsimu::arena_allocator<int>>;
+  matsimu::Arena backing(1 << 16);
+  std::vector<int, Capped> capped(Capped(400, matsimu::arena_allocator<int>(&backing)));
+  capped.resize(100);
+  bool over = false;
+  try {
+    capped.resize(101);
+  } catch (const std::bad_alloc&) {
+    over = true;
+  }
+  ASSERT(over);
+
+  // Neighbor rebuilds and spatial sorts stop allocating regions after warm-up.
+  matsimu::Lattice box;
+  matsimu::ParticleSystem ps = make_lj_gas(box, 2000);
+  box.update_cache();
+  matsimu::NeighborList nl(0.8e-9, 0.2e-9);
+  nl.build(ps, &box);
+  matsimu::sort_particles_morton(ps, &box, &nl.scratch());
+  nl.build(ps, &box);
+  const std::size_t regions = nl.scratch().regions();
+  const std::size_t pairs = nl.num_pairs();
+  for (int k = 0; k < 5; ++k) {
+    matsimu::sort_particles_morton(ps, &box, &nl.scratch());
+    nl.build(ps, &box);
+  }
+  ASSERT_EQ(nl.scratch().regions(), regions);
+  ASSERT_EQ(nl.scratch().used(), std::size_t(0));
+  ASSERT_EQ(nl.num_pairs(), pairs);
+
+  // The scratch region is charged to the system's max_bytes budget.
+  ASSERT(nl.scratch().budget() == ps.budget().get());
+  matsimu::ParticleSystem tight(0, std::size_t(1) << 30);  // own budget (copies share theirs)
+  const matsimu::Real* pos[3] = {ps.pos(0), ps.pos(1), ps.pos(2)};
+  const matsimu::Real* vel[3] = {ps.vel(0), ps.vel(1), ps.vel(2)};
+  tight.append(ps.size(), pos, vel, ps.masses());
+  const std::size_t arrays = tight.bytes_in_use();
+  tight.budget()->max_bytes = arrays;
+  matsimu::NeighborList limited(0.8e-9, 0.2e-9);
+  bool refused = false;
+  try {
+    limited.build(tight, &box);
+  } catch (const std::bad_alloc&) {
+    refused = true;
+  }
+  ASSERT(refused);
+  tight.budget()->max_bytes = arrays + nl.scratch().capacity();
+  limited.build(tight, &box);
+  ASSERT_EQ(limited.num_pairs(), pairs);
+  ASSERT_EQ(tight.bytes_in_use(), arrays + limited.scratch().capacity());
+  return 0;
+}
+
+int test_memory_placement() {
+  // Small blocks and a null policy take the plain heap path.
+  ASSERT(matsimu::make_memory_placement(false, false, nullptr) == nullptr);
+  auto pool = std::make_shared<matsimu::ThreadPool>(2);
+  ASSERT(matsimu::make_memory_placement(false, true, nullptr) == nullptr);
+  auto huge = matsimu::make_memory_placement(true, false, nullptr);
+  auto touched = matsimu::make_memory_placement(false, true, pool);
+  ASSERT(huge && huge->huge_pages && !huge->first_touch);
+  ASSERT(touched && !touched->huge_pages && touched->first_touch);
+  ASSERT(!huge->placed(4096));
+  ASSERT(huge->placed(matsimu::MemoryPlacement::kMinBytes));
+
+  const std::size_t big = 3 * matsimu::MemoryPlacement::kHugePageBytes + 123;
+  void* h = matsimu::placement_allocate(big, huge.get());
+  ASSERT(reinterpret_cast<std::uintptr_t>(h) % matsimu::MemoryPlacement::kHugePageBytes == 0);
+  matsimu::placement_deallocate(h, big, huge.get());
+  char* t = static_cast<char*>(matsimu::placement_allocate(big, touched.get()));
+  ASSERT(reinterpret_cast<std::uintptr_t>(t) % 4096 == 0);
+  for (std::size_t off = 0; off < big; off += 4096) ASSERT_EQ(t[off], 0);
+  matsimu::placement_deallocate(t, big, touched.get());
+
+  // Particle arrays: placed, still bounded by the byte budget.
+  matsimu::ParticleSystem ps(300000, 1ull << 30, huge);
+  ASSERT(reinterpret_cast<std::uintptr_t>(ps.pos(0)) % matsimu::MemoryPlacement::kHugePageBytes == 0);
+  ps.pos(0)[299999] = 1.0;
+  bool over = false;
+  try {
+    matsimu::ParticleSystem tiny(300000, 1 << 20, huge);
+  } catch (const std::bad_alloc&) {
+    over = true;
+  }
+  ASSERT(over);
+
+  // Placement changes where the memory lives, never the results.
+  matsimu::Real epot[2];
+  for (int k = 0; k < 2; ++k) {
+    matsimu::SimulationParams p;
+    p.dt = 1e-15;
+    p.num_threads = 2;
+    p.huge_pages = p.first_touch = k == 1;
+    p.precision = matsimu::Precision::Double;
+    matsimu::Simulation sim(p, std::make_shared<matsimu::LennardJones>(1.65e-21, 0.34e-9, 1.0e-9));
+    ASSERT(sim.is_valid());
+    matsimu::Lattice box;
+    sim.system() = make_lj_gas(box, 200);
+    box.update_cache();
+    sim.set_lattice(box);
+    sim.initialize();
+    for (int s = 0; s < 5; ++s) ASSERT(sim.step());
+    epot[k] = sim.potential_energy();
+  }
+  ASSERT_EQ(epot[0], epot[1]);
+
+  matsimu::HeatDiffusion2DParams hp;
+  hp.precision = matsimu::Precision::Double;
+  hp.nx = hp.ny = 600;  // 2.9 MB per field: above kMinBytes
+  hp.dt = 0.9 * hp.stability_limit();
+  hp.num_threads = 2;
+  matsimu::HeatDiffusion2DModel plain(hp);
+  hp.huge_pages = hp.first_touch = true;
+  matsimu::HeatDiffusion2DModel placed(hp);
+  ASSERT(placed.is_valid());
+  ASSERT(reinterpret_cast<std::uintptr_t>(placed.temperature().data()) %
+             matsimu::MemoryPlacement::kHugePageBytes == 0);
+  for (int s = 0; s < 3; ++s) {
+    ASSERT(plain.step());
+    ASSERT(placed.step());
+  }
+  ASSERT(std::equal(plain.temperature().begin(), plain.temperature().end(), placed.temperature().begin()));
+
+  std::string path = "/tmp/matsimu_test_placement.conf";
+  {
+    std::ofstream f(path);
+    f << "huge_pages = true\nfirst_touch = 1\n";
+  }
+  matsimu::ConfigResult r = matsimu::load_config(path);
+  std::remove(path.c_str());
+  ASSERT(r.ok);
+  ASSERT(r.params.huge_pages);
+  ASSERT(r.params.first_touch);
+  return 0;
+}
+
+// Argon simple-cubic crystal at 40 K, 6^3 sites of 0.38 nm.
+matsimu::ParticleSystem make_lj_crystal(matsimu::Lattice& box) {
+  const int m = 6;
+  const matsimu::Real a = 0.38e-9;
+  box.a1[0] = box.a2[1] = box.a3[2] = m * a;
+  matsimu::ParticleSystem ps;
+  for (int i = 0; i < m; ++i)
+    for (int j = 0; j < m; ++j)
+      for (int k = 0; k < m; ++k) {
+        matsimu::Particle p;
+        p.pos[0] = i * a; p.pos[1] = j * a; p.pos[2] = k * a;
+        p.mass = 6.63e-26;
+        ps.add_particle(p);
+      }
+  matsimu::assign_maxwell_velocities(ps, 40.0, 11u);
+  return ps;
+}
+
+int test_respa_integrator() {
+  // Inner and outer shells add up to the full potential.
+  matsimu::Lattice box;
+  matsimu::ParticleSystem all = make_lj_gas(box, 300);
+  for (std::size_t i = 0; i < all.size(); ++i) all.set_mass(i, 6.63e-26);
+  matsimu::ParticleSystem inner = all, outer = all;
+  auto lj = std::make_shared<matsimu::LennardJones>(1.654e-21, 3.405e-10, 1.0e-9);
+  matsimu::NeighborForceField nf(lj, 1.0e-9, 0.2e-9);
+  nf.set_simd_level(matsimu::SimdLevel::Scalar);
+  const matsimu::Real e_all = nf.compute_forces(all, &box);
+  nf.set_shell_switch(0.6e-9, 0.12e-9);  // after the build: both shells walk the full list
+  const matsimu::Real e_in = nf.compute_forces(inner, &box, true, matsimu::ForceShell::Inner);
+  const matsimu::Real e_out = nf.compute_forces(outer, &box, true, matsimu::ForceShell::Outer);
+  ASSERT(e_in != 0.0 && e_out != 0.0);
+  ASSERT(std::fabs(e_in + e_out - e_all) <= 1e-9 * std::fabs(e_all));
+  for (int d = 0; d < 3; ++d)
+    for (std::size_t i = 0; i < all.size(); ++i) {
+      const matsimu::Real ref = all.force(d)[i];
+      ASSERT(std::fabs(inner.force(d)[i] + outer.force(d)[i] - ref) <= 1e-9 * (std::fabs(ref) + 1e-15));
+    }
+  ASSERT_EQ(nf.compute_energy(all, &box), e_all);  // shell passes leave the cache alone
+
+  // The short inner list, scalar and SIMD, gives the same shells.
+  const matsimu::SimdLevel best = matsimu::detect_simd_level();
+  for (matsimu::SimdLevel level : {matsimu::SimdLevel::Scalar, matsimu::SimdLevel::AVX2,
+                                   matsimu::SimdLevel::AVX512}) {
+    if (level > best) continue;
+    matsimu::NeighborForceField nf_short(lj, 1.0e-9, 0.2e-9);
+    nf_short.set_simd_level(level);
+    nf_short.set_shell_switch(0.6e-9, 0.12e-9);
+    for (const matsimu::ForceShell shell : {matsimu::ForceShell::Inner, matsimu::ForceShell::Outer}) {
+      const matsimu::ParticleSystem& ref = shell == matsimu::ForceShell::Inner ? inner : outer;
+      matsimu::ParticleSystem ps = all;
+      const matsimu::Real e = nf_short.compute_forces(ps, &box, true, shell);
+      const matsimu::Real e_ref = shell == matsimu::ForceShell::Inner ? e_in : e_out;
+      ASSERT(std::fabs(e - e_ref) <= 1e-12 * std::fabs(e_ref));
+      for (int d = 0; d < 3; ++d)
+        for (std::size_t i = 0; i < ps.size(); ++i) {
+          const matsimu::Real f = ref.force(d)[i];
+          ASSERT(std::fabs(ps.force(d)[i] - f) <= 1e-10 * (std::fabs(f) + 1e-15));
+        }
+    }
+  }
+
+  // 200 outer steps of 8 fs (2 fs inner) against plain Verlet at 2 fs:
+  // peak |E - E0| within 2x (about 0.9x here), with a quarter of the
+  // outer-shell passes. The switching zone sits between the second and
+  // third neighbor shells of the crystal (0.54 and 0.66 nm); the default
+  // zone [0.48, 0.6] nm cuts through the second shell and lets it
+  // contribute a fast, outer-stepped force (about 2.6x). The end-of-run
+  // energy is no measure: Verlet's error oscillates through zero.
+  matsimu::Real drift[2];
+  for (int k = 0; k < 2; ++k) {
+    matsimu::SimulationParams p;
+    p.cutoff = 1.0e-9;
+    p.dt = k == 0 ? 2e-15 : 8e-15;
+    p.respa_steps = k == 0 ? 1 : 4;
+    p.respa_split = 0.7e-9;
+    p.respa_switch = 0.2e-9;
+    p.max_steps = k == 0 ? 800 : 200;
+    p.num_threads = 2;
+    p.health_check = matsimu::HealthCheck::Fused;
+    p.precision = matsimu::Precision::Double;
+    matsimu::Simulation sim(p, lj);
+    ASSERT(sim.is_valid());
+    ASSERT_EQ(sim.integrator() && dynamic_cast<matsimu::RespaIntegrator*>(sim.integrator()) != nullptr, k == 1);
+    matsimu::Lattice crystal;
+    sim.system() = make_lj_crystal(crystal);
+    sim.set_lattice(crystal);
+    sim.initialize();
+    const matsimu::Real e0 = sim.total_energy();
+    drift[k] = 0.0;
+    while (sim.step())
+      drift[k] = std::max(drift[k], std::fabs(sim.total_energy() - e0) / std::fabs(e0));
+    ASSERT_EQ(sim.step_count(), p.max_steps);
+  }
+  ASSERT(drift[0] > 0.0);
+  ASSERT(drift[1] <= 2.0 * drift[0]);
+  ASSERT(drift[1] < 1e-4);
+
+  // Plugged in at run time; a switch wider than the split is rejected.
+  matsimu::SimulationParams p;
+  p.cutoff = 1.0e-9;
+  matsimu::Simulation sim(p, lj);
+  sim.set_integrator(std::make_unique<matsimu::RespaIntegrator>(4e-15, 2, 0.7e-9, 0.1e-9));
+  matsimu::Lattice crystal;
+  sim.system() = make_lj_crystal(crystal);
+  sim.set_lattice(crystal);
+  sim.initialize();
+  for (int s = 0; s < 10; ++s) ASSERT(sim.step());
+  p.respa_steps = 2;
+  p.respa_switch = 0.7e-9;
+  ASSERT(p.validate());
+  p.respa_switch = 0.0;
+  p.use_neighbor_list = false;
+  ASSERT(p.validate());
+
+  std::string path = "/tmp/matsimu_test_respa.conf";
+  {
+    std::ofstream f(path);
+    f << "respa_steps = 3\nrespa_split = 0.7e-9\nrespa_switch = 0.1e-9\n";
+  }
+  matsimu::ConfigResult r = matsimu::load_config(path);
+  std::remove(path.c_str());
+  ASSERT(r.ok);
+  ASSERT_EQ(r.params.respa_steps, std::size_t(3));
+  ASSERT_EQ(r.params.resolved_respa_split(), 0.7e-9);
+  ASSERT_EQ(r.params.resolved_respa_switch(), 0.1e-9);
+  return 0;
+}
+
+int test_tabulated_potential() {
+  const matsimu::Real eps = 1.654e-21, sigma = 3.405e-10, rc = 2.5 * sigma;
+  const matsimu::LennardJones lj(eps, sigma, rc);
+  const matsimu::TabulatedPotential table(lj, 0.8 * sigma);
+  ASSERT_EQ(table.points(), matsimu::TabulatedPotential::kDefaultPoints);
+  ASSERT_EQ(table.cutoff_squared(), lj.cutoff_squared());
+  // Segments are aligned to their size, one cache line per lookup.
+  constexpr std::size_t segment_bytes = matsimu::TabulatedPotential::kSegmentStride * sizeof(matsimu::Real);
+  ASSERT_EQ(reinterpret_cast<std::uintptr_t>(table.segment_data()) % segment_bytes, std::uintptr_t(0));
+
+  // Against the analytic form from the repulsive wall to the cutoff.
+  matsimu::Real max_de = 0.0, max_df = 0.0, f_scale = 0.0;
+  for (matsimu::Real r = 0.88 * sigma; r < rc; r += 1e-4 * sigma) {
+    const matsimu::Real r2 = r * r;
+    matsimu::Real e, f;
+    table.energy_and_force(r2, e, f);
+    ASSERT_EQ(e, table.energy(r2));
+    ASSERT_EQ(f, table.force_div_r(r2));
+    max_de = std::max(max_de, std::fabs(e - lj.energy(r2)));
+    max_df = std::max(max_df, std::fabs(f - lj.force_div_r(r2)) * r);
+    f_scale = std::max(f_scale, std::fabs(lj.force_div_r(r2)) * r);
+  }
+  ASSERT(max_de < 1e-7 * eps);
+  ASSERT(max_df < 1e-6 * f_scale);
+  ASSERT_EQ(table.energy(rc * rc), 0.0);
+  ASSERT_EQ(table.force_div_r(std::numeric_limits<matsimu::Real>::quiet_NaN()), 0.0);
+
+  // Drop-in for the neighbor force field.
+  matsimu::Lattice box;
+  matsimu::ParticleSystem analytic = make_lj_crystal(box);
+  for (std::size_t i = 0; i < analytic.size(); ++i) analytic.pos(0)[i] += 0.02e-9 * std::sin(0.7 * i);
+  matsimu::ParticleSystem tabulated = analytic;
+  matsimu::NeighborForceField nf_lj(std::make_shared<matsimu::LennardJones>(lj), rc, 0.1e-9);
+  matsimu::NeighborForceField nf_tab(std::make_shared<matsimu::TabulatedPotential>(table), rc, 0.1e-9);
+  nf_lj.set_simd_level(matsimu::SimdLevel::Scalar);
+  const matsimu::Real e_lj = nf_lj.compute_forces(analytic, &box);
+  const matsimu::Real e_tab = nf_tab.compute_forces(tabulated, &box);
+  ASSERT(std::fabs(e_tab - e_lj) <= 1e-6 * std::fabs(e_lj));
+  for (int d = 0; d < 3; ++d)
+    for (std::size_t i = 0; i < analytic.size(); ++i)
+      ASSERT(std::fabs(tabulated.force(d)[i] - analytic.force(d)[i]) <= 1e-5 * f_scale);
+
+  // Table file: unevenly spaced rows, resampled onto the r² grid.
+  std::string path = "/tmp/matsimu_test_potential.table";
+  {
+    std::ofstream f(path);
+    f << std::setprecision(17) << "# r energy force\n";
+    for (int k = 0; k <= 600; ++k) {
+      const matsimu::Real r = 0.8 * sigma + (rc - 0.8 * sigma) * std::pow(k / 600.0, 1.5);
+      const matsimu::Real r2 = k == 600 ? std::nextafter(rc * rc, 0.0) : r * r;
+      f << r << " " << lj.energy(r2) << " " << lj.force_div_r(r2) * r << "\n";
+    }
+  }
+  matsimu::PotentialTableResult loaded = matsimu::load_potential_table(path);
+  std::remove(path.c_str());
+  ASSERT(loaded.ok);
+  ASSERT(std::fabs(loaded.potential->cutoff() - rc) <= 1e-12 * rc);
+  for (matsimu::Real r = 0.9 * sigma; r < 0.99 * rc; r += 0.01 * sigma) {
+    ASSERT(std::fabs(loaded.potential->energy(r * r) - lj.energy(r * r)) <= 1e-5 * eps);
+    ASSERT(std::fabs(loaded.potential->force_div_r(r * r) - lj.force_div_r(r * r)) * r <= 1e-4 * f_scale);
+  }
+
+  {
+    std::ofstream f(path);
+    f << "3e-10 1 2\n2e-10 1 2\n";
+  }
+  loaded = matsimu::load_potential_table(path);
+  std::remove(path.c_str());
+  ASSERT(!loaded.ok && !loaded.error.empty());
+  ASSERT(!matsimu::load_potential_table("/nonexistent/table").ok);
+  bool threw = false;
+  try {
+    matsimu::TabulatedPotential bad(lj, 2.0 * rc);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  ASSERT(threw);
+  return 0;
+}
+
+int test_run_file() {
+  // Numbers go through from_chars: whole value or nothing.
+  matsimu::Real x = 1.0;
+  std::size_t n = 7;
+  ASSERT(matsimu::parse_config_number("2.5e-15", x) && x == 2.5e-15);
+  ASSERT(!matsimu::parse_config_number("2.5e-15 s", x) && x == 2.5e-15);
+  ASSERT(!matsimu::parse_config_number("-3", n) && n == 7u);
+  ASSERT(!matsimu::parse_config_number("", n));
+
+  // Binary particle file round trip.
+  matsimu::Lattice box;
+  const matsimu::ParticleSystem crystal = make_lj_crystal(box);
+  const std::string particles = "/tmp/matsimu_test_particles.bin";
+  ASSERT(matsimu::save_particles(crystal, box, particles).ok);
+  matsimu::ParticleFileResult loaded = matsimu::load_particles(particles);
+  ASSERT(loaded.ok);
+  const matsimu::ParticleSystem& ps = loaded.source->particles;
+  ASSERT_EQ(ps.size(), crystal.size());
+  ASSERT_EQ(loaded.source->lattice.a2[1], box.a2[1]);
+  for (std::size_t i = 0; i < ps.size(); ++i) {
+    ASSERT_EQ(ps.pos(0)[i], crystal.pos(0)[i]);
+    ASSERT_EQ(ps.vel(2)[i], crystal.vel(2)[i]);
+    ASSERT_EQ(ps.masses()[i], crystal.masses()[i]);
+  }
+  ASSERT(!matsimu::load_particles("/nonexistent/particles.bin").ok);
+  ASSERT(!matsimu::load_particles(particles, 1024).ok);  // over budget
+
+  const std::string path = "/tmp/matsimu_test_runs.cfg";
+  {
+    std::ofstream f(path);
+    f << "threads = 2\n"
+         "[defaults]\n"
+         "max_steps = 20\n"
+         "cutoff = 0.65e-9\n"
+         "# MD only: the grid runs skip it\n"
+         "temperature = 80\n"
+         "[run crystal]\n"
+         "cells = 3\n"
+         "thermostat = rescale\n"
+         "[run from-file]\n"
+         "particles = matsimu_test_particles.bin\n"
+         "[run plate]\n"
+         "model = heat2d\n"
+         "nx = 16\n"
+         "ny = 12\n"
+         "ic = uniform_hot\n"
+         "precision = double\n"
+         "backend = device\n"
+         "[run]\n"
+         "model = heat\n"
+         "n_cells = 20\n"
+         "end_time = 1e-4\n";
+  }
+  matsimu::RunPlanResult r = matsimu::load_run_file(path);
+  ASSERT(r.ok);
+  const matsimu::RunPlan& plan = r.plan;
+  ASSERT_EQ(plan.runs.size(), std::size_t(4));
+  ASSERT_EQ(plan.options.threads, std::size_t(2));
+  ASSERT(plan.runs[1].md.system.source != nullptr);
+  ASSERT(plan.runs[2].model == matsimu::RunModel::Heat2D);
+  ASSERT_EQ(plan.runs[2].heat_2d.ny, std::size_t(12));
+  ASSERT_EQ(plan.runs[2].heat_2d.max_steps, std::size_t(20));
+  ASSERT(plan.runs[2].heat_2d.ic == matsimu::HeatIC2D::UniformHot);
+  ASSERT(plan.runs[2].heat_2d.backend == matsimu::ComputeBackend::Device);
+  ASSERT_EQ(plan.runs[3].name, std::string("run3"));
+
+  // MD runs match the batch runner on the same spec.
+  const std::vector<matsimu::ReplicaResult> results = matsimu::run_plan(plan);
+  ASSERT_EQ(results.size(), std::size_t(4));
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    ASSERT(results[i].ok);
+    ASSERT_EQ(results[i].index, i);
+  }
+  const matsimu::ReplicaResult direct = matsimu::run_replica(plan.runs[0].md, 1u << 30);
+  ASSERT_EQ(results[0].total_energy, direct.total_energy);
+  ASSERT_EQ(results[1].atoms, crystal.size());
+  ASSERT_EQ(results[1].steps, std::size_t(20));
+  ASSERT_EQ(results[2].steps, std::size_t(20));
+  ASSERT(results[3].steps > 0);
+  std::ostringstream csv;
+  matsimu::write_run_csv(csv, plan, results);
+  ASSERT(csv.str().rfind("index,name,model,atoms,status", 0) == 0);
+  ASSERT(csv.str().find("\n2,plate,heat2d,0,ok,20,") != std::string::npos);
+
+  // Errors name the line.
+  auto fails = [&](const char* text, const char* fragment) {
+    {
+      std::ofstream f(path);
+      f << text;
+    }
+    const matsimu::RunPlanResult bad = matsimu::load_run_file(path);
+    return !bad.ok && bad.error.find(fragment) != std::string::npos;
+  };
+  ASSERT(fails("[run a]\nmodel = heat2d\ntemperature = 50\n", "Line 3: unknown key"));
+  ASSERT(fails("[defaults]\nbogus = 1\n[run a]\n", "Line 2: unknown key 'bogus'"));
+  ASSERT(fails("[run a]\nparticles = missing.bin\n", "Line 2: Cannot open"));
+  ASSERT(fails("[stage]\n", "unknown section"));
+  ASSERT(fails("[run hot]\nmodel = heat2d\ndt = 1\n", "Run 'hot' (line 1)"));
+  ASSERT(fails("threads = 2\n", "no [run] section"));
+  ASSERT(fails("[run a]\nmodel = heat3d\nbackend = gpu\n", "Line 3: invalid backend value"));
+  std::remove(path.c_str());
+  std::remove(particles.c_str());
+  return 0;
+}
+
+int test_distributed_simulation() {
+  matsimu::Lattice crystal;
+  const matsimu::ParticleSystem start = make_lj_crystal(crystal);  // 2.28 nm cube
+  auto lj = std::make_shared<matsimu::LennardJones>(1.654e-21, 3.405e-10, 0.85e-9);
+  matsimu::SimulationParams p;
+  p.cutoff = 0.85e-9;
+  p.neighbor_skin = 0.05e-9;  // frequent rebuilds, so particles migrate
+  p.dt = 4e-15;
+  p.max_steps = 150;
+  p.precision = matsimu::Precision::Double;
+
+  // Grid: least surface with subdomains at least cutoff + skin wide.
+  auto group = matsimu::LocalCommunicator::create_group(8);
+  matsimu::DomainDecomposition dd8(crystal, 0.9e-9, *group[5]);
+  ASSERT(dd8.is_valid());
+  ASSERT(dd8.grid() == (std::array<int, 3>{{2, 2, 2}}));
+  ASSERT(dd8.coords() == (std::array<int, 3>{{1, 0, 1}}));
+  const matsimu::Real corner[3] = {2.0e-9, -0.1e-9, 1.5e-9};  // wraps to y = 2.18 nm
+  ASSERT_EQ(dd8.owner_of(corner), 7);
+  auto three = matsimu::LocalCommunicator::create_group(3);
+  ASSERT(!matsimu::DomainDecomposition(crystal, 0.9e-9, *three[0]).is_valid());
+
+  // Single-process reference, Berendsen-coupled to 60 K.
+  matsimu::Simulation ref(p, lj);
+  ref.system() = start;
+  ref.set_lattice(crystal);
+  ref.set_thermostat(std::make_shared<matsimu::VelocityRescaleThermostat>(60.0, 2e-13));
+  ref.initialize();
+  ref.run();
+  ASSERT_EQ(ref.step_count(), p.max_steps);
+
+  for (int ranks : {1, 2, 4, 8}) {
+    auto comms = matsimu::LocalCommunicator::create_group(ranks);
+    std::vector<std::unique_ptr<matsimu::DistributedSimulation>> sims;
+    for (int r = 0; r < ranks; ++r) {
+      sims.push_back(std::make_unique<matsimu::DistributedSimulation>(p, lj, comms[r]));
+      sims.back()->set_lattice(crystal);
+      sims.back()->scatter(start);
+      sims.back()->set_thermostat(std::make_shared<matsimu::VelocityRescaleThermostat>(60.0, 2e-13));
+    }
+    std::vector<matsimu::ParticleSystem> gathered(static_cast<std::size_t>(ranks));
+    std::vector<std::thread> threads;
+    for (int r = 0; r < ranks; ++r)
+      threads.emplace_back([&, r] {
+        sims[r]->run();
+        sims[r]->gather(gathered[r]);
+      });
+    for (auto& t : threads) t.join();
+
+    std::size_t owned = 0, rebuilds = 0, migrated = 0;
+    for (auto& s : sims) {
+      ASSERT(s->is_valid());
+      ASSERT_EQ(s->step_count(), p.max_steps);
+      owned += s->system().size();
+      for (std::size_t i = 0; i < s->system().size(); ++i) {
+        const matsimu::Particle q = start[s->system().id(i)];
+        migrated += s->domain().owner_of(q.pos) != s->communicator().rank();
+      }
+      rebuilds = std::max(rebuilds, s->neighbor_rebuilds());
+      if (ranks > 1) ASSERT(s->ghost_count() > 0);
+    }
+    ASSERT_EQ(owned, start.size());
+    ASSERT(rebuilds > 3);
+    if (ranks > 1) ASSERT(migrated > 0);
+    const matsimu::DistributedSimulation& root = *sims[0];
+    ASSERT_EQ(root.global_count(), start.size());
+    ASSERT(std::fabs(root.temperature() - ref.temperature()) <= 1e-9 * ref.temperature());
+    const matsimu::Real e_ref = ref.potential_energy();
+    ASSERT(std::fabs(sims[0]->potential_energy() - e_ref) <= 1e-9 * std::fabs(e_ref));
+
+    // Same trajectory as the reference, up to rounding (ids follow the particles).
+    const matsimu::ParticleSystem& all = gathered[0];
+    ASSERT_EQ(all.size(), start.size());
+    if (ranks > 1) ASSERT(gathered[1].empty());
+    std::vector<std::uint32_t> slot;
+    ref.system().slots_by_id(slot);
+    matsimu::Real max_dx = 0.0;
+    for (std::size_t i = 0; i < all.size(); ++i) {
+      const matsimu::Real a[3] = {all.pos(0)[i], all.pos(1)[i], all.pos(2)[i]};
+      const matsimu::Real b[3] = {ref.system().pos(0)[slot[i]], ref.system().pos(1)[slot[i]],
+                                  ref.system().pos(2)[slot[i]]};
+      matsimu::Real dr[3];
+      crystal.min_image_displacement(a, b, dr);
+      max_dx = std::max({max_dx, std::fabs(dr[0]), std::fabs(dr[1]), std::fabs(dr[2])});
+    }
+    ASSERT(max_dx < 1e-15);
+  }
+
+  // Per-rank crystal construction keeps the sites scatter() would, with the
+  // same ids and positions; sites on slab boundaries (offset 0) included.
+  matsimu::Lattice fcc_cell;
+  fcc_cell.a1[0] = fcc_cell.a2[1] = fcc_cell.a3[2] = 0.526e-9;
+  for (const matsimu::Real shift : {0.0, 0.3}) {
+    matsimu::CrystalSpec spec;
+    for (auto& r : spec.repeats) r = 4;
+    spec.repeats[1] = 5;
+    spec.offset[0] = spec.offset[2] = shift;
+    matsimu::ParticleSystem whole;
+    const matsimu::Lattice box = matsimu::fill_crystal(whole, fcc_cell, spec);
+    for (int ranks : {1, 2, 8}) {
+      auto comms = matsimu::LocalCommunicator::create_group(ranks);
+      std::size_t owned = 0;
+      for (int r = 0; r < ranks; ++r) {
+        matsimu::DistributedSimulation by_scatter(p, lj, comms[r]);
+        matsimu::DistributedSimulation by_site(p, lj, comms[r]);
+        by_scatter.set_lattice(box);
+        by_site.set_lattice(box);
+        by_scatter.scatter(whole);
+        by_site.scatter_crystal(fcc_cell, spec);
+        ASSERT(by_site.is_valid());
+        const matsimu::ParticleSystem& a = by_scatter.system();
+        const matsimu::ParticleSystem& b = by_site.system();
+        ASSERT_EQ(b.size(), a.size());
+        for (std::size_t i = 0; i < a.size(); ++i) {
+          ASSERT_EQ(b.id(i), a.id(i));
+          for (int d = 0; d < 3; ++d) ASSERT_EQ(b.pos(d)[i], a.pos(d)[i]);
+          ASSERT_EQ(b.masses()[i], a.masses()[i]);
+        }
+        owned += b.size();
+      }
+      ASSERT_EQ(owned, whole.size());
+    }
+  }
+  matsimu::CrystalSpec wrong_box;
+  matsimu::DistributedSimulation mismatched(p, lj, group[0]);
+  mismatched.set_lattice(crystal);
+  mismatched.scatter_crystal(fcc_cell, wrong_box);
+  ASSERT(!mismatched.is_valid());
+  ASSERT(mismatched.system().empty());
+
+  // Each rank reports the cell-too-small error instead of running.
+  matsimu::DistributedSimulation bad(p, lj, three[0]);
+  bad.set_lattice(crystal);
+  ASSERT(!bad.is_valid());
+  ASSERT(!bad.step());
+  ASSERT(bad.error_message().find("3 ranks") != std::string::npos);
+  return 0;
+}
+
+int test_distributed_heat_2d() {
+  matsimu::HeatDiffusion2DParams p;
+  p.nx = 45;  // interior 43 x 30: uneven tiles
+  p.ny = 32;
+  p.dt = 0.9 * p.stability_limit();
+  p.max_steps = 60;
+  p.hot_radius_frac = 0.2;
+  p.precision = matsimu::Precision::Double;
+
+  // Tile grid: least halo per tile.
+  auto six = matsimu::LocalCommunicator::create_group(6);
+  matsimu::DistributedHeat2DModel tiled(p, six[4]);
+  ASSERT(tiled.is_valid());
+  ASSERT(tiled.grid() == (std::array<int, 2>{{3, 2}}));
+  ASSERT(tiled.coords() == (std::array<int, 2>{{1, 1}}));
+  ASSERT_EQ(tiled.tile().i0, 15u);
+  ASSERT_EQ(tiled.tile().j0, 16u);
+  ASSERT_EQ(tiled.tile().nx, 14u);
+  ASSERT_EQ(tiled.tile().ny, 15u);
+
+  for (matsimu::HeatIC2D ic : {matsimu::HeatIC2D::HotCenter, matsimu::HeatIC2D::UniformHot}) {
+    p.ic = ic;
+    matsimu::HeatDiffusion2DModel ref(p);
+    while (ref.step()) {}
+    for (int ranks : {1, 2, 4, 6}) {
+      auto comms = matsimu::LocalCommunicator::create_group(ranks);
+      matsimu::HeatDiffusion2DParams pr = p;
+      pr.num_threads = ranks == 2 ? 3 : 1;
+      std::vector<std::unique_ptr<matsimu::DistributedHeat2DModel>> models;
+      for (int r = 0; r < ranks; ++r)
+        models.push_back(std::make_unique<matsimu::DistributedHeat2DModel>(pr, comms[r]));
+      std::vector<std::vector<matsimu::Real>> gathered(static_cast<std::size_t>(ranks));
+      std::vector<std::thread> threads;
+      for (int r = 0; r < ranks; ++r)
+        threads.emplace_back([&, r] {
+          while (models[r]->step()) {}
+          models[r]->gather(gathered[r]);
+        });
+      for (auto& t : threads) t.join();
+
+      std::size_t cells = 0;
+      for (auto& m : models) {
+        ASSERT(m->is_valid());
+        ASSERT_EQ(m->step_count(), p.max_steps);
+        cells += m->tile().nx * m->tile().ny;
+      }
+      ASSERT_EQ(cells, (p.nx - 2) * (p.ny - 2));
+      if (ranks > 1) ASSERT(gathered[1].empty());
+      // Same arithmetic as the single-grid sweep: bit-identical.
+      const std::vector<matsimu::Real>& all = gathered[0];
+      ASSERT_EQ(all.size(), p.nx * p.ny);
+      ASSERT(std::equal(all.begin(), all.end(), ref.temperature().begin()));
+    }
+  }
+
+  // Too many ranks for the grid; implicit / single precision are rejected.
+  auto many = matsimu::LocalCommunicator::create_group(31 * 37);
+  matsimu::DistributedHeat2DModel crowded(p, many[0]);
+  ASSERT(!crowded.is_valid());
+  ASSERT(!crowded.step());
+  ASSERT(crowded.error_message().find("1147 ranks") != std::string::npos);
+  matsimu::HeatDiffusion2DParams single = p;
+  single.precision = matsimu::Precision::Single;
+  ASSERT(!matsimu::DistributedHeat2DModel(single, nullptr).is_valid());
+  return 0;
+}
+
+int test_batch_ensemble() {
+  matsimu::SimulationParams cfg;
+  ASSERT(matsimu::apply_config_value(cfg, "max_bytes", "4096") == std::nullopt);
+  ASSERT_EQ(cfg.max_bytes, std::size_t(4096));
+  ASSERT(matsimu::apply_config_value(cfg, "no_such_key", "1").has_value());
+  ASSERT(matsimu::apply_config_value(cfg, "dt", "fast").has_value());
+
+  const std::string path = "/tmp/matsimu_test_batch.cfg";
+  {
+    std::ofstream f(path);
+    f << "# 2 temperatures x 2 seeds\n"
+         "max_steps = 20\n"
+         "cutoff = 0.65e-9\n"
+         "neighbor_skin = 0.1e-9\n"
+         "cells = 3\n"
+         "thermostat = rescale\n"
+         "temperature = 60, 120\n"
+         "seed = 3:4\n"
+         "threads = 2\n";
+  }
+  matsimu::SweepResult sweep = matsimu::load_sweep(path);
+  ASSERT(sweep.ok);
+  ASSERT_EQ(sweep.plan.size(), std::size_t(4));
+  const std::vector<matsimu::ReplicaSpec> specs = matsimu::expand_sweep(sweep.plan);
+  ASSERT_EQ(specs.size(), std::size_t(4));
+  ASSERT_EQ(specs[1].params.temperature, matsimu::Real(60));  // last axis fastest
+  ASSERT_EQ(specs[1].seed, 4u);
+  ASSERT_EQ(specs[2].params.temperature, matsimu::Real(120));
+  ASSERT_EQ(specs[2].seed, 3u);
+
+  // Parallel results match serial ones replica by replica.
+  const auto parallel = matsimu::run_ensemble(specs, sweep.plan.options);
+  const auto serial = matsimu::run_ensemble(specs);
+  ASSERT_EQ(parallel.size(), std::size_t(4));
+  for (std::size_t i = 0; i < specs.size(); ++i) {
+    ASSERT(parallel[i].ok);
+    ASSERT_EQ(parallel[i].index, i);
+    ASSERT_EQ(parallel[i].atoms, std::size_t(108));
+    ASSERT_EQ(parallel[i].steps, std::size_t(20));
+    ASSERT_EQ(parallel[i].total_energy, serial[i].total_energy);
+    ASSERT(parallel[i].temperature > 0.0);
+  }
+  ASSERT(parallel[0].total_energy != parallel[1].total_energy);  // seeds differ
+
+  std::ostringstream csv;
+  matsimu::write_ensemble_csv(csv, sweep.plan, specs, parallel);
+  std::istringstream rows(csv.str());
+  std::string line;
+  std::getline(rows, line);
+  ASSERT(line.rfind("index,temperature,seed,atoms,status,", 0) == 0);
+  std::size_t n_rows = 0;
+  while (std::getline(rows, line)) ++n_rows;
+  ASSERT_EQ(n_rows, std::size_t(4));
+
+  // A total cap too small for the particle arrays fails every replica.
+  matsimu::EnsembleOptions tight;
+  tight.threads = 2;
+  tight.max_bytes = 2048;
+  for (const auto& r : matsimu::run_ensemble(specs, tight)) {
+    ASSERT(!r.ok);
+    ASSERT(r.error.find("memory budget") != std::string::npos);
+  }
+
+  {
+    std::ofstream f(path);
+    f << "temperature = 60, hot\n";
+  }
+  ASSERT(!matsimu::load_sweep(path).ok);
+  std::remove(path.c_str());
+  return 0;
+}
+
+int test_lattice_cache_matches_general() {
+  std::mt19937 rng(3u);
+  std::uniform_real_distribution<matsimu::Real> uni(-9.0e-9, 9.0e-9);
+  matsimu::Lattice ortho;
+  ortho.a1[0] = 4.0e-9; ortho.a2[1] = 3.0e-9; ortho.a3[2] = 5.0e-9;
+  matsimu::Lattice tri = ortho;
+  tri.a2[0] = 1.0e-9; tri.a3[0] = 0.5e-9; tri.a3[1] = -0.7e-9;
+
+  for (const matsimu::Lattice& general : {ortho, tri}) {
+    matsimu::Lattice cached = general;
+    cached.update_cache();
+    ASSERT(cached.is_orthorhombic() == (general.a2[0] == 0.0));
+    for (int k = 0; k < 200; ++k) {
+      const matsimu::Real r1[3] = {uni(rng), uni(rng), uni(rng)};
+      const matsimu::Real r2[3] = {uni(rng), uni(rng), uni(rng)};
+      matsimu::Real d_gen[3], d_fast[3], f_gen[3], f_fast[3];
+      general.min_image_displacement(r1, r2, d_gen);
+      cached.min_image_displacement(r1, r2, d_fast);
+      general.cartesian_to_fractional(r1, f_gen);
+      cached.cartesian_to_fractional(r1, f_fast);
+      for (int d = 0; d < 3; ++d) {
+        ASSERT(std::fabs(d_gen[d] - d_fast[d]) < 1e-20);
+        ASSERT(std::fabs(f_gen[d] - f_fast[d]) < 1e-12);
+      }
+    }
+  }
+
+  // Changing the basis after update_cache() falls back to the general path.
+  matsimu::Lattice stale = ortho;
+  stale.update_cache();
+  stale.a1[0] = 2.0e-9;
+  const matsimu::Real r1[3] = {0.0, 0.0, 0.0};
+  const matsimu::Real r2[3] = {1.5e-9, 0.0, 0.0};
+  matsimu::Real dr[3];
+  stale.min_image_displacement(r1, r2, dr);
+  ASSERT(std::fabs(dr[0] + 0.5e-9) < 1e-20);
+  return 0;
+}
+
+// Steps until the run stops; a NaN velocity is injected before the first step.
+int steps_until_non_finite(matsimu::HealthCheck policy, std::size_t interval) {
+  matsimu::SimulationParams p;
+  p.max_steps = 100;
+  p.use_neighbor_list = false;
+  p.health_check = policy;
+  p.health_check_interval = interval;
+  matsimu::Simulation sim(p);
+  if (!sim.is_valid()) return -1;
+  matsimu::Particle a;
+  sim.system().add_particle(a);
+  a.pos[0] = 1.0;
+  sim.system().add_particle(a);
+  sim.initialize();
+  sim.system().vel(1)[0] = std::numeric_limits<matsimu::Real>::quiet_NaN();
+  int steps = 0;
+  while (sim.step()) ++steps;
+  if (sim.error_message() != "Particle state became non-finite") return -1;
+  return steps + 1;
+}
+
+int test_health_check_policies() {
+  ASSERT_EQ(steps_until_non_finite(matsimu::HealthCheck::EveryStep, 1), 1);
+  ASSERT_EQ(steps_until_non_finite(matsimu::HealthCheck::Fused, 1), 1);
+  ASSERT_EQ(steps_until_non_finite(matsimu::HealthCheck::Interval, 4), 4);
+
+  // Fused check also catches a bad mass and a non-finite force.
+  matsimu::ParticleSystem ps;
+  ps.add_particle(matsimu::Particle());
+  matsimu::VelocityVerlet vv(1e-15);
+  ASSERT(vv.step1_checked(ps));
+  ASSERT(vv.step2_checked(ps));
+  ps.set_mass(0, -1.0);
+  ASSERT(!vv.step2_checked(ps));
+  ps.set_mass(0, 1.0);
+  ps.force(2)[0] = std::numeric_limits<matsimu::Real>::infinity();
+  ASSERT(!vv.step2_checked(ps));
+
+  matsimu::SimulationParams bad;
+  bad.health_check = matsimu::HealthCheck::Interval;
+  bad.health_check_interval = 0;
+  ASSERT(bad.validate().has_value());
+  return 0;
+}
+
+int test_observables() {
+  const matsimu::Real rc = 1.0e-9;
+  const matsimu::LennardJones lj(1.654e-21, 3.405e-10, rc);
+  auto table = std::make_shared<matsimu::TabulatedPotential>(lj, 0.8 * 3.405e-10);
+  auto make_sim = [&](std::size_t threads) {
+    matsimu::SimulationParams p;
+    p.cutoff = rc;
+    p.num_threads = threads;
+    auto sim = std::make_unique<matsimu::Simulation>(p, table);
+    matsimu::Lattice crystal;
+    sim->system() = make_lj_crystal(crystal);
+    sim->set_lattice(crystal);
+    sim->initialize();
+    return sim;
+  };
+
+  matsimu::ObservableParams op;
+  op.rdf_stride = 4;
+  op.rdf_bins = 50;
+  op.rdf_max = 0.9e-9;
+  op.pressure_stride = 3;
+  op.temperature_profile_stride = 6;
+  op.temperature_profile_bins = 6;
+  op.temperature_profile_axis = 1;
+
+  // Sampling leaves the trajectory untouched.
+  auto plain = make_sim(1);
+  auto sampled = make_sim(1);
+  ASSERT(!sampled->set_observables(op));
+  for (int s = 0; s < 12; ++s) {
+    ASSERT(plain->step());
+    ASSERT(sampled->step());
+  }
+  for (int d = 0; d < 3; ++d)
+    for (std::size_t i = 0; i < plain->system().size(); ++i) {
+      ASSERT_EQ(sampled->system().pos(d)[i], plain->system().pos(d)[i]);
+      ASSERT_EQ(sampled->system().vel(d)[i], plain->system().vel(d)[i]);
+    }
+  const matsimu::Observables& obs = sampled->observables();
+  ASSERT_EQ(obs.rdf_samples(), std::size_t(3));
+  ASSERT_EQ(obs.pressure_samples(), std::size_t(4));
+  ASSERT_EQ(obs.temperature_profile_samples(), std::size_t(2));
+  ASSERT_EQ(obs.rdf().size(), std::size_t(50));
+  ASSERT_EQ(obs.rdf_bin_width(), 0.9e-9 / 50);
+
+  // Step 12 sampled everything: check against brute force over the final state.
+  const matsimu::ParticleSystem& ps = sampled->system();
+  const matsimu::Lattice& box = *sampled->lattice();
+  const matsimu::Real width = obs.rdf_bin_width();
+  std::vector<std::uint64_t> hist(50, 0);
+  matsimu::Real virial = 0.0;
+  for (std::size_t i = 0; i < ps.size(); ++i)
+    for (std::size_t j = i + 1; j < ps.size(); ++j) {
+      const matsimu::Real ri[3] = {ps.pos(0)[i], ps.pos(1)[i], ps.pos(2)[i]};
+      const matsimu::Real rj[3] = {ps.pos(0)[j], ps.pos(1)[j], ps.pos(2)[j]};
+      matsimu::Real dr[3];
+      box.min_image_displacement(ri, rj, dr);
+      const matsimu::Real r2 = dr[0] * dr[0] + dr[1] * dr[1] + dr[2] * dr[2];
+      if (r2 >= table->cutoff_squared()) continue;
+      virial += table->force_div_r(r2) * r2;
+      if (r2 < 0.81e-18) ++hist[std::min<std::size_t>(49, static_cast<std::size_t>(std::sqrt(r2) / width))];
+    }
+  ASSERT(std::fabs(obs.last_virial() - virial) <= 1e-9 * std::fabs(virial));
+  const matsimu::Real volume = std::fabs(box.volume());
+  ASSERT(std::fabs(obs.last_pressure() - (2.0 * sampled->kinetic_energy() + virial) / (3.0 * volume)) <=
+         1e-9 * std::fabs(obs.last_pressure()));
+  // Counts of the last sample: the running total minus the first two.
+  auto counts_after = [&](std::size_t steps, std::size_t threads) {
+    auto sim = make_sim(threads);
+    sim->set_observables(op);
+    for (std::size_t s = 0; s < steps; ++s) sim->step();
+    return sim->observables().rdf_counts();
+  };
+  // All-pairs force field, threaded.
+  {
+    matsimu::SimulationParams p;
+    p.cutoff = rc;
+    p.use_neighbor_list = false;
+    p.num_threads = 2;
+    matsimu::Simulation direct(p, table);
+    direct.system() = ps;
+    direct.set_lattice(box);
+    direct.initialize();
+    matsimu::ObservableParams pressure_only;
+    pressure_only.pressure_stride = 1;
+    ASSERT(!direct.set_observables(pressure_only));
+    ASSERT(direct.step());
+    ASSERT_EQ(direct.observables().pressure_samples(), std::size_t(1));
+    ASSERT(std::fabs(direct.observables().last_virial() - virial) <= 0.05 * std::fabs(virial));
+  }
+  const std::vector<std::uint64_t> before = counts_after(8, 1);
+  const std::vector<std::uint64_t> total = counts_after(12, 3);  // per-thread histograms merge
+  ASSERT(total == obs.rdf_counts());
+  for (std::size_t k = 0; k < hist.size(); ++k) ASSERT_EQ(total[k] - before[k], hist[k]);
+
+  // The profile's slabs hold every atom and add up to 2K.
+  const matsimu::KineticProfile& profile = obs.last_profile();
+  matsimu::Real mv2 = 0.0;
+  std::uint64_t atoms = 0;
+  for (std::size_t k = 0; k < profile.bins(); ++k) {
+    mv2 += profile.mv2()[k];
+    atoms += profile.counts()[k];
+  }
+  ASSERT_EQ(atoms, std::uint64_t(ps.size()));
+  ASSERT(std::fabs(mv2 - 2.0 * sampled->kinetic_energy()) <= 1e-12 * mv2);
+  for (matsimu::Real t : obs.temperature_profile()) ASSERT(t > 0.0);
+
+  // Under a thermostat, pressure and profile take K on the same side of it.
+  {
+    auto heated = make_sim(1);
+    heated->set_thermostat(std::make_shared<matsimu::VelocityRescaleThermostat>(300.0, 1e-14));
+    matsimu::ObservableParams both;
+    both.pressure_stride = 1;
+    both.temperature_profile_stride = 1;
+    ASSERT(!heated->set_observables(both));
+    ASSERT(heated->step());
+    const matsimu::Observables& hot = heated->observables();
+    matsimu::Real swept = 0.0;
+    for (matsimu::Real m : hot.last_profile().mv2()) swept += m;
+    const matsimu::Real two_k = hot.last_pressure() * 3.0 * volume - hot.last_virial();
+    ASSERT(std::fabs(two_k - swept) <= 1e-9 * swept);
+    ASSERT(std::fabs(swept - 2.0 * heated->kinetic_energy()) > 1e-3 * swept);
+  }
+
+  matsimu::ObservableParams bad = op;
+  bad.temperature_profile_axis = 3;
+  ASSERT(sampled->set_observables(bad).has_value());
+  ASSERT_EQ(sampled->observables().rdf_samples(), std::size_t(3));
+  bad = op;
+  bad.rdf_bins = 0;
+  ASSERT(bad.validate().has_value());
+  return 0;
+}
+
+int test_device_backend() {
+  // Explicit heat stencils on the device match the scalar host kernels bit for bit.
+  matsimu::HeatDiffusion2DParams p2;
+  p2.precision = matsimu::Precision::Double;
+  p2.nx = 53;
+  p2.ny = 41;
+  p2.hot_radius_frac = 0.2;
+  p2.dt = 0.9 * p2.stability_limit();
+  matsimu::HeatDiffusion2DModel host2(p2);
+  host2.set_simd_level(matsimu::SimdLevel::Scalar);
+  p2.backend = matsimu::ComputeBackend::Device;
+  matsimu::HeatDiffusion2DModel dev2(p2);
+  ASSERT(host2.is_valid());
+  ASSERT(dev2.is_valid());
+  for (int s = 0; s < 20; ++s) {
+    ASSERT(host2.step());
+    ASSERT(dev2.step());
+  }
+  for (std::size_t k = 0; k < host2.temperature().size(); ++k)
+    ASSERT_EQ(dev2.temperature()[k], host2.temperature()[k]);
+
+  // Checkpoint buffers come back through the host copy; restore uploads.
+  std::vector<matsimu::StateBuffer> bufs = dev2.state_buffers();
+  ASSERT(!bufs.empty());
+  std::vector<char> saved(static_cast<char*>(bufs[0].data),
+                          static_cast<char*>(bufs[0].data) + bufs[0].bytes);
+  const matsimu::Real t_saved = dev2.time();
+  const std::size_t n_saved = dev2.step_count();
+  for (int s = 0; s < 5; ++s) ASSERT(dev2.step());
+  bufs = dev2.state_buffers();
+  std::copy(saved.begin(), saved.end(), static_cast<char*>(bufs[0].data));
+  dev2.restore_clock(t_saved, n_saved);
+  for (int s = 0; s < 5; ++s) {
+    ASSERT(dev2.step());
+    ASSERT(host2.step());
+  }
+  for (std::size_t k = 0; k < host2.temperature().size(); ++k)
+    ASSERT_EQ(dev2.temperature()[k], host2.temperature()[k]);
+
+  matsimu::HeatDiffusion2DParams bad = p2;
+  bad.scheme = matsimu::HeatScheme::Implicit;
+  ASSERT(bad.validate().has_value());
+  bad = p2;
+  bad.precision = matsimu::Precision::Single;
+  ASSERT(bad.validate().has_value());
+
+  matsimu::HeatDiffusion3DParams p3;
+  p3.nx = 21;  // padded pitch
+  p3.ny = 13;
+  p3.nz = 9;
+  p3.hot_radius_frac = 0.25;
+  p3.dt = 0.9 * p3.stability_limit();
+  matsimu::HeatDiffusion3DModel host3(p3);
+  host3.set_simd_level(matsimu::SimdLevel::Scalar);
+  p3.backend = matsimu::ComputeBackend::Device;
+  matsimu::HeatDiffusion3DModel dev3(p3);
+  ASSERT(dev3.is_valid());
+  for (int s = 0; s < 12; ++s) {
+    ASSERT(host3.step());
+    ASSERT(dev3.step());
+  }
+  for (std::size_t k = 0; k < p3.nz; ++k)
+    for (std::size_t j = 0; j < p3.ny; ++j)
+      for (std::size_t i = 0; i < p3.nx; ++i)
+        ASSERT_EQ(dev3.temperature(i, j, k), host3.temperature(i, j, k));
+
+  // Device forces agree with the host neighbor list (LJ and tabulated), with
+  // 2 and 3 binning cells per axis.
+  const matsimu::Real rc = 0.9e-9, skin = 0.1e-9;
+  auto lj = std::make_shared<matsimu::LennardJones>(1.654e-21, 3.405e-10, rc);
+  auto table = std::make_shared<matsimu::TabulatedPotential>(*lj, 0.8 * 3.405e-10);
+  matsimu::Lattice small_box;
+  const matsimu::ParticleSystem crystal = make_lj_crystal(small_box);
+  small_box.update_cache();
+  matsimu::Lattice fcc_cell;
+  fcc_cell.a1[0] = fcc_cell.a2[1] = fcc_cell.a3[2] = 0.526e-9;
+  matsimu::CrystalSpec fcc;
+  for (auto& r : fcc.repeats) r = 7;
+  matsimu::ParticleSystem block;
+  const matsimu::Lattice block_box = matsimu::fill_crystal(block, fcc_cell, fcc);
+  const std::pair<const matsimu::ParticleSystem*, matsimu::Lattice> force_cases[] = {
+      {&crystal, small_box}, {&block, block_box}};
+  for (const auto& [start, box] : force_cases)
+  for (const std::shared_ptr<matsimu::Potential>& pot :
+       {std::shared_ptr<matsimu::Potential>(lj), std::shared_ptr<matsimu::Potential>(table)}) {
+    matsimu::ParticleSystem ref = *start;
+    for (std::size_t i = 0; i < ref.size(); ++i) ref.pos(1)[i] += 0.015e-9 * std::cos(1.3 * i);
+    matsimu::ParticleSystem dev = ref;
+    matsimu::NeighborForceField nf(pot, rc, skin);
+    nf.set_simd_level(matsimu::SimdLevel::Scalar);
+    const matsimu::Real e_ref = nf.compute_forces(ref, &box);
+
+    const std::size_t n = dev.size();
+    matsimu::DeviceMirror<matsimu::Real> pos[3], force[3];
+    matsimu::DeviceParticleArrays arrays;
+    arrays.n = n;
+    for (int d = 0; d < 3; ++d) {
+      pos[d].map(dev.pos(d), n);
+      force[d].map(dev.force(d), n);
+      arrays.pos[d] = dev.pos(d);
+      arrays.force[d] = dev.force(d);
+    }
+    matsimu::DeviceForceField dff(pot, skin);
+    dff.set_box(box);
+    const matsimu::Real e_dev = dff.compute_forces(arrays);
+    ASSERT_EQ(dff.compute_forces(arrays, false), 0.0);
+    ASSERT_EQ(dff.rebuilds(), std::size_t(1));
+    for (int d = 0; d < 3; ++d) force[d].download();
+    ASSERT(std::fabs(e_dev - e_ref) <= 1e-10 * std::fabs(e_ref));
+    matsimu::Real f_scale = 0.0;
+    for (int d = 0; d < 3; ++d)
+      for (std::size_t i = 0; i < n; ++i) f_scale = std::max(f_scale, std::fabs(ref.force(d)[i]));
+    ASSERT(f_scale > 0.0);
+    for (int d = 0; d < 3; ++d)
+      for (std::size_t i = 0; i < n; ++i)
+        ASSERT(std::fabs(dev.force(d)[i] - ref.force(d)[i]) <= 1e-9 * f_scale);
+  }
+  bool rejected = false;
+  try {
+    matsimu::DeviceForceField harmonic(std::make_shared<matsimu::HarmonicPotential>(1.0, 0.3e-9, rc), skin);
+  } catch (const std::invalid_argument&) {
+    rejected = true;
+  }
+  ASSERT(rejected);
+
+  // Device MD follows the host trajectory and conserves energy.
+  matsimu::SimulationParams mp;
+  mp.cutoff = rc;
+  mp.neighbor_skin = skin;
+  mp.dt = 2e-15;
+  mp.max_steps = 200;
+  mp.precision = matsimu::Precision::Double;
+  matsimu::Simulation host(mp, lj);
+  matsimu::Lattice cell;
+  host.system() = make_lj_crystal(cell);
+  host.set_lattice(cell);
+  host.initialize();
+  matsimu::DeviceSimulation device(mp, lj);
+  ASSERT(!device.is_valid());
+  device.system() = make_lj_crystal(cell);
+  device.set_lattice(cell);
+  ASSERT(device.is_valid());
+  device.initialize();
+  ASSERT(std::fabs(device.temperature() - host.temperature()) <= 1e-9 * host.temperature());
+  const matsimu::Real e0 = device.total_energy();
+  ASSERT(std::fabs(e0 - host.total_energy()) <= 1e-9 * std::fabs(e0));
+  const std::size_t snaps = device.snapshots();
+  for (int s = 0; s < 100; ++s) {
+    ASSERT(host.step());
+    ASSERT(device.step());
+  }
+  ASSERT_EQ(device.snapshots(), snaps);  // nothing downloaded while stepping
+  const matsimu::ParticleSystem& dev_ps = static_cast<const matsimu::DeviceSimulation&>(device).system();
+  ASSERT_EQ(device.snapshots(), snaps + 1);
+  static_cast<const matsimu::DeviceSimulation&>(device).system();
+  ASSERT_EQ(device.snapshots(), snaps + 1);
+  matsimu::Real max_dx = 0.0;
+  for (int d = 0; d < 3; ++d)
+    for (std::size_t i = 0; i < dev_ps.size(); ++i) {
+      matsimu::Real dx = std::fabs(dev_ps.pos(d)[i] - host.system().pos(d)[i]);
+      dx = std::min(dx, cell.a1[0] - dx);
+      max_dx = std::max(max_dx, dx);
+    }
+  ASSERT(max_dx < 1e-13);
+  ASSERT(std::fabs(device.temperature() - host.temperature()) <= 1e-6 * host.temperature());
+  device.run();
+  ASSERT(device.finished());
+  ASSERT_EQ(device.step_count(), mp.max_steps);
+  ASSERT(std::fabs(device.total_energy() - e0) <= 1e-4 * std::fabs(e0));
+
+  // Host edits are uploaded on the next step; rescaling runs on the device.
+  mp.max_steps = 50;
+  matsimu::DeviceSimulation hot(mp, table);
+  hot.system() = make_lj_crystal(cell);
+  hot.set_lattice(cell);
+  hot.set_thermostat(std::make_shared<matsimu::VelocityRescaleThermostat>(120.0, 10e-15));
+  hot.initialize();
+  ASSERT(hot.step());
+  const std::size_t uploads = hot.uploads();
+  matsimu::ParticleSystem& hot_ps = hot.system();  // snapshot only: nothing written
+  ASSERT(hot_ps.size() > 0);
+  ASSERT(hot.step());
+  ASSERT_EQ(hot.uploads(), uploads);
+  const matsimu::Real t_start = hot.temperature();
+  matsimu::Real* vel[3] = {hot.system().vel(0), hot.system().vel(1), hot.system().vel(2)};
+  for (int d = 0; d < 3; ++d)
+    for (std::size_t i = 0; i < hot_ps.size(); ++i) vel[d][i] *= 1.5;
+  ASSERT(hot.step());
+  ASSERT_EQ(hot.uploads(), uploads + 1);
+  ASSERT(hot.temperature() > 1.5 * t_start);
+  hot.run();
+  ASSERT(std::fabs(hot.temperature() - 120.0) < 30.0);
+
+  // Andersen goes through the host velocities.
+  matsimu::DeviceSimulation andersen(mp, lj);
+  andersen.system() = make_lj_crystal(cell);
+  andersen.set_lattice(cell);
+  andersen.set_thermostat(std::make_shared<matsimu::AndersenThermostat>(80.0, 1e13, 5u));
+  andersen.run();
+  ASSERT(andersen.is_valid());
+  ASSERT_EQ(andersen.step_count(), mp.max_steps);
+  ASSERT(andersen.temperature() > 40.0);
+
+  // Unsupported potential, sheared or too small box, r-RESPA.
+  matsimu::DeviceSimulation harmonic_sim(mp, std::make_shared<matsimu::HarmonicPotential>(1.0, 0.3e-9, rc));
+  harmonic_sim.set_lattice(cell);
+  ASSERT(!harmonic_sim.is_valid());
+  ASSERT(!harmonic_sim.error_message().empty());
+  matsimu::DeviceSimulation boxed(mp, lj);
+  matsimu::Lattice sheared = cell;
+  sheared.a2[0] = 0.3e-9;
+  boxed.set_lattice(sheared);
+  ASSERT(!boxed.is_valid());
+  matsimu::Lattice small = cell;
+  small.a1[0] = 1.5e-9;
+  boxed.set_lattice(small);
+  ASSERT(!boxed.is_valid());
+  ASSERT(!boxed.step());
+  boxed.set_lattice(cell);
+  ASSERT(boxed.is_valid());
+  matsimu::SimulationParams respa = mp;
+  respa.respa_steps = 2;
+  respa.respa_switch = 0.6e-9;
+  ASSERT(!matsimu::DeviceSimulation(respa, lj).is_valid());
+
+  // Simulation picks the device run through params.backend.
+  matsimu::SimulationParams dp = mp;
+  ASSERT(!matsimu::apply_config_value(dp, "backend", "device"));
+  ASSERT(matsimu::apply_config_value(dp, "backend", "gpu").has_value());
+  ASSERT(dp.backend == matsimu::ComputeBackend::Device);
+  respa.backend = matsimu::ComputeBackend::Device;
+  ASSERT(respa.validate().has_value());
+  matsimu::Simulation selected(dp);  // potential after the lattice
+  ASSERT(selected.device_simulation() != nullptr);
+  ASSERT(host.device_simulation() == nullptr);
+  selected.system() = make_lj_crystal(cell);
+  selected.set_lattice(cell);
+  ASSERT(!selected.is_valid());
+  selected.set_potential(lj);
+  ASSERT(selected.is_valid());
+  ASSERT(selected.potential() == lj.get());
+  ASSERT(selected.set_observables(matsimu::ObservableParams{}).has_value());
+  matsimu::DeviceSimulation direct(dp, lj);
+  direct.system() = make_lj_crystal(cell);
+  direct.set_lattice(cell);
+  std::size_t callbacks = 0;
+  selected.set_step_callback([&](const matsimu::Simulation&) { ++callbacks; });
+  selected.run();
+  direct.run();
+  ASSERT_EQ(selected.step_count(), direct.step_count());
+  ASSERT_EQ(callbacks, direct.step_count());
+  ASSERT_EQ(selected.stats().steps, direct.step_count());
+  ASSERT_EQ(selected.total_energy(), direct.total_energy());
+  for (int d = 0; d < 3; ++d)
+    for (std::size_t i = 0; i < direct.system().size(); ++i)
+      ASSERT_EQ(selected.system().pos(d)[i], direct.system().pos(d)[i]);
+  return 0;
+}
+
 }  // namespace
 
 int main() {
@@ -271,6 +2959,44 @@ int main() {
     test_heat_deterministic,
     test_heat2d_examples_smoke,
     test_thermal_shock_like_md_smoke,
+    test_neighbor_build_modes_match,
+    test_neighbor_csr_reuses_storage,
+    test_config_neighbor_build,
+    test_particle_soa_layout,
+    test_particle_builder,
+    test_parallel_forces_deterministic,
+    test_config_num_threads,
+    test_pair_force_direction,
+    test_fused_pair_kernel_matches_virtual,
+    test_simd_lj_matches_scalar,
+    test_lattice_cache_matches_general,
+    test_health_check_policies,
+    test_energy_cache_and_energy_free_forces,
+    test_energy_interval,
+    test_heat2d_tiled_matches_reference,
+    test_heat_advance_matches_steps,
+    test_heat_implicit_schemes,
+    test_heat3d_matches_reference,
+    test_precision_accuracy,
+    test_checkpoint_restart,
+    test_trajectory_writer,
+    test_frame_exchange,
+    test_simulation_runner,
+    test_step_stats,
+    test_skin_tuner,
+    test_spatial_sort,
+    test_kinetic_moments,
+    test_counter_rng,
+    test_arena,
+    test_memory_placement,
+    test_respa_integrator,
+    test_tabulated_potential,
+    test_distributed_simulation,
+    test_distributed_heat_2d,
+    test_batch_ensemble,
+    test_run_file,
+    test_observables,
+    test_device_backend,
   };
   for (auto run : tests) {
     if (run() != 0) return 1;